@@ -0,0 +1,76 @@
+#version 120
+
+// The visual frame of the vertex within its pyramid level
+attribute float frame;
+// 1.0 for the peak of the left channel, -1.0 for the peak of the right
+// channel and 0.0 for the origin of both
+attribute float side;
+// The low, mid, high and all values of the visual sample in [0, 1]
+attribute vec4 value;
+
+// The displayed range of visual frames of the drawn level
+uniform float firstFrame;
+uniform float lastFrame;
+
+// -1: top/left, 0: center, 1: bottom/right
+uniform int alignment;
+uniform bool vertical;
+
+// 0: single band selected by bandMask, 1: RGB mix of all bands, 2: axis
+uniform int mode;
+uniform vec4 bandMask;
+uniform vec4 bandColor;
+uniform vec4 lowColor;
+uniform vec4 midColor;
+uniform vec4 highColor;
+
+uniform float allGain;
+uniform float lowGain;
+uniform float midGain;
+uniform float highGain;
+
+varying vec4 vertexColor;
+
+void main(void) {
+    float x;
+    float y;
+    if (mode == 2) {
+        // The axis consists of two vertices at frame 0.0 and 1.0
+        x = frame * 2.0 - 1.0;
+        y = 0.0;
+        vertexColor = bandColor;
+    } else {
+        x = 2.0 * (frame - firstFrame) / (lastFrame - firstFrame) - 1.0;
+
+        vec4 scaled = value * vec4(lowGain, midGain, highGain, 1.0);
+        float height;
+        if (mode == 1) {
+            height = length(scaled.xyz) / sqrt(3.0);
+            vec3 color = scaled.x * lowColor.rgb +
+                    scaled.y * midColor.rgb +
+                    scaled.z * highColor.rgb;
+            float maxComponent = max(color.r, max(color.g, color.b));
+            vertexColor = vec4(color / max(maxComponent, 0.0001), bandColor.a);
+        } else {
+            height = dot(scaled, bandMask);
+            vertexColor = bandColor;
+        }
+        height *= allGain;
+
+        if (alignment == 0) {
+            y = side * height;
+        } else {
+            // Both channels are drawn from the edge
+            y = abs(side) * height * 2.0 - 1.0;
+            if (alignment < 0) {
+                y = -y;
+            }
+        }
+    }
+
+    if (vertical) {
+        gl_Position = vec4(-y, -x, 0.0, 1.0);
+    } else {
+        gl_Position = vec4(x, y, 0.0, 1.0);
+    }
+}
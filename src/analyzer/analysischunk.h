@@ -0,0 +1,58 @@
+#pragma once
+
+#include "analyzer/constants.h"
+#include "util/assert.h"
+#include "util/types.h"
+
+namespace mixxx {
+
+// A chunk of decoded audio data that is shared by all analyzers of a track.
+//
+// The audio source is decoded only once and the intermediate representations
+// that are needed by more than one analyzer are derived only once per chunk,
+// e.g. the mono downmix for beat and key detection. Analyzers receive
+// read-only views of buffers that are owned by the AnalyzerThread and must
+// not keep any pointers after processing the chunk.
+class AnalysisChunk {
+  public:
+    AnalysisChunk(
+            const CSAMPLE* pStereoSamples,
+            const CSAMPLE* pMonoSamples,
+            SINT frameCount)
+            : m_pStereoSamples(pStereoSamples),
+              m_pMonoSamples(pMonoSamples),
+              m_frameCount(frameCount) {
+        DEBUG_ASSERT(m_pStereoSamples);
+        DEBUG_ASSERT(m_frameCount >= 0);
+    }
+
+    SINT frameCount() const {
+        return m_frameCount;
+    }
+
+    // Interleaved samples with kAnalysisChannels channels
+    const CSAMPLE* stereoSamples() const {
+        return m_pStereoSamples;
+    }
+    SINT stereoSampleCount() const {
+        return m_frameCount * kAnalysisChannels;
+    }
+
+    // Only available if requested by any of the analyzers,
+    // i.e. if Analyzer::requiresMonoDownmix() returned true.
+    bool hasMonoSamples() const {
+        return m_pMonoSamples != nullptr;
+    }
+    // A single sample per frame
+    const CSAMPLE* monoSamples() const {
+        DEBUG_ASSERT(hasMonoSamples());
+        return m_pMonoSamples;
+    }
+
+  private:
+    const CSAMPLE* m_pStereoSamples;
+    const CSAMPLE* m_pMonoSamples;
+    SINT m_frameCount;
+};
+
+} // namespace mixxx
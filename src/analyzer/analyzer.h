@@ -1,5 +1,6 @@
 #pragma once
 
+#include "analyzer/analysischunk.h"
 #include "audio/types.h"
 #include "util/assert.h"
 #include "util/types.h"
@@ -37,6 +38,23 @@ class Analyzer {
     // but not finalize()!
     virtual bool processSamples(const CSAMPLE* pIn, const int iLen) = 0;
 
+    // Return true if processChunk() needs the mono downmix of the
+    // audio data. It is derived once per chunk and shared by all
+    // analyzers that request it.
+    virtual bool requiresMonoDownmix() const {
+        return false;
+    }
+
+    // Analyze the next chunk of audio data. Analyzers that are able to
+    // reuse the intermediate representations of the chunk override this
+    // method. The default implementation passes the stereo samples to
+    // processSamples().
+    virtual bool processChunk(const mixxx::AnalysisChunk& chunk) {
+        return processSamples(
+                chunk.stereoSamples(),
+                static_cast<int>(chunk.stereoSampleCount()));
+    }
+
     // Update the track object with the analysis results after
     // processing finished successfully, i.e. all available audio
     // samples have been processed.
@@ -85,6 +103,21 @@ class AnalyzerWithState final {
         }
     }
 
+    bool requiresMonoDownmix() const {
+        return m_active && m_analyzer->requiresMonoDownmix();
+    }
+
+    void processChunk(const mixxx::AnalysisChunk& chunk) {
+        if (m_active) {
+            m_active = m_analyzer->processChunk(chunk);
+            if (!m_active) {
+                // Ensure that cleanup() is invoked after processing
+                // failed and the analyzer became inactive!
+                m_analyzer->cleanup();
+            }
+        }
+    }
+
     void finish(TrackPointer tio) {
         if (m_active) {
             m_analyzer->storeResults(tio);
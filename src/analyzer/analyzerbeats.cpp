@@ -205,6 +205,24 @@ bool AnalyzerBeats::processSamples(const CSAMPLE *pIn, const int iLen) {
     return m_pPlugin->processSamples(pIn, iLen);
 }
 
+bool AnalyzerBeats::processChunk(const mixxx::AnalysisChunk& chunk) {
+    VERIFY_OR_DEBUG_ASSERT(m_pPlugin) {
+        return false;
+    }
+    VERIFY_OR_DEBUG_ASSERT(chunk.hasMonoSamples()) {
+        return processSamples(
+                chunk.stereoSamples(),
+                static_cast<int>(chunk.stereoSampleCount()));
+    }
+
+    m_iCurrentSample += static_cast<int>(chunk.stereoSampleCount());
+    if (m_iCurrentSample > m_iMaxSamplesToProcess) {
+        return true; // silently ignore all remaining samples
+    }
+
+    return m_pPlugin->processMonoSamples(chunk.monoSamples(), chunk.frameCount());
+}
+
 void AnalyzerBeats::cleanup() {
     m_pPlugin.reset();
 }
@@ -30,6 +30,10 @@ class AnalyzerBeats : public Analyzer {
             mixxx::audio::SampleRate sampleRate,
             int totalSamples) override;
     bool processSamples(const CSAMPLE *pIn, const int iLen) override;
+    bool requiresMonoDownmix() const override {
+        return true;
+    }
+    bool processChunk(const mixxx::AnalysisChunk& chunk) override;
     void storeResults(TrackPointer tio) override;
     void cleanup() override;
 
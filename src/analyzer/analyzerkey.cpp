@@ -163,6 +163,24 @@ bool AnalyzerKey::processSamples(const CSAMPLE *pIn, const int iLen) {
     return m_pPlugin->processSamples(pIn, iLen);
 }
 
+bool AnalyzerKey::processChunk(const mixxx::AnalysisChunk& chunk) {
+    VERIFY_OR_DEBUG_ASSERT(m_pPlugin) {
+        return false;
+    }
+    VERIFY_OR_DEBUG_ASSERT(chunk.hasMonoSamples()) {
+        return processSamples(
+                chunk.stereoSamples(),
+                static_cast<int>(chunk.stereoSampleCount()));
+    }
+
+    m_iCurrentSample += static_cast<int>(chunk.stereoSampleCount());
+    if (m_iCurrentSample > m_iMaxSamplesToProcess) {
+        return true; // silently ignore remaining samples
+    }
+
+    return m_pPlugin->processMonoSamples(chunk.monoSamples(), chunk.frameCount());
+}
+
 void AnalyzerKey::cleanup() {
     m_pPlugin.reset();
 }
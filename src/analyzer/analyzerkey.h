@@ -23,6 +23,10 @@ class AnalyzerKey : public Analyzer {
             mixxx::audio::SampleRate sampleRate,
             int totalSamples) override;
     bool processSamples(const CSAMPLE *pIn, const int iLen) override;
+    bool requiresMonoDownmix() const override {
+        return true;
+    }
+    bool processChunk(const mixxx::AnalysisChunk& chunk) override;
     void storeResults(TrackPointer tio) override;
     void cleanup() override;
 
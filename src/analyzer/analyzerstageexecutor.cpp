@@ -0,0 +1,95 @@
+#include "analyzer/analyzerstageexecutor.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+#include "util/assert.h"
+#include "util/workerthread.h"
+
+AnalyzerStageExecutor::AnalyzerStageExecutor()
+        : m_numStealableStages(0) {
+}
+
+void AnalyzerStageExecutor::addThread(WorkerThread* pThread) {
+    DEBUG_ASSERT(pThread);
+    QMutexLocker locker(&m_mutex);
+    m_threads.push_back(pThread);
+}
+
+void AnalyzerStageExecutor::removeThread(WorkerThread* pThread) {
+    QMutexLocker locker(&m_mutex);
+    m_threads.erase(
+            std::remove(m_threads.begin(), m_threads.end(), pThread),
+            m_threads.end());
+}
+
+void AnalyzerStageExecutor::submit(
+        Batch* pBatch, const WorkerThread* pSubmittingThread) {
+    DEBUG_ASSERT(pBatch);
+    if (pBatch->m_numStages <= 0) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_batches.push_back(pBatch);
+    m_numStealableStages.fetch_add(pBatch->m_numStages, std::memory_order_release);
+    // Idle threads check hasStealableStages() before falling asleep,
+    // so no wake up gets lost. Waking a busy thread has no effect.
+    // The threads never lock m_mutex while their sleep mutex is locked,
+    // i.e. this cannot deadlock.
+    for (auto* pThread : m_threads) {
+        if (pThread != pSubmittingThread) {
+            pThread->wake();
+        }
+    }
+}
+
+int AnalyzerStageExecutor::claimStage(Batch* pBatch) {
+    DEBUG_ASSERT(pBatch->m_nextStage < pBatch->m_numStages);
+    const int stageIndex = pBatch->m_nextStage++;
+    if (pBatch->m_nextStage == pBatch->m_numStages) {
+        // Nothing left to steal
+        m_batches.erase(
+                std::find(m_batches.begin(), m_batches.end(), pBatch));
+    }
+    m_numStealableStages.fetch_sub(1, std::memory_order_relaxed);
+    return stageIndex;
+}
+
+void AnalyzerStageExecutor::finishStage(Batch* pBatch) {
+    DEBUG_ASSERT(pBatch->m_pendingStages > 0);
+    if (--pBatch->m_pendingStages == 0) {
+        m_stageFinished.wakeAll();
+    }
+}
+
+void AnalyzerStageExecutor::complete(Batch* pBatch) {
+    DEBUG_ASSERT(pBatch);
+    if (pBatch->m_numStages <= 0) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    while (pBatch->m_nextStage < pBatch->m_numStages) {
+        const int stageIndex = claimStage(pBatch);
+        locker.unlock();
+        pBatch->m_stage(stageIndex);
+        locker.relock();
+        finishStage(pBatch);
+    }
+    // Wait for the stages that have been stolen
+    while (pBatch->m_pendingStages > 0) {
+        m_stageFinished.wait(&m_mutex);
+    }
+}
+
+void AnalyzerStageExecutor::stealStages() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_batches.empty()) {
+        // The oldest batch is the one that is most likely waited for
+        Batch* pBatch = m_batches.front();
+        const int stageIndex = claimStage(pBatch);
+        locker.unlock();
+        pBatch->m_stage(stageIndex);
+        locker.relock();
+        finishStage(pBatch);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class WorkerThread;
+
+// Distributes the independent stages of a track analysis among the
+// analyzer threads of a TrackAnalysisScheduler.
+//
+// An analyzer thread decodes a block of audio data once and submits a
+// batch with one stage per analyzer for processing this block. Analyzer
+// threads that have no track to analyze steal stages from the batches of
+// the other threads. The submitting thread processes all stages that have
+// not been stolen and waits until the stolen stages have been finished
+// before submitting the next batch. The stages of a single analyzer are
+// therefore processed in order, but never concurrently.
+//
+// All functions are thread-safe.
+class AnalyzerStageExecutor {
+  public:
+    typedef std::function<void(int stageIndex)> Stage;
+
+    class Batch {
+      public:
+        Batch(int numStages, Stage stage)
+                : m_numStages(numStages),
+                  m_stage(std::move(stage)),
+                  m_nextStage(0),
+                  m_pendingStages(numStages) {
+        }
+        Batch(const Batch&) = delete;
+        Batch(Batch&&) = delete;
+
+      private:
+        friend class AnalyzerStageExecutor;
+
+        const int m_numStages;
+        const Stage m_stage;
+        // Guarded by the mutex of the executor
+        int m_nextStage;
+        int m_pendingStages;
+    };
+
+    AnalyzerStageExecutor();
+
+    // Threads that are registered are woken up when stages become
+    // available for stealing.
+    void addThread(WorkerThread* pThread);
+    void removeThread(WorkerThread* pThread);
+
+    // Publishes the stages of the batch. The batch must be completed
+    // before it is destroyed.
+    void submit(Batch* pBatch, const WorkerThread* pSubmittingThread);
+    // Processes all stages of the batch that have not been stolen and
+    // returns after all stages have been finished.
+    void complete(Batch* pBatch);
+
+    // Lock-free check for stages that could be stolen
+    bool hasStealableStages() const {
+        return m_numStealableStages.load(std::memory_order_acquire) > 0;
+    }
+    // Processes stages of other threads until no more stages are available.
+    void stealStages();
+
+  private:
+    // Claims the next stage of the batch. Must be called with m_mutex locked.
+    int claimStage(Batch* pBatch);
+    void finishStage(Batch* pBatch);
+
+    QMutex m_mutex;
+    QWaitCondition m_stageFinished;
+    std::vector<WorkerThread*> m_threads;
+    // Batches with stages that have not been claimed yet
+    std::vector<Batch*> m_batches;
+    std::atomic<int> m_numStealableStages;
+};
@@ -0,0 +1,25 @@
+#include "analyzer/analyzerstatistics.h"
+
+#include <QMutexLocker>
+
+void AnalyzerStatistics::addCpuTime(
+        const QString& analyzerName, mixxx::Duration cpuTime) {
+    QMutexLocker locker(&m_mutex);
+    for (auto& cpuTimeOfAnalyzer : m_cpuTimes) {
+        if (cpuTimeOfAnalyzer.first == analyzerName) {
+            cpuTimeOfAnalyzer.second += cpuTime;
+            return;
+        }
+    }
+    m_cpuTimes.append(qMakePair(analyzerName, cpuTime));
+}
+
+AnalyzerCpuTimes AnalyzerStatistics::cpuTimes() const {
+    QMutexLocker locker(&m_mutex);
+    return m_cpuTimes;
+}
+
+void AnalyzerStatistics::reset() {
+    QMutexLocker locker(&m_mutex);
+    m_cpuTimes.clear();
+}
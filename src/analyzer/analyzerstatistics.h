@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include "util/duration.h"
+
+// CPU time per analyzer, in the order the analyzers have been reported
+typedef QList<QPair<QString, mixxx::Duration>> AnalyzerCpuTimes;
+
+// Accumulates the CPU time spent by the analyzers of all analyzer
+// threads of a TrackAnalysisScheduler.
+//
+// All functions are thread-safe.
+class AnalyzerStatistics {
+  public:
+    void addCpuTime(const QString& analyzerName, mixxx::Duration cpuTime);
+
+    AnalyzerCpuTimes cpuTimes() const;
+
+    void reset();
+
+  private:
+    mutable QMutex m_mutex;
+    AnalyzerCpuTimes m_cpuTimes;
+};
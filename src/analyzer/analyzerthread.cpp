@@ -18,6 +18,8 @@
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
 #include "util/logger.h"
+#include "util/sample.h"
+#include "util/threadcputimer.h"
 #include "util/timer.h"
 
 namespace {
@@ -36,6 +38,11 @@ mixxx::Logger kLogger("AnalyzerThread");
 // continuous feedback.
 const mixxx::Duration kBusyProgressInhibitDuration = mixxx::Duration::fromMillis(60);
 
+// The stages of a track are submitted and synchronized once per block.
+// Bigger blocks amortize the synchronization overhead between the
+// analyzer threads.
+constexpr SINT kChunksPerParallelBlock = 16;
+
 void deleteAnalyzerThread(AnalyzerThread* plainPtr) {
     if (plainPtr) {
         plainPtr->deleteAfterFinished();
@@ -62,12 +69,16 @@ AnalyzerThread::Pointer AnalyzerThread::createInstance(
         int id,
         mixxx::DbConnectionPoolPtr dbConnectionPool,
         UserSettingsPointer pConfig,
-        AnalyzerModeFlags modeFlags) {
+        AnalyzerModeFlags modeFlags,
+        std::shared_ptr<AnalyzerStageExecutor> pStageExecutor,
+        std::shared_ptr<AnalyzerStatistics> pStatistics) {
     return Pointer(new AnalyzerThread(
                            id,
                            dbConnectionPool,
                            pConfig,
-                           modeFlags),
+                           modeFlags,
+                           std::move(pStageExecutor),
+                           std::move(pStatistics)),
             deleteAnalyzerThread);
 }
 
@@ -75,7 +86,9 @@ AnalyzerThread::AnalyzerThread(
         int id,
         mixxx::DbConnectionPoolPtr dbConnectionPool,
         UserSettingsPointer pConfig,
-        AnalyzerModeFlags modeFlags)
+        AnalyzerModeFlags modeFlags,
+        std::shared_ptr<AnalyzerStageExecutor> pStageExecutor,
+        std::shared_ptr<AnalyzerStatistics> pStatistics)
         : WorkerThread(
             QString("AnalyzerThread %1").arg(id),
             (modeFlags & AnalyzerModeFlags::LowPriority ? QThread::LowPriority : QThread::InheritPriority)),
@@ -83,10 +96,36 @@ AnalyzerThread::AnalyzerThread(
           m_dbConnectionPool(std::move(dbConnectionPool)),
           m_pConfig(pConfig),
           m_modeFlags(modeFlags),
+          m_pStageExecutor(
+                  (modeFlags & AnalyzerModeFlags::ParallelStages) ? std::move(pStageExecutor) : nullptr),
+          m_pStatistics(std::move(pStatistics)),
           m_nextTrack(2), // minimum capacity
-          m_sampleBuffer(mixxx::kAnalysisSamplesPerChunk),
+          m_monoDownmixRequired(false),
           m_emittedState(AnalyzerThreadState::Void) {
     std::call_once(registerMetaTypesOnceFlag, registerMetaTypesOnce);
+    const SINT chunksPerBlock = m_pStageExecutor ? kChunksPerParallelBlock : 1;
+    for (auto& decodedBlock : m_decodedBlocks) {
+        decodedBlock.sampleBuffer = mixxx::SampleBuffer(
+                chunksPerBlock * mixxx::kAnalysisSamplesPerChunk);
+        decodedBlock.monoSampleBuffer = mixxx::SampleBuffer(
+                chunksPerBlock * mixxx::kAnalysisFramesPerChunk);
+        decodedBlock.chunks.reserve(chunksPerBlock);
+    }
+}
+
+void AnalyzerThread::addAnalyzer(AnalyzerPtr analyzer, const QString& name) {
+    m_analyzers.push_back(AnalyzerWithState(std::move(analyzer)));
+    m_analyzerNames.push_back(name);
+    m_analyzerCpuTimes.push_back(mixxx::Duration());
+}
+
+void AnalyzerThread::reportCpuTimes() {
+    for (std::size_t i = 0; i < m_analyzerCpuTimes.size(); ++i) {
+        if (m_pStatistics) {
+            m_pStatistics->addCpuTime(m_analyzerNames[i], m_analyzerCpuTimes[i]);
+        }
+        m_analyzerCpuTimes[i] = mixxx::Duration();
+    }
 }
 
 void AnalyzerThread::doRun() {
@@ -103,30 +142,46 @@ void AnalyzerThread::doRun() {
             return;
         }
         QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_dbConnectionPool);
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerWaveform>(m_pConfig, dbConnection)));
+        addAnalyzer(std::make_unique<AnalyzerWaveform>(m_pConfig, dbConnection),
+                QStringLiteral("Waveform"));
     }
     if (AnalyzerGain::isEnabled(ReplayGainSettings(m_pConfig))) {
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerGain>(m_pConfig)));
+        addAnalyzer(std::make_unique<AnalyzerGain>(m_pConfig),
+                QStringLiteral("ReplayGain"));
     }
     if (AnalyzerEbur128::isEnabled(ReplayGainSettings(m_pConfig))) {
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerEbur128>(m_pConfig)));
+        addAnalyzer(std::make_unique<AnalyzerEbur128>(m_pConfig),
+                QStringLiteral("EBU R128"));
     }
     // BPM detection might be disabled in the config, but can be overridden
     // and enabled by explicitly setting the mode flag.
     const bool enforceBpmDetection = (m_modeFlags & AnalyzerModeFlags::WithBeats) != 0;
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerBeats>(m_pConfig, enforceBpmDetection)));
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerKey>(m_pConfig)));
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerSilence>(m_pConfig)));
+    addAnalyzer(std::make_unique<AnalyzerBeats>(m_pConfig, enforceBpmDetection),
+            QStringLiteral("Beats"));
+    addAnalyzer(std::make_unique<AnalyzerKey>(m_pConfig),
+            QStringLiteral("Key"));
+    addAnalyzer(std::make_unique<AnalyzerSilence>(m_pConfig),
+            QStringLiteral("Silence"));
     DEBUG_ASSERT(!m_analyzers.empty());
     kLogger.debug() << "Activated" << m_analyzers.size() << "analyzers";
 
+    if (m_pStageExecutor) {
+        m_pStageExecutor->addThread(this);
+    }
+
     m_lastBusyProgressEmittedTimer.start();
 
     mixxx::AudioSource::OpenParams openParams;
     openParams.setChannelCount(mixxx::kAnalysisChannels);
 
     while (awaitWorkItemsFetched()) {
-        DEBUG_ASSERT(m_currentTrack);
+        if (!m_currentTrack) {
+            // Help the other analyzer threads while waiting for the next track
+            DEBUG_ASSERT(m_pStageExecutor);
+            sleepWhileSuspended();
+            m_pStageExecutor->stealStages();
+            continue;
+        }
         kLogger.debug() << "Analyzing" << m_currentTrack->getFileInfo();
 
         // Get the audio
@@ -152,6 +207,14 @@ void AnalyzerThread::doRun() {
         }
 
         if (processTrack) {
+            // Derive the shared intermediate representations only
+            // if they are actually needed by any analyzer
+            m_monoDownmixRequired = false;
+            for (const auto& analyzer : m_analyzers) {
+                if (analyzer.requiresMonoDownmix()) {
+                    m_monoDownmixRequired = true;
+                }
+            }
             const auto analysisResult = analyzeAudioSource(audioSource);
             DEBUG_ASSERT(analysisResult != AnalysisResult::Pending);
             if (analysisResult == AnalysisResult::Finished) {
@@ -163,14 +226,19 @@ void AnalyzerThread::doRun() {
                 // suddenly.
                 emitBusyProgress(kAnalyzerProgressFinalizing);
                 // This takes around 3 sec on a Atom Netbook
-                for (auto&& analyzer : m_analyzers) {
-                    analyzer.finish(m_currentTrack);
+                for (std::size_t i = 0; i < m_analyzers.size(); ++i) {
+                    ThreadCpuTimer timer;
+                    timer.start();
+                    m_analyzers[i].finish(m_currentTrack);
+                    m_analyzerCpuTimes[i] += timer.elapsed();
                 }
+                reportCpuTimes();
                 emitDoneProgress(kAnalyzerProgressDone);
             } else {
                 for (auto&& analyzer : m_analyzers) {
                     analyzer.cancel();
                 }
+                reportCpuTimes();
                 emitDoneProgress(kAnalyzerProgressUnknown);
             }
         } else {
@@ -181,7 +249,13 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_currentTrack);
     DEBUG_ASSERT(isStopping());
 
+    if (m_pStageExecutor) {
+        m_pStageExecutor->removeThread(this);
+    }
+
     m_analyzers.clear();
+    m_analyzerNames.clear();
+    m_analyzerCpuTimes.clear();
 
     kLogger.debug() << "Exiting worker thread";
     emitProgress(AnalyzerThreadState::Exit);
@@ -213,35 +287,34 @@ WorkerThread::TryFetchWorkItemsResult AnalyzerThread::tryFetchWorkItems() {
                 << "Dequeued next track"
                 << m_currentTrack->getId();
         return TryFetchWorkItemsResult::Ready;
+    } else if (m_pStageExecutor && m_pStageExecutor->hasStealableStages()) {
+        // Steal stages without a current track. The scheduler
+        // still needs to know that this thread is idle.
+        if (m_emittedState != AnalyzerThreadState::Idle) {
+            emitProgress(AnalyzerThreadState::Idle);
+        }
+        return TryFetchWorkItemsResult::Ready;
     } else {
         emitProgress(AnalyzerThreadState::Idle);
         return TryFetchWorkItemsResult::Idle;
     }
 }
 
-AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
-        const mixxx::AudioSourcePointer& audioSource) {
-    DEBUG_ASSERT(m_currentTrack);
-
-    mixxx::AudioSourceStereoProxy audioSourceProxy(
-            audioSource,
-            mixxx::kAnalysisFramesPerChunk);
-    DEBUG_ASSERT(
-            audioSourceProxy.getSignalInfo().getChannelCount() ==
-            mixxx::kAnalysisChannels);
-
-    // Analysis starts now
-    emitBusyProgress(kAnalyzerProgressNone);
-
-    mixxx::IndexRange remainingFrameRange = audioSource->frameIndexRange();
-    while (!remainingFrameRange.empty()) {
+bool AnalyzerThread::decodeBlock(
+        mixxx::AudioSourceStereoProxy* pAudioSourceProxy,
+        mixxx::IndexRange* pRemainingFrameRange,
+        DecodedBlock* pBlock) {
+    mixxx::IndexRange& remainingFrameRange = *pRemainingFrameRange;
+    const SINT chunksPerBlock =
+            pBlock->sampleBuffer.size() / mixxx::kAnalysisSamplesPerChunk;
+    pBlock->chunks.clear();
+    while (!remainingFrameRange.empty() &&
+            static_cast<SINT>(pBlock->chunks.size()) < chunksPerBlock) {
         sleepWhileSuspended();
         if (isStopping()) {
-            return AnalysisResult::Cancelled;
+            return false;
         }
 
-        // 1st step: Decode next chunk of audio data
-
         // Split the range for the next chunk from the remaining (= to-be-analyzed) frames
         auto chunkFrameRange =
                 remainingFrameRange.splitAndShrinkFront(
@@ -250,10 +323,13 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
 
         // Request the next chunk of audio data
         const auto readableSampleFrames =
-                audioSourceProxy.readSampleFrames(
+                pAudioSourceProxy->readSampleFrames(
                         mixxx::WritableSampleFrames(
                                 chunkFrameRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+                                mixxx::SampleBuffer::WritableSlice(
+                                        pBlock->sampleBuffer,
+                                        pBlock->chunks.size() * mixxx::kAnalysisSamplesPerChunk,
+                                        mixxx::kAnalysisSamplesPerChunk)));
         // The returned range fits into the requested range
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
@@ -263,17 +339,17 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
 
         // Shrink the original range of the current chunks to the actual available
         // range.
-        chunkFrameRange = intersect(chunkFrameRange, audioSourceProxy.frameIndexRange());
+        chunkFrameRange = intersect(chunkFrameRange, pAudioSourceProxy->frameIndexRange());
         // The audio data that has just been read should still fit into the adjusted
         // chunk range.
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
         // We also need to adjust the remaining frame range for the next requests.
-        remainingFrameRange = intersect(remainingFrameRange, audioSourceProxy.frameIndexRange());
+        remainingFrameRange = intersect(remainingFrameRange, pAudioSourceProxy->frameIndexRange());
         // Currently the range will never grow, but lets also account for this case
         // that might become relevant in the future.
         VERIFY_OR_DEBUG_ASSERT(remainingFrameRange.empty() ||
-                remainingFrameRange.end() == audioSourceProxy.frameIndexRange().end()) {
+                remainingFrameRange.end() == pAudioSourceProxy->frameIndexRange().end()) {
             if (chunkFrameRange.length() < mixxx::kAnalysisFramesPerChunk) {
                 // If we have read an incomplete chunk while the range has grown
                 // we need to discard the read results and re-read the current
@@ -282,49 +358,135 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
                 remainingFrameRange.growFront(chunkFrameRange.length());
                 continue;
             }
-            DEBUG_ASSERT(remainingFrameRange.end() < audioSourceProxy.frameIndexRange().end());
+            DEBUG_ASSERT(remainingFrameRange.end() < pAudioSourceProxy->frameIndexRange().end());
             kLogger.warning()
                     << "Unexpected growth of the audio source while reading"
                     << mixxx::IndexRange::forward(
-                            remainingFrameRange.end(), audioSourceProxy.frameIndexRange().end());
+                            remainingFrameRange.end(), pAudioSourceProxy->frameIndexRange().end());
             remainingFrameRange.growBack(
-                    audioSourceProxy.frameIndexRange().end() - remainingFrameRange.end());
-        }
-
-        sleepWhileSuspended();
-        if (isStopping()) {
-            return AnalysisResult::Cancelled;
+                    pAudioSourceProxy->frameIndexRange().end() - remainingFrameRange.end());
         }
 
-        // 2nd: step: Analyze chunk of decoded audio data
         if (!readableSampleFrames.frameIndexRange().empty()) {
-            for (auto&& analyzer : m_analyzers) {
-                analyzer.processSamples(
+            const SINT frameCount =
+                    readableSampleFrames.readableLength() / mixxx::kAnalysisChannels;
+            CSAMPLE* pMonoSamples = nullptr;
+            if (m_monoDownmixRequired) {
+                pMonoSamples = pBlock->monoSampleBuffer.data(
+                        pBlock->chunks.size() * mixxx::kAnalysisFramesPerChunk);
+                SampleUtil::downmixStereoToMono(
+                        pMonoSamples,
                         readableSampleFrames.readableData(),
-                        readableSampleFrames.readableLength());
+                        frameCount);
             }
+            pBlock->chunks.emplace_back(
+                    readableSampleFrames.readableData(),
+                    pMonoSamples,
+                    frameCount);
         }
+    }
+    return true;
+}
 
-        // Don't check again for paused/stopped again and simply finish
-        // the current iteration by emitting progress.
+void AnalyzerThread::processBlock(const DecodedBlock& block, int analyzerIndex) {
+    // Might be invoked by a different analyzer thread that has
+    // stolen this stage. Only the state of the analyzer and its
+    // CPU time must be accessed here. Only the CPU time of this thread
+    // is measured, i.e. without preemption and waiting.
+    ThreadCpuTimer timer;
+    timer.start();
+    auto& analyzer = m_analyzers[analyzerIndex];
+    for (const auto& chunk : block.chunks) {
+        analyzer.processChunk(chunk);
+    }
+    m_analyzerCpuTimes[analyzerIndex] += timer.elapsed();
+}
+
+AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
+        const mixxx::AudioSourcePointer& audioSource) {
+    DEBUG_ASSERT(m_currentTrack);
+
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            audioSource,
+            mixxx::kAnalysisFramesPerChunk);
+    DEBUG_ASSERT(
+            audioSourceProxy.getSignalInfo().getChannelCount() ==
+            mixxx::kAnalysisChannels);
 
-        // 3rd step: Update & emit progress
+    // Analysis starts now
+    emitBusyProgress(kAnalyzerProgressNone);
+
+    const int numAnalyzers = static_cast<int>(m_analyzers.size());
+    mixxx::IndexRange remainingFrameRange = audioSource->frameIndexRange();
+
+    // 1st step: Decode the first block of audio data
+    int decodedBlockIndex = 0;
+    if (!decodeBlock(
+                &audioSourceProxy,
+                &remainingFrameRange,
+                &m_decodedBlocks[decodedBlockIndex])) {
+        return AnalysisResult::Cancelled;
+    }
+    while (true) {
+        const DecodedBlock& decodedBlock = m_decodedBlocks[decodedBlockIndex];
+        const SINT remainingFrameCount = remainingFrameRange.length();
+
+        // 2nd step: Analyze the decoded block, i.e. publish one stage
+        // per analyzer that may be stolen by idle analyzer threads.
+        AnalyzerStageExecutor::Batch batch(
+                numAnalyzers,
+                [this, &decodedBlock](int analyzerIndex) {
+                    processBlock(decodedBlock, analyzerIndex);
+                });
+        if (m_pStageExecutor) {
+            m_pStageExecutor->submit(&batch, this);
+        }
+
+        // 3rd step: Decode the next block in the meantime
+        bool cancelled = false;
+        const bool lastBlock = remainingFrameRange.empty();
+        if (!lastBlock) {
+            decodedBlockIndex = 1 - decodedBlockIndex;
+            cancelled = !decodeBlock(
+                    &audioSourceProxy,
+                    &remainingFrameRange,
+                    &m_decodedBlocks[decodedBlockIndex]);
+        }
+
+        // The stages of the previous block must be finished before
+        // either the next block is submitted or its buffer is reused.
+        if (m_pStageExecutor) {
+            m_pStageExecutor->complete(&batch);
+        } else {
+            for (int analyzerIndex = 0; analyzerIndex < numAnalyzers; ++analyzerIndex) {
+                processBlock(decodedBlock, analyzerIndex);
+            }
+        }
+        if (cancelled) {
+            return AnalysisResult::Cancelled;
+        }
+
+        // 4th step: Update & emit progress
         if (audioSource->frameLength() > 0) {
             const double frameProgress =
-                    double(audioSource->frameLength() - remainingFrameRange.length()) /
+                    double(audioSource->frameLength() - remainingFrameCount) /
                     double(audioSource->frameLength());
             // math_min is required to compensate rounding errors
             const AnalyzerProgress progress =
                     math_min(kAnalyzerProgressFinalizing,
                             frameProgress *
                                     (kAnalyzerProgressFinalizing - kAnalyzerProgressNone));
-            DEBUG_ASSERT(progress > kAnalyzerProgressNone);
+            DEBUG_ASSERT(progress >= kAnalyzerProgressNone);
             emitBusyProgress(progress);
         } else {
             // Unreadable audio source
             DEBUG_ASSERT(remainingFrameRange.empty());
             emitBusyProgress(kAnalyzerProgressUnknown);
         }
+
+        if (lastBlock) {
+            break;
+        }
     }
 
     return AnalysisResult::Finished;
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "analyzer/analyzer.h"
 #include "analyzer/analyzerprogress.h"
+#include "analyzer/analyzerstageexecutor.h"
+#include "analyzer/analyzerstatistics.h"
 #include "preferences/usersettings.h"
 #include "rigtorp/SPSCQueue.h"
 #include "sources/audiosource.h"
@@ -15,11 +18,20 @@
 #include "util/samplebuffer.h"
 #include "util/workerthread.h"
 
+namespace mixxx {
+
+class AudioSourceStereoProxy;
+
+} // namespace mixxx
+
 enum AnalyzerModeFlags {
     None = 0x00,
     WithBeats = 0x01,
     WithWaveform = 0x02,
     LowPriority = 0x04,
+    // Split the analysis of a track into one stage per analyzer
+    // that may be stolen by idle analyzer threads
+    ParallelStages = 0x08,
     All = WithBeats | WithWaveform,
 };
 
@@ -57,13 +69,17 @@ class AnalyzerThread : public WorkerThread {
             int id,
             mixxx::DbConnectionPoolPtr dbConnectionPool,
             UserSettingsPointer pConfig,
-            AnalyzerModeFlags modeFlags);
+            AnalyzerModeFlags modeFlags,
+            std::shared_ptr<AnalyzerStageExecutor> pStageExecutor = nullptr,
+            std::shared_ptr<AnalyzerStatistics> pStatistics = nullptr);
 
     /*private*/ AnalyzerThread(
             int id,
             mixxx::DbConnectionPoolPtr dbConnectionPool,
             UserSettingsPointer pConfig,
-            AnalyzerModeFlags modeFlags);
+            AnalyzerModeFlags modeFlags,
+            std::shared_ptr<AnalyzerStageExecutor> pStageExecutor,
+            std::shared_ptr<AnalyzerStatistics> pStatistics);
     ~AnalyzerThread() override = default;
 
     int id() const {
@@ -98,6 +114,9 @@ class AnalyzerThread : public WorkerThread {
     const mixxx::DbConnectionPoolPtr m_dbConnectionPool;
     const UserSettingsPointer m_pConfig;
     const AnalyzerModeFlags m_modeFlags;
+    // Shared with the other analyzer threads of the scheduler, may be null
+    const std::shared_ptr<AnalyzerStageExecutor> m_pStageExecutor;
+    const std::shared_ptr<AnalyzerStatistics> m_pStatistics;
 
     /////////////////////////////////////////////////////////////////////////
     // Thread-safe atomic values
@@ -115,8 +134,24 @@ class AnalyzerThread : public WorkerThread {
     // run() by the worker thread.
 
     std::vector<AnalyzerWithState> m_analyzers;
+    std::vector<QString> m_analyzerNames;
+    // Accumulated while analyzing the current track
+    std::vector<mixxx::Duration> m_analyzerCpuTimes;
+
+    // Multiple chunks of audio data that are decoded at once and
+    // processed by all analyzers
+    struct DecodedBlock {
+        mixxx::SampleBuffer sampleBuffer;
+        // Only filled if m_monoDownmixRequired
+        mixxx::SampleBuffer monoSampleBuffer;
+        std::vector<mixxx::AnalysisChunk> chunks;
+    };
+    // Double buffering: The next block is decoded while the
+    // analyzers are processing the previous block
+    DecodedBlock m_decodedBlocks[2];
 
-    mixxx::SampleBuffer m_sampleBuffer;
+    // Set when initializing the analyzers for the current track
+    bool m_monoDownmixRequired;
 
     TrackPointer m_currentTrack;
 
@@ -132,6 +167,19 @@ class AnalyzerThread : public WorkerThread {
     AnalysisResult analyzeAudioSource(
             const mixxx::AudioSourcePointer& audioSource);
 
+    // Decodes the next chunks from the remaining frames into the block
+    // and returns false if the analysis has been cancelled
+    bool decodeBlock(
+            mixxx::AudioSourceStereoProxy* pAudioSourceProxy,
+            mixxx::IndexRange* pRemainingFrameRange,
+            DecodedBlock* pBlock);
+
+    // Feeds all chunks of the block into a single analyzer
+    void processBlock(const DecodedBlock& block, int analyzerIndex);
+
+    void addAnalyzer(AnalyzerPtr analyzer, const QString& name);
+    void reportCpuTimes();
+
     // Blocks the worker thread until a next track becomes available
     TrackPointer receiveNextTrack();
 
@@ -6,12 +6,31 @@
 #include "library/trackcollection.h"
 #include "track/track.h"
 #include "util/logger.h"
+#include "util/sample.h"
 #include "waveform/waveformfactory.h"
 
 namespace {
 
 mixxx::Logger kLogger("AnalyzerWaveform");
 
+// The samples are filtered and reduced in blocks that fit together with
+// the filtered bands into the L1 cache
+constexpr int kBlockSamples = 512;
+
+// Returns the first position after position at which a stride of the
+// given length is complete, i.e. where fmod(position, length) < 1.
+int nextStridePosition(int position, double length) {
+    int next = static_cast<int>(std::ceil((std::floor(position / length) + 1) * length));
+    // Compensate rounding errors of the estimate
+    while (next - 1 > position && std::fmod(next - 1, length) < 1) {
+        --next;
+    }
+    while (next <= position || std::fmod(next, length) >= 1) {
+        ++next;
+    }
+    return next;
+}
+
 } // namespace
 
 AnalyzerWaveform::AnalyzerWaveform(
@@ -21,11 +40,16 @@ AnalyzerWaveform::AnalyzerWaveform(
           m_waveformData(nullptr),
           m_waveformSummaryData(nullptr),
           m_stride(0, 0),
+          m_nextStorePosition(0),
+          m_nextAverageStorePosition(0),
           m_currentStride(0),
           m_currentSummaryStride(0) {
     m_filter[0] = nullptr;
     m_filter[1] = nullptr;
     m_filter[2] = nullptr;
+    for (int i = 0; i < FilterCount; ++i) {
+        m_buffers[i].resize(kBlockSamples);
+    }
     m_analysisDao.initialize(dbConnection);
 }
 
@@ -74,6 +98,10 @@ bool AnalyzerWaveform::initialize(TrackPointer tio,
 
     m_stride = WaveformStride(m_waveform->getAudioVisualRatio(),
             m_waveformSummary->getAudioVisualRatio());
+    m_nextStorePosition = nextStridePosition(
+            m_stride.m_position, m_stride.m_length);
+    m_nextAverageStorePosition = nextStridePosition(
+            m_stride.m_position, m_stride.m_averageLength);
 
     m_currentStride = 0;
     m_currentSummaryStride = 0;
@@ -113,7 +141,14 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveform = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
+                    if (pLoadedTrackWaveform->isValid()) {
+                        missingWaveform = false;
+                    } else {
+                        // Corrupt, e.g. a block of the waveform file doesn't
+                        // match its checksum. Analyze the track again.
+                        pLoadedTrackWaveform.clear();
+                        m_analysisDao.deleteAnalysis(analysis.analysisId);
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao.deleteAnalysis(analysis.analysisId);
@@ -124,7 +159,13 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveformSummary = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
+                    if (pLoadedTrackWaveformSummary->isValid()) {
+                        missingWavesummary = false;
+                    } else {
+                        // Corrupt, analyze the track again
+                        pLoadedTrackWaveformSummary.clear();
+                        m_analysisDao.deleteAnalysis(analysis.analysisId);
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao.deleteAnalysis(analysis.analysisId);
@@ -177,82 +218,85 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, const int bufferLen
         return false;
     }
 
-    //this should only append once if bufferLength is constant
-    if (bufferLength > (int)m_buffers[0].size()) {
-        m_buffers[Low].resize(bufferLength);
-        m_buffers[Mid].resize(bufferLength);
-        m_buffers[High].resize(bufferLength);
-    }
-
-    m_filter[Low]->process(buffer, &m_buffers[Low][0], bufferLength);
-    m_filter[Mid]->process(buffer, &m_buffers[Mid][0], bufferLength);
-    m_filter[High]->process(buffer, &m_buffers[High][0], bufferLength);
-
     m_waveform->setSaveState(Waveform::SaveState::NotSaved);
     m_waveformSummary->setSaveState(Waveform::SaveState::NotSaved);
 
-    for (int i = 0; i < bufferLength; i += 2) {
-        // Take max value, not average of data
-        CSAMPLE cover[2] = {fabs(buffer[i]), fabs(buffer[i + 1])};
-        CSAMPLE clow[2] = {fabs(m_buffers[Low][i]), fabs(m_buffers[Low][i + 1])};
-        CSAMPLE cmid[2] = {fabs(m_buffers[Mid][i]), fabs(m_buffers[Mid][i + 1])};
-        CSAMPLE chigh[2] = {fabs(m_buffers[High][i]), fabs(m_buffers[High][i + 1])};
-
-        // This is for if you want to experiment with averaging instead of
-        // maxing.
-        // m_stride.m_overallData[Right] += buffer[i]*buffer[i];
-        // m_stride.m_overallData[Left] += buffer[i + 1]*buffer[i + 1];
-        // m_stride.m_filteredData[Right][Low] += m_buffers[Low][i]*m_buffers[Low][i];
-        // m_stride.m_filteredData[Left][Low] += m_buffers[Low][i + 1]*m_buffers[Low][i + 1];
-        // m_stride.m_filteredData[Right][Mid] += m_buffers[Mid][i]*m_buffers[Mid][i];
-        // m_stride.m_filteredData[Left][Mid] += m_buffers[Mid][i + 1]*m_buffers[Mid][i + 1];
-        // m_stride.m_filteredData[Right][High] += m_buffers[High][i]*m_buffers[High][i];
-        // m_stride.m_filteredData[Left][High] += m_buffers[High][i + 1]*m_buffers[High][i + 1];
-
-        // Record the max across this stride.
-        storeIfGreater(&m_stride.m_overallData[Left], cover[Left]);
-        storeIfGreater(&m_stride.m_overallData[Right], cover[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Low], clow[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Low], clow[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Mid], cmid[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Mid], cmid[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][High], chigh[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][High], chigh[Right]);
-
-        m_stride.m_position++;
-
-        if (fmod(m_stride.m_position, m_stride.m_length) < 1) {
-            VERIFY_OR_DEBUG_ASSERT(m_currentStride + ChannelCount <= m_waveform->getDataSize()) {
-                qWarning() << "AnalyzerWaveform::process - currentStride > waveform size";
-                return false;
+    for (int blockStart = 0; blockStart < bufferLength; blockStart += kBlockSamples) {
+        const CSAMPLE* pBlock = buffer + blockStart;
+        const int blockLength = math_min(kBlockSamples, bufferLength - blockStart);
+
+        m_filter[Low]->process(pBlock, m_buffers[Low].data(), blockLength);
+        m_filter[Mid]->process(pBlock, m_buffers[Mid].data(), blockLength);
+        m_filter[High]->process(pBlock, m_buffers[High].data(), blockLength);
+
+        // Reduce the block in segments that end at the next stride boundary
+        for (int i = 0; i + 1 < blockLength;) {
+            const int frames = math_min3(
+                    m_nextStorePosition - m_stride.m_position,
+                    m_nextAverageStorePosition - m_stride.m_position,
+                    (blockLength - i) / 2);
+
+            // Record the max across this stride.
+            SampleUtil::maxAbsPerChannel(
+                    &m_stride.m_overallData[Left],
+                    &m_stride.m_overallData[Right],
+                    pBlock + i,
+                    frames * 2);
+            for (int f = 0; f < FilterCount; ++f) {
+                SampleUtil::maxAbsPerChannel(
+                        &m_stride.m_filteredData[Left][f],
+                        &m_stride.m_filteredData[Right][f],
+                        m_buffers[f].data() + i,
+                        frames * 2);
             }
-            m_stride.store(m_waveformData + m_currentStride);
-            m_currentStride += ChannelCount;
-            m_waveform->setCompletion(m_currentStride);
-        }
 
-        if (fmod(m_stride.m_position, m_stride.m_averageLength) < 1) {
-            VERIFY_OR_DEBUG_ASSERT(m_currentSummaryStride + ChannelCount <= m_waveformSummary->getDataSize()) {
-                qWarning() << "AnalyzerWaveform::process - current summary stride > waveform summary size";
-                return false;
+            m_stride.m_position += frames;
+            i += frames * 2;
+
+            if (m_stride.m_position == m_nextStorePosition) {
+                VERIFY_OR_DEBUG_ASSERT(m_currentStride + ChannelCount <= m_waveform->getDataSize()) {
+                    qWarning() << "AnalyzerWaveform::process - currentStride > waveform size";
+                    return false;
+                }
+                m_stride.store(m_waveformData + m_currentStride);
+                m_currentStride += ChannelCount;
+                m_nextStorePosition = nextStridePosition(
+                        m_stride.m_position, m_stride.m_length);
             }
-            m_stride.averageStore(m_waveformSummaryData + m_currentSummaryStride);
-            m_currentSummaryStride += ChannelCount;
-            m_waveformSummary->setCompletion(m_currentSummaryStride);
+
+            if (m_stride.m_position == m_nextAverageStorePosition) {
+                VERIFY_OR_DEBUG_ASSERT(m_currentSummaryStride + ChannelCount <= m_waveformSummary->getDataSize()) {
+                    qWarning() << "AnalyzerWaveform::process - current summary stride > waveform summary size";
+                    return false;
+                }
+                m_stride.averageStore(m_waveformSummaryData + m_currentSummaryStride);
+                m_currentSummaryStride += ChannelCount;
+                m_nextAverageStorePosition = nextStridePosition(
+                        m_stride.m_position, m_stride.m_averageLength);
 
 #ifdef TEST_HEAT_MAP
-            QPointF point(m_stride.m_filteredData[Right][High],
-                    m_stride.m_filteredData[Right][Mid]);
+                QPointF point(m_stride.m_filteredData[Right][High],
+                        m_stride.m_filteredData[Right][Mid]);
 
-            float norm = sqrt(point.x() * point.x() + point.y() * point.y());
-            point /= norm;
+                float norm = sqrt(point.x() * point.x() + point.y() * point.y());
+                point /= norm;
 
-            point *= m_stride.m_filteredData[Right][Low];
-            test_heatMap->setPixel(point.toPoint(), 0xFF0000FF);
+                point *= m_stride.m_filteredData[Right][Low];
+                test_heatMap->setPixel(point.toPoint(), 0xFF0000FF);
 #endif
+            }
         }
     }
 
+    // Update the downsampled levels once per chunk instead of once per
+    // stride to keep the overhead low. The completion is published
+    // afterwards, so renderers never see completed data with an
+    // outdated pyramid.
+    m_waveform->updatePyramid(m_currentStride);
+    m_waveform->setCompletion(m_currentStride);
+    m_waveformSummary->updatePyramid(m_currentSummaryStride);
+    m_waveformSummary->setCompletion(m_currentSummaryStride);
+
     //kLogger.debug() << "process - m_waveform->getCompletion()" << m_waveform->getCompletion() << "off" << m_waveform->getDataSize();
     //kLogger.debug() << "process - m_waveformSummary->getCompletion()" << m_waveformSummary->getCompletion() << "off" << m_waveformSummary->getDataSize();
     return true;
@@ -269,6 +313,7 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     // Force completion to waveform size
     if (m_waveform) {
         m_waveform->setSaveState(Waveform::SaveState::SavePending);
+        m_waveform->updatePyramid(m_waveform->getDataSize());
         m_waveform->setCompletion(m_waveform->getDataSize());
         m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
         m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
@@ -278,6 +323,7 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     // Force completion to waveform size
     if (m_waveformSummary) {
         m_waveformSummary->setSaveState(Waveform::SaveState::SavePending);
+        m_waveformSummary->updatePyramid(m_waveformSummary->getDataSize());
         m_waveformSummary->setCompletion(m_waveformSummary->getDataSize());
         m_waveformSummary->setVersion(WaveformFactory::currentWaveformSummaryVersion());
         m_waveformSummary->setDescription(WaveformFactory::currentWaveformSummaryDescription());
@@ -300,9 +346,3 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
     kLogger.debug() << "Waveform generation for track" << tio->getId() << "done"
                     << m_timer.elapsed().debugSecondsWithUnit();
 }
-
-void AnalyzerWaveform::storeIfGreater(float* pDest, float source) {
-    if (*pDest < source) {
-        *pDest = source;
-    }
-}
@@ -155,7 +155,6 @@ class AnalyzerWaveform : public Analyzer {
 
     void createFilters(mixxx::audio::SampleRate sampleRate);
     void destroyFilters();
-    void storeIfGreater(float* pDest, float source);
 
     mutable AnalysisDao m_analysisDao;
 
@@ -165,11 +164,16 @@ class AnalyzerWaveform : public Analyzer {
     WaveformData* m_waveformSummaryData;
 
     WaveformStride m_stride;
+    // The positions of m_stride at which the next visual samples of
+    // the waveform and the summary are stored
+    int m_nextStorePosition;
+    int m_nextAverageStorePosition;
 
     int m_currentStride;
     int m_currentSummaryStride;
 
     EngineFilterIIRBase* m_filter[FilterCount];
+    // The filtered samples of the current block
     std::vector<float> m_buffers[FilterCount];
 
     PerformanceTimer m_timer;
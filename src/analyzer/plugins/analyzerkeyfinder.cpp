@@ -3,6 +3,7 @@
 #include "analyzer/constants.h"
 #include "util/assert.h"
 #include "util/math.h"
+#include "util/sample.h"
 
 using mixxx::track::io::key::ChromaticKey;
 using mixxx::track::io::key::ChromaticKey_IsValid;
@@ -82,24 +83,30 @@ AnalyzerPluginInfo AnalyzerKeyFinder::pluginInfo() {
 
 bool AnalyzerKeyFinder::initialize(mixxx::audio::SampleRate sampleRate) {
     m_audioData.setFrameRate(sampleRate);
-    m_audioData.setChannels(kAnalysisChannels);
+    // KeyFinder reduces the audio data to mono anyway
+    m_audioData.setChannels(1);
     return true;
 }
 
 bool AnalyzerKeyFinder::processSamples(const CSAMPLE* pIn, const int iLen) {
     DEBUG_ASSERT(iLen % kAnalysisChannels == 0);
+    const SINT numInputFrames = iLen / kAnalysisChannels;
+    if (static_cast<SINT>(m_downmixBuffer.size()) < numInputFrames) {
+        m_downmixBuffer.resize(numInputFrames);
+    }
+    SampleUtil::downmixStereoToMono(m_downmixBuffer.data(), pIn, numInputFrames);
+    return processMonoSamples(m_downmixBuffer.data(), numInputFrames);
+}
+
+bool AnalyzerKeyFinder::processMonoSamples(const CSAMPLE* pIn, SINT frameCount) {
     if (m_audioData.getSampleCount() == 0) {
-        m_audioData.addToSampleCount(iLen);
+        m_audioData.addToSampleCount(frameCount);
     }
 
-    const SINT numInputFrames = iLen / kAnalysisChannels;
-    m_currentFrame += numInputFrames;
+    m_currentFrame += frameCount;
 
-    for (SINT frame = 0; frame < numInputFrames; frame++) {
-        for (SINT channel = 0; channel < kAnalysisChannels; channel++) {
-            m_audioData.setSampleByFrame(
-                    frame, channel, pIn[frame * kAnalysisChannels + channel]);
-        }
+    for (SINT frame = 0; frame < frameCount; frame++) {
+        m_audioData.setSampleByFrame(frame, 0, pIn[frame]);
     }
     m_keyFinder.progressiveChromagram(m_audioData, m_workspace);
     return true;
@@ -2,6 +2,7 @@
 #include <keyfinder/keyfinder.h>
 
 #include <QObject>
+#include <vector>
 
 #include "analyzer/plugins/analyzerplugin.h"
 #include "util/types.h"
@@ -21,6 +22,7 @@ class AnalyzerKeyFinder : public AnalyzerKeyPlugin {
 
     bool initialize(mixxx::audio::SampleRate sampleRate) override;
     bool processSamples(const CSAMPLE* pIn, const int iLen) override;
+    bool processMonoSamples(const CSAMPLE* pIn, SINT frameCount) override;
     bool finalize() override;
 
     KeyChangeList getKeyChanges() const override {
@@ -31,6 +33,8 @@ class AnalyzerKeyFinder : public AnalyzerKeyPlugin {
     KeyFinder::KeyFinder m_keyFinder;
     KeyFinder::Workspace m_workspace;
     KeyFinder::AudioData m_audioData;
+    /// Only needed if the samples are not downmixed by the caller
+    std::vector<CSAMPLE> m_downmixBuffer;
 
     SINT m_currentFrame;
     KeyChangeList m_resultKeys;
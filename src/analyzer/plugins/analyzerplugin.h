@@ -62,6 +62,9 @@ class AnalyzerPlugin {
 
     virtual bool initialize(mixxx::audio::SampleRate sampleRate) = 0;
     virtual bool processSamples(const CSAMPLE* pIn, const int iLen) = 0;
+    // Alternative to processSamples() for the shared mono downmix of
+    // the audio data, i.e. a single sample per frame
+    virtual bool processMonoSamples(const CSAMPLE* pIn, SINT frameCount) = 0;
     virtual bool finalize() = 0;
 };
 
@@ -74,6 +74,14 @@ bool AnalyzerQueenMaryBeats::processSamples(const CSAMPLE* pIn, const int iLen)
     return m_helper.processStereoSamples(pIn, iLen);
 }
 
+bool AnalyzerQueenMaryBeats::processMonoSamples(const CSAMPLE* pIn, SINT frameCount) {
+    if (!m_pDetectionFunction) {
+        return false;
+    }
+
+    return m_helper.processMonoSamples(pIn, frameCount);
+}
+
 bool AnalyzerQueenMaryBeats::finalize() {
     m_helper.finalize();
 
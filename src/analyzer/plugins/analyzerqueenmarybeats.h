@@ -34,6 +34,7 @@ class AnalyzerQueenMaryBeats : public AnalyzerBeatsPlugin {
 
     bool initialize(mixxx::audio::SampleRate sampleRate) override;
     bool processSamples(const CSAMPLE* pIn, const int iLen) override;
+    bool processMonoSamples(const CSAMPLE* pIn, SINT frameCount) override;
     bool finalize() override;
 
     bool supportsBeatTracking() const override {
@@ -34,6 +34,7 @@ class AnalyzerQueenMaryKey : public AnalyzerKeyPlugin {
 
     bool initialize(mixxx::audio::SampleRate sampleRate) override;
     bool processSamples(const CSAMPLE* pIn, const int iLen) override;
+    bool processMonoSamples(const CSAMPLE* pIn, SINT frameCount) override;
     bool finalize() override;
 
     KeyChangeList getKeyChanges() const override {
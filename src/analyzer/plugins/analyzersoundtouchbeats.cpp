@@ -3,6 +3,7 @@
 #include <soundtouch/BPMDetect.h>
 
 #include "analyzer/constants.h"
+#include "util/math.h"
 #include "util/sample.h"
 
 namespace mixxx {
@@ -16,7 +17,9 @@ AnalyzerSoundTouchBeats::~AnalyzerSoundTouchBeats() {
 
 bool AnalyzerSoundTouchBeats::initialize(mixxx::audio::SampleRate sampleRate) {
     m_resultBpm = mixxx::Bpm();
-    m_pSoundTouch = std::make_unique<soundtouch::BPMDetect>(2, sampleRate);
+    // BPMDetect averages all channels, so feeding the mono downmix
+    // yields the same result
+    m_pSoundTouch = std::make_unique<soundtouch::BPMDetect>(1, sampleRate);
     return true;
 }
 
@@ -27,13 +30,22 @@ bool AnalyzerSoundTouchBeats::processSamples(const CSAMPLE* pIn, const int iLen)
     DEBUG_ASSERT(iLen % kAnalysisChannels == 0);
     // We analyze a mono mixdown of the signal since we don't think stereo does
     // us any good.
-
-    CSAMPLE* pDownmix = m_downmixBuffer.data();
-    for (int i = 0; i < iLen / 2; i += 2) {
-        pDownmix[i] = (pIn[i * 2] + pIn[i * 2 + 1]) * 0.5f;
+    SINT remainingFrames = iLen / kAnalysisChannels;
+    while (remainingFrames > 0) {
+        const SINT frameCount = math_min(remainingFrames, m_downmixBuffer.size());
+        SampleUtil::downmixStereoToMono(m_downmixBuffer.data(), pIn, frameCount);
+        m_pSoundTouch->inputSamples(m_downmixBuffer.data(), frameCount);
+        pIn += frameCount * kAnalysisChannels;
+        remainingFrames -= frameCount;
     }
+    return true;
+}
 
-    m_pSoundTouch->inputSamples(pIn, iLen / 2);
+bool AnalyzerSoundTouchBeats::processMonoSamples(const CSAMPLE* pIn, SINT frameCount) {
+    if (!m_pSoundTouch) {
+        return false;
+    }
+    m_pSoundTouch->inputSamples(pIn, frameCount);
     return true;
 }
 
@@ -31,6 +31,7 @@ class AnalyzerSoundTouchBeats : public AnalyzerBeatsPlugin {
 
     bool initialize(mixxx::audio::SampleRate sampleRate) override;
     bool processSamples(const CSAMPLE* pIn, const int iLen) override;
+    bool processMonoSamples(const CSAMPLE* pIn, SINT frameCount) override;
     bool finalize() override;
 
     bool supportsBeatTracking() const override {
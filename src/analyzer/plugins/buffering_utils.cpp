@@ -23,7 +23,11 @@ bool DownmixAndOverlapHelper::initialize(size_t windowSize,
 
 bool DownmixAndOverlapHelper::processStereoSamples(const CSAMPLE* pInput, size_t inputStereoSamples) {
     const size_t numInputFrames = inputStereoSamples / 2;
-    return processInner(pInput, numInputFrames);
+    return processInner(pInput, numInputFrames, 2);
+}
+
+bool DownmixAndOverlapHelper::processMonoSamples(const CSAMPLE* pInput, size_t inputFrames) {
+    return processInner(pInput, inputFrames, 1);
 }
 
 bool DownmixAndOverlapHelper::finalize() {
@@ -34,11 +38,11 @@ bool DownmixAndOverlapHelper::finalize() {
     // instead of "m_windowSize / 2 - m_stepSize"
     size_t framesToFillWindow = m_windowSize - m_bufferWritePosition;
     size_t numInputFrames = math_max(framesToFillWindow, m_windowSize / 2 - 1);
-    return processInner(nullptr, numInputFrames);
+    return processInner(nullptr, numInputFrames, 0);
 }
 
 bool DownmixAndOverlapHelper::processInner(
-        const CSAMPLE* pInput, size_t numInputFrames) {
+        const CSAMPLE* pInput, size_t numInputFrames, int numInputChannels) {
     size_t inRead = 0;
     double* pDownmix = m_buffer.data();
 
@@ -47,7 +51,12 @@ bool DownmixAndOverlapHelper::processInner(
         DEBUG_ASSERT(m_bufferWritePosition <= m_windowSize);
         size_t writeAvailable = m_windowSize - m_bufferWritePosition;
         size_t numFrames = math_min(readAvailable, writeAvailable);
-        if (pInput) {
+        if (pInput && numInputChannels == 1) {
+            for (size_t i = 0; i < numFrames; ++i) {
+                pDownmix[m_bufferWritePosition + i] = pInput[inRead + i];
+            }
+        } else if (pInput) {
+            DEBUG_ASSERT(numInputChannels == 2);
             for (size_t i = 0; i < numFrames; ++i) {
                 // We analyze a mono downmix of the signal since we don't think
                 // stereo does us any good.
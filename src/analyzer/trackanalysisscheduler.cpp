@@ -49,6 +49,12 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
         const UserSettingsPointer& pConfig,
         AnalyzerModeFlags modeFlags)
         : m_library(library),
+          // Stealing stages is only useful with multiple threads
+          m_pStageExecutor(
+                  (modeFlags & AnalyzerModeFlags::ParallelStages) && numWorkerThreads > 1
+                          ? std::make_shared<AnalyzerStageExecutor>()
+                          : nullptr),
+          m_pStatistics(std::make_shared<AnalyzerStatistics>()),
           m_currentTrackProgress(kAnalyzerProgressUnknown),
           m_currentTrackNumber(0),
           m_dequeuedTracksCount(0),
@@ -63,7 +69,9 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
                 << "Starting"
                 << numWorkerThreads
                 << "worker threads. Priority: "
-                << (modeFlags & AnalyzerModeFlags::LowPriority ? "low" : "normal");
+                << (modeFlags & AnalyzerModeFlags::LowPriority ? "low" : "normal")
+                << "Parallel stages:"
+                << static_cast<bool>(m_pStageExecutor);
     }
     // 1st pass: Create worker threads
     m_workers.reserve(numWorkerThreads);
@@ -72,7 +80,9 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
                 threadId,
                 library->dbConnectionPool(),
                 pConfig,
-                modeFlags));
+                modeFlags,
+                m_pStageExecutor,
+                m_pStatistics));
         connect(m_workers.back().thread(), &AnalyzerThread::progress,
             this, &TrackAnalysisScheduler::onWorkerThreadProgress);
     }
@@ -91,6 +101,8 @@ void TrackAnalysisScheduler::emitProgressOrFinished() {
     // The finished() signal is emitted regardless of when the last
     // signal has been emitted
     if (allTracksFinished()) {
+        emitStatistics(m_dequeuedTracksCount);
+        m_pStatistics->reset();
         m_currentTrackProgress = kAnalyzerProgressUnknown;
         m_currentTrackNumber = 0;
         m_dequeuedTracksCount = 0;
@@ -166,12 +178,23 @@ void TrackAnalysisScheduler::emitProgressOrFinished() {
             m_dequeuedTracksCount + static_cast<int>(m_queuedTrackIds.size());
     DEBUG_ASSERT(m_currentTrackNumber <= m_dequeuedTracksCount);
     DEBUG_ASSERT(m_dequeuedTracksCount <= totalTracksCount);
+    emitStatistics(finishedTracksCount);
     emit progress(
             m_currentTrackProgress,
             m_currentTrackNumber,
             totalTracksCount);
 }
 
+void TrackAnalysisScheduler::emitStatistics(int finishedTracksCount) {
+    const double elapsedMinutes =
+            std::chrono::duration<double, std::ratio<60>>(
+                    Clock::now() - m_analysisStartedAt)
+                    .count();
+    const double tracksPerMinute =
+            elapsedMinutes > 0 ? finishedTracksCount / elapsedMinutes : 0;
+    emit statistics(tracksPerMinute, m_pStatistics->cpuTimes());
+}
+
 void TrackAnalysisScheduler::onWorkerThreadProgress(
         int threadId,
         AnalyzerThreadState threadState,
@@ -270,6 +293,10 @@ void TrackAnalysisScheduler::resume() {
 
 bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
     DEBUG_ASSERT(worker);
+    if (m_dequeuedTracksCount == 0) {
+        // (Re-)start measuring the throughput
+        m_analysisStartedAt = Clock::now();
+    }
     while (!m_queuedTrackIds.empty()) {
         TrackId nextTrackId = m_queuedTrackIds.front();
         DEBUG_ASSERT(nextTrackId.isValid());
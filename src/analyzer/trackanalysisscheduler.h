@@ -2,6 +2,7 @@
 
 #include <QList>
 
+#include <chrono>
 #include <deque>
 #include <set>
 #include <vector>
@@ -66,6 +67,9 @@ class TrackAnalysisScheduler : public QObject {
     void trackProgress(TrackId trackId, AnalyzerProgress analyzerProgress);
     // Current average progress for all scheduled tracks and from all workers
     void progress(AnalyzerProgress currentTrackProgress, int currentTrackNumber, int totalTracksCount);
+    // Throughput since the analysis has been started and the accumulated
+    // CPU time of each analyzer. Emitted before progress() and finished().
+    void statistics(double tracksPerMinute, const AnalyzerCpuTimes& analyzerCpuTimes);
     void finished();
 
   private slots:
@@ -140,6 +144,7 @@ class TrackAnalysisScheduler : public QObject {
 
     bool submitNextTrack(Worker* worker);
     void emitProgressOrFinished();
+    void emitStatistics(int finishedTracksCount);
 
     bool allTracksFinished() const {
         return m_queuedTrackIds.empty() &&
@@ -148,6 +153,10 @@ class TrackAnalysisScheduler : public QObject {
 
     Library* m_library;
 
+    // Shared with the worker threads that might outlive the scheduler
+    const std::shared_ptr<AnalyzerStageExecutor> m_pStageExecutor;
+    const std::shared_ptr<AnalyzerStatistics> m_pStatistics;
+
     std::vector<Worker> m_workers;
 
     std::deque<TrackId> m_queuedTrackIds;
@@ -164,4 +173,7 @@ class TrackAnalysisScheduler : public QObject {
 
     typedef std::chrono::steady_clock Clock;
     Clock::time_point m_lastProgressEmittedAt;
+
+    // Reset when the first track is dequeued
+    Clock::time_point m_analysisStartedAt;
 };
@@ -33,7 +33,11 @@ ControlDoublePrivate::ControlDoublePrivate(
           m_trackType(Stat::UNSPECIFIED),
           m_trackFlags(Stat::COUNT | Stat::SUM | Stat::AVERAGE |
                   Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
-          m_confirmRequired(false) {
+          m_confirmRequired(false),
+          m_slot(ControlSlot::allocate(this, bIgnoreNops)),
+          m_pValue(m_slot.index() != ControlSlot::kInvalidIndex
+                          ? &ControlSlot::valueOf(m_slot.index())
+                          : &m_unslottedValue) {
     initialize(defaultValue);
 }
 
@@ -46,16 +50,16 @@ void ControlDoublePrivate::initialize(double defaultValue) {
         }
     }
     m_defaultValue.setValue(defaultValue);
-    m_value.setValue(value);
+    m_pValue->setValue(value);
 
-    //qDebug() << "Creating:" << m_trackKey << "at" << &m_value << sizeof(m_value);
+    //qDebug() << "Creating:" << m_trackKey << "at" << m_pValue << sizeof(*m_pValue);
 
     if (m_bTrack) {
         // TODO(rryan): Make configurable.
         m_trackKey = "control " + m_key.group + "," + m_key.item;
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
                     static_cast<Stat::ComputeFlags>(m_trackFlags),
-                    m_value.getValue());
+                    m_pValue->getValue());
     }
 }
 
@@ -71,6 +75,10 @@ ControlDoublePrivate::~ControlDoublePrivate() {
             pConfig->set(m_key, QString::number(get()));
         }
     }
+
+    if (m_slot.index() != ControlSlot::kInvalidIndex) {
+        m_slot.release();
+    }
 }
 
 // static
@@ -219,7 +227,7 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     if (m_bIgnoreNops && get() == value) {
         return;
     }
-    m_value.setValue(value);
+    m_pValue->setValue(value);
     emit valueChanged(value, pSender);
 
     if (m_bTrack) {
@@ -228,6 +236,16 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     }
 }
 
+void ControlDoublePrivate::notifyValueChanged() {
+    const double value = get();
+    emit valueChanged(value, nullptr);
+
+    if (m_bTrack) {
+        Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
+                    static_cast<Stat::ComputeFlags>(m_trackFlags), value);
+    }
+}
+
 void ControlDoublePrivate::setBehavior(ControlNumericBehavior* pBehavior) {
     // This marks the old mpBehavior for deletion. It is deleted once it is not
     // used in any other function
@@ -7,6 +7,7 @@
 #include <QString>
 
 #include "control/controlbehavior.h"
+#include "control/controlslot.h"
 #include "control/controlvalue.h"
 #include "preferences/usersettings.h"
 #include "util/mutex.h"
@@ -29,7 +30,8 @@ enum class ControlFlag {
 Q_DECLARE_FLAGS(ControlFlags, ControlFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(ControlFlags)
 
-class ControlDoublePrivate : public QObject {
+class ControlDoublePrivate : public QObject,
+                             public QEnableSharedFromThis<ControlDoublePrivate> {
     Q_OBJECT
   public:
     ~ControlDoublePrivate() override;
@@ -91,7 +93,14 @@ class ControlDoublePrivate : public QObject {
     void setAndConfirm(double value, QObject* pSender);
     // Gets the control value.
     double get() const {
-        return m_value.getValue();
+        return m_pValue->getValue();
+    }
+
+    // The slot for reading and writing the value without locking
+    // and signal emission, e.g. from the engine thread. Might be
+    // invalid if no more slots are available.
+    ControlSlot slot() const {
+        return m_slot;
     }
     // Resets the control value to its default.
     void reset();
@@ -149,6 +158,9 @@ class ControlDoublePrivate : public QObject {
         // confirmation is only required if connect was successful
         m_confirmRequired = connect(this, &ControlDoublePrivate::valueChangeRequest,
                     receiver, func, type);
+        if (m_slot.index() != ControlSlot::kInvalidIndex) {
+            m_slot.setConfirmRequired(m_confirmRequired);
+        }
         return m_confirmRequired;
     }
 
@@ -159,6 +171,8 @@ class ControlDoublePrivate : public QObject {
     void valueChangeRequest(double value);
 
   private:
+    friend class ControlSlot;
+
     ControlDoublePrivate(
             const ConfigKey& key,
             ControlObject* pCreatorCO,
@@ -173,6 +187,13 @@ class ControlDoublePrivate : public QObject {
 
     void initialize(double defaultValue);
     void setInner(double value, QObject* pSender);
+    // Emits the deferred notification after the value has been set by slot
+    void notifyValueChanged();
+    // Passes the value that has been set by slot to the change request
+    // handler without applying the behavior
+    void requestValueChange(double value) {
+        emit valueChangeRequest(value);
+    }
 
     const ConfigKey m_key;
 
@@ -199,8 +220,11 @@ class ControlDoublePrivate : public QObject {
     // User-visible, i18n description for what the control does.
     QString m_description;
 
-    // The control value.
-    ControlValueAtomic<double> m_value;
+    // The control value is stored in m_slot. m_unslottedValue is only
+    // used if no slot could be allocated.
+    const ControlSlot m_slot;
+    ControlValueAtomic<double> m_unslottedValue;
+    ControlValueAtomic<double>* const m_pValue;
     // The default control value.
     ControlValueAtomic<double> m_defaultValue;
 
@@ -64,6 +64,12 @@ class ControlObject : public QObject {
         return m_pControl ? m_pControl->get() : 0.0;
     }
 
+    // Returns the slot for lock-free access to the value without
+    // immediate signal emission, see ControlSlot
+    inline ControlSlot slot() const {
+        return m_pControl ? m_pControl->slot() : ControlSlot();
+    }
+
     // Returns the bool interpretation of the ControlObject
     inline bool toBool() const {
         return get() > 0.0;
@@ -122,6 +122,12 @@ class ControlProxy : public QObject {
         return m_pControl ? m_pControl->get() : 0.0;
     }
 
+    /// Returns the slot for lock-free access to the value without
+    /// immediate signal emission, see ControlSlot.
+    inline ControlSlot slot() const {
+        return m_pControl ? m_pControl->slot() : ControlSlot();
+    }
+
     /// Returns the bool interpretation of the value. Thread safe, non-blocking.
     inline bool toBool() const {
         return get() > 0.0;
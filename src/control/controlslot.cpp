@@ -0,0 +1,270 @@
+#include "control/controlslot.h"
+
+#include <QSharedPointer>
+#include <vector>
+
+#include "control/control.h"
+#include "util/logger.h"
+#include "util/mutex.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ControlSlot");
+
+constexpr int kSlotsPerSegment = 1024;
+// Up to 1M slots. Only the pointers are allocated upfront.
+constexpr int kMaxSegments = 1024;
+constexpr int kSlotsPerPendingWord = 64;
+
+// A handle packs the index into the lower bits and the generation into
+// the remaining bits of a non-negative int. The generation wraps around
+// after 2048 controls have reused the same slot.
+constexpr int kHandleIndexBits = 20;
+constexpr int kHandleIndexMask = (1 << kHandleIndexBits) - 1;
+constexpr quint32 kGenerationMask = (1u << (31 - kHandleIndexBits)) - 1;
+static_assert(kMaxSegments * kSlotsPerSegment <= (1 << kHandleIndexBits),
+        "Slot indexes don't fit into handles");
+
+struct Slot {
+    ControlValueAtomic<double> value;
+    // The last value that has been written by slot if the
+    // control requires a confirmation
+    ControlValueAtomic<double> requestedValue;
+    std::atomic<bool> confirmRequired{false};
+    std::atomic<bool> ignoreNops{false};
+    std::atomic<bool> allocated{false};
+    // Incremented on release to detect stale handles
+    std::atomic<quint32> generation{0};
+    // Guarded by slotMutex()
+    ControlDoublePrivate* pControl{nullptr};
+};
+
+struct Segment {
+    Slot slots[kSlotsPerSegment];
+    // One bit per slot with a deferred notification
+    std::atomic<quint64> pendingWords[kSlotsPerSegment / kSlotsPerPendingWord];
+
+    Segment() {
+        for (auto& pendingWord : pendingWords) {
+            pendingWord.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Segments are never freed and never move
+std::atomic<Segment*> s_segments[kMaxSegments];
+std::atomic<int> s_segmentCount(0);
+
+// Function-local statics are initialized on first use,
+// independent of the order of static initialization
+MMutex& slotMutex() {
+    static MMutex s_mutex;
+    return s_mutex;
+}
+
+struct SlotAllocation {
+    int nextIndex = 0;
+    int usedCount = 0;
+    std::vector<int> freeIndexes;
+};
+
+SlotAllocation& slotAllocation() {
+    static SlotAllocation s_allocation;
+    return s_allocation;
+}
+
+inline Segment* segmentOf(int index) {
+    return s_segments[index / kSlotsPerSegment].load(std::memory_order_acquire);
+}
+
+inline Slot& slotOf(int index) {
+    return segmentOf(index)->slots[index % kSlotsPerSegment];
+}
+
+inline std::atomic<quint64>& pendingWordOf(int index) {
+    return segmentOf(index)->pendingWords[(index % kSlotsPerSegment) / kSlotsPerPendingWord];
+}
+
+inline quint64 pendingBitOf(int index) {
+    return quint64(1) << (index % kSlotsPerPendingWord);
+}
+
+} // anonymous namespace
+
+// static
+ControlValueAtomic<double>& ControlSlot::valueOf(int index) {
+    return slotOf(index).value;
+}
+
+// static
+ControlSlot ControlSlot::fromHandle(int handle) {
+    if (handle < 0) {
+        return ControlSlot();
+    }
+    return ControlSlot(handle & kHandleIndexMask,
+            static_cast<quint32>(handle) >> kHandleIndexBits);
+}
+
+int ControlSlot::handle() const {
+    if (m_index == kInvalidIndex) {
+        return kInvalidHandle;
+    }
+    return static_cast<int>(m_generation << kHandleIndexBits) | m_index;
+}
+
+bool ControlSlot::isCurrent() const {
+    return slotOf(m_index).generation.load(std::memory_order_acquire) == m_generation;
+}
+
+bool ControlSlot::isValid() const {
+    if (m_index < 0 || m_index >= kMaxSegments * kSlotsPerSegment) {
+        return false;
+    }
+    if (!segmentOf(m_index)) {
+        return false;
+    }
+    return slotOf(m_index).allocated.load(std::memory_order_acquire) &&
+            isCurrent();
+}
+
+double ControlSlot::get() const {
+    DEBUG_ASSERT(m_index != kInvalidIndex);
+    if (!isCurrent()) {
+        return 0.0;
+    }
+    return valueOf(m_index).getValue();
+}
+
+void ControlSlot::set(double value) const {
+    DEBUG_ASSERT(m_index != kInvalidIndex);
+    if (!isCurrent()) {
+        return;
+    }
+    Slot& slot = slotOf(m_index);
+    if (slot.confirmRequired.load(std::memory_order_acquire)) {
+        slot.requestedValue.setValue(value);
+    } else {
+        if (slot.ignoreNops.load(std::memory_order_relaxed) &&
+                slot.value.getValue() == value) {
+            return;
+        }
+        slot.value.setValue(value);
+    }
+    pendingWordOf(m_index).fetch_or(pendingBitOf(m_index), std::memory_order_release);
+}
+
+// static
+ControlSlot ControlSlot::allocate(ControlDoublePrivate* pControl, bool ignoreNops) {
+    DEBUG_ASSERT(pControl);
+    MMutexLocker locker(&slotMutex());
+    SlotAllocation& allocation = slotAllocation();
+    int index;
+    if (allocation.freeIndexes.empty()) {
+        index = allocation.nextIndex;
+        const int segmentIndex = index / kSlotsPerSegment;
+        VERIFY_OR_DEBUG_ASSERT(segmentIndex < kMaxSegments) {
+            kLogger.critical()
+                    << "No more slots available for"
+                    << pControl->getKey();
+            return ControlSlot();
+        }
+        if (index % kSlotsPerSegment == 0) {
+            s_segments[segmentIndex].store(new Segment, std::memory_order_release);
+            s_segmentCount.store(segmentIndex + 1, std::memory_order_release);
+        }
+        ++allocation.nextIndex;
+    } else {
+        index = allocation.freeIndexes.back();
+        allocation.freeIndexes.pop_back();
+    }
+    ++allocation.usedCount;
+    Slot& slot = slotOf(index);
+    DEBUG_ASSERT(!slot.pControl);
+    slot.pControl = pControl;
+    slot.confirmRequired.store(false, std::memory_order_relaxed);
+    slot.ignoreNops.store(ignoreNops, std::memory_order_relaxed);
+    slot.allocated.store(true, std::memory_order_release);
+    return ControlSlot(index, slot.generation.load(std::memory_order_relaxed));
+}
+
+void ControlSlot::release() const {
+    DEBUG_ASSERT(m_index != kInvalidIndex);
+    MMutexLocker locker(&slotMutex());
+    Slot& slot = slotOf(m_index);
+    DEBUG_ASSERT(slot.pControl);
+    slot.pControl = nullptr;
+    // Invalidate all handles before the slot can be reused
+    slot.generation.store(
+            (m_generation + 1) & kGenerationMask, std::memory_order_release);
+    slot.allocated.store(false, std::memory_order_release);
+    // Don't notify the next owner of this slot
+    pendingWordOf(m_index).fetch_and(~pendingBitOf(m_index), std::memory_order_relaxed);
+    SlotAllocation& allocation = slotAllocation();
+    allocation.freeIndexes.push_back(m_index);
+    --allocation.usedCount;
+}
+
+void ControlSlot::setConfirmRequired(bool confirmRequired) const {
+    DEBUG_ASSERT(m_index != kInvalidIndex);
+    slotOf(m_index).confirmRequired.store(confirmRequired, std::memory_order_release);
+}
+
+// static
+int ControlSlot::count() {
+    MMutexLocker locker(&slotMutex());
+    return slotAllocation().usedCount;
+}
+
+// static
+void ControlSlot::flushNotifications() {
+    struct Notification {
+        QSharedPointer<ControlDoublePrivate> pControl;
+        bool confirmRequired;
+        double requestedValue;
+    };
+    std::vector<Notification> notifications;
+    const int segmentCount = s_segmentCount.load(std::memory_order_acquire);
+    for (int segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex) {
+        Segment* pSegment = s_segments[segmentIndex].load(std::memory_order_acquire);
+        for (int wordIndex = 0;
+                wordIndex < kSlotsPerSegment / kSlotsPerPendingWord;
+                ++wordIndex) {
+            std::atomic<quint64>& pendingWord = pSegment->pendingWords[wordIndex];
+            if (pendingWord.load(std::memory_order_relaxed) == 0) {
+                // Early exit without a read-modify-write operation
+                continue;
+            }
+            quint64 pendingBits = pendingWord.exchange(0, std::memory_order_acq_rel);
+            // The owners of the slots must not be deleted while
+            // collecting strong references
+            MMutexLocker locker(&slotMutex());
+            for (int bit = 0; pendingBits != 0; ++bit, pendingBits >>= 1) {
+                if ((pendingBits & 1) == 0) {
+                    continue;
+                }
+                Slot& slot = pSegment->slots[wordIndex * kSlotsPerPendingWord + bit];
+                if (!slot.pControl) {
+                    continue;
+                }
+                // Returns null if the control is about to be deleted
+                auto pControl = slot.pControl->sharedFromThis();
+                if (!pControl) {
+                    continue;
+                }
+                notifications.push_back(Notification{
+                        std::move(pControl),
+                        slot.confirmRequired.load(std::memory_order_acquire),
+                        slot.requestedValue.getValue()});
+            }
+        }
+    }
+    // Signals are emitted without holding the lock, because the
+    // receivers might create or delete controls
+    for (const auto& notification : notifications) {
+        if (notification.confirmRequired) {
+            notification.pControl->requestValueChange(notification.requestedValue);
+        } else {
+            notification.pControl->notifyValueChanged();
+        }
+    }
+}
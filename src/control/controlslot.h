@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+
+#include "control/controlvalue.h"
+
+class ControlDoublePrivate;
+
+// A stable integer handle of a control value for real-time access.
+//
+// The values of all controls are stored in a dense table of atomic slots
+// that is allocated in fixed-size segments and never moves. Reading and
+// writing a value by its slot doesn't need any hashing, locking, memory
+// allocation or signal emission and is safe from any thread, including
+// the engine thread.
+//
+// Writing a value by its slot only marks the slot as changed. The
+// valueChanged() signals of all changed controls are emitted at once
+// by flushNotifications() that is invoked on every GUI tick. If the
+// control requires a confirmation of value changes the written value
+// is not stored immediately, but passed as a change request when
+// flushing the notifications.
+//
+// Neither writing by slot nor the deferred change request apply the
+// behavior of the control, just like setAndConfirm().
+//
+// The index of a released slot is reused for the next control. Each
+// handle carries the generation of its slot that is incremented on
+// release, so a stale handle of a deleted control is detected instead of
+// accessing the value of the new owner.
+class ControlSlot {
+  public:
+    static constexpr int kInvalidIndex = -1;
+    static constexpr int kInvalidHandle = -1;
+
+    ControlSlot()
+            : m_index(kInvalidIndex),
+              m_generation(0) {
+    }
+
+    // Restores a handle that has been passed as a plain integer
+    static ControlSlot fromHandle(int handle);
+
+    int index() const {
+        return m_index;
+    }
+
+    // The index and generation packed into a non-negative integer, e.g.
+    // for passing the slot to controller scripts
+    int handle() const;
+
+    // Returns false for invalid indexes and handles of released slots.
+    // Only needed when the handle is passed from untrusted sources, e.g.
+    // controller scripts.
+    bool isValid() const;
+
+    // Returns 0.0 if the slot has been released in the meantime
+    double get() const;
+
+    // Sets the value and defers the change notification until the next
+    // GUI tick. Writes to a slot that has been released in the meantime
+    // are ignored.
+    void set(double value) const;
+
+    // Emits the deferred change notifications. Must be invoked from
+    // the main thread.
+    static void flushNotifications();
+
+    // The number of slots that are currently in use
+    static int count();
+
+  private:
+    friend class ControlDoublePrivate;
+
+    // Functions for managing the slots of ControlDoublePrivate
+    static ControlSlot allocate(ControlDoublePrivate* pControl, bool ignoreNops);
+    void release() const;
+    void setConfirmRequired(bool confirmRequired) const;
+
+    ControlSlot(int index, quint32 generation)
+            : m_index(index),
+              m_generation(generation) {
+    }
+
+    static ControlValueAtomic<double>& valueOf(int index);
+    bool isCurrent() const;
+
+    int m_index;
+    quint32 m_generation;
+};
@@ -2,6 +2,7 @@
 
 #include "control/controlobject.h"
 #include "control/controlobjectscript.h"
+#include "control/controlslot.h"
 #include "controllers/controllerdebug.h"
 #include "controllers/scripting/legacy/controllerscriptenginelegacy.h"
 #include "controllers/scripting/legacy/scriptconnectionjsproxy.h"
@@ -131,6 +132,43 @@ void ControllerScriptInterfaceLegacy::setValue(
     }
 }
 
+int ControllerScriptInterfaceLegacy::getSlot(const QString& group, const QString& name) {
+    // The cached ControlObjectScript keeps the control and
+    // its slot alive until the script engine is shut down
+    ControlObjectScript* coScript = getControlObjectScript(group, name);
+    if (coScript == nullptr) {
+        qWarning() << "Unknown control" << group << name
+                   << ", returning invalid slot";
+        return ControlSlot::kInvalidHandle;
+    }
+    return coScript->slot().handle();
+}
+
+double ControllerScriptInterfaceLegacy::getValueBySlot(int slot) {
+    const ControlSlot controlSlot = ControlSlot::fromHandle(slot);
+    if (!controlSlot.isValid()) {
+        qWarning() << "Invalid control slot" << slot
+                   << ", returning 0.0";
+        return 0.0;
+    }
+    return controlSlot.get();
+}
+
+void ControllerScriptInterfaceLegacy::setValueBySlot(int slot, double newValue) {
+    if (util_isnan(newValue)) {
+        qWarning() << "script setting slot" << slot
+                   << "to NotANumber, ignoring.";
+        return;
+    }
+    const ControlSlot controlSlot = ControlSlot::fromHandle(slot);
+    if (!controlSlot.isValid()) {
+        qWarning() << "Invalid control slot" << slot
+                   << ", ignoring.";
+        return;
+    }
+    controlSlot.set(newValue);
+}
+
 double ControllerScriptInterfaceLegacy::getParameter(const QString& group, const QString& name) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
     if (coScript == nullptr) {
@@ -22,6 +22,14 @@ class ControllerScriptInterfaceLegacy : public QObject {
 
     Q_INVOKABLE double getValue(const QString& group, const QString& name);
     Q_INVOKABLE void setValue(const QString& group, const QString& name, double newValue);
+    // Fast path for scripts that access the same controls repeatedly. The
+    // slot of a control is looked up once and then used for reading and
+    // writing the value without any lookup. Change notifications for
+    // values written by slot are deferred until the next GUI tick and
+    // soft takeover is not applied.
+    Q_INVOKABLE int getSlot(const QString& group, const QString& name);
+    Q_INVOKABLE double getValueBySlot(int slot);
+    Q_INVOKABLE void setValueBySlot(int slot, double newValue);
     Q_INVOKABLE double getParameter(const QString& group, const QString& name);
     Q_INVOKABLE void setParameter(const QString& group, const QString& name, double newValue);
     Q_INVOKABLE double getParameterForValue(
@@ -30,6 +30,16 @@ const QString kUserName = QStringLiteral("mixxx");
 
 const QString kPassword = QStringLiteral("mixxx");
 
+const ConfigKey kPerformanceProfileConfigKey =
+        ConfigKey("[Library]", "DatabasePerformanceProfile");
+const ConfigKey kMmapSizeConfigKey =
+        ConfigKey("[Library]", "DatabaseMmapSizeMiB");
+const ConfigKey kCacheSizeConfigKey =
+        ConfigKey("[Library]", "DatabaseCacheSizeMiB");
+
+constexpr int kDefaultMmapSizeMiB = 256;
+constexpr int kDefaultCacheSizeMiB = 32;
+
 // The connection parameters for the main Mixxx DB
 mixxx::DbConnection::Params dbConnectionParams(
         const UserSettingsPointer& pConfig,
@@ -58,6 +68,14 @@ mixxx::DbConnection::Params dbConnectionParams(
     }
     params.userName = kUserName;
     params.password = kPassword;
+    // Performance profile
+    params.tuning.enabled =
+            pConfig->getValue<bool>(kPerformanceProfileConfigKey, true);
+    const qint64 mmapSizeMiB =
+            pConfig->getValue<int>(kMmapSizeConfigKey, kDefaultMmapSizeMiB);
+    params.tuning.mmapSizeBytes = mmapSizeMiB * 1024 * 1024;
+    params.tuning.cacheSizeKiB =
+            pConfig->getValue<int>(kCacheSizeConfigKey, kDefaultCacheSizeMiB) * 1024;
     return params;
 }
 
@@ -33,17 +33,81 @@ const SINT kDefaultHintFrames = 1024;
 // CachingReader must be multiplied by the number of decks to calculate
 // the total amount!
 //
+// The initial number of chunks can be configured per deck with
+// ConfigKey(group, "cache_initial_chunks"). The pool grows on demand up to
+// the maximum of the role of the reader while the total memory of all
+// chunks stays below the budget of CachingReaderChunkBudget. EngineMaster
+// sets this budget from ConfigKey("[Master]", "cache_memory_budget_mb").
+//
 // NOTE(uklotzde, 2019-09-05): Reduce this number to just few chunks
 // (kNumberOfCachedChunksInMemory = 1, 2, 3, ...) for testing purposes
 // to verify that the MRU/LRU cache works as expected. Even though
 // massive drop outs are expected to occur Mixxx should run reliably!
 const SINT kNumberOfCachedChunksInMemory = 80;
 
+// Upper bound for the chunks of a deck, i.e. 256 MB or ~11 minutes at
+// 48 kHz. It also limits the size of the status FIFO.
+const SINT kMaxNumberOfCachedChunksForDeck = 1 << 12;
+
+// Samplers and preview decks play short clips or only parts of a track
+const SINT kMaxNumberOfCachedChunksForSampler = 2 * kNumberOfCachedChunksInMemory;
+
+// Preload buffers are retired on every track (un)load and deleted by the
+// worker shortly after.
+const SINT kRetiredPreloadFIFOCapacity = 16;
+
+SINT configuredInitialChunks(
+        const UserSettingsPointer& pConfig,
+        const QString& group) {
+    if (!pConfig) {
+        return kNumberOfCachedChunksInMemory;
+    }
+    const SINT numChunks = pConfig->getValue(
+            ConfigKey(group, "cache_initial_chunks"),
+            static_cast<int>(kNumberOfCachedChunksInMemory));
+    // At least two chunks are needed for reading across a chunk boundary
+    return math_clamp(numChunks, SINT(2), kMaxNumberOfCachedChunksForDeck);
+}
+
+CachingReaderPreload::Options configuredPreloadOptions(
+        const UserSettingsPointer& pConfig,
+        const QString& group) {
+    CachingReaderPreload::Options options;
+    if (!pConfig) {
+        return options;
+    }
+    options.enabled = pConfig->getValue(
+            ConfigKey(group, "preload_track"), options.enabled);
+    if (pConfig->getValue(ConfigKey("[Master]", "preload_float16"), false)) {
+        options.sampleFormat = CachingReaderPreload::SampleFormat::Float16;
+    }
+    options.memoryMapped = pConfig->getValue(
+            ConfigKey("[Master]", "preload_mmap"), options.memoryMapped);
+    return options;
+}
+
+SINT maxChunksForRole(
+        CachingReader::Role role,
+        SINT numInitialChunks) {
+    switch (role) {
+    case CachingReader::Role::Deck:
+        return math_max(numInitialChunks, kMaxNumberOfCachedChunksForDeck);
+    case CachingReader::Role::Sampler:
+        return math_max(numInitialChunks, kMaxNumberOfCachedChunksForSampler);
+    }
+    DEBUG_ASSERT(!"unreachable");
+    return numInitialChunks;
+}
+
 } // anonymous namespace
 
 CachingReader::CachingReader(const QString& group,
-        UserSettingsPointer config)
-        : m_pConfig(config),
+        UserSettingsPointer config,
+        Role role)
+        : m_group(group),
+          m_pConfig(config),
+          m_numInitialChunks(configuredInitialChunks(config, group)),
+          m_maxChunks(maxChunksForRole(role, m_numInitialChunks)),
           // Limit the number of in-flight requests to the worker. This should
           // prevent to overload the worker when it is not able to fetch those
           // requests from the FIFO timely. Otherwise outdated requests pile up
@@ -53,21 +117,61 @@ CachingReader::CachingReader(const QString& group,
           // buffer, where new requests replace old requests when full. Those
           // old requests need to be returned immediately to the CachingReader
           // that must take ownership and free them!!!
-          m_chunkReadRequestFIFO(kNumberOfCachedChunksInMemory / 4),
-          // The capacity of the back channel must be equal to the number of
-          // allocated chunks, because the worker use writeBlocking(). Otherwise
-          // the worker could get stuck in a hot loop!!!
-          m_readerStatusUpdateFIFO(kNumberOfCachedChunksInMemory),
+          m_chunkReadRequestFIFO(math_max(m_numInitialChunks / 4, SINT(1))),
+          // Only a few prefetch requests are queued at a time, because an
+          // urgent read of a chunk that is still waiting in this FIFO would
+          // be delayed by all requests in front of it.
+          m_prefetchRequestFIFO(math_max(m_numInitialChunks / 16, SINT(1))),
+          // The capacity of the back channel must be equal to the maximum
+          // number of allocated chunks, because the worker use writeBlocking().
+          // Otherwise the worker could get stuck in a hot loop!!!
+          // One additional slot is needed for the preload buffer.
+          m_readerStatusUpdateFIFO(m_maxChunks + 1),
+          m_retiredPreloadFIFO(kRetiredPreloadFIFOCapacity),
+          // All additional chunks may be released at once
+          m_releasedChunkFIFO(math_max(m_maxChunks - m_numInitialChunks, SINT(1))),
           m_state(STATE_IDLE),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
-          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusUpdateFIFO) {
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
+          m_numCallbacks(0),
+          m_sampleBuffer(CachingReaderChunk::kSamples * m_numInitialChunks),
+          m_cacheHits(0),
+          m_cacheMisses(0),
+          m_cacheEvictions(0),
+          m_pCacheHitsControl(std::make_unique<ControlObject>(
+                  ConfigKey(group, "cache_hits"))),
+          m_pCacheMissesControl(std::make_unique<ControlObject>(
+                  ConfigKey(group, "cache_misses"))),
+          m_pCacheEvictionsControl(std::make_unique<ControlObject>(
+                  ConfigKey(group, "cache_evictions"))),
+          m_pCacheChunksControl(std::make_unique<ControlObject>(
+                  ConfigKey(group, "cache_chunks"))),
+          m_pPreload(nullptr),
+          m_pPreloadProgressControl(std::make_unique<ControlObject>(
+                  ConfigKey(group, "preload_progress"))),
+          m_worker(group,
+                  &m_chunkReadRequestFIFO,
+                  &m_prefetchRequestFIFO,
+                  &m_readerStatusUpdateFIFO,
+                  &m_retiredPreloadFIFO,
+                  &m_releasedChunkFIFO,
+                  CachingReaderDiskCache::open(config),
+                  m_maxChunks - m_numInitialChunks) {
+    m_pCacheHitsControl->setReadOnly();
+    m_pCacheMissesControl->setReadOnly();
+    m_pCacheEvictionsControl->setReadOnly();
+    m_pCacheChunksControl->setReadOnly();
+    m_pPreloadProgressControl->setReadOnly();
+
+    // Reserve the capacity for all chunks the pool of this role may grow
+    // to, because additional chunks are adopted in the engine callback.
+    m_chunks.reserve(m_maxChunks);
+    m_allocatedCachingReaderChunks.reserve(m_numInitialChunks);
+    CachingReaderChunkBudget::reserveUnlimited(m_numInitialChunks);
     // Divide up the allocated raw memory buffer into total_chunks
     // chunks. Initialize each chunk to hold nothing and add it to the free
     // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
+    for (SINT i = 0; i < m_numInitialChunks; ++i) {
         CachingReaderChunkForOwner* c =
                 new CachingReaderChunkForOwner(
                         mixxx::SampleBuffer::WritableSlice(
@@ -77,6 +181,7 @@ CachingReader::CachingReader(const QString& group,
         m_chunks.push_back(c);
         m_freeChunks.push_back(c);
     }
+    m_pCacheChunksControl->forceSet(m_chunks.size());
 
     // Forward signals from worker
     connect(&m_worker, &CachingReaderWorker::trackLoading,
@@ -94,6 +199,26 @@ CachingReader::CachingReader(const QString& group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    // Adopt the chunks that the worker allocated after the last callback
+    ReaderStatusUpdate update;
+    while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
+        if (update.status == CHUNK_ALLOCATED) {
+            m_chunks.push_back(update.takeAllocatedChunk());
+        } else if (update.status == PRELOAD_STARTED) {
+            delete update.takePreload();
+        }
+    }
+    CachingReaderPreload* pRetiredPreload;
+    while (m_retiredPreloadFIFO.read(&pRetiredPreload, 1) == 1) {
+        delete pRetiredPreload;
+    }
+    CachingReaderChunkForOwner* pReleasedChunk;
+    while (m_releasedChunkFIFO.read(&pReleasedChunk, 1) == 1) {
+        delete pReleasedChunk;
+    }
+    delete m_pPreload;
+    // The worker accounts the memory of the additional chunks
+    CachingReaderChunkBudget::release(m_numInitialChunks);
     qDeleteAll(m_chunks);
 }
 
@@ -136,26 +261,79 @@ void CachingReader::freeAllChunks() {
     m_allocatedCachingReaderChunks.clear();
 }
 
-CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
+void CachingReader::adoptChunk(CachingReaderChunkForOwner* pChunk) {
+    DEBUG_ASSERT(pChunk);
+    DEBUG_ASSERT(pChunk->getState() == CachingReaderChunkForOwner::FREE);
+    VERIFY_OR_DEBUG_ASSERT(m_chunks.size() < m_maxChunks) {
+        // Never reallocate m_chunks in the engine callback. The worker
+        // respects the limit, so this should never happen.
+        kLogger.warning() << "Discarding chunk beyond the capacity of the cache";
+        return;
+    }
+    m_chunks.push_back(pChunk);
+    m_freeChunks.push_back(pChunk);
+}
+
+void CachingReader::releaseAdditionalChunks() {
+    freeAllChunks();
+    // The chunks of the initial pool come first and are kept. Chunks with
+    // pending reads are kept until the next eject.
+    int numChunks = m_numInitialChunks;
+    for (int i = m_numInitialChunks; i < m_chunks.size(); ++i) {
+        CachingReaderChunkForOwner* pChunk = m_chunks[i];
+        if (pChunk->getState() != CachingReaderChunkForOwner::FREE ||
+                m_releasedChunkFIFO.write(&pChunk, 1) != 1) {
+            m_chunks[numChunks++] = pChunk;
+        }
+    }
+    if (numChunks == m_chunks.size()) {
+        return;
+    }
+    // Shrinking does not reallocate the vector
+    m_chunks.resize(numChunks);
+    m_freeChunks.clear();
+    for (const auto& pChunk : qAsConst(m_chunks)) {
+        if (pChunk->getState() == CachingReaderChunkForOwner::FREE) {
+            m_freeChunks.push_back(pChunk);
+        }
+    }
+    m_worker.workReady();
+}
+
+CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex, int priority) {
     if (m_freeChunks.empty()) {
         return nullptr;
     }
     CachingReaderChunkForOwner* pChunk = m_freeChunks.front();
     m_freeChunks.pop_front();
 
-    pChunk->init(chunkIndex);
+    pChunk->init(chunkIndex, priority, m_numCallbacks);
 
     m_allocatedCachingReaderChunks.insert(chunkIndex, pChunk);
 
     return pChunk;
 }
 
-CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkIndex) {
-    auto* pChunk = allocateChunk(chunkIndex);
+CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(
+        SINT chunkIndex, int priority) {
+    auto* pChunk = allocateChunk(chunkIndex, priority);
     if (!pChunk) {
+        if (m_chunks.size() < m_maxChunks) {
+            // The pool is too small for the current access pattern. The
+            // worker is woken up by the caller.
+            m_worker.requestMoreChunks();
+        }
         if (m_lruCachingReaderChunk) {
+            if (priority >= Hint::kPriorityPrefetch &&
+                    m_lruCachingReaderChunk->getPriority(m_numCallbacks) < priority) {
+                // Prefetching must not replace chunks that are more likely
+                // to be read, e.g. the chunks around the play position. All
+                // other chunks have been used even more recently.
+                return nullptr;
+            }
             freeChunk(m_lruCachingReaderChunk);
-            pChunk = allocateChunk(chunkIndex);
+            ++m_cacheEvictions;
+            pChunk = allocateChunk(chunkIndex, priority);
         } else {
             kLogger.warning() << "No cached LRU chunk available for freeing";
         }
@@ -199,6 +377,7 @@ CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex
     auto* pChunk = lookupChunk(chunkIndex);
     if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
         freshenChunk(pChunk);
+        pChunk->raisePriority(Hint::kPriorityImmediate, m_numCallbacks);
     }
     return pChunk;
 }
@@ -219,12 +398,41 @@ void CachingReader::newTrack(TrackPointer pTrack) {
         kLogger.warning()
                 << "Loading a new track while loading a track may lead to inconsistent states";
     }
-    m_worker.newTrack(std::move(pTrack));
+    m_worker.newTrack(std::move(pTrack),
+            configuredPreloadOptions(m_pConfig, m_group));
+}
+
+void CachingReader::retirePreload(CachingReaderPreload* pPreload) {
+    if (!pPreload) {
+        return;
+    }
+    VERIFY_OR_DEBUG_ASSERT(m_retiredPreloadFIFO.write(&pPreload, 1) == 1) {
+        // Leaking the memory is preferable to freeing it in the callback
+        kLogger.warning() << "Failed to retire preload buffer";
+        return;
+    }
+    m_worker.workReady();
 }
 
 void CachingReader::process() {
     ReaderStatusUpdate update;
     while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
+        if (update.status == CHUNK_ALLOCATED) {
+            // New chunks are independent of the track
+            adoptChunk(update.takeAllocatedChunk());
+            continue;
+        }
+        if (update.status == PRELOAD_STARTED) {
+            // The buffer is outdated if the next track is already loading
+            auto* pPreload = update.takePreload();
+            if (atomicLoadAcquire(m_state) == STATE_TRACK_LOADED) {
+                retirePreload(m_pPreload);
+                m_pPreload = pPreload;
+            } else {
+                retirePreload(pPreload);
+            }
+            continue;
+        }
         auto* pChunk = update.takeFromWorker();
         if (pChunk) {
             // Result of a read request (with a chunk)
@@ -272,11 +480,18 @@ void CachingReader::process() {
                     DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_LOADING);
                     freeAllChunks();
                 }
+                retirePreload(m_pPreload);
+                m_pPreload = nullptr;
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
                 m_state.storeRelease(STATE_TRACK_LOADED);
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
+                retirePreload(m_pPreload);
+                m_pPreload = nullptr;
+                // Hand the chunks that the pool has grown by back to the
+                // worker, which frees their memory.
+                releaseAdditionalChunks();
                 // This message could be processed later when a new
                 // track is already loading! In this case the TRACK_LOADED will
                 // be the very next status update.
@@ -338,6 +553,17 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                     CachingReaderChunk::samples2frames(numSamples));
     DEBUG_ASSERT(!remainingFrameIndexRange.empty());
 
+    // Bypass the chunks if the frames have already been preloaded
+    if (m_pPreload) {
+        const auto preloadedFrameIndexRange = intersect(
+                m_pPreload->decodedFrameIndexRange(),
+                m_readableFrameIndexRange);
+        if (remainingFrameIndexRange.isSubrangeOf(preloadedFrameIndexRange)) {
+            m_pPreload->readSampleFrames(buffer, remainingFrameIndexRange, reverse);
+            return ReadResult::AVAILABLE;
+        }
+    }
+
     auto result = ReadResult::AVAILABLE;
     if (!intersect(remainingFrameIndexRange, m_readableFrameIndexRange).empty()) {
         // Fill the buffer up to the first readable sample with
@@ -422,6 +648,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                 mixxx::IndexRange bufferedFrameIndexRange;
                 const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
                 if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                    ++m_cacheHits;
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -439,6 +666,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                     // pending.
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
+                    ++m_cacheMisses;
                     Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
@@ -505,85 +733,144 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
     return result;
 }
 
+void CachingReader::updateCacheControls() {
+    // Only update the controls on changes to avoid needless signals
+    if (m_pCacheHitsControl->get() != m_cacheHits) {
+        m_pCacheHitsControl->forceSet(m_cacheHits);
+    }
+    if (m_pCacheMissesControl->get() != m_cacheMisses) {
+        m_pCacheMissesControl->forceSet(m_cacheMisses);
+    }
+    if (m_pCacheEvictionsControl->get() != m_cacheEvictions) {
+        m_pCacheEvictionsControl->forceSet(m_cacheEvictions);
+    }
+    if (m_pCacheChunksControl->get() != m_chunks.size()) {
+        m_pCacheChunksControl->forceSet(m_chunks.size());
+    }
+    const double preloadProgress = m_pPreload ? m_pPreload->progress() : 0.0;
+    if (m_pPreloadProgressControl->get() != preloadProgress) {
+        m_pPreloadProgressControl->forceSet(preloadProgress);
+    }
+}
+
 void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
+    // Called once per callback. The priorities of chunks that are neither
+    // hinted nor read in this and the next callback decay.
+    ++m_numCallbacks;
+    updateCacheControls();
+
     // If no file is loaded, skip.
     if (atomicLoadRelaxed(m_state) != STATE_TRACK_LOADED) {
         return;
     }
 
     // For every chunk that the hints indicated, check if it is in the cache. If
-    // any are not, then wake.
+    // any are not, then wake. The prefetch hints are handled last, so they
+    // only get the chunks that are left over.
     bool shouldWake = false;
-
-    for (const auto& hint: hintList) {
-        SINT hintFrame = hint.frame;
-        SINT hintFrameCount = hint.frameCount;
-
-        // Handle some special length values
-        if (hintFrameCount == Hint::kFrameCountForward) {
-        	hintFrameCount = kDefaultHintFrames;
-        } else if (hintFrameCount == Hint::kFrameCountBackward) {
-        	hintFrame -= kDefaultHintFrames;
-        	hintFrameCount = kDefaultHintFrames;
-            if (hintFrame < 0) {
-            	hintFrameCount += hintFrame;
-                hintFrame = 0;
-            }
+    for (const auto& hint : hintList) {
+        if (hint.priority < Hint::kPriorityPrefetch) {
+            shouldWake |= hintChunks(hint, &m_chunkReadRequestFIFO);
         }
-
-        VERIFY_OR_DEBUG_ASSERT(hintFrameCount >= 0) {
-            kLogger.warning() << "CachingReader: Ignoring negative hint length.";
-            continue;
+    }
+    for (const auto& hint : hintList) {
+        if (hint.priority >= Hint::kPriorityPrefetch) {
+            shouldWake |= hintChunks(hint, &m_prefetchRequestFIFO);
         }
+    }
 
-        const auto readableFrameIndexRange = intersect(
-                m_readableFrameIndexRange,
-                mixxx::IndexRange::forward(hintFrame, hintFrameCount));
-        if (readableFrameIndexRange.empty()) {
-            continue;
+    // If there are chunks to be read, wake up.
+    if (shouldWake) {
+        m_worker.workReady();
+    }
+}
+
+bool CachingReader::hintChunks(const Hint& hint,
+        FIFO<CachingReaderChunkReadRequest>* pRequestFIFO) {
+    SINT hintFrame = hint.frame;
+    SINT hintFrameCount = hint.frameCount;
+
+    // Handle some special length values
+    if (hintFrameCount == Hint::kFrameCountForward) {
+    	hintFrameCount = kDefaultHintFrames;
+    } else if (hintFrameCount == Hint::kFrameCountBackward) {
+    	hintFrame -= kDefaultHintFrames;
+    	hintFrameCount = kDefaultHintFrames;
+        if (hintFrame < 0) {
+        	hintFrameCount += hintFrame;
+            hintFrame = 0;
         }
+    }
+
+    VERIFY_OR_DEBUG_ASSERT(hintFrameCount >= 0) {
+        kLogger.warning() << "CachingReader: Ignoring negative hint length.";
+        return false;
+    }
 
-        const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
-        const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
-        for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
-            CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
+    const auto readableFrameIndexRange = intersect(
+            m_readableFrameIndexRange,
+            mixxx::IndexRange::forward(hintFrame, hintFrameCount));
+    if (readableFrameIndexRange.empty()) {
+        return false;
+    }
+    if (m_pPreload &&
+            readableFrameIndexRange.isSubrangeOf(
+                    m_pPreload->decodedFrameIndexRange())) {
+        // No need to read chunks of preloaded frames
+        return false;
+    }
+
+    const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
+    const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
+    bool shouldWake = false;
+    for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
+        CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
+        if (!pChunk) {
+            if (pRequestFIFO->writeAvailable() <= 0) {
+                // Don't evict a chunk for a request that cannot be submitted.
+                // A full prefetch FIFO is expected and the remaining chunks
+                // will be requested by one of the next callbacks.
+                if (hint.priority < Hint::kPriorityPrefetch) {
+                    kLogger.warning()
+                            << "Failed to submit read request for chunk"
+                            << chunkIndex;
+                }
+                return true;
+            }
+            shouldWake = true;
+            pChunk = allocateChunkExpireLRU(chunkIndex, hint.priority);
             if (!pChunk) {
-                shouldWake = true;
-                pChunk = allocateChunkExpireLRU(chunkIndex);
-                if (!pChunk) {
+                if (hint.priority < Hint::kPriorityPrefetch) {
                     kLogger.warning()
                             << "Failed to allocate chunk"
                             << chunkIndex
                             << "for read request";
-                    continue;
-                }
-                // Do not insert the allocated chunk into the MRU/LRU list,
-                // because it will be handed over to the worker immediately
-                CachingReaderChunkReadRequest request;
-                request.giveToWorker(pChunk);
-                if (kLogger.traceEnabled()) {
-                    kLogger.trace()
-                            << "Requesting read of chunk"
-                            << request.chunk;
-                }
-                if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
-                    kLogger.warning()
-                            << "Failed to submit read request for chunk"
-                            << chunkIndex;
-                    // Revoke the chunk from the worker and free it
-                    pChunk->takeFromWorker();
-                    freeChunk(pChunk);
                 }
-            } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
-                // This will cause the chunk to be 'freshened' in the cache. The
-                // chunk will be moved to the end of the LRU list.
-                freshenChunk(pChunk);
+                continue;
+            }
+            // Do not insert the allocated chunk into the MRU/LRU list,
+            // because it will be handed over to the worker immediately
+            CachingReaderChunkReadRequest request;
+            request.giveToWorker(pChunk);
+            if (kLogger.traceEnabled()) {
+                kLogger.trace()
+                        << "Requesting read of chunk"
+                        << request.chunk;
+            }
+            if (pRequestFIFO->write(&request, 1) != 1) {
+                kLogger.warning()
+                        << "Failed to submit read request for chunk"
+                        << chunkIndex;
+                // Revoke the chunk from the worker and free it
+                pChunk->takeFromWorker();
+                freeChunk(pChunk);
             }
+        } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
+            // This will cause the chunk to be 'freshened' in the cache. The
+            // chunk will be moved to the end of the LRU list.
+            freshenChunk(pChunk);
+            pChunk->raisePriority(hint.priority, m_numCallbacks);
         }
     }
-
-    // If there are chunks to be read, wake up.
-    if (shouldWake) {
-        m_worker.workReady();
-    }
+    return shouldWake;
 }
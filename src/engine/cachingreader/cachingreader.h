@@ -6,6 +6,7 @@
 #include <QVarLengthArray>
 #include <QVector>
 #include <list>
+#include <memory>
 
 #include "engine/cachingreader/cachingreaderworker.h"
 #include "engine/engineworker.h"
@@ -14,6 +15,8 @@
 #include "util/fifo.h"
 #include "util/types.h"
 
+class ControlObject;
+
 // A Hint is an indication to the CachingReader that a certain section of a
 // SoundSource will be used 'soon' and so it should be brought into memory by
 // the reader work thread.
@@ -23,17 +26,25 @@ typedef struct Hint {
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
-    // used for samples that will be read imminently. Hints for samples that
-    // have the potential to be read (i.e. a cue point) should be issued with
-    // priority >10.
+    // Hints are serviced in the order of their priority. A priority of 1 is
+    // the highest priority and should be used for samples that will be read
+    // imminently. Hints for samples that have the potential to be read (i.e.
+    // a cue point) should be issued with kPriorityPrefetch or higher. Those
+    // are only prefetched when this neither delays nor evicts the chunks of
+    // more important hints.
     int priority;
 
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
 
+    // The samples at the play position
+    static constexpr int kPriorityImmediate = 1;
+    // The samples that will be read soon, e.g. the start of an active loop
+    static constexpr int kPriorityHigh = 2;
+    // The samples that might be read, e.g. at cue points
+    static constexpr int kPriorityPrefetch = 10;
+
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -66,14 +77,35 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // read or hinted via hintAndMaybeWake) then it is moved to the back of the
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
-// allocateChunkExpireLRU).
+// allocateChunkExpireLRU). Prefetching never evicts a chunk that has been
+// requested or read with a higher priority in the current or the previous
+// callback. Chunks that have left the play window lose their priority.
+//
+// Hints with a priority below Hint::kPriorityPrefetch are requested through
+// a separate FIFO that the worker always services first. Speculative hints
+// can neither fill up the FIFO nor delay the imminent reads.
+//
+// The initial number of chunks is configurable per deck. Whenever a chunk
+// needs to be evicted the worker is asked to grow the pool, which it does
+// up to the maximum of the role of the reader and as long as the global
+// memory budget shared by all readers permits (see CachingReaderChunkBudget).
+// The pool shrinks back to its initial size when the track is ejected.
 class CachingReader : public QObject {
     Q_OBJECT
 
   public:
+    // Determines how far the pool of chunks may grow
+    enum class Role {
+        // Decks may need to cache a whole track
+        Deck,
+        // Samplers and preview decks
+        Sampler,
+    };
+
     // Construct a CachingReader with the given group.
     CachingReader(const QString& group,
-            UserSettingsPointer _config);
+            UserSettingsPointer _config,
+            Role role);
     ~CachingReader() override;
 
     void process();
@@ -115,12 +147,23 @@ class CachingReader : public QObject {
     void trackLoadFailed(TrackPointer pTrack, const QString& reason);
 
   private:
+    const QString m_group;
     const UserSettingsPointer m_pConfig;
 
+    // The number of chunks that are allocated up front and the maximum
+    // number of chunks the pool may grow to.
+    const SINT m_numInitialChunks;
+    const SINT m_maxChunks;
+
     // Thread-safe FIFOs for communication between the engine callback and
     // reader thread.
     FIFO<CachingReaderChunkReadRequest> m_chunkReadRequestFIFO;
+    FIFO<CachingReaderChunkReadRequest> m_prefetchRequestFIFO;
     FIFO<ReaderStatusUpdate> m_readerStatusUpdateFIFO;
+    // Preload buffers that are returned to the worker for deletion
+    FIFO<CachingReaderPreload*> m_retiredPreloadFIFO;
+    // Additional chunks that are returned to the worker for deletion
+    FIFO<CachingReaderChunkForOwner*> m_releasedChunkFIFO;
 
     // Looks for the provided chunk number in the index of in-memory chunks and
     // returns it if it is present. If not, returns nullptr. If it is present then
@@ -141,11 +184,31 @@ class CachingReader : public QObject {
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
+    // Adds a chunk that has been allocated by the worker to the free list
+    void adoptChunk(CachingReaderChunkForOwner* pChunk);
+
+    // Frees all chunks and returns the chunks beyond the initial pool to
+    // the worker
+    void releaseAdditionalChunks();
+
+    // Publishes the cache statistics to the controls
+    void updateCacheControls();
+
+    // Hands the buffer over to the worker that deletes it. Memory must
+    // not be freed in the engine callback.
+    void retirePreload(CachingReaderPreload* pPreload);
+
     // Gets a chunk from the free list. Returns nullptr if none available.
-    CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
+    CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex, int priority);
 
-    // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
-    CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
+    // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none
+    // available and if it has not been used with a higher priority.
+    CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex, int priority);
+
+    // Requests all missing chunks of the hint through the given FIFO and
+    // returns true if the worker needs to be woken up.
+    bool hintChunks(const Hint& hint,
+            FIFO<CachingReaderChunkReadRequest>* pRequestFIFO);
 
     enum State {
         STATE_IDLE,
@@ -155,7 +218,8 @@ class CachingReader : public QObject {
     };
     QAtomicInt m_state;
 
-    // Keeps track of all CachingReaderChunks we've allocated.
+    // Keeps track of all CachingReaderChunks we've allocated. The capacity
+    // is reserved up front for the maximum number of chunks.
     QVector<CachingReaderChunkForOwner*> m_chunks;
 
     // List of free chunks. Linked list so that we have constant time insertions
@@ -170,11 +234,28 @@ class CachingReader : public QObject {
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
+    // Counts the callbacks for the decay of chunk priorities
+    quint32 m_numCallbacks;
+
     // The raw memory buffer which is divided up into chunks.
     mixxx::SampleBuffer m_sampleBuffer;
 
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // Cache statistics, only touched from the engine callback
+    qint64 m_cacheHits;
+    qint64 m_cacheMisses;
+    qint64 m_cacheEvictions;
+    std::unique_ptr<ControlObject> m_pCacheHitsControl;
+    std::unique_ptr<ControlObject> m_pCacheMissesControl;
+    std::unique_ptr<ControlObject> m_pCacheEvictionsControl;
+    std::unique_ptr<ControlObject> m_pCacheChunksControl;
+
+    // The preloaded track if enabled. Frames that have already been decoded
+    // are read from this buffer instead of the chunks.
+    CachingReaderPreload* m_pPreload;
+    std::unique_ptr<ControlObject> m_pPreloadProgressControl;
+
     CachingReaderWorker m_worker;
 };
@@ -1,7 +1,9 @@
 #include "engine/cachingreader/cachingreaderchunk.h"
 
 #include <QtDebug>
+#include <atomic>
 
+#include "engine/cachingreader/cachingreaderdiskcache.h"
 #include "sources/audiosourcestereoproxy.h"
 #include "engine/engine.h"
 #include "util/math.h"
@@ -79,6 +81,26 @@ mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
     return m_bufferedSampleFrames.frameIndexRange();
 }
 
+mixxx::IndexRange CachingReaderChunk::loadSampleFrames(
+        CachingReaderDiskCache* pDiskCache,
+        const QString& trackKey) {
+    DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+    const auto frameIndexRange = pDiskCache->load(trackKey, m_index, m_sampleBuffer);
+    m_bufferedSampleFrames = mixxx::ReadableSampleFrames(
+            frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice(
+                    m_sampleBuffer.data(),
+                    frames2samples(frameIndexRange.length())));
+    return frameIndexRange;
+}
+
+void CachingReaderChunk::storeSampleFrames(
+        CachingReaderDiskCache* pDiskCache,
+        const QString& trackKey) const {
+    DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+    pDiskCache->storeInBackground(trackKey, m_index, m_bufferedSampleFrames);
+}
+
 mixxx::IndexRange CachingReaderChunk::readBufferedSampleFrames(
         CSAMPLE* sampleBuffer,
         const mixxx::IndexRange& frameIndexRange) const {
@@ -123,11 +145,14 @@ CachingReaderChunkForOwner::CachingReaderChunkForOwner(
         mixxx::SampleBuffer::WritableSlice sampleBuffer)
         : CachingReaderChunk(std::move(sampleBuffer)),
           m_state(FREE),
+          m_priority(kNoPriority),
+          m_previousPriority(kNoPriority),
+          m_priorityCallback(0),
           m_pPrev(nullptr),
           m_pNext(nullptr) {
 }
 
-void CachingReaderChunkForOwner::init(SINT index) {
+void CachingReaderChunkForOwner::init(SINT index, int priority, quint32 callback) {
     // Must not be accessed by a worker!
     DEBUG_ASSERT(m_state != READ_PENDING);
     // Must not be referenced in MRU/LRU list!
@@ -136,6 +161,9 @@ void CachingReaderChunkForOwner::init(SINT index) {
 
     CachingReaderChunk::init(index);
     m_state = READY;
+    m_priority = priority;
+    m_previousPriority = kNoPriority;
+    m_priorityCallback = callback;
 }
 
 void CachingReaderChunkForOwner::free() {
@@ -248,3 +276,58 @@ void CachingReaderChunkForOwner::removeFromList(
         }
     }
 }
+
+namespace {
+
+std::atomic<SINT> s_limitBytes(CachingReaderChunkBudget::kDefaultLimitBytes);
+std::atomic<SINT> s_allocatedBytes(0);
+
+} // anonymous namespace
+
+// static
+void CachingReaderChunkBudget::setLimitBytes(SINT limitBytes) {
+    DEBUG_ASSERT(limitBytes >= 0);
+    s_limitBytes.store(limitBytes, std::memory_order_relaxed);
+}
+
+// static
+SINT CachingReaderChunkBudget::limitBytes() {
+    return s_limitBytes.load(std::memory_order_relaxed);
+}
+
+// static
+SINT CachingReaderChunkBudget::allocatedBytes() {
+    return s_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+// static
+void CachingReaderChunkBudget::reserveUnlimited(SINT numChunks) {
+    DEBUG_ASSERT(numChunks >= 0);
+    s_allocatedBytes.fetch_add(numChunks * bytesPerChunk(), std::memory_order_relaxed);
+}
+
+// static
+SINT CachingReaderChunkBudget::tryReserve(SINT numChunks) {
+    DEBUG_ASSERT(numChunks >= 0);
+    SINT allocated = s_allocatedBytes.load(std::memory_order_relaxed);
+    SINT reserved;
+    do {
+        const SINT available = limitBytes() - allocated;
+        reserved = math_clamp(available / bytesPerChunk(), SINT(0), numChunks);
+        if (reserved == 0) {
+            return 0;
+        }
+    } while (!s_allocatedBytes.compare_exchange_weak(allocated,
+            allocated + reserved * bytesPerChunk(),
+            std::memory_order_relaxed));
+    return reserved;
+}
+
+// static
+void CachingReaderChunkBudget::release(SINT numChunks) {
+    DEBUG_ASSERT(numChunks >= 0);
+    const SINT allocated = s_allocatedBytes.fetch_sub(
+            numChunks * bytesPerChunk(), std::memory_order_relaxed);
+    Q_UNUSED(allocated); // only used in DEBUG_ASSERT
+    DEBUG_ASSERT(allocated >= numChunks * bytesPerChunk());
+}
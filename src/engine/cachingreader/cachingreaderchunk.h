@@ -1,6 +1,11 @@
 #pragma once
 
+#include <limits>
+
 #include "sources/audiosource.h"
+#include "util/math.h"
+
+class CachingReaderDiskCache;
 
 // A Chunk is a memory-resident section of audio that has been cached.
 // Each chunk holds a fixed number kFrames of frames with samples for
@@ -56,6 +61,17 @@ public:
             const mixxx::AudioSourcePointer& pAudioSource,
             mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
 
+    // Restore the sample frames from the disk cache instead of decoding
+    // them and return the range of frames that have been restored.
+    mixxx::IndexRange loadSampleFrames(
+            CachingReaderDiskCache* pDiskCache,
+            const QString& trackKey);
+    // Store a copy of the buffered sample frames in the disk cache. The
+    // file is written in the background.
+    void storeSampleFrames(
+            CachingReaderDiskCache* pDiskCache,
+            const QString& trackKey) const;
+
     mixxx::IndexRange readBufferedSampleFrames(
             CSAMPLE* sampleBuffer,
             const mixxx::IndexRange& frameIndexRange) const;
@@ -92,7 +108,7 @@ public:
             mixxx::SampleBuffer::WritableSlice sampleBuffer);
     ~CachingReaderChunkForOwner() override = default;
 
-    void init(SINT index);
+    void init(SINT index, int priority, quint32 callback);
     void free();
 
     enum State {
@@ -105,6 +121,34 @@ public:
         return m_state;
     }
 
+    // The priority of chunks that have not been hinted or read recently
+    static constexpr int kNoPriority = std::numeric_limits<int>::max();
+
+    // The highest priority (i.e. lowest number) of the hints and reads
+    // for this chunk in the given and in the preceding callback. The
+    // priority decays to kNoPriority when the chunk is neither hinted nor
+    // read anymore, e.g. after it has left the play window. See
+    // Hint::priority.
+    int getPriority(quint32 callback) const {
+        if (callback == m_priorityCallback) {
+            return math_min(m_priority, m_previousPriority);
+        }
+        if (callback == m_priorityCallback + 1) {
+            return m_priority;
+        }
+        return kNoPriority;
+    }
+    void raisePriority(int priority, quint32 callback) {
+        if (callback != m_priorityCallback) {
+            m_previousPriority = (callback == m_priorityCallback + 1)
+                    ? m_priority
+                    : kNoPriority;
+            m_priority = kNoPriority;
+            m_priorityCallback = callback;
+        }
+        m_priority = math_min(m_priority, priority);
+    }
+
     // The state is controlled by the cache as the owner of each chunk!
     void giveToWorker() {
         // Must not be referenced in MRU/LRU list!
@@ -137,7 +181,42 @@ public:
 
 private:
     State m_state;
+    // The priorities of the callback m_priorityCallback and the one before
+    int m_priority;
+    int m_previousPriority;
+    quint32 m_priorityCallback;
 
     CachingReaderChunkForOwner* m_pPrev; // previous item in double-linked list
     CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
 };
+
+// Accounts the memory of the chunks of all CachingReaders against a single
+// global budget. The initial chunks of each reader are always granted, but
+// the pools only grow on demand while the budget is not exhausted.
+//
+// All functions are thread-safe and lock-free.
+class CachingReaderChunkBudget {
+  public:
+    // 512 MB or ~8000 chunks for all decks and samplers
+    static constexpr SINT kDefaultLimitBytes = SINT(512) * 1024 * 1024;
+
+    static SINT bytesPerChunk() {
+        return CachingReaderChunk::kSamples * sizeof(CSAMPLE);
+    }
+
+    static void setLimitBytes(SINT limitBytes);
+    static SINT limitBytes();
+    static SINT allocatedBytes();
+
+    // The number of chunks that fit into the budget
+    static SINT limitChunks() {
+        return limitBytes() / bytesPerChunk();
+    }
+
+    // Accounts numChunks chunks regardless of the limit.
+    static void reserveUnlimited(SINT numChunks);
+    // Accounts up to numChunks chunks within the limit and returns
+    // the actual number of chunks that have been accounted.
+    static SINT tryReserve(SINT numChunks);
+    static void release(SINT numChunks);
+};
@@ -0,0 +1,423 @@
+#include "engine/cachingreader/cachingreaderdiskcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QVector>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "track/track.h"
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CachingReaderDiskCache");
+
+const int kDefaultMaxSizeMB = 2048;
+
+const QString kFileSuffix = QStringLiteral(".chunk");
+const QString kTempFileSuffix = QStringLiteral(".tmp");
+
+// 4 MB of samples
+const int kMaxPendingStores = 64;
+
+// Decoding of these formats is fast enough
+const QStringList kUncompressedFileSuffixes = {
+        QStringLiteral("wav"),
+        QStringLiteral("aif"),
+        QStringLiteral("aiff"),
+};
+
+// Files are only read on the same machine, so the header is stored
+// in native byte order. The magic number detects a mismatch. The
+// checksum covers the header, the track key and the samples.
+struct ChunkFileHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 chunkIndex;
+    qint64 frameIndexStart;
+    qint64 frameIndexEnd;
+    qint64 sampleCount;
+    quint64 checksum;
+};
+
+const quint32 kChunkFileMagic = 0x4d584343; // "MXCC"
+const quint32 kChunkFileVersion = 2;
+
+// FNV-1a
+const quint64 kChecksumOffsetBasis = 14695981039346656037ULL;
+const quint64 kChecksumPrime = 1099511628211ULL;
+
+quint64 addToChecksum(quint64 hash, const void* pData, size_t size) {
+    const auto* pBytes = static_cast<const uchar*>(pData);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= pBytes[i];
+        hash *= kChecksumPrime;
+    }
+    return hash;
+}
+
+// The samples are hashed by their bit patterns, i.e. 4 bytes at once
+quint64 addSamplesToChecksum(quint64 hash, const CSAMPLE* pSamples, SINT sampleCount) {
+    static_assert(sizeof(CSAMPLE) == sizeof(quint32),
+            "unexpected sample size");
+    for (SINT i = 0; i < sampleCount; ++i) {
+        quint32 bits;
+        std::memcpy(&bits, &pSamples[i], sizeof(bits));
+        hash ^= bits;
+        hash *= kChecksumPrime;
+    }
+    return hash;
+}
+
+quint64 checksum(
+        ChunkFileHeader header,
+        const QString& trackKey,
+        const CSAMPLE* pSamples) {
+    header.checksum = 0;
+    quint64 hash = addToChecksum(kChecksumOffsetBasis, &header, sizeof(header));
+    const QByteArray trackKeyBytes = trackKey.toUtf8();
+    hash = addToChecksum(hash, trackKeyBytes.constData(), trackKeyBytes.size());
+    return addSamplesToChecksum(hash, pSamples, header.sampleCount);
+}
+
+bool isValidHeader(
+        const ChunkFileHeader& header,
+        SINT chunkIndex,
+        SINT maxSampleCount,
+        qint64 fileSize) {
+    return header.magic == kChunkFileMagic &&
+            header.version == kChunkFileVersion &&
+            header.chunkIndex == chunkIndex &&
+            header.frameIndexStart <= header.frameIndexEnd &&
+            // Chunks are stored with all their channels
+            header.sampleCount ==
+            CachingReaderChunk::frames2samples(
+                    header.frameIndexEnd - header.frameIndexStart) &&
+            header.sampleCount <= maxSampleCount &&
+            fileSize == static_cast<qint64>(sizeof(header) +
+                                header.sampleCount * sizeof(CSAMPLE));
+}
+
+} // anonymous namespace
+
+CachingReaderDiskCache::CachingReaderDiskCache(
+        const QString& directory, qint64 maxBytes)
+        : m_directory(directory),
+          m_maxBytes(maxBytes),
+          m_numPendingStores(0),
+          m_scanned(false),
+          m_sizeBytes(0) {
+    m_writerThreadPool.setMaxThreadCount(1);
+}
+
+CachingReaderDiskCache::~CachingReaderDiskCache() {
+    waitForPendingStores();
+}
+
+// static
+std::shared_ptr<CachingReaderDiskCache> CachingReaderDiskCache::open(
+        const UserSettingsPointer& pConfig) {
+    if (!pConfig ||
+            !pConfig->getValue(ConfigKey("[Master]", "chunk_disk_cache"), false)) {
+        return nullptr;
+    }
+    static QMutex s_instanceMutex;
+    static std::weak_ptr<CachingReaderDiskCache> s_pInstance;
+    QMutexLocker locker(&s_instanceMutex);
+    auto pInstance = s_pInstance.lock();
+    if (!pInstance) {
+        const int maxSizeMB = pConfig->getValue(
+                ConfigKey("[Master]", "chunk_disk_cache_mb"),
+                kDefaultMaxSizeMB);
+        pInstance = std::make_shared<CachingReaderDiskCache>(
+                QDir(pConfig->getSettingsPath()).filePath("chunkcache"),
+                qint64(std::max(maxSizeMB, 0)) * 1024 * 1024);
+        s_pInstance = pInstance;
+    }
+    return pInstance;
+}
+
+// static
+QString CachingReaderDiskCache::trackKey(
+        const TrackPointer& pTrack,
+        const mixxx::AudioSourcePointer& pAudioSource) {
+    if (!pTrack || !pAudioSource) {
+        return QString();
+    }
+    const QFileInfo fileInfo(pTrack->getLocation());
+    if (kUncompressedFileSuffixes.contains(fileInfo.suffix().toLower())) {
+        return QString();
+    }
+    // The decoded samples change when the file is modified or if
+    // a different decoder is used
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileInfo.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.size()));
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(pAudioSource->getSignalInfo().getSampleRate().value()));
+    hash.addData(QByteArray::number(static_cast<qint64>(pAudioSource->frameIndexRange().start())));
+    hash.addData(QByteArray::number(static_cast<qint64>(pAudioSource->frameIndexRange().end())));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// static
+QString CachingReaderDiskCache::fileName(const QString& trackKey, SINT chunkIndex) {
+    return trackKey + QChar('/') + QString::number(chunkIndex) + kFileSuffix;
+}
+
+qint64 CachingReaderDiskCache::sizeBytes() const {
+    QMutexLocker locker(&m_mutex);
+    return m_sizeBytes;
+}
+
+mixxx::IndexRange CachingReaderDiskCache::load(
+        const QString& trackKey,
+        SINT chunkIndex,
+        mixxx::SampleBuffer::WritableSlice buffer) {
+    DEBUG_ASSERT(!trackKey.isEmpty());
+    const QString name = fileName(trackKey, chunkIndex);
+    {
+        QMutexLocker locker(&m_mutex);
+        scanDirectory();
+        if (!m_entriesByFileName.contains(name)) {
+            return mixxx::IndexRange();
+        }
+        touchEntry(name);
+    }
+
+    QFile file(QDir(m_directory).filePath(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        // The file might have been evicted in the meantime
+        return mixxx::IndexRange();
+    }
+    const qint64 fileSize = file.size();
+    const uchar* pData = nullptr;
+    if (fileSize >= static_cast<qint64>(sizeof(ChunkFileHeader))) {
+        pData = file.map(0, fileSize);
+    }
+    mixxx::IndexRange frameIndexRange;
+    if (pData) {
+        ChunkFileHeader header;
+        std::memcpy(&header, pData, sizeof(header));
+        const auto* pSamples = reinterpret_cast<const CSAMPLE*>(pData + sizeof(header));
+        // The header is validated before the samples are touched
+        if (isValidHeader(header, chunkIndex, buffer.length(), fileSize) &&
+                header.checksum == checksum(header, trackKey, pSamples)) {
+            std::memcpy(buffer.data(), pSamples, header.sampleCount * sizeof(CSAMPLE));
+            frameIndexRange = mixxx::IndexRange::between(
+                    header.frameIndexStart, header.frameIndexEnd);
+        }
+        file.unmap(const_cast<uchar*>(pData));
+    }
+    if (frameIndexRange.empty()) {
+        kLogger.warning()
+                << "Discarding corrupt file"
+                << file.fileName();
+        file.close();
+        file.remove();
+        QMutexLocker locker(&m_mutex);
+        removeEntry(name);
+        return mixxx::IndexRange();
+    }
+    // Preserve the order of recently used files across restarts
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return frameIndexRange;
+}
+
+bool CachingReaderDiskCache::store(
+        const QString& trackKey,
+        SINT chunkIndex,
+        const mixxx::ReadableSampleFrames& sampleFrames) {
+    DEBUG_ASSERT(!trackKey.isEmpty());
+    if (sampleFrames.frameIndexRange().empty() || m_maxBytes <= 0) {
+        return false;
+    }
+    const SINT sampleCount = sampleFrames.readableLength();
+    ChunkFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kChunkFileMagic;
+    header.version = kChunkFileVersion;
+    header.chunkIndex = chunkIndex;
+    header.frameIndexStart = sampleFrames.frameIndexRange().start();
+    header.frameIndexEnd = sampleFrames.frameIndexRange().end();
+    header.sampleCount = sampleCount;
+    header.checksum = checksum(header, trackKey, sampleFrames.readableData());
+
+    const QString name = fileName(trackKey, chunkIndex);
+    const QDir dir(m_directory);
+    if (!dir.mkpath(trackKey)) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << dir.filePath(trackKey);
+        return false;
+    }
+    // The file is written under a temporary name and renamed, so that
+    // readers never see an incomplete file. It is not synced to disk,
+    // because it is only a cache. Torn files fail the checksum.
+    const QString filePath = dir.filePath(name);
+    QFile file(filePath + kTempFileSuffix);
+    const qint64 bytes = sizeof(header) + sampleCount * sizeof(CSAMPLE);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+                    static_cast<qint64>(sizeof(header)) ||
+            file.write(reinterpret_cast<const char*>(sampleFrames.readableData()),
+                    sampleCount * sizeof(CSAMPLE)) !=
+                    static_cast<qint64>(sampleCount * sizeof(CSAMPLE))) {
+        kLogger.warning()
+                << "Failed to write file"
+                << file.fileName()
+                << file.errorString();
+        file.remove();
+        return false;
+    }
+    file.close();
+    QFile::remove(filePath);
+    if (!file.rename(filePath)) {
+        kLogger.warning()
+                << "Failed to rename file"
+                << file.fileName()
+                << file.errorString();
+        file.remove();
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    scanDirectory();
+    removeEntry(name);
+    insertEntry(name, bytes);
+    evictEntries();
+    return true;
+}
+
+void CachingReaderDiskCache::storeInBackground(
+        const QString& trackKey,
+        SINT chunkIndex,
+        const mixxx::ReadableSampleFrames& sampleFrames) {
+    DEBUG_ASSERT(!trackKey.isEmpty());
+    if (sampleFrames.frameIndexRange().empty() || m_maxBytes <= 0) {
+        return;
+    }
+    if (m_numPendingStores.fetchAndAddAcquire(1) >= kMaxPendingStores) {
+        // The chunk will be stored when it is decoded again
+        m_numPendingStores.fetchAndAddRelease(-1);
+        return;
+    }
+    // The chunk is reused by the cache as soon as it has been returned,
+    // so the samples are copied
+    QVector<CSAMPLE> samples(sampleFrames.readableLength());
+    std::copy(sampleFrames.readableData(),
+            sampleFrames.readableData() + sampleFrames.readableLength(),
+            samples.begin());
+    const auto frameIndexRange = sampleFrames.frameIndexRange();
+    QtConcurrent::run(&m_writerThreadPool,
+            [this, trackKey, chunkIndex, frameIndexRange, samples] {
+                store(trackKey,
+                        chunkIndex,
+                        mixxx::ReadableSampleFrames(
+                                frameIndexRange,
+                                mixxx::SampleBuffer::ReadableSlice(
+                                        samples.constData(),
+                                        samples.size())));
+                m_numPendingStores.fetchAndAddRelease(-1);
+            });
+}
+
+void CachingReaderDiskCache::waitForPendingStores() {
+    m_writerThreadPool.waitForDone();
+}
+
+void CachingReaderDiskCache::scanDirectory() {
+    if (m_scanned) {
+        return;
+    }
+    m_scanned = true;
+
+    struct ScannedFile {
+        QString fileName;
+        qint64 bytes;
+        QDateTime lastModified;
+    };
+    std::vector<ScannedFile> files;
+    const QDir dir(m_directory);
+    QDirIterator it(m_directory,
+            QStringList{QChar('*') + kFileSuffix},
+            QDir::Files,
+            QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+        files.push_back(ScannedFile{
+                dir.relativeFilePath(fileInfo.filePath()),
+                fileInfo.size(),
+                fileInfo.lastModified()});
+    }
+    // Insert the most recently used file last
+    std::sort(files.begin(),
+            files.end(),
+            [](const ScannedFile& lhs, const ScannedFile& rhs) {
+                return lhs.lastModified < rhs.lastModified;
+            });
+    for (const auto& file : files) {
+        insertEntry(file.fileName, file.bytes);
+    }
+    kLogger.info()
+            << "Found"
+            << files.size()
+            << "files with"
+            << m_sizeBytes
+            << "bytes in"
+            << m_directory;
+    evictEntries();
+}
+
+void CachingReaderDiskCache::touchEntry(const QString& fileName) {
+    const auto it = m_entriesByFileName.find(fileName);
+    DEBUG_ASSERT(it != m_entriesByFileName.end());
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+}
+
+void CachingReaderDiskCache::insertEntry(const QString& fileName, qint64 bytes) {
+    DEBUG_ASSERT(!m_entriesByFileName.contains(fileName));
+    m_entries.push_front(Entry{fileName, bytes});
+    m_entriesByFileName.insert(fileName, m_entries.begin());
+    m_sizeBytes += bytes;
+}
+
+void CachingReaderDiskCache::removeEntry(const QString& fileName) {
+    const auto it = m_entriesByFileName.find(fileName);
+    if (it == m_entriesByFileName.end()) {
+        return;
+    }
+    m_sizeBytes -= it.value()->bytes;
+    m_entries.erase(it.value());
+    m_entriesByFileName.erase(it);
+}
+
+void CachingReaderDiskCache::evictEntries() {
+    const QDir dir(m_directory);
+    while (m_sizeBytes > m_maxBytes && !m_entries.empty()) {
+        const Entry& entry = m_entries.back();
+        const QString filePath = dir.filePath(entry.fileName);
+        if (!QFile::remove(filePath)) {
+            kLogger.warning()
+                    << "Failed to remove file"
+                    << filePath;
+        }
+        // Only succeeds if the last file of the track has been removed
+        dir.rmdir(QFileInfo(entry.fileName).path());
+        m_sizeBytes -= entry.bytes;
+        m_entriesByFileName.remove(entry.fileName);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <list>
+#include <memory>
+
+#include "preferences/usersettings.h"
+#include "sources/audiosource.h"
+#include "track/track_decl.h"
+#include "util/types.h"
+
+// A persistent cache of decoded chunks on disk that is shared by the workers
+// of all decks.
+//
+// Seeking in compressed files requires to decode from a preceding frame
+// boundary, which makes loading tracks and jumping to cue points slow. The
+// worker stores every decoded chunk of a compressed file and restores it
+// with a memory-mapped read when it is requested again, e.g. after reloading
+// the track.
+//
+// Each chunk is stored in a separate file together with a checksum of its
+// header and samples. Files are grouped in a directory per track. The directory name
+// is derived from the file identity of the track, i.e. its location, size
+// and modification time, and the signal of the decoded audio source. The
+// total size of all files is bounded. The least recently used files are
+// deleted if the limit is exceeded.
+//
+// The workers only hand over copies of the samples and a background thread
+// writes the files, so reading chunks never waits for the disk. The files
+// are not synced, a torn file fails the checksum and is discarded.
+//
+// All functions are thread-safe.
+class CachingReaderDiskCache {
+  public:
+    CachingReaderDiskCache(const QString& directory, qint64 maxBytes);
+    ~CachingReaderDiskCache();
+
+    // Returns the cache instance that is shared by all decks or nullptr
+    // if the cache is disabled.
+    static std::shared_ptr<CachingReaderDiskCache> open(
+            const UserSettingsPointer& pConfig);
+
+    // Returns the key for the decoded samples of the track or an empty
+    // string if the track should not be cached, e.g. because the file
+    // is not compressed.
+    static QString trackKey(
+            const TrackPointer& pTrack,
+            const mixxx::AudioSourcePointer& pAudioSource);
+
+    const QString& directory() const {
+        return m_directory;
+    }
+    qint64 maxBytes() const {
+        return m_maxBytes;
+    }
+    qint64 sizeBytes() const;
+
+    // Copies the cached samples of the chunk into the buffer and returns
+    // the range of the restored frames. The range is empty on a cache miss
+    // or if the file is corrupt.
+    mixxx::IndexRange load(
+            const QString& trackKey,
+            SINT chunkIndex,
+            mixxx::SampleBuffer::WritableSlice buffer);
+
+    // Stores the samples of the chunk.
+    bool store(
+            const QString& trackKey,
+            SINT chunkIndex,
+            const mixxx::ReadableSampleFrames& sampleFrames);
+    // Copies the samples of the chunk and stores them in the background.
+    // The chunk is skipped if too many stores are pending, e.g. because
+    // the disk is slow.
+    void storeInBackground(
+            const QString& trackKey,
+            SINT chunkIndex,
+            const mixxx::ReadableSampleFrames& sampleFrames);
+    // Blocks until all pending stores have been written
+    void waitForPendingStores();
+
+  private:
+    struct Entry {
+        QString fileName;
+        qint64 bytes;
+    };
+    typedef std::list<Entry> EntryList;
+
+    static QString fileName(const QString& trackKey, SINT chunkIndex);
+
+    // All private functions must be called with m_mutex locked
+    void scanDirectory();
+    void touchEntry(const QString& fileName);
+    void insertEntry(const QString& fileName, qint64 bytes);
+    void removeEntry(const QString& fileName);
+    void evictEntries();
+
+    const QString m_directory;
+    const qint64 m_maxBytes;
+
+    // A single thread writes all files
+    QThreadPool m_writerThreadPool;
+    QAtomicInt m_numPendingStores;
+
+    mutable QMutex m_mutex;
+    bool m_scanned;
+    // The most recently used entry is in front
+    EntryList m_entries;
+    QHash<QString, EntryList::iterator> m_entriesByFileName;
+    qint64 m_sizeBytes;
+};
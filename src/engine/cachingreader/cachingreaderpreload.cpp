@@ -0,0 +1,210 @@
+#include "engine/cachingreader/cachingreaderpreload.h"
+
+#include <QDir>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderPreload");
+
+} // anonymous namespace
+
+CachingReaderPreload::CachingReaderPreload(
+        const mixxx::IndexRange& frameIndexRange,
+        SampleFormat sampleFormat)
+        : m_frameIndexRange(frameIndexRange),
+          m_sampleFormat(sampleFormat),
+          m_pData(nullptr),
+          m_decodedFrames(0),
+          m_finished(false) {
+}
+
+CachingReaderPreload::~CachingReaderPreload() {
+    if (m_pMappedFile) {
+        m_pMappedFile->unmap(m_pData);
+    }
+}
+
+// static
+std::unique_ptr<CachingReaderPreload> CachingReaderPreload::allocate(
+        const mixxx::IndexRange& frameIndexRange,
+        const Options& options) {
+    DEBUG_ASSERT(frameIndexRange.start() <= frameIndexRange.end());
+    // The constructor is private
+    std::unique_ptr<CachingReaderPreload> pPreload(
+            new CachingReaderPreload(frameIndexRange, options.sampleFormat));
+    const qint64 bytes = static_cast<qint64>(
+            CachingReaderChunk::frames2samples(frameIndexRange.length())) *
+            pPreload->bytesPerSample();
+    if (options.memoryMapped) {
+        auto pFile = std::make_unique<QTemporaryFile>(
+                QDir::temp().filePath(QStringLiteral("mixxx-preload-XXXXXX")));
+        if (!pFile->open() || !pFile->resize(bytes)) {
+            kLogger.warning()
+                    << "Failed to create temporary file for"
+                    << bytes
+                    << "bytes:"
+                    << pFile->errorString();
+            return nullptr;
+        }
+        pPreload->m_pData = pFile->map(0, bytes);
+        if (!pPreload->m_pData) {
+            kLogger.warning()
+                    << "Failed to map temporary file:"
+                    << pFile->errorString();
+            return nullptr;
+        }
+        pPreload->m_pMappedFile = std::move(pFile);
+    } else {
+        pPreload->m_heapData.reset(new (std::nothrow) uchar[bytes]);
+        pPreload->m_pData = pPreload->m_heapData.get();
+        if (!pPreload->m_pData) {
+            kLogger.warning()
+                    << "Failed to allocate"
+                    << bytes
+                    << "bytes";
+            return nullptr;
+        }
+    }
+    return pPreload;
+}
+
+SINT CachingReaderPreload::bytesPerSample() const {
+    switch (m_sampleFormat) {
+    case SampleFormat::Float32:
+        return sizeof(CSAMPLE);
+    case SampleFormat::Float16:
+        return sizeof(qfloat16);
+    }
+    DEBUG_ASSERT(!"unreachable");
+    return sizeof(CSAMPLE);
+}
+
+double CachingReaderPreload::progress() const {
+    if (m_frameIndexRange.empty()) {
+        return 1.0;
+    }
+    return static_cast<double>(m_decodedFrames.load(std::memory_order_relaxed)) /
+            m_frameIndexRange.length();
+}
+
+void CachingReaderPreload::markFinished() {
+    m_finished.store(true, std::memory_order_release);
+}
+
+void CachingReaderPreload::decodeNextFrames(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer::WritableSlice tempBuffer,
+        SINT maxFrames) {
+    DEBUG_ASSERT(!isFinished());
+    const SINT decodedFrames = m_decodedFrames.load(std::memory_order_relaxed);
+    const auto frameIndexRange = intersect(
+            mixxx::IndexRange::forward(
+                    m_frameIndexRange.start() + decodedFrames,
+                    maxFrames),
+            intersect(m_frameIndexRange, pAudioSource->frameIndexRange()));
+    if (frameIndexRange.empty()) {
+        markFinished();
+        return;
+    }
+
+    const SINT sampleOffset = CachingReaderChunk::frames2samples(decodedFrames);
+    const SINT sampleCount = CachingReaderChunk::frames2samples(frameIndexRange.length());
+    // 32-bit samples are decoded directly into the buffer, 16-bit samples
+    // are converted from the stereo buffer. The stereo proxy uses the
+    // remaining part of the temporary buffer for converting the channels.
+    CSAMPLE* pStereoSamples;
+    mixxx::SampleBuffer::WritableSlice proxyBuffer;
+    if (m_sampleFormat == SampleFormat::Float32) {
+        pStereoSamples = reinterpret_cast<CSAMPLE*>(m_pData) + sampleOffset;
+        proxyBuffer = tempBuffer;
+    } else {
+        DEBUG_ASSERT(tempBuffer.length() >= sampleCount);
+        pStereoSamples = tempBuffer.data();
+        proxyBuffer = mixxx::SampleBuffer::WritableSlice(
+                tempBuffer.data(sampleCount),
+                tempBuffer.length() - sampleCount);
+    }
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource,
+            proxyBuffer);
+    const auto readableSampleFrames =
+            audioSourceProxy.readSampleFrames(
+                    mixxx::WritableSampleFrames(
+                            frameIndexRange,
+                            mixxx::SampleBuffer::WritableSlice(
+                                    pStereoSamples,
+                                    sampleCount)));
+    const auto readFrameIndexRange = readableSampleFrames.frameIndexRange();
+
+    // Only a gapless sequence of frames from the start is usable
+    SINT readFrames = 0;
+    if (!readFrameIndexRange.empty() &&
+            readFrameIndexRange.start() == frameIndexRange.start()) {
+        readFrames = readFrameIndexRange.length();
+        const SINT readSamples = CachingReaderChunk::frames2samples(readFrames);
+        if (readableSampleFrames.readableData() != pStereoSamples) {
+            SampleUtil::copy(pStereoSamples,
+                    readableSampleFrames.readableData(),
+                    readSamples);
+        }
+        if (m_sampleFormat == SampleFormat::Float16) {
+            qFloatToFloat16(
+                    reinterpret_cast<qfloat16*>(m_pData) + sampleOffset,
+                    pStereoSamples,
+                    readSamples);
+        }
+        m_decodedFrames.store(decodedFrames + readFrames, std::memory_order_release);
+    }
+    if (readFrames < frameIndexRange.length()) {
+        kLogger.warning()
+                << "Aborting preload after"
+                << decodedFrames + readFrames
+                << "of"
+                << m_frameIndexRange.length()
+                << "frames: expected"
+                << frameIndexRange
+                << ", actual"
+                << readFrameIndexRange;
+        markFinished();
+    } else if (m_frameIndexRange.start() + decodedFrames + readFrames >=
+            m_frameIndexRange.end()) {
+        markFinished();
+    }
+}
+
+void CachingReaderPreload::readSampleFrames(
+        CSAMPLE* pDest,
+        const mixxx::IndexRange& frameIndexRange,
+        bool reverse) const {
+    DEBUG_ASSERT(frameIndexRange.isSubrangeOf(decodedFrameIndexRange()));
+    const SINT sampleOffset = CachingReaderChunk::frames2samples(
+            frameIndexRange.start() - m_frameIndexRange.start());
+    const SINT sampleCount = CachingReaderChunk::frames2samples(
+            frameIndexRange.length());
+    if (m_sampleFormat == SampleFormat::Float32) {
+        const CSAMPLE* pSrc = reinterpret_cast<const CSAMPLE*>(m_pData) + sampleOffset;
+        if (reverse) {
+            SampleUtil::copyReverse(pDest, pSrc, sampleCount);
+        } else {
+            SampleUtil::copy(pDest, pSrc, sampleCount);
+        }
+        return;
+    }
+    qFloatFromFloat16(
+            pDest,
+            reinterpret_cast<const qfloat16*>(m_pData) + sampleOffset,
+            sampleCount);
+    if (reverse) {
+        // Reverse the order of the stereo frames in place
+        for (SINT i = 0, j = sampleCount - 2; i < j; i += 2, j -= 2) {
+            std::swap(pDest[i], pDest[j]);
+            std::swap(pDest[i + 1], pDest[j + 1]);
+        }
+    }
+}
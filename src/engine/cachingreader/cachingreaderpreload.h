@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QFloat16>
+#include <QTemporaryFile>
+#include <atomic>
+#include <memory>
+
+#include "sources/audiosource.h"
+#include "util/indexrange.h"
+#include "util/types.h"
+
+// The fully decoded audio data of a track in a single contiguous buffer.
+//
+// The CachingReaderWorker decodes the track in the background and appends
+// the decoded frames. The number of decoded frames is published atomically
+// and the CachingReader only reads frames that have already been decoded,
+// so no further synchronization is required.
+//
+// The samples are either stored as 32-bit floats or as 16-bit floats to
+// halve the memory consumption. The buffer is either allocated on the heap
+// or memory mapped from a temporary file. A mapped buffer allows the kernel
+// to page out the samples to the file instead of the swap space, but might
+// cause page faults in the engine callback under memory pressure.
+class CachingReaderPreload {
+  public:
+    enum class SampleFormat {
+        Float32,
+        Float16,
+    };
+
+    struct Options {
+        bool enabled = false;
+        SampleFormat sampleFormat = SampleFormat::Float32;
+        bool memoryMapped = false;
+    };
+
+    // Allocates the memory for all frames of the given range. Returns
+    // nullptr if the memory could not be allocated.
+    static std::unique_ptr<CachingReaderPreload> allocate(
+            const mixxx::IndexRange& frameIndexRange,
+            const Options& options);
+
+    ~CachingReaderPreload();
+
+    const mixxx::IndexRange& frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+
+    // The leading frames that have been decoded so far. Thread-safe.
+    mixxx::IndexRange decodedFrameIndexRange() const {
+        return mixxx::IndexRange::forward(
+                m_frameIndexRange.start(),
+                m_decodedFrames.load(std::memory_order_acquire));
+    }
+
+    // Decoding has either been completed or aborted on a read error.
+    // Thread-safe.
+    bool isFinished() const {
+        return m_finished.load(std::memory_order_acquire);
+    }
+
+    // The fraction of decoded frames. Thread-safe.
+    double progress() const;
+
+    // Decodes up to maxFrames frames that follow the decoded frames from the
+    // audio source. The temporary buffer must be large enough for maxFrames
+    // frames of the audio source. Only called by the worker.
+    void decodeNextFrames(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer::WritableSlice tempBuffer,
+            SINT maxFrames);
+
+    // Copies the stereo samples of the given range to pDest. The range must
+    // be a subrange of decodedFrameIndexRange(). If reverse is true the
+    // frames are copied in reverse order. Called from the engine callback.
+    void readSampleFrames(
+            CSAMPLE* pDest,
+            const mixxx::IndexRange& frameIndexRange,
+            bool reverse) const;
+
+  private:
+    CachingReaderPreload(
+            const mixxx::IndexRange& frameIndexRange,
+            SampleFormat sampleFormat);
+
+    SINT bytesPerSample() const;
+    void markFinished();
+
+    const mixxx::IndexRange m_frameIndexRange;
+    const SampleFormat m_sampleFormat;
+
+    // Either m_heapData or m_pMappedFile owns the memory
+    std::unique_ptr<uchar[]> m_heapData;
+    std::unique_ptr<QTemporaryFile> m_pMappedFile;
+    uchar* m_pData;
+
+    std::atomic<SINT> m_decodedFrames;
+    std::atomic<bool> m_finished;
+};
@@ -11,25 +11,54 @@
 #include "util/compatibility.h"
 #include "util/event.h"
 #include "util/logger.h"
+#include "util/math.h"
 
 namespace {
 
 mixxx::Logger kLogger("CachingReaderWorker");
 
+// The pool grows in steps of 16 chunks or ~1 MB
+const SINT kNumberOfChunksPerAllocation = 16;
+
+// The number of frames that are preloaded at once. The worker checks for
+// new tracks and chunk requests in between, so the latency of both is only
+// increased by decoding this amount of frames.
+const SINT kNumberOfPreloadFrames = CachingReaderChunk::kFrames * 4;
+
 } // anonymous namespace
 
 CachingReaderWorker::CachingReaderWorker(
         const QString& group,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
+        FIFO<CachingReaderChunkReadRequest>* pPrefetchRequestFIFO,
+        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+        FIFO<CachingReaderPreload*>* pRetiredPreloadFIFO,
+        FIFO<CachingReaderChunkForOwner*>* pReleasedChunkFIFO,
+        std::shared_ptr<CachingReaderDiskCache> pDiskCache,
+        SINT maxAdditionalChunks)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
+          m_pPrefetchRequestFIFO(pPrefetchRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
+          m_pRetiredPreloadFIFO(pRetiredPreloadFIFO),
+          m_pReleasedChunkFIFO(pReleasedChunkFIFO),
           m_newTrackAvailable(false),
+          m_pDiskCache(std::move(pDiskCache)),
+          m_maxAdditionalChunks(maxAdditionalChunks),
+          m_numAdditionalChunks(0),
+          m_numReleasedChunks(0),
+          m_moreChunksRequested(0),
+          m_pPreload(nullptr),
           m_stop(0) {
 }
 
+CachingReaderWorker::~CachingReaderWorker() {
+    // The cache deletes the chunks that it still owns, but the memory
+    // of all additional chunks is accounted here
+    CachingReaderChunkBudget::release(m_numAdditionalChunks);
+}
+
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         const CachingReaderChunkReadRequest& request) {
     CachingReaderChunk* pChunk = request.chunk;
@@ -47,6 +76,16 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         return result;
     }
 
+    // Restoring the chunk from the disk cache is faster than seeking
+    // and decoding compressed files
+    if (!m_diskCacheTrackKey.isEmpty() &&
+            pChunk->loadSampleFrames(m_pDiskCache.get(), m_diskCacheTrackKey) ==
+                    chunkFrameIndexRange) {
+        ReaderStatusUpdate result;
+        result.init(CHUNK_READ_SUCCESS, pChunk, m_pAudioSource->frameIndexRange());
+        return result;
+    }
+
     // Try to read the data required for the chunk from the audio source
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
             m_pAudioSource,
@@ -59,7 +98,14 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
             bufferedFrameIndexRange.isSubrangeOf(chunkFrameIndexRange));
 
     ReaderStatus status = bufferedFrameIndexRange.empty() ? CHUNK_READ_EOF : CHUNK_READ_SUCCESS;
-    if (bufferedFrameIndexRange != chunkFrameIndexRange) {
+    if (bufferedFrameIndexRange == chunkFrameIndexRange) {
+        // Only complete chunks are cached. The samples are copied and
+        // written in the background, so the result is not delayed by
+        // disk I/O.
+        if (!m_diskCacheTrackKey.isEmpty()) {
+            pChunk->storeSampleFrames(m_pDiskCache.get(), m_diskCacheTrackKey);
+        }
+    } else {
         kLogger.warning()
                 << m_group
                 << "Failed to read chunk samples for frame index range:"
@@ -76,10 +122,12 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
 }
 
 // WARNING: Always called from a different thread (GUI)
-void CachingReaderWorker::newTrack(TrackPointer pTrack) {
+void CachingReaderWorker::newTrack(TrackPointer pTrack,
+        const CachingReaderPreload::Options& preloadOptions) {
     {
         QMutexLocker locker(&m_newTrackMutex);
         m_pNewTrack = pTrack;
+        m_newPreloadOptions = preloadOptions;
         m_newTrackAvailable = true;
     }
     workReady();
@@ -93,19 +141,30 @@ void CachingReaderWorker::run() {
     while (!atomicLoadAcquire(m_stop)) {
         // Request is initialized by reading from FIFO
         CachingReaderChunkReadRequest request;
+        deleteRetiredPreloads();
+        deleteReleasedChunks();
         if (m_newTrackAvailable) {
             TrackPointer pLoadTrack;
+            CachingReaderPreload::Options preloadOptions;
             { // locking scope
                 QMutexLocker locker(&m_newTrackMutex);
                 pLoadTrack = m_pNewTrack;
+                preloadOptions = m_newPreloadOptions;
                 m_pNewTrack.reset();
                 m_newTrackAvailable = false;
             } // implicitly unlocks the mutex
-            loadTrack(pLoadTrack);
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
+            loadTrack(pLoadTrack, preloadOptions);
+        } else if (m_moreChunksRequested.fetchAndStoreAcquire(0)) {
+            allocateMoreChunks();
+        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1 ||
+                m_pPrefetchRequestFIFO->read(&request, 1) == 1) {
+            // Read the requested chunk and send the result. Prefetching is
+            // interrupted after each chunk to check for more urgent requests.
             const ReaderStatusUpdate update(processReadRequest(request));
             m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (m_pPreload) {
+            // Only preload when there is nothing else to do
+            decodePreload();
         } else {
             Event::end(m_tag);
             m_semaRun.acquire();
@@ -114,16 +173,23 @@ void CachingReaderWorker::run() {
     }
 }
 
-void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
+void CachingReaderWorker::loadTrack(const TrackPointer& pTrack,
+        const CachingReaderPreload::Options& preloadOptions) {
+    // The cache retires the buffer of the previous track when receiving
+    // the status update for the new track
+    stopPreload();
+
     // Discard all pending read requests
     CachingReaderChunkReadRequest request;
-    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1 ||
+            m_pPrefetchRequestFIFO->read(&request, 1) == 1) {
         const auto update = ReaderStatusUpdate::readDiscarded(request.chunk);
         m_pReaderStatusFIFO->writeBlocking(&update, 1);
     }
 
     // Unload the track
     m_pAudioSource.reset(); // Close open file handles
+    m_diskCacheTrackKey.clear();
 
     if (!pTrack) {
         // If no new track is available then we are done
@@ -189,6 +255,10 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
     }
 
+    if (m_pDiskCache) {
+        m_diskCacheTrackKey = CachingReaderDiskCache::trackKey(pTrack, m_pAudioSource);
+    }
+
     const auto update =
             ReaderStatusUpdate::trackLoaded(
                     m_pAudioSource->frameIndexRange());
@@ -202,6 +272,151 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
             pTrack,
             m_pAudioSource->getSignalInfo().getSampleRate(),
             sampleCount);
+
+    // The track is playable from the chunks while it is preloaded
+    if (preloadOptions.enabled) {
+        startPreload(pTrack, preloadOptions);
+    }
+}
+
+void CachingReaderWorker::startPreload(const TrackPointer& pTrack,
+        const CachingReaderPreload::Options& preloadOptions) {
+    DEBUG_ASSERT(!m_pPreload);
+    // A separate audio source keeps the read position of the chunk reader
+    // and avoids seeking back and forth between both.
+    mixxx::AudioSource::OpenParams config;
+    config.setChannelCount(CachingReaderChunk::kChannels);
+    m_pPreloadAudioSource = SoundSourceProxy(pTrack).openAudioSource(config);
+    if (!m_pPreloadAudioSource) {
+        kLogger.warning()
+                << m_group
+                << "Failed to open file for preloading"
+                << pTrack->getFileInfo();
+        return;
+    }
+    auto pPreload = CachingReaderPreload::allocate(
+            m_pPreloadAudioSource->frameIndexRange(),
+            preloadOptions);
+    if (!pPreload) {
+        kLogger.warning()
+                << m_group
+                << "Failed to allocate memory for preloading"
+                << pTrack->getFileInfo();
+        m_pPreloadAudioSource.reset();
+        return;
+    }
+
+    // Decoded samples and the stereo conversion of the audio source
+    // need disjoint parts of the buffer
+    const SINT tempBufferSize =
+            CachingReaderChunk::frames2samples(kNumberOfPreloadFrames) +
+            m_pPreloadAudioSource->getSignalInfo().frames2samples(
+                    kNumberOfPreloadFrames);
+    if (m_preloadTempBuffer.size() != tempBufferSize) {
+        mixxx::SampleBuffer(tempBufferSize).swap(m_preloadTempBuffer);
+    }
+
+    m_pPreload = pPreload.get();
+    m_preloadTimer.start();
+    // Transfer the ownership to the cache
+    const auto update = ReaderStatusUpdate::preloadStarted(pPreload.release());
+    m_pReaderStatusFIFO->writeBlocking(&update, 1);
+}
+
+void CachingReaderWorker::decodePreload() {
+    DEBUG_ASSERT(m_pPreload);
+    m_pPreload->decodeNextFrames(
+            m_pPreloadAudioSource,
+            mixxx::SampleBuffer::WritableSlice(m_preloadTempBuffer),
+            kNumberOfPreloadFrames);
+    if (m_pPreload->isFinished()) {
+        kLogger.info()
+                << m_group
+                << "Preloaded"
+                << m_pPreload->decodedFrameIndexRange().length()
+                << "frames in"
+                << m_preloadTimer.elapsed().formatMillisWithUnit();
+        stopPreload();
+    }
+}
+
+void CachingReaderWorker::stopPreload() {
+    // The buffer is still owned by the cache
+    m_pPreload = nullptr;
+    m_pPreloadAudioSource.reset(); // Close open file handles
+}
+
+void CachingReaderWorker::deleteRetiredPreloads() {
+    CachingReaderPreload* pPreload;
+    while (m_pRetiredPreloadFIFO->read(&pPreload, 1) == 1) {
+        if (pPreload == m_pPreload) {
+            stopPreload();
+        }
+        delete pPreload;
+    }
+}
+
+void CachingReaderWorker::allocateMoreChunks() {
+    const SINT numChunks = CachingReaderChunkBudget::tryReserve(
+            math_min(kNumberOfChunksPerAllocation,
+                    m_maxAdditionalChunks - m_numAdditionalChunks));
+    if (numChunks <= 0) {
+        if (kLogger.debugEnabled()) {
+            kLogger.debug()
+                    << m_group
+                    << "Chunk memory budget exhausted:"
+                    << CachingReaderChunkBudget::allocatedBytes()
+                    << "of"
+                    << CachingReaderChunkBudget::limitBytes()
+                    << "bytes allocated";
+        }
+        return;
+    }
+    m_numAdditionalChunks += numChunks;
+
+    mixxx::SampleBuffer sampleBuffer(CachingReaderChunk::kSamples * numChunks);
+    for (SINT i = 0; i < numChunks; ++i) {
+        auto* pChunk = new CachingReaderChunkForOwner(
+                mixxx::SampleBuffer::WritableSlice(
+                        sampleBuffer,
+                        CachingReaderChunk::kSamples * i,
+                        CachingReaderChunk::kSamples));
+        const auto update = ReaderStatusUpdate::chunkAllocated(pChunk);
+        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    }
+    // Moving the buffer does not move the sample memory
+    m_additionalSampleBuffers.push_back(std::move(sampleBuffer));
+
+    kLogger.debug()
+            << m_group
+            << "Allocated"
+            << numChunks
+            << "additional chunks";
+}
+
+void CachingReaderWorker::deleteReleasedChunks() {
+    CachingReaderChunkForOwner* pChunk;
+    while (m_pReleasedChunkFIFO->read(&pChunk, 1) == 1) {
+        delete pChunk;
+        ++m_numReleasedChunks;
+    }
+    // The chunks of an allocation share their sample memory. Chunks that
+    // are still on their way to the cache are released on the next eject.
+    if (m_numReleasedChunks == 0 ||
+            m_numReleasedChunks < m_numAdditionalChunks) {
+        return;
+    }
+    DEBUG_ASSERT(m_numReleasedChunks == m_numAdditionalChunks);
+    m_additionalSampleBuffers.clear();
+    CachingReaderChunkBudget::release(m_numAdditionalChunks);
+
+    kLogger.debug()
+            << m_group
+            << "Freed"
+            << m_numAdditionalChunks
+            << "additional chunks";
+    m_numAdditionalChunks = 0;
+    m_numReleasedChunks = 0;
 }
 
 void CachingReaderWorker::quitWait() {
@@ -5,12 +5,16 @@
 #include <QString>
 #include <QThread>
 #include <QtDebug>
+#include <vector>
 
 #include "engine/cachingreader/cachingreaderchunk.h"
+#include "engine/cachingreader/cachingreaderdiskcache.h"
+#include "engine/cachingreader/cachingreaderpreload.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
 #include "track/track_decl.h"
 #include "util/fifo.h"
+#include "util/performancetimer.h"
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
@@ -30,12 +34,15 @@ enum ReaderStatus {
     CHUNK_READ_EOF,
     CHUNK_READ_INVALID,
     CHUNK_READ_DISCARDED, // response without frame index range!
+    CHUNK_ALLOCATED, // a new free chunk for the pool of the cache
+    PRELOAD_STARTED, // the buffer for preloading the whole track
 };
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct ReaderStatusUpdate {
   private:
     CachingReaderChunk* chunk;
+    CachingReaderPreload* preload;
     SINT readableFrameIndexRangeStart;
     SINT readableFrameIndexRangeEnd;
 
@@ -48,6 +55,7 @@ typedef struct ReaderStatusUpdate {
             const mixxx::IndexRange& readableFrameIndexRangeArg) {
         status = statusArg;
         chunk = chunkArg;
+        preload = nullptr;
         readableFrameIndexRangeStart = readableFrameIndexRangeArg.start();
         readableFrameIndexRangeEnd = readableFrameIndexRangeArg.end();
     }
@@ -67,13 +75,50 @@ typedef struct ReaderStatusUpdate {
         return update;
     }
 
+    static ReaderStatusUpdate chunkAllocated(
+            CachingReaderChunkForOwner* pChunk) {
+        DEBUG_ASSERT(pChunk);
+        DEBUG_ASSERT(pChunk->getState() == CachingReaderChunkForOwner::FREE);
+        ReaderStatusUpdate update;
+        update.init(CHUNK_ALLOCATED, pChunk, mixxx::IndexRange());
+        return update;
+    }
+
+    static ReaderStatusUpdate preloadStarted(
+            CachingReaderPreload* pPreload) {
+        DEBUG_ASSERT(pPreload);
+        ReaderStatusUpdate update;
+        update.init(PRELOAD_STARTED, nullptr, mixxx::IndexRange());
+        update.preload = pPreload;
+        return update;
+    }
+
     static ReaderStatusUpdate trackUnloaded() {
         ReaderStatusUpdate update;
         update.init(TRACK_UNLOADED, nullptr, mixxx::IndexRange());
         return update;
     }
 
+    // Transfers the ownership of a chunk with the status CHUNK_ALLOCATED
+    CachingReaderChunkForOwner* takeAllocatedChunk() {
+        DEBUG_ASSERT(status == CHUNK_ALLOCATED);
+        DEBUG_ASSERT(dynamic_cast<CachingReaderChunkForOwner*>(chunk));
+        auto* pChunk = static_cast<CachingReaderChunkForOwner*>(chunk);
+        chunk = nullptr;
+        return pChunk;
+    }
+
+    // Transfers the ownership of the buffer with the status PRELOAD_STARTED
+    CachingReaderPreload* takePreload() {
+        DEBUG_ASSERT(status == PRELOAD_STARTED);
+        auto* pPreload = preload;
+        preload = nullptr;
+        return pPreload;
+    }
+
     CachingReaderChunkForOwner* takeFromWorker() {
+        DEBUG_ASSERT(status != CHUNK_ALLOCATED);
+        DEBUG_ASSERT(status != PRELOAD_STARTED);
         CachingReaderChunkForOwner* pChunk = nullptr;
         if (chunk) {
             DEBUG_ASSERT(dynamic_cast<CachingReaderChunkForOwner*>(chunk));
@@ -96,13 +141,38 @@ class CachingReaderWorker : public EngineWorker {
 
   public:
     // Construct a CachingReader with the given group.
+    // Requests from pPrefetchRequestFIFO are only processed if
+    // pChunkReadRequestFIFO is empty.
+    // Decoded chunks are restored from and stored in the optional
+    // pDiskCache.
+    // The worker allocates up to maxAdditionalChunks chunks for growing
+    // the pool of the cache on demand. These chunks are returned through
+    // pReleasedChunkFIFO when the cache shrinks its pool again. Preload
+    // buffers that are no longer used by the cache are returned through
+    // pRetiredPreloadFIFO.
     CachingReaderWorker(const QString& group,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
-    ~CachingReaderWorker() override = default;
+            FIFO<CachingReaderChunkReadRequest>* pPrefetchRequestFIFO,
+            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+            FIFO<CachingReaderPreload*>* pRetiredPreloadFIFO,
+            FIFO<CachingReaderChunkForOwner*>* pReleasedChunkFIFO,
+            std::shared_ptr<CachingReaderDiskCache> pDiskCache,
+            SINT maxAdditionalChunks);
+    ~CachingReaderWorker() override;
 
-    // Request to load a new track. wake() must be called afterwards.
-    void newTrack(TrackPointer pTrack);
+    // Request to load a new track. If preloading is enabled the whole track
+    // is decoded in the background after it has been loaded. wake() must be
+    // called afterwards.
+    void newTrack(TrackPointer pTrack,
+            const CachingReaderPreload::Options& preloadOptions);
+
+    // Request more chunks for the pool of the cache if the global memory
+    // budget permits. The chunks are delivered as CHUNK_ALLOCATED status
+    // updates. Called from the engine callback, wake() must be called
+    // afterwards.
+    void requestMoreChunks() {
+        m_moreChunksRequested = 1;
+    }
 
     // Run upkeep operations like loading tracks and reading from file. Run by a
     // thread pool via the EngineWorkerScheduler.
@@ -123,16 +193,35 @@ class CachingReaderWorker : public EngineWorker {
     // Thread-safe FIFOs for communication between the engine callback and
     // reader thread.
     FIFO<CachingReaderChunkReadRequest>* m_pChunkReadRequestFIFO;
+    FIFO<CachingReaderChunkReadRequest>* m_pPrefetchRequestFIFO;
     FIFO<ReaderStatusUpdate>* m_pReaderStatusFIFO;
+    FIFO<CachingReaderPreload*>* m_pRetiredPreloadFIFO;
+    FIFO<CachingReaderChunkForOwner*>* m_pReleasedChunkFIFO;
 
     // Queue of Tracks to load, and the corresponding lock. Must acquire the
     // lock to touch.
     QMutex m_newTrackMutex;
     bool m_newTrackAvailable;
     TrackPointer m_pNewTrack;
+    CachingReaderPreload::Options m_newPreloadOptions;
 
     // Internal method to load a track. Emits trackLoaded when finished.
-    void loadTrack(const TrackPointer& pTrack);
+    void loadTrack(const TrackPointer& pTrack,
+            const CachingReaderPreload::Options& preloadOptions);
+
+    // Allocates the preload buffer for the loaded track and hands it over
+    // to the cache. The track is decoded by subsequent decodePreload() calls.
+    void startPreload(const TrackPointer& pTrack,
+            const CachingReaderPreload::Options& preloadOptions);
+    void decodePreload();
+    void stopPreload();
+    void deleteRetiredPreloads();
+
+    // Allocates additional chunks and hands them over to the cache.
+    void allocateMoreChunks();
+    // Deletes the additional chunks that the cache has released and frees
+    // their memory once all of them have been returned.
+    void deleteReleasedChunks();
 
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
@@ -140,9 +229,31 @@ class CachingReaderWorker : public EngineWorker {
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
+    // Shared with the workers of all other decks
+    const std::shared_ptr<CachingReaderDiskCache> m_pDiskCache;
+    // The key of the loaded track in the disk cache. Empty if the chunks
+    // of the track are not cached.
+    QString m_diskCacheTrackKey;
+
     // Temporary buffer for reading samples from all channels
     // before conversion to a stereo signal.
     mixxx::SampleBuffer m_tempReadBuffer;
 
+    // The sample memory of the chunks that have been allocated in addition
+    // to the initial pool of the cache. The chunks are owned by the cache,
+    // but their memory must only be freed after the cache deleted them.
+    std::vector<mixxx::SampleBuffer> m_additionalSampleBuffers;
+    const SINT m_maxAdditionalChunks;
+    SINT m_numAdditionalChunks;
+    SINT m_numReleasedChunks;
+    QAtomicInt m_moreChunksRequested;
+
+    // The preload buffer that is currently filled. It is owned by the cache
+    // and only deleted by the worker after the cache retired it.
+    CachingReaderPreload* m_pPreload;
+    mixxx::AudioSourcePointer m_pPreloadAudioSource;
+    mixxx::SampleBuffer m_preloadTempBuffer;
+    PerformanceTimer m_preloadTimer;
+
     QAtomicInt m_stop;
 };
@@ -0,0 +1,182 @@
+#include "engine/channelmixer.h"
+
+#include "util/sample.h"
+
+// ChannelMixer used to be generated by tools/generate_sample_functions.py
+// with one unrolled branch per number of active channels. The mixing loops
+// below handle any number of channels with a fixed code size: channels are
+// accumulated in groups of kMixGroupSize into cache sized blocks of the
+// output buffer. The group size is a template parameter so the compiler can
+// fully unroll and vectorize the inner loop.
+
+namespace {
+
+// Returns the old and updates the cached gain of the channel
+CSAMPLE_GAIN updateGain(
+        const EngineMaster::GainCalculator& gainCalculator,
+        EngineMaster::ChannelInfo* pChannelInfo,
+        EngineMaster::GainCache* pGainCache) {
+    const CSAMPLE_GAIN oldGain = pGainCache->m_gain;
+    if (pGainCache->m_fadeout) {
+        pGainCache->m_gain = 0;
+        pGainCache->m_fadeout = false;
+    } else {
+        pGainCache->m_gain = gainCalculator.getGain(pChannelInfo);
+    }
+    return oldGain;
+}
+
+// Accumulates kNumInputs stereo input blocks into the output block.
+// If kOverwrite is set the previous content of the output block is
+// discarded.
+template<int kNumInputs, bool kOverwrite>
+inline void mixBlock(
+        CSAMPLE* M_RESTRICT pOutput,
+        const CSAMPLE* const* pInputs,
+        SINT blockStart,
+        SINT blockSamples) {
+    const CSAMPLE* M_RESTRICT pIn[kNumInputs];
+    for (int c = 0; c < kNumInputs; ++c) {
+        pIn[c] = pInputs[c] + blockStart;
+    }
+    CSAMPLE* M_RESTRICT pOut = pOutput + blockStart;
+    // note: LOOP VECTORIZED only with "int i" (not SINT i)
+    for (int i = 0; i < blockSamples; ++i) {
+        CSAMPLE sum = kOverwrite ? CSAMPLE_ZERO : pOut[i];
+        for (int c = 0; c < kNumInputs; ++c) {
+            sum += pIn[c][i];
+        }
+        pOut[i] = sum;
+    }
+}
+
+template<bool kOverwrite>
+inline void mixGroup(
+        int numInputs,
+        CSAMPLE* pOutput,
+        const CSAMPLE* const* pInputs,
+        SINT blockStart,
+        SINT blockSamples) {
+    static_assert(ChannelMixer::kMixGroupSize == 4,
+            "The switch below must cover all group sizes");
+    switch (numInputs) {
+    case 1:
+        mixBlock<1, kOverwrite>(pOutput, pInputs, blockStart, blockSamples);
+        break;
+    case 2:
+        mixBlock<2, kOverwrite>(pOutput, pInputs, blockStart, blockSamples);
+        break;
+    case 3:
+        mixBlock<3, kOverwrite>(pOutput, pInputs, blockStart, blockSamples);
+        break;
+    case 4:
+        mixBlock<4, kOverwrite>(pOutput, pInputs, blockStart, blockSamples);
+        break;
+    default:
+        DEBUG_ASSERT(!"unsupported group size");
+    }
+}
+
+} // anonymous namespace
+
+// static
+void ChannelMixer::mixChannels(
+        CSAMPLE* pOutput,
+        const CSAMPLE* const* pInputs,
+        int numInputs,
+        SINT numSamples) {
+    if (numInputs <= 0) {
+        SampleUtil::clear(pOutput, numSamples);
+        return;
+    }
+    for (SINT blockStart = 0; blockStart < numSamples;
+            blockStart += kMixBlockSamples) {
+        const SINT blockSamples = math_min(
+                kMixBlockSamples, numSamples - blockStart);
+        // The first group overwrites the output block, all following
+        // groups accumulate into it while it is still cached.
+        int groupStart = 0;
+        int groupSize = math_min(numInputs, kMixGroupSize);
+        mixGroup<true>(groupSize, pOutput, pInputs, blockStart, blockSamples);
+        groupStart += groupSize;
+        while (groupStart < numInputs) {
+            groupSize = math_min(numInputs - groupStart, kMixGroupSize);
+            mixGroup<false>(groupSize,
+                    pOutput,
+                    pInputs + groupStart,
+                    blockStart,
+                    blockSamples);
+            groupStart += groupSize;
+        }
+    }
+}
+
+// static
+void ChannelMixer::applyEffectsAndMixChannels(const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput,
+        const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Clear pOutput buffer
+    // 2. Calculate gains for each channel
+    // 3. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
+    //     A) Copies each channel input buffer to a temporary buffer
+    //     B) Applies gain to the temporary buffer
+    //     C) Processes effects on the temporary buffer
+    //     D) Mixes the temporary buffer into pOutput
+    // The original channel input buffers are not modified.
+    SampleUtil::clear(pOutput, iBufferSize);
+    for (EngineMaster::ChannelInfo* pChannelInfo : qAsConst(*activeChannels)) {
+        EngineMaster::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
+        const CSAMPLE_GAIN oldGain = updateGain(gainCalculator, pChannelInfo, &gainCache);
+        pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
+                outputHandle,
+                pChannelInfo->m_pBuffer,
+                pOutput,
+                iBufferSize,
+                iSampleRate,
+                pChannelInfo->m_features,
+                oldGain,
+                gainCache.m_gain);
+    }
+}
+
+// static
+void ChannelMixer::applyEffectsInPlaceAndMixChannels(
+        const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput,
+        const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
+    //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
+    //    B) Applies effects to the buffer, modifying the original input buffer
+    // 3. Mix the channel buffers together to make pOutput, overwriting the pOutput buffer from the last engine callback
+    //
+    // The post-fader gain has to be applied before the post-fader effects
+    // are processed, so it cannot be folded into the mixing pass here.
+    QVarLengthArray<const CSAMPLE*, kPreallocatedChannels> buffers;
+    for (EngineMaster::ChannelInfo* pChannelInfo : qAsConst(*activeChannels)) {
+        EngineMaster::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
+        const CSAMPLE_GAIN oldGain = updateGain(gainCalculator, pChannelInfo, &gainCache);
+        pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
+                outputHandle,
+                pChannelInfo->m_pBuffer,
+                iBufferSize,
+                iSampleRate,
+                pChannelInfo->m_features,
+                oldGain,
+                gainCache.m_gain);
+        buffers.append(pChannelInfo->m_pBuffer);
+    }
+    mixChannels(pOutput, buffers.constData(), buffers.size(), iBufferSize);
+}
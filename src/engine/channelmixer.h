@@ -28,4 +28,20 @@ class ChannelMixer {
         unsigned int iBufferSize,
         unsigned int iSampleRate,
         EngineEffectsManager* pEngineEffectsManager);
+
+    // Number of samples of each buffer that are mixed at once. The output
+    // block and the input blocks of a group of kMixGroupSize channels fit
+    // into the L1 data cache of all supported CPUs.
+    static constexpr SINT kMixBlockSamples = 512;
+    // Number of input channels that are accumulated in one pass over an
+    // output block.
+    static constexpr int kMixGroupSize = 4;
+
+    // Overwrites pOutput with the sum of all stereo input buffers. Works for
+    // any number of inputs, including none.
+    static void mixChannels(
+            CSAMPLE* pOutput,
+            const CSAMPLE* const* pInputs,
+            int numInputs,
+            SINT numSamples);
 };
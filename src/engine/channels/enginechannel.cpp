@@ -2,6 +2,7 @@
 
 #include "control/controlobject.h"
 #include "control/controlpushbutton.h"
+#include "engine/effects/engineeffectsmanager.h"
 #include "moc_enginechannel.cpp"
 
 EngineChannel::EngineChannel(const ChannelHandleAndGroup& handleGroup,
@@ -14,6 +15,7 @@ EngineChannel::EngineChannel(const ChannelHandleAndGroup& handleGroup,
           m_vuMeter(getGroup()),
           m_pSampleRate(new ControlProxy("[Master]", "samplerate")),
           m_sampleBuffer(nullptr),
+          m_bPreFaderEffectsPending(false),
           m_bIsPrimaryDeck(isPrimaryDeck),
           m_bIsTalkoverChannel(isTalkoverChannel),
           m_channelIndex(-1) {
@@ -53,6 +55,24 @@ EngineChannel::~EngineChannel() {
     delete m_pTalkover;
 }
 
+void EngineChannel::processPreFader(CSAMPLE* pOut, const int iBufferSize) {
+    if (m_bPreFaderEffectsPending && m_pEffectsManager != nullptr) {
+        EngineEffectsManager* pEngineEffectsManager = m_pEffectsManager->getEngineEffectsManager();
+        if (pEngineEffectsManager != nullptr) {
+            pEngineEffectsManager->processPreFaderInPlace(m_group.handle(),
+                    m_pEffectsManager->getMasterHandle(),
+                    pOut,
+                    iBufferSize,
+                    // TODO(jholthuis): Use mixxx::audio::SampleRate instead
+                    static_cast<unsigned int>(m_pSampleRate->get()));
+        }
+    }
+    m_bPreFaderEffectsPending = false;
+
+    // Update VU meter
+    m_vuMeter.process(pOut, iBufferSize);
+}
+
 void EngineChannel::setPfl(bool enabled) {
     m_pPFL->set(enabled ? 1.0 : 0.0);
 }
@@ -56,7 +56,13 @@ class EngineChannel : public EngineObject {
         m_channelIndex = channelIndex;
     }
 
+    // Renders the signal of this channel without the pre-fader effects.
+    // This may run in a worker thread of the channel thread pool.
     virtual void process(CSAMPLE* pOut, const int iBufferSize) = 0;
+    // Applies the pre-fader effects to the output of process() and updates
+    // the VU meter. The effect chains share their buffers between channels,
+    // so this is always called serially from the callback thread.
+    void processPreFader(CSAMPLE* pOut, const int iBufferSize);
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const = 0;
     virtual void postProcess(const int iBuffersize) = 0;
 
@@ -72,6 +78,8 @@ class EngineChannel : public EngineObject {
     EngineVuMeter m_vuMeter;
     ControlProxy* m_pSampleRate;
     const CSAMPLE* volatile m_sampleBuffer;
+    // Set by process() if its output is an input for the pre-fader effects.
+    bool m_bPreFaderEffectsPending;
 
     // If set to true, this engine channel represents one of the primary playback decks.
     // It is used to check for valid bpm targets by the sync code.
@@ -2,7 +2,6 @@
 
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
-#include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginepregain.h"
 #include "engine/enginevumeter.h"
@@ -73,18 +72,7 @@ void EngineDeck::process(CSAMPLE* pOut, const int iBufferSize) {
     // Apply pregain
     m_pPregain->process(pOut, iBufferSize);
 
-    EngineEffectsManager* pEngineEffectsManager = m_pEffectsManager->getEngineEffectsManager();
-    if (pEngineEffectsManager != nullptr) {
-        pEngineEffectsManager->processPreFaderInPlace(m_group.handle(),
-                m_pEffectsManager->getMasterHandle(),
-                pOut,
-                iBufferSize,
-                // TODO(jholthuis): Use mixxx::audio::SampleRate instead
-                static_cast<unsigned int>(m_pSampleRate->get()));
-    }
-
-    // Update VU meter
-    m_vuMeter.process(pOut, iBufferSize);
+    m_bPreFaderEffectsPending = true;
 }
 
 void EngineDeck::collectFeatures(GroupFeatureState* pGroupFeatures) const {
@@ -5,7 +5,6 @@
 #include "control/control.h"
 #include "control/controlaudiotaperpot.h"
 #include "effects/effectsmanager.h"
-#include "engine/effects/engineeffectsmanager.h"
 #include "moc_enginemicrophone.cpp"
 #include "preferences/usersettings.h"
 #include "util/sample.h"
@@ -75,20 +74,11 @@ void EngineMicrophone::process(CSAMPLE* pOut, const int iBufferSize) {
     CSAMPLE_GAIN pregain = static_cast<CSAMPLE_GAIN>(m_pPregain->get());
     if (sampleBuffer) {
         SampleUtil::copyWithGain(pOut, sampleBuffer, pregain, iBufferSize);
-        EngineEffectsManager* pEngineEffectsManager = m_pEffectsManager->getEngineEffectsManager();
-        if (pEngineEffectsManager != nullptr) {
-            pEngineEffectsManager->processPreFaderInPlace(
-                    m_group.handle(), m_pEffectsManager->getMasterHandle(), pOut, iBufferSize,
-                    // TODO(jholthuis): Use mixxx::audio::SampleRate instead
-                    static_cast<unsigned int>(m_pSampleRate->get()));
-        }
+        m_bPreFaderEffectsPending = true;
     } else {
         SampleUtil::clear(pOut, iBufferSize);
     }
     m_sampleBuffer = nullptr;
-
-    // Update VU meter
-    m_vuMeter.process(pOut, iBufferSize);
 }
 
 void EngineMicrophone::collectFeatures(GroupFeatureState* pGroupFeatures) const {
@@ -1177,7 +1177,7 @@ void CueControl::hintReader(HintVector* pHintList) {
     if (mainCuePosition.isValid()) {
         cueHint.frame = static_cast<SINT>(mainCuePosition.toLowerFrameBoundary().value());
         cueHint.frameCount = Hint::kFrameCountForward;
-        cueHint.priority = 10;
+        cueHint.priority = Hint::kPriorityPrefetch;
         pHintList->append(cueHint);
     }
 
@@ -1189,7 +1189,23 @@ void CueControl::hintReader(HintVector* pHintList) {
         if (position.isValid()) {
             cueHint.frame = static_cast<SINT>(position.toLowerFrameBoundary().value());
             cueHint.frameCount = Hint::kFrameCountForward;
-            cueHint.priority = 10;
+            cueHint.priority = Hint::kPriorityPrefetch;
+            pHintList->append(cueHint);
+        }
+    }
+
+    // The intro and outro cues are the usual targets for jumps when mixing
+    for (const auto* pPositionControl : {m_pIntroStartPosition,
+                 m_pIntroEndPosition,
+                 m_pOutroStartPosition,
+                 m_pOutroEndPosition}) {
+        const auto position =
+                mixxx::audio::FramePos::fromEngineSamplePosMaybeInvalid(
+                        pPositionControl->get());
+        if (position.isValid()) {
+            cueHint.frame = static_cast<SINT>(position.toLowerFrameBoundary().value());
+            cueHint.frameCount = Hint::kFrameCountForward;
+            cueHint.priority = Hint::kPriorityPrefetch;
             pHintList->append(cueHint);
         }
     }
@@ -457,20 +457,20 @@ void LoopingControl::hintReader(HintVector* pHintList) {
         // direction we're going in, but that this is much simpler, and hints
         // aren't that bad to make anyway.
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 2;
+            loop_hint.priority = Hint::kPriorityHigh;
             loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
             loop_hint.frameCount = Hint::kFrameCountForward;
             pHintList->append(loop_hint);
         }
         if (loopSamples.end >= 0) {
-            loop_hint.priority = 10;
+            loop_hint.priority = Hint::kPriorityPrefetch;
             loop_hint.frame = SampleUtil::ceilPlayPosToFrame(loopSamples.end);
             loop_hint.frameCount = Hint::kFrameCountBackward;
             pHintList->append(loop_hint);
         }
     } else {
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 10;
+            loop_hint.priority = Hint::kPriorityPrefetch;
             loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
             loop_hint.frameCount = Hint::kFrameCountForward;
             pHintList->append(loop_hint);
@@ -99,7 +99,10 @@ EngineBuffer::EngineBuffer(const QString& group,
     // zero out crossfade buffer
     SampleUtil::clear(m_pCrossfadeBuffer, MAX_BUFFER_LEN);
 
-    m_pReader = new CachingReader(group, pConfig);
+    m_pReader = new CachingReader(group,
+            pConfig,
+            pChannel->isPrimaryDeck() ? CachingReader::Role::Deck
+                                      : CachingReader::Role::Sampler);
     connect(m_pReader, &CachingReader::trackLoading,
             this, &EngineBuffer::slotTrackLoading,
             Qt::DirectConnection);
@@ -1400,7 +1403,7 @@ void EngineBuffer::hintReader(const double dRate) {
     if (m_bSlipEnabledProcessing) {
         Hint hint;
         hint.frame = SampleUtil::floorPlayPosToFrame(m_dSlipPosition);
-        hint.priority = 1;
+        hint.priority = Hint::kPriorityImmediate;
         if (m_dSlipRate >= 0) {
             hint.frameCount = Hint::kFrameCountForward;
         } else {
@@ -1445,6 +1448,23 @@ TrackPointer EngineBuffer::getLoadedTrack() const {
     return m_pCurrentTrack;
 }
 
+bool EngineBuffer::dependsOnOtherChannels() const {
+    if (m_pSyncControl->getSyncMode() != SyncMode::None) {
+        return true;
+    }
+    if (atomicLoadRelaxed(m_iEnableSyncQueued) != SYNC_REQUEST_NONE ||
+            atomicLoadRelaxed(m_iSyncModeQueued) !=
+                    static_cast<int>(SyncMode::Invalid)) {
+        return true;
+    }
+    if (atomicLoadRelaxed(m_pChannelToCloneFrom) != nullptr) {
+        return true;
+    }
+    // Quantized seeks, play starts and scratch ends as well as queued phase
+    // seeks look up the beats of the sync target via pickSyncTarget().
+    return m_pQuantize->toBool() || atomicLoadRelaxed(m_iSeekPhaseQueued) != 0;
+}
+
 void EngineBuffer::slotEjectTrack(double v) {
     if (v > 0) {
         // Don't allow rejections while playing a track. We don't need to lock to
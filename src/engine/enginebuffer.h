@@ -129,6 +129,14 @@ class EngineBuffer : public EngineObject {
     bool isTrackLoaded() const;
     TrackPointer getLoadedTrack() const;
 
+    /// Returns true if processing this buffer in the next callback may touch
+    /// EngineSync or another deck, i.e. it is synchronized, a sync mode
+    /// change is queued, it is about to clone the position of another deck,
+    /// or it may seek into the phase of another deck because quantize is
+    /// enabled or a phase seek is queued. Only independent buffers are safe
+    /// to process in parallel.
+    bool dependsOnOtherChannels() const;
+
     double getExactPlayPos() const;
     double getVisualPlayPos() const;
     double getTrackSamples() const;
@@ -0,0 +1,223 @@
+#include "engine/enginechannelthreadpool.h"
+
+#include <algorithm>
+
+#ifdef __LINUX__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("EngineChannelThreadPool");
+
+// Set in m_pendingWorkers when the callback thread gave up spinning and
+// waits for the last worker to release m_workersDone.
+constexpr int kCallbackWaiting = 1 << 30;
+
+// A few ten microseconds on current CPUs. This is long enough to cover the
+// wake up latency of a real-time thread but short compared to a callback.
+constexpr int kMaxSpinIterations = 20000;
+
+constexpr int kNoPolicy = -1;
+
+inline void cpuRelax() {
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+} // anonymous namespace
+
+class EngineChannelWorkerThread : public QThread {
+  public:
+    EngineChannelWorkerThread(EngineChannelThreadPool* pPool, int workerIndex)
+            : m_pPool(pPool),
+              m_workerIndex(workerIndex) {
+        setObjectName(QStringLiteral("EngineChannelWorker %1").arg(workerIndex));
+    }
+
+  protected:
+    void run() override {
+        m_pPool->workerLoop(m_workerIndex);
+    }
+
+  private:
+    EngineChannelThreadPool* const m_pPool;
+    const int m_workerIndex;
+};
+
+EngineChannelThreadPool::EngineChannelThreadPool(int numThreads)
+        : m_pJobFunction(nullptr),
+          m_pJob(nullptr),
+          m_numJobs(0),
+          m_callbackThreadId(nullptr),
+          m_callbackPolicy(kNoPolicy),
+          m_callbackPriority(0),
+          m_nextJob(0),
+          m_pendingWorkers(0),
+          m_quit(false) {
+    const int maxThreads = std::max(QThread::idealThreadCount() - 1, 0);
+    numThreads = std::min(numThreads, maxThreads);
+    kLogger.info() << "Processing channels with" << numThreads
+                   << "additional threads";
+    m_workers.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        auto* pWorker = new EngineChannelWorkerThread(this, i);
+        m_workers.push_back(pWorker);
+        pWorker->start(QThread::TimeCriticalPriority);
+    }
+}
+
+EngineChannelThreadPool::~EngineChannelThreadPool() {
+    m_quit.store(true, std::memory_order_release);
+    m_wakeWorkers.release(numThreads());
+    for (auto* pWorker : m_workers) {
+        pWorker->wait();
+        delete pWorker;
+    }
+}
+
+void EngineChannelThreadPool::runJobs(
+        int numJobs, JobFunction pJobFunction, const void* pJob) {
+    // Keep one job for the calling thread
+    const int numWorkers = std::min(numJobs - 1, numThreads());
+    if (numWorkers <= 0) {
+        for (int i = 0; i < numJobs; ++i) {
+            pJobFunction(pJob, i);
+        }
+        return;
+    }
+
+#ifdef __LINUX__
+    // The callback thread changes when the sound device is reopened.
+    // Querying the scheduling parameters only then keeps the system call
+    // out of the regular callback.
+    const Qt::HANDLE callbackThreadId = QThread::currentThreadId();
+    if (callbackThreadId != m_callbackThreadId) {
+        m_callbackThreadId = callbackThreadId;
+        struct sched_param param = {0};
+        int policy = SCHED_OTHER;
+        if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+            m_callbackPolicy = policy;
+            m_callbackPriority = param.sched_priority;
+        }
+    }
+#endif
+
+    m_pJobFunction = pJobFunction;
+    m_pJob = pJob;
+    m_numJobs = numJobs;
+    m_nextJob.store(0, std::memory_order_relaxed);
+    m_pendingWorkers.store(numWorkers, std::memory_order_relaxed);
+    m_wakeWorkers.release(numWorkers);
+
+    processJobs();
+    waitForWorkers();
+}
+
+void EngineChannelThreadPool::processJobs() {
+    while (true) {
+        const int index = m_nextJob.fetch_add(1, std::memory_order_relaxed);
+        if (index >= m_numJobs) {
+            return;
+        }
+        m_pJobFunction(m_pJob, index);
+    }
+}
+
+void EngineChannelThreadPool::waitForWorkers() {
+    for (int i = 0; i < kMaxSpinIterations; ++i) {
+        if (m_pendingWorkers.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        cpuRelax();
+    }
+    // A worker is late, probably because it is preempted on our core.
+    // Block until the last worker checks out.
+    const int pending = m_pendingWorkers.fetch_or(
+            kCallbackWaiting, std::memory_order_acq_rel);
+    if (pending == 0) {
+        // All workers checked out in the meantime and none of them has seen
+        // the flag.
+        m_pendingWorkers.store(0, std::memory_order_relaxed);
+        return;
+    }
+    m_workersDone.acquire();
+    DEBUG_ASSERT(m_pendingWorkers.load(std::memory_order_relaxed) == kCallbackWaiting);
+    m_pendingWorkers.store(0, std::memory_order_relaxed);
+}
+
+void EngineChannelThreadPool::checkOutWorker() {
+    const int pending = m_pendingWorkers.fetch_sub(1, std::memory_order_acq_rel);
+    if (pending == (kCallbackWaiting | 1)) {
+        // We are the last worker and the callback thread is blocked
+        m_workersDone.release();
+    }
+}
+
+void EngineChannelThreadPool::workerLoop(int workerIndex) {
+#ifdef __LINUX__
+    // Spread the workers over distinct cores so they don't compete with
+    // each other. The callback thread is owned by the sound API and is not
+    // pinned, so nothing is reserved for it. Skipping the first core only
+    // keeps the workers off the core that is busiest with the rest of the
+    // system.
+    const int numCores = QThread::idealThreadCount();
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET((workerIndex + 1) % numCores, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)) {
+        kLogger.warning() << "Failed to pin worker" << workerIndex << "to a core";
+    }
+#else
+    Q_UNUSED(workerIndex);
+#endif
+
+    int appliedPolicy = kNoPolicy;
+    int appliedPriority = 0;
+    while (true) {
+        m_wakeWorkers.acquire();
+        if (m_quit.load(std::memory_order_acquire)) {
+            return;
+        }
+        adoptCallbackThreadScheduling(&appliedPolicy, &appliedPriority);
+        processJobs();
+        checkOutWorker();
+    }
+}
+
+void EngineChannelThreadPool::adoptCallbackThreadScheduling(
+        int* pAppliedPolicy, int* pAppliedPriority) {
+#ifdef __LINUX__
+    if (m_callbackPolicy == *pAppliedPolicy &&
+            m_callbackPriority == *pAppliedPriority) {
+        return;
+    }
+    *pAppliedPolicy = m_callbackPolicy;
+    *pAppliedPriority = m_callbackPriority;
+    if (m_callbackPolicy != SCHED_FIFO && m_callbackPolicy != SCHED_RR) {
+        // The callback thread is not real-time, e.g. with the network
+        // clock reference or in tests.
+        return;
+    }
+    struct sched_param param = {0};
+    param.sched_priority = m_callbackPriority;
+    if (pthread_setschedparam(pthread_self(), m_callbackPolicy, &param)) {
+        kLogger.warning() << "Failed bumping priority of"
+                          << QThread::currentThread()->objectName();
+    }
+#else
+    Q_UNUSED(pAppliedPolicy);
+    Q_UNUSED(pAppliedPriority);
+#endif
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+class EngineChannelWorkerThread;
+
+/// A pool of threads that processes the channels of one audio callback in
+/// parallel.
+///
+/// The callback thread publishes a batch of jobs with run(), processes jobs
+/// itself and returns once every job is done. Jobs are claimed with an atomic
+/// counter and the join is an atomic countdown barrier, so the callback
+/// thread neither locks nor blocks as long as the workers keep up. Idle
+/// workers sleep on a semaphore between callbacks. Only if the workers fall
+/// far behind does the callback thread block instead of spinning, which
+/// prevents a live lock with a worker that shares its core.
+///
+/// On Linux each worker is pinned to its own core and adopts the real-time
+/// scheduling policy and priority of the callback thread.
+class EngineChannelThreadPool {
+  public:
+    /// The number of threads is limited to the number of cores minus one
+    /// that is left for the callback thread.
+    explicit EngineChannelThreadPool(int numThreads);
+    ~EngineChannelThreadPool();
+
+    int numThreads() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    /// Calls job(index) for every index in [0, numJobs) and returns after
+    /// all calls have finished. The calls are distributed among the workers
+    /// and the calling thread. Must only be called from a single thread.
+    template<typename Job>
+    void run(int numJobs, const Job& job) {
+        runJobs(
+                numJobs,
+                [](const void* pJob, int index) {
+                    (*static_cast<const Job*>(pJob))(index);
+                },
+                &job);
+    }
+
+  private:
+    friend class EngineChannelWorkerThread;
+
+    typedef void (*JobFunction)(const void* pJob, int index);
+
+    void runJobs(int numJobs, JobFunction pJobFunction, const void* pJob);
+    void processJobs();
+    void waitForWorkers();
+
+    // Called by the workers
+    void workerLoop(int workerIndex);
+    void adoptCallbackThreadScheduling(int* pAppliedPolicy, int* pAppliedPriority);
+    void checkOutWorker();
+
+    std::vector<EngineChannelWorkerThread*> m_workers;
+
+    // The current batch. Written by the callback thread before the workers
+    // are woken up, the semaphore orders these writes with the reads of the
+    // workers.
+    JobFunction m_pJobFunction;
+    const void* m_pJob;
+    int m_numJobs;
+    Qt::HANDLE m_callbackThreadId;
+    int m_callbackPolicy;
+    int m_callbackPriority;
+
+    std::atomic<int> m_nextJob;
+    // The number of woken workers that did not check out yet. Each woken
+    // worker must check out before run() returns, otherwise a late worker
+    // could claim a job from the next batch.
+    std::atomic<int> m_pendingWorkers;
+    std::atomic<bool> m_quit;
+
+    QSemaphore m_wakeWorkers;
+    QSemaphore m_workersDone;
+};
@@ -8,9 +8,11 @@
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
+#include "engine/cachingreader/cachingreaderchunk.h"
 #include "engine/channelmixer.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/channels/enginedeck.h"
+#include "engine/enginechannelthreadpool.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginedelay.h"
@@ -24,6 +26,7 @@
 #include "moc_enginemaster.cpp"
 #include "preferences/usersettings.h"
 #include "util/defs.h"
+#include "util/math.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "util/trace.h"
@@ -66,6 +69,24 @@ EngineMaster::EngineMaster(
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
 
+    // Processing the channels in parallel is opt-in. The value is the number
+    // of threads that are used in addition to the callback thread.
+    const int numChannelThreads = pConfig->getValue(
+            ConfigKey(group, "num_channel_threads"), 0);
+    if (numChannelThreads > 0) {
+        m_pChannelThreadPool = new EngineChannelThreadPool(numChannelThreads);
+    } else {
+        m_pChannelThreadPool = nullptr;
+    }
+
+    // The memory budget for growing the chunk pools of the CachingReaders
+    // of all decks, samplers and preview decks.
+    const int chunkMemoryBudgetMB = pConfig->getValue(
+            ConfigKey(group, "cache_memory_budget_mb"),
+            static_cast<int>(CachingReaderChunkBudget::kDefaultLimitBytes / (1024 * 1024)));
+    CachingReaderChunkBudget::setLimitBytes(
+            SINT(math_max(chunkMemoryBudgetMB, 0)) * 1024 * 1024);
+
     // Master sample rate
     m_pMasterSampleRate = new ControlObject(ConfigKey(group, "samplerate"), true, true);
     m_pMasterSampleRate->set(44100.);
@@ -242,6 +263,7 @@ EngineMaster::~EngineMaster() {
     }
 
     delete m_pWorkerScheduler;
+    delete m_pChannelThreadPool;
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -249,6 +271,7 @@ EngineMaster::~EngineMaster() {
         delete pChannelInfo->m_pChannel;
         delete pChannelInfo->m_pVolumeControl;
         delete pChannelInfo->m_pMuteControl;
+        delete pChannelInfo->m_pProcessTimer;
         delete pChannelInfo;
     }
 }
@@ -353,13 +376,42 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
+    if (m_pChannelThreadPool) {
+        // The sync leader and all channels that interact with EngineSync or
+        // other decks are processed serially in the callback thread, leader
+        // first. All independent channels are processed in parallel
+        // afterwards.
+        m_parallelChannels.clear();
+        for (int i = activeChannelsStartIndex;
+                i < m_activeChannels.size(); ++i) {
+            ChannelInfo* pChannelInfo = m_activeChannels[i];
+            const EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+            if (i == 0 || (pBuffer && pBuffer->dependsOnOtherChannels())) {
+                processChannel(pChannelInfo, iBufferSize);
+            } else {
+                m_parallelChannels.append(pChannelInfo);
+            }
+        }
+        m_pChannelThreadPool->run(m_parallelChannels.size(),
+                [this, iBufferSize](int index) {
+                    processChannel(m_parallelChannels[index], iBufferSize);
+                });
+    } else {
+        for (int i = activeChannelsStartIndex;
+                i < m_activeChannels.size(); ++i) {
+            processChannel(m_activeChannels[i], iBufferSize);
+        }
+    }
+
+    // The pre-fader effects share their buffers between channels, so they
+    // are applied serially in the callback thread after all channels have
+    // been processed. Their features are collected for the post-fader
+    // effects afterwards.
     for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
+            i < m_activeChannels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_activeChannels[i];
         EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
+        pChannel->processPreFader(pChannelInfo->m_pBuffer, iBufferSize);
         if (m_pEngineEffectsManager) {
             GroupFeatureState features;
             pChannel->collectFeatures(&features);
@@ -384,6 +436,19 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMaster::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    if (pChannelInfo->m_pProcessTimer) {
+        pChannelInfo->m_pProcessTimer->start();
+    }
+
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+
+    if (pChannelInfo->m_pProcessTimer) {
+        pChannelInfo->m_pProcessTimer->elapsed(true);
+    }
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -808,6 +873,10 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     pChannelInfo->m_pMuteControl->setButtonMode(ControlPushButton::POWERWINDOW);
     pChannelInfo->m_pBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
     SampleUtil::clear(pChannelInfo->m_pBuffer, MAX_BUFFER_LEN);
+    if (CmdlineArgs::Instance().getDeveloper()) {
+        pChannelInfo->m_pProcessTimer = new Timer(
+                QStringLiteral("EngineMaster::processChannel %1").arg(group));
+    }
     m_channels.append(pChannelInfo);
     const GainCache gainCacheDefault = {0, false};
     m_channelHeadphoneGainCache.append(gainCacheDefault);
@@ -823,6 +892,7 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     m_activeBusChannels[EngineChannel::RIGHT].reserve(m_channels.size());
     m_activeHeadphoneChannels.reserve(m_channels.size());
     m_activeTalkoverChannels.reserve(m_channels.size());
+    m_parallelChannels.reserve(m_channels.size());
 
     EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
     if (pBuffer != nullptr) {
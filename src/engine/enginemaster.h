@@ -14,6 +14,7 @@
 #include "recording/recordingmanager.h"
 
 class EngineWorkerScheduler;
+class EngineChannelThreadPool;
 class EngineBuffer;
 class EngineChannel;
 class EngineDeck;
@@ -29,6 +30,7 @@ class GuiTick;
 class EngineSync;
 class EngineTalkoverDucking;
 class EngineDelay;
+class Timer;
 
 // The number of channels to pre-allocate in various structures in the
 // engine. Prevents memory allocation in EngineMaster::addChannel.
@@ -113,6 +115,7 @@ class EngineMaster : public QObject, public AudioSource {
                   m_pBuffer(NULL),
                   m_pVolumeControl(NULL),
                   m_pMuteControl(NULL),
+                  m_pProcessTimer(NULL),
                   m_index(index) {
         }
         ChannelHandle m_handle;
@@ -120,6 +123,9 @@ class EngineMaster : public QObject, public AudioSource {
         CSAMPLE* m_pBuffer;
         ControlObject* m_pVolumeControl;
         ControlPushButton* m_pMuteControl;
+        // Reports the processing time of the channel to the StatsManager.
+        // Only allocated in developer mode.
+        Timer* m_pProcessTimer;
         GroupFeatureState m_features;
         int m_index;
     };
@@ -260,6 +266,9 @@ class EngineMaster : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    // Processes a single channel and collects its features for the effects.
+    // Called concurrently from the channel threads in parallel mode.
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMasterEffects();
@@ -282,6 +291,8 @@ class EngineMaster : public QObject, public AudioSource {
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeBusChannels[3];
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeHeadphoneChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeTalkoverChannels;
+    // The active channels that are processed by the channel thread pool.
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_parallelChannels;
 
     unsigned int m_iSampleRate;
     unsigned int m_iBufferSize;
@@ -295,6 +306,8 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pSidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // Only created if parallel channel processing is enabled.
+    EngineChannelThreadPool* m_pChannelThreadPool;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -19,7 +19,7 @@ EngineWorkerScheduler::~EngineWorkerScheduler() {
 }
 
 void EngineWorkerScheduler::workerReady() {
-    m_bWakeScheduler = true;
+    m_bWakeScheduler.store(true, std::memory_order_relaxed);
 }
 
 void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
@@ -30,10 +30,10 @@ void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
 
 void EngineWorkerScheduler::runWorkers() {
     // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
+    // scheduler. workerReady may be called from the channel processing
+    // threads, but those have been joined before runWorkers is called from
+    // the callback thread.
+    if (m_bWakeScheduler.exchange(false, std::memory_order_relaxed)) {
         m_waitCondition.wakeAll();
     }
 }
@@ -3,6 +3,7 @@
 #include <QMutex>
 #include <QThreadPool>
 #include <QWaitCondition>
+#include <atomic>
 
 #include "util/fifo.h"
 
@@ -27,8 +28,9 @@ class EngineWorkerScheduler : public QThread {
 
   private:
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run. This is only touched from the engine callback and
+    // the threads that process the engine channels on its behalf.
+    std::atomic<bool> m_bWakeScheduler;
 
     std::vector<EngineWorker*> m_workers;
 
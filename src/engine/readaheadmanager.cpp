@@ -211,7 +211,7 @@ void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     }
 
     // top priority, we need to read this data immediately
-    current_position.priority = 1;
+    current_position.priority = Hint::kPriorityImmediate;
     pHintList->append(current_position);
 }
 
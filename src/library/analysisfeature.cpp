@@ -40,6 +40,10 @@ AnalyzerModeFlags getAnalyzerModeFlags(
     if (pConfig->getValue<bool>(ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"), true)) {
         modeFlags |= AnalyzerModeFlags::WithWaveform;
     }
+    // Idle analyzer threads help analyzing the last tracks of a batch
+    if (pConfig->getValue<bool>(ConfigKey("[Library]", "AnalyzerParallelStages"), true)) {
+        modeFlags |= AnalyzerModeFlags::ParallelStages;
+    }
     return static_cast<AnalyzerModeFlags>(modeFlags);
 }
 
@@ -147,6 +151,10 @@ void AnalysisFeature::analyzeTracks(const QList<TrackId>& trackIds) {
                 &TrackAnalysisScheduler::progress,
                 m_pAnalysisView,
                 &DlgAnalysis::onTrackAnalysisSchedulerProgress);
+        connect(m_pTrackAnalysisScheduler.get(),
+                &TrackAnalysisScheduler::statistics,
+                m_pAnalysisView,
+                &DlgAnalysis::onTrackAnalysisSchedulerStatistics);
         connect(m_pTrackAnalysisScheduler.get(),
                 &TrackAnalysisScheduler::finished,
                 m_pAnalysisView,
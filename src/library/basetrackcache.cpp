@@ -1,5 +1,7 @@
 #include "library/basetrackcache.h"
 
+#include <algorithm>
+
 #include "library/queryutil.h"
 #include "library/searchqueryparser.h"
 #include "library/trackcollection.h"
@@ -29,6 +31,7 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_pQueryParser(new SearchQueryParser(pTrackCollection)),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_columnIndexKeyNotation(m_columnCache.keyNotation()),
           m_database(pTrackCollection->database()) {
     m_searchColumns << "artist"
                     << "album"
@@ -46,6 +49,90 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
     for (int i = 0; i < m_searchColumns.size(); ++i) {
         m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
     }
+
+    // Resolve how each column is sorted once instead of for every
+    // comparison
+    m_sortTypes.fill(SortType::Text, m_columnCount);
+    const ColumnCache::Column numericColumns[] = {
+            ColumnCache::COLUMN_LIBRARYTABLE_YEAR,
+            ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER,
+            ColumnCache::COLUMN_LIBRARYTABLE_DURATION,
+            ColumnCache::COLUMN_LIBRARYTABLE_BITRATE,
+            ColumnCache::COLUMN_LIBRARYTABLE_BPM,
+            ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN,
+            ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE,
+            ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS,
+            ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED,
+            ColumnCache::COLUMN_LIBRARYTABLE_RATING,
+            ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION,
+    };
+    for (const auto column : numericColumns) {
+        const int field = fieldIndex(column);
+        if (field >= 0 && field < m_sortTypes.size()) {
+            m_sortTypes[field] = SortType::Numeric;
+        }
+    }
+    const int keyField = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY);
+    if (keyField >= 0 && keyField < m_sortTypes.size()) {
+        m_sortTypes[keyField] = SortType::Key;
+    }
+
+    initColumnIndex();
+}
+
+void BaseTrackCache::initColumnIndex() {
+    const auto addColumn = [this](ColumnCache::Column column, int types) {
+        const int field = fieldIndex(column);
+        if (field < 0) {
+            return;
+        }
+        // Plain text is sorted by the collation keys of the index, which
+        // agree with m_collator. Keys need to be sorted like the dirty
+        // tracks are inserted by findSortInsertionPoint().
+        TrackColumnIndex::TextComparator textComparator;
+        if (m_sortTypes.value(field) == SortType::Key) {
+            textComparator = [this, field](const QString& lhs, const QString& rhs) {
+                return compareColumnValues(
+                        field, Qt::AscendingOrder, lhs, rhs);
+            };
+        }
+        m_columnIndex.addColumn(
+                columnNameForFieldIndex(field),
+                field,
+                types,
+                std::move(textComparator));
+    };
+    // Most searches are substring matches of these columns
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_ARTIST, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_TITLE, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_ALBUM, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_ALBUMARTIST, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_GENRE, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_COMPOSER, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_GROUPING, TrackColumnIndex::NGramTextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_COMMENT, TrackColumnIndex::NGramTextColumn);
+    // Almost every location is unique
+    addColumn(ColumnCache::COLUMN_TRACKLOCATIONSTABLE_LOCATION, TrackColumnIndex::TextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_KEY, TrackColumnIndex::TextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_FILETYPE, TrackColumnIndex::TextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_DATETIMEADDED, TrackColumnIndex::TextColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_LAST_PLAYED_AT, TrackColumnIndex::TextColumn);
+    // Sorted as text like lower(year) by the database. Numeric filters
+    // of the year are left to the database.
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_YEAR, TrackColumnIndex::TextColumn);
+    // Sorted like cast(tracknumber as integer) by the database. Numeric
+    // filters compare the text instead and are left to the database.
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER,
+            TrackColumnIndex::TextColumn | TrackColumnIndex::LeadingIntegerColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_DURATION, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_BPM, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_RATING, TrackColumnIndex::NumericColumn);
+    addColumn(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID, TrackColumnIndex::NumericColumn);
 }
 
 BaseTrackCache::~BaseTrackCache() {
@@ -93,6 +180,7 @@ void BaseTrackCache::slotTracksRemoved(const QSet<TrackId>& trackIds) {
     }
     for (const auto& trackId : qAsConst(trackIds)) {
         m_trackInfo.remove(trackId);
+        m_columnIndex.removeRow(trackId);
         m_dirtyTracks.remove(trackId);
     }
 }
@@ -227,6 +315,7 @@ bool BaseTrackCache::updateTrackInIndex(
         for (int i = 0; i < numColumns; ++i) {
             getTrackValueForColumn(pTrack, i, record[i]);
         }
+        m_columnIndex.updateRow(trackId, record);
         if (m_bIsCaching) {
             replaceRecentTrack(std::move(trackId), std::move(pTrack));
         }
@@ -282,6 +371,7 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
                 record[i] = query.value(i);
             }
         }
+        m_columnIndex.updateRow(trackId, record);
     }
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
@@ -304,6 +394,7 @@ void BaseTrackCache::buildIndex() {
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
     m_trackInfo.clear();
+    m_columnIndex.clear();
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -471,72 +562,81 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
     // TODO(rryan) consider making this the data passed in and a separate
     // QVector for output
     QSet<TrackId> dirtyTracks;
     for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
 
-    QStringList queryFragments;
-    if (!extraFilter.isNull() && extraFilter != "") {
-        queryFragments << QString("(%1)").arg(extraFilter);
-    }
-    if (idStrings.size() > 0) {
-        queryFragments << QString("%1 in (%2)")
-                .arg(m_idColumn, idStrings.join(","));
-    }
-
+    // The extra filter is an SQL expression that can only be
+    // evaluated by the database.
     const std::unique_ptr<QueryNode> pQuery =
             m_pQueryParser->parseQuery(
                     searchQuery,
                     m_searchColumns,
-                    queryFragments.join(" AND "));
+                    extraFilter);
 
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
-    }
+    m_trackOrder.resize(0); // keeps allocated memory
+    trackToIndex->clear();
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
+    if (!filterAndSortInIndex(trackIds, *pQuery, orderByClause, sortColumns, columnOffset)) {
+        QStringList idStrings;
+        for (const auto& trackId: trackIds) {
+            idStrings << trackId.toString();
+        }
+        QStringList queryFragments;
+        if (idStrings.size() > 0) {
+            queryFragments << QString("%1 in (%2)")
+                    .arg(m_idColumn, idStrings.join(","));
+        }
+        const QString querySql = pQuery->toSql();
+        if (!querySql.isEmpty()) {
+            queryFragments << QString("(%1)").arg(querySql);
+        }
+        QString filter = queryFragments.join(" AND ");
+        if (!filter.isEmpty()) {
+            filter.prepend("WHERE ");
+        }
 
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
+        QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+                .arg(m_idColumn, m_tableName, filter, orderByClause);
 
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
+        if (sDebug) {
+            qDebug() << this << "select() executing:" << queryString;
+        }
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+        QSqlQuery query(m_database);
+        // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+        // won't allocate a giant in-memory table that we won't use at all.
+        query.setForwardOnly(true);
+        query.prepare(queryString);
 
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
 
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
-    }
+        int idColumn = query.record().indexOf(m_idColumn);
+        int rows = query.size();
 
-    m_trackOrder.resize(0); // keeps allocated memory
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
+        if (sDebug) {
+            qDebug() << "Rows returned:" << rows;
+        }
+
+        if (rows > 0) {
+            m_trackOrder.reserve(rows);
+        }
+
+        while (query.next()) {
+            m_trackOrder.append(TrackId(query.value(idColumn)));
+        }
     }
 
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -552,6 +652,16 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         return;
     }
 
+    // Only the dirty tracks are repositioned. Their values in m_trackInfo
+    // might be outdated, so they are removed from the sorted tracks first
+    // and then merged back at the positions of their current values.
+    struct InsertTrack {
+        TrackId trackId;
+        QVector<QVariant> sortValues;
+        int insertRow;
+    };
+    std::vector<InsertTrack> insertTracks;
+    QSet<TrackId> removeTrackIds;
     for (TrackId trackId: qAsConst(dirtyTracks)) {
         // Only get the track if it is in the cache. Tracks that
         // are not cached in memory cannot be dirty.
@@ -566,67 +676,191 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         bool shouldBeInResultSet = searchQuery.isEmpty() ||
                 pQuery->match(pTrack);
 
-        // If the track is in this result set.
-        bool isInResultSet = trackToIndex->contains(trackId);
-
-        if (shouldBeInResultSet) {
-            // Track should be in result set...
-
+        if (trackToIndex->contains(trackId)) {
             // Remove the track from the results first (we have to do this or it
             // will sort wrong).
-            if (isInResultSet) {
-                int index = (*trackToIndex)[trackId];
-                m_trackOrder.remove(index);
-                // Don't update trackToIndex, since we do it below.
+            removeTrackIds.insert(trackId);
+        }
+        if (shouldBeInResultSet) {
+            QVector<QVariant> sortValues;
+            sortValues.reserve(sortColumns.size());
+            for (const auto& sc : sortColumns) {
+                QVariant trackValue;
+                getTrackValueForColumn(pTrack, sc.m_column - columnOffset, trackValue);
+                sortValues.append(trackValue);
             }
+            insertTracks.push_back(InsertTrack{trackId, std::move(sortValues), 0});
+        }
+    }
+    if (removeTrackIds.isEmpty() && insertTracks.empty()) {
+        return;
+    }
+
+    if (!removeTrackIds.isEmpty()) {
+        m_trackOrder.erase(
+                std::remove_if(m_trackOrder.begin(),
+                        m_trackOrder.end(),
+                        [&removeTrackIds](TrackId trackId) {
+                            return removeTrackIds.contains(trackId);
+                        }),
+                m_trackOrder.end());
+    }
+
+    // Figure out where each track is supposed to sort. The table is sorted
+    // by the sort columns, so we can binary search.
+    for (auto& insertTrack : insertTracks) {
+        insertTrack.insertRow = findSortInsertionPoint(
+                insertTrack.sortValues, sortColumns, columnOffset, m_trackOrder);
+        if (sDebug) {
+            qDebug() << this
+                     << "Insertion sort says it should be inserted at:"
+                     << insertTrack.insertRow;
+        }
+    }
+    // Tracks that sort at the same row are ordered among each other
+    std::stable_sort(insertTracks.begin(),
+            insertTracks.end(),
+            [this, &sortColumns, columnOffset](
+                    const InsertTrack& lhs, const InsertTrack& rhs) {
+                if (lhs.insertRow != rhs.insertRow) {
+                    return lhs.insertRow < rhs.insertRow;
+                }
+                for (int i = 0; i < sortColumns.size(); ++i) {
+                    const int compare = compareColumnValues(
+                            sortColumns[i].m_column - columnOffset,
+                            sortColumns[i].m_order,
+                            lhs.sortValues[i],
+                            rhs.sortValues[i]);
+                    if (compare != 0) {
+                        return compare < 0;
+                    }
+                }
+                return false;
+            });
+
+    // Merge the tracks in a single pass
+    QVector<TrackId> trackOrder;
+    trackOrder.reserve(m_trackOrder.size() + static_cast<int>(insertTracks.size()));
+    auto insertTrack = insertTracks.cbegin();
+    for (int row = 0; row <= m_trackOrder.size(); ++row) {
+        while (insertTrack != insertTracks.cend() && insertTrack->insertRow == row) {
+            trackOrder.append(insertTrack->trackId);
+            ++insertTrack;
+        }
+        if (row < m_trackOrder.size()) {
+            trackOrder.append(m_trackOrder[row]);
+        }
+    }
+    m_trackOrder.swap(trackOrder);
 
-            // Figure out where it is supposed to sort. The table is sorted by
-            // the sort column, so we can binary search.
-            int insertRow = findSortInsertionPoint(
-                    pTrack, sortColumns, columnOffset, m_trackOrder);
+    trackToIndex->clear();
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
+    }
+}
+
+bool BaseTrackCache::filterAndSortInIndex(const QSet<TrackId>& trackIds,
+        const QueryNode& query,
+        const QString& orderByClause,
+        const QList<SortColumn>& sortColumns,
+        int columnOffset) {
+    PerformanceTimer timer;
+    timer.start();
 
-            if (sDebug) {
-                qDebug() << this
-                         << "Insertion sort says it should be inserted at:"
-                         << insertRow;
+    // All sort columns need to be indexed. Otherwise the database
+    // needs to sort, e.g. by the id or randomly.
+    QVector<int> sortIndexColumns;
+    if (!orderByClause.isEmpty()) {
+        for (const auto& sc : sortColumns) {
+            const int column = m_columnIndex.columnForField(sc.m_column - columnOffset);
+            if (column < 0) {
+                return false;
             }
+            sortIndexColumns.append(column);
+        }
+    }
 
-            // The track should sort at insertRow
-            m_trackOrder.insert(insertRow, trackId);
+    TrackColumnIndex::RowMask matches;
+    if (!query.matchIndex(m_columnIndex, &matches)) {
+        return false;
+    }
 
-            trackToIndex->clear();
-            // Fix the index. TODO(rryan) find a non-stupid way to do this.
-            for (int i = 0; i < m_trackOrder.size(); ++i) {
-                (*trackToIndex)[m_trackOrder[i]] = i;
+    // Restrict the matches to the given tracks
+    TrackColumnIndex::RowMask candidates = m_columnIndex.emptyMask();
+    for (const auto& trackId : trackIds) {
+        const auto row = m_columnIndex.row(trackId);
+        if (row < 0) {
+            // Not (yet) indexed. Let the database decide.
+            return false;
+        }
+        candidates[row] = matches[row];
+    }
+
+    const int keyColumn = m_columnIndex.columnForField(
+            fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY));
+    if (keyColumn >= 0 && m_columnIndexKeyNotation != m_columnCache.keyNotation()) {
+        m_columnIndexKeyNotation = m_columnCache.keyNotation();
+        m_columnIndex.invalidateSortOrder(keyColumn);
+    }
+
+    if (sortIndexColumns.isEmpty()) {
+        for (int row = 0; row < m_columnIndex.rowCount(); ++row) {
+            if (candidates[row]) {
+                m_trackOrder.append(m_columnIndex.trackId(row));
+            }
+        }
+    } else if (sortIndexColumns.size() == 1) {
+        // Pick the matches from the presorted rows
+        const auto& sortedRows = m_columnIndex.sortedRows(sortIndexColumns.first());
+        if (sortColumns.first().m_order == Qt::AscendingOrder) {
+            for (auto it = sortedRows.begin(); it != sortedRows.end(); ++it) {
+                if (candidates[*it]) {
+                    m_trackOrder.append(m_columnIndex.trackId(*it));
+                }
             }
-        } else if (isInResultSet) {
-            // Track should not be in this result set, but it is. We need to
-            // remove it.
-            int index = (*trackToIndex)[trackId];
-            m_trackOrder.remove(index);
-
-            trackToIndex->clear();
-            // Fix the index. TODO(rryan) find a non-stupid way to do this.
-            for (int i = 0; i < m_trackOrder.size(); ++i) {
-                (*trackToIndex)[m_trackOrder[i]] = i;
+        } else {
+            for (auto it = sortedRows.rbegin(); it != sortedRows.rend(); ++it) {
+                if (candidates[*it]) {
+                    m_trackOrder.append(m_columnIndex.trackId(*it));
+                }
+            }
+        }
+    } else {
+        // Compare the precomputed ranks of all sort columns
+        std::vector<TrackColumnIndex::ColumnOrder> columnOrders;
+        columnOrders.reserve(sortIndexColumns.size());
+        for (int i = 0; i < sortIndexColumns.size(); ++i) {
+            columnOrders.push_back(TrackColumnIndex::ColumnOrder{
+                    sortIndexColumns[i], sortColumns[i].m_order});
+        }
+        std::vector<TrackColumnIndex::Row> rows;
+        for (int row = 0; row < m_columnIndex.rowCount(); ++row) {
+            if (candidates[row]) {
+                rows.push_back(row);
             }
         }
+        m_columnIndex.sortRows(&rows, columnOrders);
+        m_trackOrder.reserve(static_cast<int>(rows.size()));
+        for (const auto row : rows) {
+            m_trackOrder.append(m_columnIndex.trackId(row));
+        }
     }
+
+    if (sDebug) {
+        qDebug() << this << "filterAndSortInIndex took"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
 }
 
-int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
+int BaseTrackCache::findSortInsertionPoint(const QVector<QVariant>& trackValues,
         const QList<SortColumn>& sortColumns,
         const int columnOffset,
         const QVector<TrackId>& trackIds) const {
-    QList<QVariant> trackValues;
     if (sortColumns.isEmpty()) {
         return 0;
     }
-    for (const auto& sc: sortColumns) {
-        QVariant trackValue;
-        getTrackValueForColumn(pTrack, sc.m_column - columnOffset, trackValue);
-        trackValues.append(trackValue);
-    }
 
     int min = 0;
     int max = trackIds.size() - 1;
@@ -685,18 +919,8 @@ int BaseTrackCache::compareColumnValues(int sortColumn,
         const QVariant& val2) const {
     int result = 0;
 
-    if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION)
-    ) {
+    const SortType sortType = m_sortTypes.value(sortColumn, SortType::Text);
+    if (sortType == SortType::Numeric) {
         // Sort as floats.
         double delta = val1.toDouble() - val2.toDouble();
 
@@ -707,7 +931,7 @@ int BaseTrackCache::compareColumnValues(int sortColumn,
         } else {
             result = -1;
         }
-    } else if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+    } else if (sortType == SortType::Key) {
         KeyUtils::KeyNotation keyNotation = m_columnCache.keyNotation();
 
         int key1 = KeyUtils::keyToCircleOfFifthsOrder(
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <gtest/gtest_prod.h>
+
 #include <QHash>
 #include <QList>
 #include <QObject>
@@ -11,11 +13,13 @@
 #include <memory>
 
 #include "library/columncache.h"
+#include "library/trackcolumnindex.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/class.h"
 #include "util/string.h"
 
+class QueryNode;
 class SearchQueryParser;
 class TrackCollection;
 
@@ -87,6 +91,11 @@ class BaseTrackCache : public QObject {
     void slotTrackClean(TrackId trackId);
 
   private:
+    FRIEND_TEST(BaseTrackCacheTest, IndexAgreesWithDatabase);
+    FRIEND_TEST(BaseTrackCacheTest, NumericTextFiltersFallBackToDatabase);
+
+    void initColumnIndex();
+
     const TrackPointer& getRecentTrack(TrackId trackId) const;
     void replaceRecentTrack(TrackPointer pTrack) const;
     void replaceRecentTrack(TrackId trackId, TrackPointer pTrack) const;
@@ -99,10 +108,25 @@ class BaseTrackCache : public QObject {
     void getTrackValueForColumn(TrackPointer pTrack, int column,
                                 QVariant& trackValue) const;
 
-    int findSortInsertionPoint(TrackPointer pTrack,
+    // Filters and sorts the tracks in memory by m_columnIndex. Returns
+    // false if the query or the sort order requires the database.
+    bool filterAndSortInIndex(const QSet<TrackId>& trackIds,
+            const QueryNode& query,
+            const QString& orderByClause,
+            const QList<SortColumn>& sortColumns,
+            int columnOffset);
+
+    int findSortInsertionPoint(const QVector<QVariant>& trackValues,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
                                const QVector<TrackId>& trackIds) const;
+
+    enum class SortType {
+        Text,
+        Numeric,
+        Key,
+    };
+
     int compareColumnValues(int sortColumn,
             Qt::SortOrder sortOrder,
             const QVariant& val1,
@@ -126,6 +150,9 @@ class BaseTrackCache : public QObject {
 
     const mixxx::StringCollator m_collator;
 
+    // How the values of each field are compared
+    QVector<SortType> m_sortTypes;
+
     QStringList m_searchColumns;
     QVector<int> m_searchColumnIndices;
 
@@ -148,6 +175,11 @@ class BaseTrackCache : public QObject {
     bool m_bIndexBuilt;
     bool m_bIsCaching;
     QHash<TrackId, QVector<QVariant> > m_trackInfo;
+    // Mirrors the searchable and sortable columns of m_trackInfo
+    TrackColumnIndex m_columnIndex;
+    // The key notation that the key column of m_columnIndex has been
+    // sorted with
+    KeyUtils::KeyNotation m_columnIndexKeyNotation;
     QSqlDatabase m_database;
 
     DISALLOW_COPY_AND_ASSIGN(BaseTrackCache);
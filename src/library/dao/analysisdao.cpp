@@ -1,3 +1,5 @@
+#include <QBuffer>
+#include <QSaveFile>
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QSqlError>
@@ -6,6 +8,7 @@
 #include "library/dao/analysisdao.h"
 #include "library/queryutil.h"
 #include "preferences/waveformsettings.h"
+#include "util/assert.h"
 #include "util/performancetimer.h"
 #include "waveform/waveform.h"
 
@@ -74,6 +77,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
     const int dataChecksumColumn = queryRecord.indexOf("data_checksum");
 
     QDir analysisPath(getAnalysisStoragePath());
+    QList<int> legacyWaveforms;
     while (query->next()) {
         AnalysisDao::AnalysisInfo info;
         info.analysisId = query->value(idColumn).toInt();
@@ -84,6 +88,26 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         int checksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
+
+        // Only the header of a WaveformFile is read here, the waveform
+        // is mapped later on.
+        QFile file(dataPath);
+        if (file.open(QIODevice::ReadOnly)) {
+            int headerChecksum = WaveformFile::headerChecksum(&file);
+            if (headerChecksum != -1) {
+                if (checksum != headerChecksum) {
+                    qDebug() << "WARNING: Corrupt analysis header loaded from"
+                             << dataPath;
+                    continue;
+                }
+                info.dataFormat = DataFormat::WaveformFile;
+                info.dataPath = dataPath;
+                bytes += file.size();
+                analyses.append(info);
+                continue;
+            }
+        }
+
         QByteArray compressedData = loadDataFromFile(dataPath);
         int file_checksum = qChecksum(compressedData.constData(),
                                       compressedData.length());
@@ -94,8 +118,16 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         }
         info.data = qUncompress(compressedData);
         bytes += info.data.length();
+        if (info.type == TYPE_WAVEFORM || info.type == TYPE_WAVESUMMARY) {
+            legacyWaveforms.append(analyses.size());
+        }
         analyses.append(info);
     }
+    // Migrate after the query is done, since the analyses are updated
+    query->finish();
+    for (int i : legacyWaveforms) {
+        migrateToWaveformFile(&analyses[i]);
+    }
     qDebug() << "AnalysisDAO fetched" << analyses.size() << "analyses,"
              << bytes << "bytes for track"
              << trackId << "in" << time.elapsed().debugMillisWithUnit();
@@ -114,9 +146,22 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     PerformanceTimer time;
     time.start();
 
-    QByteArray compressedData = qCompress(info->data, kCompressionLevel);
-    int checksum = qChecksum(compressedData.constData(),
-                             compressedData.length());
+    QByteArray storedData;
+    int checksum;
+    if (info->dataFormat == DataFormat::WaveformFile) {
+        storedData = info->data;
+        QBuffer buffer(&storedData);
+        buffer.open(QIODevice::ReadOnly);
+        checksum = WaveformFile::headerChecksum(&buffer);
+        VERIFY_OR_DEBUG_ASSERT(checksum != -1) {
+            qDebug() << "Can't save analysis since it is not a valid waveform file.";
+            return false;
+        }
+    } else {
+        storedData = qCompress(info->data, kCompressionLevel);
+        checksum = qChecksum(storedData.constData(),
+                             storedData.length());
+    }
 
     QSqlQuery query(m_database);
     if (info->analysisId == -1) {
@@ -161,14 +206,14 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
 
     QString dataPath = getAnalysisStoragePath().absoluteFilePath(
         QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
+    if (!saveDataToFile(dataPath, storedData)) {
         qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
         return false;
     }
 
     qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
+             << QString("%1 (%2 stored)").arg(QString::number(info->data.length()),
+                                              QString::number(storedData.length()))
              << "bytes for track"
              << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
     return true;
@@ -268,40 +313,19 @@ bool AnalysisDao::deleteFile(const QString& fileName) const {
 }
 
 bool AnalysisDao::saveDataToFile(const QString& fileName, const QByteArray& data) const {
-    QFile file(fileName);
-
-    // If the file exists, do the right thing. Write to a temp file, unlink the
-    // existing file, and then move the temp file to the real file's name.
-    if (file.exists()) {
-        QString tempFileName = fileName + ".tmp";
-        QFile tempFile(tempFileName);
-        if (!tempFile.open(QIODevice::WriteOnly)) {
-            return false;
-        }
-        int bytesWritten = tempFile.write(data);
-        if (bytesWritten == -1 || bytesWritten != data.length()) {
-            return false;
-        }
-        tempFile.close();
-        if (!file.remove()) {
-            return false;
-        }
-        if (!tempFile.rename(fileName)) {
-            return false;
-        }
-        return true;
-    }
-
-    // If the file doesn't exist, just create a new file and write the data.
+    // QSaveFile writes to a temporary file and only replaces the existing
+    // file after all data has been written. A WaveformFile that contains
+    // its end marker has therefore been written completely.
+    QSaveFile file(fileName);
     if (!file.open(QIODevice::WriteOnly)) {
         return false;
     }
-    int bytesWritten = file.write(data);
-    if (bytesWritten == -1 || bytesWritten != data.length()) {
+    const qint64 bytesWritten = file.write(data);
+    if (bytesWritten != data.length()) {
+        file.cancelWriting();
         return false;
     }
-    file.close();
-    return true;
+    return file.commit();
 }
 
 void AnalysisDao::saveTrackAnalyses(
@@ -329,7 +353,8 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
+    analysis.dataFormat = DataFormat::WaveformFile;
+    analysis.data = WaveformFile::toByteArray(*pWaveform, waveformFileCompression());
     bool success = saveAnalysis(&analysis);
     if (success) {
         pWaveform->setSaveState(Waveform::SaveState::Saved);
@@ -344,7 +369,7 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
+    analysis.data = WaveformFile::toByteArray(*pWaveSummary, waveformFileCompression());
 
     success = saveAnalysis(&analysis);
     if (success) {
@@ -355,6 +380,32 @@ void AnalysisDao::saveTrackAnalyses(
              << "analysisId" << analysis.analysisId;
 }
 
+void AnalysisDao::migrateToWaveformFile(AnalysisInfo* pInfo) {
+    const Waveform waveform(pInfo->data);
+    if (!waveform.isValid()) {
+        return;
+    }
+    AnalysisInfo migrated = *pInfo;
+    migrated.dataFormat = DataFormat::WaveformFile;
+    migrated.data = WaveformFile::toByteArray(waveform, waveformFileCompression());
+    if (!saveAnalysis(&migrated)) {
+        qDebug() << "WARNING: Failed to migrate analysis" << pInfo->analysisId
+                 << "to a waveform file";
+        return;
+    }
+    pInfo->dataFormat = DataFormat::WaveformFile;
+    pInfo->data.clear();
+    pInfo->dataPath = getAnalysisStoragePath().absoluteFilePath(
+            QString::number(pInfo->analysisId));
+}
+
+WaveformFile::Compression AnalysisDao::waveformFileCompression() const {
+    WaveformSettings waveformSettings(m_pConfig);
+    return waveformSettings.waveformCacheCompressionEnabled()
+            ? WaveformFile::Compression::Zlib
+            : WaveformFile::Compression::None;
+}
+
 size_t AnalysisDao::getDiskUsageInBytes(
         const QSqlDatabase& database,
         AnalysisType type) const {
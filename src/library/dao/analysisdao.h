@@ -8,6 +8,7 @@
 #include "library/dao/dao.h"
 #include "track/trackid.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformfile.h"
 
 class AnalysisDao : public DAO {
   public:
@@ -19,17 +20,28 @@ class AnalysisDao : public DAO {
         TYPE_WAVESUMMARY
     };
 
+    enum class DataFormat {
+        // The data is compressed with qCompress() when stored
+        Compressed,
+        // The data is a WaveformFile that is stored as is. It is not
+        // loaded into data but mapped from dataPath on demand.
+        WaveformFile,
+    };
+
     struct AnalysisInfo {
         AnalysisInfo()
                 : analysisId(-1),
-                  type(TYPE_UNKNOWN) {
+                  type(TYPE_UNKNOWN),
+                  dataFormat(DataFormat::Compressed) {
         }
         int analysisId;
         TrackId trackId;
         AnalysisType type;
         QString description;
         QString version;
+        DataFormat dataFormat;
         QByteArray data;
+        QString dataPath;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -63,6 +75,10 @@ class AnalysisDao : public DAO {
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
     bool deleteFile(const QString& filename) const;
     QList<AnalysisInfo> loadAnalysesFromQuery(TrackId trackId, QSqlQuery* query);
+    // Stores a waveform analysis that has been loaded from a qCompress()'d
+    // protobuf as a WaveformFile
+    void migrateToWaveformFile(AnalysisInfo* pInfo);
+    WaveformFile::Compression waveformFileCompression() const;
 
     const UserSettingsPointer m_pConfig;
 };
@@ -3,6 +3,7 @@
 #include <QSqlDatabase>
 
 #include "util/assert.h"
+#include "util/db/sqlstatementcache.h"
 
 class DAO {
   public:
@@ -11,6 +12,13 @@ class DAO {
     virtual void initialize(const QSqlDatabase& database) {
         DEBUG_ASSERT(!m_database.isOpen());
         m_database = database;
+        m_statementCache.setDatabase(database);
+    }
+
+    // Releases the connection and the statements prepared for it
+    void disconnectDatabase() {
+        m_statementCache.setDatabase(QSqlDatabase());
+        m_database = QSqlDatabase();
     }
 
     const QSqlDatabase& database() const {
@@ -19,4 +27,8 @@ class DAO {
 
   protected:
     QSqlDatabase m_database;
+
+    // Frequently executed statements of the DAO are only prepared once.
+    // Queries from the cache must be finished with SqlQueryFinisher.
+    mutable SqlStatementCache m_statementCache;
 };
@@ -12,6 +12,7 @@
 #include "track/track.h"
 #include "util/compatibility.h"
 #include "util/db/fwdsqlquery.h"
+#include "util/db/sqlqueryfinisher.h"
 #include "util/math.h"
 
 PlaylistDAO::PlaylistDAO()
@@ -113,9 +114,9 @@ int PlaylistDAO::createUniquePlaylist(QString* pName, const HiddenType hidden) {
 QString PlaylistDAO::getPlaylistName(const int playlistId) const {
     //qDebug() << "PlaylistDAO::getPlaylistName" << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT name FROM Playlists WHERE id= :id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":id", playlistId);
 
     if (!query.exec()) {
@@ -135,10 +136,10 @@ QString PlaylistDAO::getPlaylistName(const int playlistId) const {
 QList<TrackId> PlaylistDAO::getTrackIds(const int playlistId) const {
     QList<TrackId> trackIds;
 
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT DISTINCT track_id FROM PlaylistTracks "
             "WHERE playlist_id = :id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -155,9 +156,9 @@ QList<TrackId> PlaylistDAO::getTrackIds(const int playlistId) const {
 int PlaylistDAO::getPlaylistIdFromName(const QString& name) const {
     //qDebug() << "PlaylistDAO::getPlaylistIdFromName" << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT id FROM Playlists WHERE name = :name"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":name", name);
     if (query.exec()) {
         if (query.next()) {
@@ -306,9 +307,9 @@ bool PlaylistDAO::setPlaylistLocked(const int playlistId, const bool locked) {
 }
 
 bool PlaylistDAO::isPlaylistLocked(const int playlistId) const {
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT locked FROM Playlists WHERE id = :id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":id", playlistId);
 
     if (query.exec()) {
@@ -432,9 +433,9 @@ PlaylistDAO::HiddenType PlaylistDAO::getHiddenType(const int playlistId) const {
     // qDebug() << "PlaylistDAO::getHiddenType"
     //          << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT hidden FROM Playlists WHERE id = :id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":id", playlistId);
 
     if (query.exec()) {
@@ -542,45 +543,50 @@ void PlaylistDAO::removeTracksFromPlaylist(int playlistId, const QList<int>& pos
 }
 
 void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
-            "SELECT track_id FROM PlaylistTracks "
-            "WHERE playlist_id=:id AND position=:position"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    TrackId trackId;
+    {
+        QSqlQuery query = m_statementCache.prepare(QStringLiteral(
+                "SELECT track_id FROM PlaylistTracks "
+                "WHERE playlist_id=:id AND position=:position"));
+        const SqlQueryFinisher finisher(query);
+        query.bindValue(":id", playlistId);
+        query.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
-    }
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return;
+        }
 
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
-        return;
+        if (!query.next()) {
+            qDebug() << "removeTrackFromPlaylist no track exists at position:"
+                     << position << "in playlist:" << playlistId;
+            return;
+        }
+        trackId = TrackId(query.value(query.record().indexOf("track_id")));
     }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
 
     // Delete the track from the playlist.
-    query.prepare(QStringLiteral(
+    QSqlQuery deleteQuery = m_statementCache.prepare(QStringLiteral(
             "DELETE FROM PlaylistTracks "
             "WHERE playlist_id=:id AND position=:position"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    const SqlQueryFinisher deleteFinisher(deleteQuery);
+    deleteQuery.bindValue(":id", playlistId);
+    deleteQuery.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!deleteQuery.exec()) {
+        LOG_FAILED_QUERY(deleteQuery);
         return;
     }
 
-    query.prepare(QStringLiteral(
+    QSqlQuery updateQuery = m_statementCache.prepare(QStringLiteral(
             "UPDATE PlaylistTracks SET position=position-1 "
             "WHERE position>=:position AND playlist_id=:id"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    const SqlQueryFinisher updateFinisher(updateQuery);
+    updateQuery.bindValue(":id", playlistId);
+    updateQuery.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!updateQuery.exec()) {
+        LOG_FAILED_QUERY(updateQuery);
     }
 
     m_playlistsTrackIsIn.remove(trackId, playlistId);
@@ -605,28 +611,29 @@ bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId,
     }
 
     // Move all the tracks in the playlist up by one
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery updateQuery = m_statementCache.prepare(QStringLiteral(
             "UPDATE PlaylistTracks SET position=position+1 "
             "WHERE position>=:position AND playlist_id=:id"));
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    const SqlQueryFinisher updateFinisher(updateQuery);
+    updateQuery.bindValue(":id", playlistId);
+    updateQuery.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!updateQuery.exec()) {
+        LOG_FAILED_QUERY(updateQuery);
         return false;
     }
 
     //Insert the song into the PlaylistTracks table
-    query.prepare(QStringLiteral(
+    QSqlQuery insertQuery = m_statementCache.prepare(QStringLiteral(
             "INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
             "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)"));
-    query.bindValue(":playlist_id", playlistId);
-    query.bindValue(":track_id", trackId.toVariant());
-    query.bindValue(":position", position);
+    const SqlQueryFinisher insertFinisher(insertQuery);
+    insertQuery.bindValue(":playlist_id", playlistId);
+    insertQuery.bindValue(":track_id", trackId.toVariant());
+    insertQuery.bindValue(":position", position);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    if (!insertQuery.exec()) {
+        LOG_FAILED_QUERY(insertQuery);
         return false;
     }
     transaction.commit();
@@ -815,10 +822,10 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
 int PlaylistDAO::getMaxPosition(const int playlistId) const {
     // Find out the highest position existing in the playlist so we know what
     // position this track should have.
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT max(position) as position FROM PlaylistTracks "
             "WHERE playlist_id = :id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -855,10 +862,10 @@ void PlaylistDAO::removeTracksFromPlaylists(const QList<TrackId>& trackIds) {
 }
 
 int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
-    QSqlQuery query(m_database);
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT COUNT(id) AS count FROM PlaylistTracks "
             "WHERE playlist_id = :playlist_id"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":playlist_id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query) << "Couldn't get the number of tracks in playlist"
@@ -875,7 +882,6 @@ int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
 
 void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const int newPosition) {
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
 
     // Algorithm for code below
     // Case 1: destination < source (newPositon < oldPosition)
@@ -889,41 +895,43 @@ void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const i
     //   3) Set position=dest where pos=-1 -- Move that track from dummy pos to final destination
 
     // Move moved track to dummy position -1
-    query.prepare(QStringLiteral(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "UPDATE PlaylistTracks SET position=-1 "
             "WHERE position=:position AND "
             "playlist_id=:id"));
+    SqlQueryFinisher finisher(query);
     query.bindValue(":position", oldPosition);
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
     }
+    finisher.finish();
 
     if (newPosition < oldPosition) {
-        query.prepare(QStringLiteral(
+        query = m_statementCache.prepare(QStringLiteral(
                 "UPDATE PlaylistTracks SET position=position+1 "
                 "WHERE position >= :new_position AND position < :old_position AND "
                 "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
     } else {
-        query.prepare(QStringLiteral(
+        query = m_statementCache.prepare(QStringLiteral(
                 "UPDATE PlaylistTracks SET position=position-1 "
                 "WHERE position > :old_position AND position <= :new_position AND "
                 "playlist_id=:id"));
-        query.bindValue(":new_position", newPosition);
-        query.bindValue(":old_position", oldPosition);
-        query.bindValue(":id", playlistId);
     }
+    SqlQueryFinisher shiftFinisher(query);
+    query.bindValue(":new_position", newPosition);
+    query.bindValue(":old_position", oldPosition);
+    query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
     }
+    shiftFinisher.finish();
 
-    query.prepare(QStringLiteral(
+    query = m_statementCache.prepare(QStringLiteral(
             "UPDATE PlaylistTracks SET position=:new_position "
             "WHERE position=-1 AND "
             "playlist_id=:id"));
+    const SqlQueryFinisher moveFinisher(query);
     query.bindValue(":new_position", newPosition);
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
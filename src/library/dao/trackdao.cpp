@@ -32,6 +32,7 @@
 #include "util/datetime.h"
 #include "util/db/fwdsqlquery.h"
 #include "util/db/sqlite.h"
+#include "util/db/sqlqueryfinisher.h"
 #include "util/db/sqllikewildcardescaper.h"
 #include "util/db/sqllikewildcards.h"
 #include "util/db/sqlstringformatter.h"
@@ -136,11 +137,11 @@ TrackId TrackDAO::getTrackIdByLocation(const QString& location) const {
         return TrackId();
     }
 
-    QSqlQuery query(m_database);
-    query.prepare(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "SELECT library.id FROM library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE track_locations.location=:location");
+            "WHERE track_locations.location=:location"));
+    const SqlQueryFinisher finisher(query);
     query.bindValue(":location", location);
     VERIFY_OR_DEBUG_ASSERT(query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -264,16 +265,79 @@ QSet<QString> TrackDAO::getAllTrackLocations() const {
     return locations;
 }
 
+namespace {
+
+// Returns the time stamps for all tracks that are selected by the query
+QHash<QString, QDateTime> readSourceSynchronizedAtByLocation(QSqlQuery* pQuery) {
+    QHash<QString, QDateTime> sourceSynchronizedAtByLocation;
+    const int locationColumn = pQuery->record().indexOf("location");
+    const int sourceSynchronizedAtColumn =
+            pQuery->record().indexOf("source_synchronized_ms");
+    while (pQuery->next()) {
+        QDateTime sourceSynchronizedAt;
+        const QVariant value = pQuery->value(sourceSynchronizedAtColumn);
+        // See also: setTrackSourceSynchronizedAt()
+        if (!value.isNull() && value.canConvert<quint64>()) {
+            sourceSynchronizedAt.setTimeSpec(Qt::UTC);
+            sourceSynchronizedAt.setMSecsSinceEpoch(qvariant_cast<quint64>(value));
+        }
+        sourceSynchronizedAtByLocation.insert(
+                pQuery->value(locationColumn).toString(),
+                sourceSynchronizedAt);
+    }
+    return sourceSynchronizedAtByLocation;
+}
+
+} // anonymous namespace
+
+QHash<QString, QDateTime> TrackDAO::getAllTrackLocationsWithSourceSynchronizedAt() const {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT track_locations.location, library.source_synchronized_ms "
+                  "FROM track_locations "
+                  "INNER JOIN library on library.location = track_locations.id");
+    VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+    return readSourceSynchronizedAtByLocation(&query);
+}
+
+QHash<QString, QDateTime> TrackDAO::getTrackLocationsInDirectoryWithSourceSynchronizedAt(
+        const QString& directory,
+        bool includeSubdirectories) const {
+    QString whereClause = QStringLiteral("track_locations.directory=%1")
+                                  .arg(SqlStringFormatter::format(m_database, directory));
+    if (includeSubdirectories) {
+        const QString likeClause =
+                SqlLikeWildcardEscaper::apply(directory + "/", kSqlLikeMatchAll) +
+                kSqlLikeMatchAll;
+        whereClause += QStringLiteral(" OR track_locations.directory LIKE %1 ESCAPE '%2'")
+                               .arg(SqlStringFormatter::format(m_database, likeClause),
+                                       kSqlLikeMatchAll);
+    }
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "SELECT track_locations.location, library.source_synchronized_ms "
+            "FROM track_locations "
+            "INNER JOIN library on library.location = track_locations.id "
+            "WHERE %1")
+                          .arg(whereClause));
+    VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+        LOG_FAILED_QUERY(query) << "could not get tracks within directory:" << directory;
+    }
+    return readSourceSynchronizedAtByLocation(&query);
+}
+
 // Some code (eg. drag and drop) needs to just get a track's location, and it's
 // not worth retrieving a whole Track.
 QString TrackDAO::getTrackLocation(TrackId trackId) const {
     qDebug() << "TrackDAO::getTrackLocation"
              << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
+            "SELECT track_locations.location FROM track_locations "
+            "INNER JOIN library ON library.location = track_locations.id "
+            "WHERE library.id=:id"));
+    const SqlQueryFinisher finisher(query);
     QString trackLocation = "";
-    query.prepare("SELECT track_locations.location FROM track_locations "
-                  "INNER JOIN library ON library.location = track_locations.id "
-                  "WHERE library.id=:id");
     query.bindValue(":id", trackId.toVariant());
     VERIFY_OR_DEBUG_ASSERT(query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -793,7 +857,8 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
 
 TrackPointer TrackDAO::addTracksAddFile(
         const mixxx::FileAccess& fileAccess,
-        bool unremove) {
+        bool unremove,
+        const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo* pImported) {
     // Check that track is a supported extension.
     // TODO(uklotzde): The following check can be skipped if
     // the track is already in the library. A refactoring is
@@ -841,7 +906,9 @@ TrackPointer TrackDAO::addTracksAddFile(
 
     // Initially (re-)import the metadata for the newly created track
     // from the file.
-    SoundSourceProxy(pTrack).updateTrackFromSource();
+    SoundSourceProxy(pTrack).updateTrackFromSource(
+            SoundSourceProxy::UpdateTrackFromSourceMode::Default,
+            pImported);
     if (!pTrack->isSourceSynchronized()) {
         qWarning() << "TrackDAO::addTracksAddFile:"
                 << "Failed to parse track metadata from file"
@@ -1336,7 +1403,6 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
     // will be locked again after the query has been executed (see below)
     // and potential race conditions will be resolved.
     ScopedTimer t("TrackDAO::getTrackById");
-    QSqlQuery query(m_database);
 
     ColumnPopulator columns[] = {
             // Location must be first.
@@ -1412,10 +1478,12 @@ TrackPointer TrackDAO::getTrackById(TrackId trackId) const {
         columnsStr.append(columns[i].name);
     }
 
-    query.prepare(QString(
+    QSqlQuery query = m_statementCache.prepare(QString(
             "SELECT %1 FROM Library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE library.id = %2").arg(columnsStr, trackId.toString()));
+            "WHERE library.id=:id").arg(columnsStr));
+    const SqlQueryFinisher finisher(query);
+    query.bindValue(":id", trackId.toVariant());
 
     VERIFY_OR_DEBUG_ASSERT(query.exec()) {
         LOG_FAILED_QUERY(query)
@@ -1602,10 +1670,8 @@ bool TrackDAO::updateTrack(Track* pTrack) const {
     // PerformanceTimer time;
     // time.start();
 
-    QSqlQuery query(m_database);
-
     // Update everything but "location", since that's what we identify the track by.
-    query.prepare(
+    QSqlQuery query = m_statementCache.prepare(QStringLiteral(
             "UPDATE library SET "
             "artist=:artist,"
             "title=:title,"
@@ -1651,7 +1717,8 @@ bool TrackDAO::updateTrack(Track* pTrack) const {
             "coverart_color=:coverart_color,"
             "coverart_digest=:coverart_digest,"
             "coverart_hash=:coverart_hash "
-            "WHERE id=:track_id");
+            "WHERE id=:track_id"));
+    const SqlQueryFinisher finisher(query);
 
     query.bindValue(":track_id", trackId.toVariant());
 
@@ -1731,6 +1798,34 @@ void TrackDAO::markTracksInDirectoriesAsVerified(const QStringList& directories)
     }
 }
 
+QSet<TrackId> TrackDAO::markTrackLocationsAsDeleted(const QStringList& locations) const {
+    QSet<TrackId> trackIds;
+    if (locations.isEmpty()) {
+        return trackIds;
+    }
+    const QString locationList = SqlStringFormatter::formatList(m_database, locations);
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT library.id as id FROM library INNER JOIN track_locations ON "
+                          "track_locations.id=library.location WHERE "
+                          "track_locations.fs_deleted=0 AND track_locations.location IN (%1)")
+                          .arg(locationList));
+    VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+        LOG_FAILED_QUERY(query) << "Couldn't find deleted tracks";
+    }
+    while (query.next()) {
+        trackIds.insert(TrackId(query.value(query.record().indexOf("id"))));
+    }
+    query.prepare(QString("UPDATE track_locations "
+                          "SET fs_deleted=1, needs_verification=0 "
+                          "WHERE location IN (%1)")
+                          .arg(locationList));
+    VERIFY_OR_DEBUG_ASSERT(query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark track locations as deleted.";
+    }
+    return trackIds;
+}
+
 void TrackDAO::markUnverifiedTracksAsDeleted() {
     //qDebug() << "TrackDAO::markUnverifiedTracksAsDeleted" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
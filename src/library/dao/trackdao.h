@@ -1,6 +1,8 @@
 #pragma once
 
+#include <QDateTime>
 #include <QFileInfo>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QSet>
@@ -10,6 +12,7 @@
 #include "library/dao/dao.h"
 #include "library/relocatedtrack.h"
 #include "preferences/usersettings.h"
+#include "sources/soundsourceproxy.h"
 #include "track/globaltrackcache.h"
 #include "util/class.h"
 #include "util/memory.h"
@@ -64,6 +67,13 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
 
     // Returns a set of all track locations in the library.
     QSet<QString> getAllTrackLocations() const;
+    // Returns all track locations in the library together with the time
+    // stamp of the file when its metadata has been imported or exported
+    // the last time. The time stamp is invalid if this never happened.
+    QHash<QString, QDateTime> getAllTrackLocationsWithSourceSynchronizedAt() const;
+    QHash<QString, QDateTime> getTrackLocationsInDirectoryWithSourceSynchronizedAt(
+            const QString& directory,
+            bool includeSubdirectories) const;
     QString getTrackLocation(TrackId trackId) const;
 
     // Only used by friend class LibraryScanner, but public for testing!
@@ -124,15 +134,20 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     TrackId addTracksAddTrack(
             const TrackPointer& pTrack,
             bool unremove);
+    // The metadata of the file is parsed unless it has already been
+    // imported in advance, e.g. by a worker thread.
     TrackPointer addTracksAddFile(
             const mixxx::FileAccess& fileAccess,
-            bool unremove);
+            bool unremove,
+            const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo* pImported = nullptr);
     TrackPointer addTracksAddFile(
             const QString& filePath,
-            bool unremove) {
+            bool unremove,
+            const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo* pImported = nullptr) {
         return addTracksAddFile(
                 mixxx::FileAccess(mixxx::FileInfo(filePath)),
-                unremove);
+                unremove,
+                pImported);
     }
     void addTracksFinish(bool rollback = false);
 
@@ -160,6 +175,8 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     void markTracksInDirectoriesAsVerified(const QStringList& directories) const;
     void invalidateTrackLocationsInLibrary() const;
     void markUnverifiedTracksAsDeleted();
+    // Returns the ids of the tracks that have not been marked before
+    QSet<TrackId> markTrackLocationsAsDeleted(const QStringList& locations) const;
 
     bool verifyRemainingTracks(
             const QList<mixxx::FileInfo>& libraryRootDirs,
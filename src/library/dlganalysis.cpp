@@ -1,6 +1,7 @@
 #include "library/dlganalysis.h"
 
 #include <QSqlTableModel>
+#include <QStringList>
 
 #include "analyzer/analyzerprogress.h"
 #include "library/dao/trackschema.h"
@@ -18,7 +19,8 @@ DlgAnalysis::DlgAnalysis(WLibrary* parent,
                        Library* pLibrary)
         : QWidget(parent),
           m_pConfig(pConfig),
-          m_bAnalysisActive(false) {
+          m_bAnalysisActive(false),
+          m_tracksPerMinute(-1) {
     setupUi(this);
     m_songsButtonGroup.addButton(radioButtonRecentlyAdded);
     m_songsButtonGroup.addButton(radioButtonAllSongs);
@@ -179,6 +181,7 @@ void DlgAnalysis::slotAnalysisActive(bool bActive) {
         pushButtonAnalyze->setChecked(true);
         pushButtonAnalyze->setText(tr("Stop Analysis"));
         labelProgress->setEnabled(true);
+        m_tracksPerMinute = -1;
     } else {
         pushButtonAnalyze->setChecked(false);
         pushButtonAnalyze->setText(tr("Analyze"));
@@ -192,7 +195,15 @@ void DlgAnalysis::onTrackAnalysisSchedulerProgress(
     //qDebug() << this << "onTrackAnalysisSchedulerProgress" << analyzerProgress << finishedCount << totalCount;
     if (labelProgress->isEnabled()) {
         QString progressText;
-        if (analyzerProgress >= kAnalyzerProgressNone) {
+        if (m_tracksPerMinute > 0 && analyzerProgress >= kAnalyzerProgressNone) {
+            QString progressPercent = QString::number(
+                    analyzerProgressPercent(analyzerProgress));
+            progressText = tr("Analyzing %1% %2/%3 (%4 tracks/min)")
+                                   .arg(progressPercent,
+                                           QString::number(finishedCount),
+                                           QString::number(totalCount),
+                                           QString::number(m_tracksPerMinute, 'f', 1));
+        } else if (analyzerProgress >= kAnalyzerProgressNone) {
             QString progressPercent = QString::number(
                     analyzerProgressPercent(analyzerProgress));
             progressText = tr("Analyzing %1% %2/%3").arg(
@@ -209,6 +220,24 @@ void DlgAnalysis::onTrackAnalysisSchedulerProgress(
     }
 }
 
+void DlgAnalysis::onTrackAnalysisSchedulerStatistics(
+        double tracksPerMinute, const AnalyzerCpuTimes& analyzerCpuTimes) {
+    m_tracksPerMinute = tracksPerMinute;
+    if (analyzerCpuTimes.isEmpty()) {
+        return;
+    }
+    // The CPU time of all analyzer threads is summed up and
+    // might exceed the elapsed time of the analysis.
+    QStringList lines;
+    lines.append(tr("CPU time per analyzer:"));
+    for (const auto& cpuTime : analyzerCpuTimes) {
+        lines.append(QStringLiteral("%1: %2").arg(
+                cpuTime.first,
+                cpuTime.second.formatSecondsWithUnit()));
+    }
+    labelProgress->setToolTip(lines.join(QChar('\n')));
+}
+
 void DlgAnalysis::onTrackAnalysisSchedulerFinished() {
     slotAnalysisActive(false);
 }
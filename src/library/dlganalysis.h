@@ -8,6 +8,7 @@
 #include "library/libraryview.h"
 #include "library/ui_dlganalysis.h"
 #include "analyzer/analyzerprogress.h"
+#include "analyzer/analyzerstatistics.h"
 
 class AnalysisLibraryTableModel;
 class WAnalysisLibraryTableView;
@@ -42,6 +43,7 @@ class DlgAnalysis : public QWidget, public Ui::DlgAnalysis, public virtual Libra
     void analyze();
     void slotAnalysisActive(bool bActive);
     void onTrackAnalysisSchedulerProgress(AnalyzerProgress analyzerProgress, int finishedCount, int totalCount);
+    void onTrackAnalysisSchedulerStatistics(double tracksPerMinute, const AnalyzerCpuTimes& analyzerCpuTimes);
     void onTrackAnalysisSchedulerFinished();
     void showRecentSongs();
     void showAllSongs();
@@ -58,6 +60,8 @@ class DlgAnalysis : public QWidget, public Ui::DlgAnalysis, public virtual Libra
     //Note m_pTrackTablePlaceholder is defined in the .ui file
     UserSettingsPointer m_pConfig;
     bool m_bAnalysisActive;
+    // Negative if unknown
+    double m_tracksPerMinute;
     QButtonGroup m_songsButtonGroup;
     WAnalysisLibraryTableView* m_pAnalysisLibraryTableView;
     AnalysisLibraryTableModel* m_pAnalysisLibraryTableModel;
@@ -2,6 +2,7 @@
 
 #include "library/scanner/libraryscanner.h"
 #include "moc_importfilestask.cpp"
+#include "sources/soundsourceproxy.h"
 #include "util/timer.h"
 
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
@@ -42,6 +43,9 @@ void ImportFilesTask::run() {
             // executed when other files in the same directory have changed (the
             // directory hash has changed).
             emit trackExists(trackLocation);
+            if (m_scannerGlobal->trackNeedsReimport(trackLocation, fileInfo)) {
+                emit trackModified(trackLocation);
+            }
         } else {
             if (!fileInfo.exists()) {
                 qWarning() << "ImportFilesTask: Skipping inaccessible file"
@@ -50,7 +54,13 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit addNewTrack(trackLocation);
+            // Parsing the file is the most expensive part of adding a new
+            // track. It is done here on the worker thread, concurrently with
+            // the other tasks, and not on the library scanner thread that
+            // only writes the results into the database.
+            emit addNewTrack(trackLocation,
+                    SoundSourceProxy::importNewTrackMetadataAndCoverInfoFromFile(
+                            mixxx::FileAccess(mixxx::FileInfo(fileInfo), m_pToken)));
         }
     }
     // Insert or update the hash in the database.
@@ -1,8 +1,12 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <QDirIterator>
+#include <algorithm>
+
 #include "library/coverartutils.h"
 #include "library/queryutil.h"
 #include "library/scanner/libraryscannerdlg.h"
+#include "library/scanner/librarywatcher.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/scannertask.h"
 #include "library/scanner/scannerutil.h"
@@ -13,14 +17,40 @@
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/fwdsqlquery.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
 namespace {
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
+// Directories are walked and the metadata of new files is parsed
+// concurrently by the worker threads. Too many of them would only
+// compete for disk access.
+const int kMaxScannerThreadPoolSize = 8;
+
+// Added tracks are committed in batches. Large transactions are
+// much faster than committing every single track while the new
+// tracks still appear in the library during a long scan.
+const int kMaxTracksPerTransaction = 1000;
+
+const mixxx::Duration kThroughputReportInterval = mixxx::Duration::fromSeconds(1);
+
+const ConfigKey kLiveSyncConfigKey = ConfigKey("[Library]", "LiveSync");
+
+// The interval in minutes after which live sync checks the modification
+// times of all files again on platforms where modified files are not
+// reported (see LibraryWatcher). This is a full rescan of the library, so
+// it is disabled by default (0) and there is no preference for it.
+const ConfigKey kLiveSyncRecheckMinutesConfigKey =
+        ConfigKey("[Library]", "LiveSyncRecheckMinutes");
+
+double perSecond(int count, mixxx::Duration elapsed) {
+    if (elapsed <= mixxx::Duration::empty()) {
+        return 0.0;
+    }
+    return count / elapsed.toDoubleSeconds();
+}
 
 mixxx::Logger kLogger("LibraryScanner");
 
@@ -71,10 +101,14 @@ LibraryScanner::LibraryScanner(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pConfig(pConfig),
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
+          m_numTracksInTransaction(0),
+          m_liveSync(false),
+          m_liveSyncFailed(false),
           m_stateSema(1), // only one transaction is possible at a time
           m_state(IDLE) {
     // Move LibraryScanner to its own thread so that our signals/slots will
@@ -85,11 +119,18 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(math_clamp(
+            QThread::idealThreadCount(), 1, kMaxScannerThreadPoolSize));
+
+    qRegisterMetaType<SoundSourceProxy::ImportedTrackMetadataAndCoverInfo>();
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
     connect(this, &LibraryScanner::startScan, this, &LibraryScanner::slotStartScan);
+    connect(this,
+            &LibraryScanner::liveSyncRequested,
+            this,
+            &LibraryScanner::slotSetLiveSync);
 
     m_pProgressDlg.reset(new LibraryScannerDlg());
     connect(this,
@@ -100,6 +141,10 @@ LibraryScanner::LibraryScanner(
             &LibraryScanner::progressHashing,
             m_pProgressDlg.data(),
             &LibraryScannerDlg::slotUpdate);
+    connect(this,
+            &LibraryScanner::progressThroughput,
+            m_pProgressDlg.data(),
+            &LibraryScannerDlg::slotUpdateThroughput);
     connect(this,
             &LibraryScanner::scanStarted,
             m_pProgressDlg.data(),
@@ -147,10 +192,29 @@ void LibraryScanner::run() {
         m_analysisDao.initialize(dbConnection);
         m_directoryDao.initialize(dbConnection);
 
+        // The watcher lives in the scanner thread and reports changes
+        // to its event loop.
+        m_pWatcher = std::make_unique<LibraryWatcher>();
+        connect(m_pWatcher.get(),
+                &LibraryWatcher::directoriesChanged,
+                this,
+                &LibraryScanner::slotSyncDirectories);
+        m_pWatcher->setRecheckInterval(mixxx::Duration::fromSeconds(
+                60 * m_pConfig->getValue(kLiveSyncRecheckMinutesConfigKey, 0)));
+        if (m_pConfig->getValue(kLiveSyncConfigKey, false)) {
+            // Don't force a scan on every startup. Changes made while
+            // Mixxx was not running are found by the rescan on startup
+            // if enabled.
+            m_liveSync = true;
+            watchLibraryDirectories();
+        }
+
         // Start the event loop.
         kLogger.debug() << "Event loop starting";
         exec();
         kLogger.debug() << "Event loop stopped";
+
+        m_pWatcher.reset();
     }
     kLogger.debug() << "Exiting thread";
 }
@@ -171,7 +235,11 @@ void LibraryScanner::slotStartScan() {
     }
     changeScannerState(SCANNING);
 
-    QSet<QString> trackLocations = m_trackDao.getAllTrackLocations();
+    // While live sync is enabled the metadata of modified files is
+    // imported again, because the watches do not report the files that
+    // have been modified while Mixxx was not running.
+    QHash<QString, QDateTime> trackLocations =
+            m_trackDao.getAllTrackLocationsWithSourceSynchronizedAt();
     QHash<QString, mixxx::cache_key_t> directoryHashes = m_libraryHashDao.getDirectoryHashes();
     QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
     QRegExp coverExtensionFilter =
@@ -180,10 +248,11 @@ void LibraryScanner::slotStartScan() {
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
+            new ScannerGlobal(trackLocations, m_liveSync, directoryHashes, extensionFilter,
                               coverExtensionFilter, directoryBlacklist));
 
     m_scannerGlobal->startTimer();
+    m_throughputTimer.start();
 
     emit scanStarted();
 
@@ -203,6 +272,7 @@ void LibraryScanner::slotStartScan() {
     // Start scanning the library. This prepares insertion queries in TrackDAO
     // (must be called before calling addTracksAdd) and begins a transaction.
     m_trackDao.addTracksPrepare();
+    m_numTracksInTransaction = 0;
 
     // First Scan all known directories we have a hash for.
     // In a second stage, we scan all new directories. This guarantees,
@@ -371,23 +441,27 @@ void LibraryScanner::slotFinishUnhashedScan() {
 
     if (bScanFinishedCleanly) {
         kLogger.debug() << "Recursive scanning finished cleanly";
-    } else {
+    } else if (m_scannerGlobal->shouldCancel()) {
         kLogger.debug() << "Recursive scanning interrupted by the user";
+    } else {
+        kLogger.debug() << "Recursive scanning did not finish cleanly";
     }
 
-    // Finish adding the tracks -- rollback the transaction if the scan did not
-    // finish cleanly and the user did not cancel the transaction.
-    m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
-                               !bScanFinishedCleanly);
+    // Finish adding the tracks. The tracks that have been added are kept
+    // even if the scan did not finish cleanly, like those that have already
+    // been committed in batches during the scan (see commitAddedTracks()).
+    // They exist on disk and the directories that have not been scanned
+    // completely keep their previous hashes, so they are scanned again by
+    // the next scan.
+    m_trackDao.addTracksFinish();
+    reportThroughput(true);
 
+    // Tracks are only marked as missing after a complete scan
     if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
         cleanUpScan();
-    }
-
-    if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
         kLogger.debug() << "Scan finished cleanly";
     } else {
-        kLogger.debug() << "Scan cancelled";
+        kLogger.debug() << "Scan cancelled or incomplete";
     }
 
     // TODO(XXX) doesn't take into account verifyRemainingTracks.
@@ -395,18 +469,34 @@ void LibraryScanner::slotFinishUnhashedScan() {
            "%d unchanged directories. "
            "%d changed/added directories. "
            "%d tracks verified from changed/added directories. "
-           "%d new tracks.",
+           "%d new tracks. "
+           "%.1f directories/s, %.1f files/s, %.1f rows/s.",
            m_scannerGlobal->timerElapsed().formatNanosWithUnit().toLocal8Bit().constData(),
            m_scannerGlobal->verifiedDirectories().size(),
            m_scannerGlobal->numScannedDirectories(),
            m_scannerGlobal->verifiedTracks().size(),
-           m_scannerGlobal->addedTracks().size());
+           m_scannerGlobal->addedTracks().size(),
+           perSecond(m_scannerGlobal->numVisitedDirectories(),
+                   m_scannerGlobal->timerElapsed()),
+           perSecond(m_scannerGlobal->numVisitedFiles(),
+                   m_scannerGlobal->timerElapsed()),
+           perSecond(m_scannerGlobal->numWrittenRows(),
+                   m_scannerGlobal->timerElapsed()));
 
     m_scannerGlobal.clear();
     changeScannerState(FINISHED);
     // now we may accept new scan commands
 
     emit scanFinished();
+
+    // Start watching the directories that have been discovered by the
+    // scan and catch up with the changes reported in the meantime.
+    watchLibraryDirectories();
+    if (!m_pendingSyncDirectoryPaths.isEmpty()) {
+        const QStringList directoryPaths = m_pendingSyncDirectoryPaths.values();
+        m_pendingSyncDirectoryPaths.clear();
+        slotSyncDirectories(directoryPaths);
+    }
 }
 
 void LibraryScanner::scan() {
@@ -478,6 +568,10 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             &ScannerTask::trackExists,
             this,
             &LibraryScanner::slotTrackExists);
+    connect(pTask,
+            &ScannerTask::trackModified,
+            this,
+            &LibraryScanner::slotTrackModified);
     connect(pTask,
             &ScannerTask::addNewTrack,
             this,
@@ -507,6 +601,7 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
     // (it was changed or new).
     if (m_scannerGlobal) {
         m_scannerGlobal->directoryScanned();
+        m_scannerGlobal->rowsWritten(1);
     }
 
     if (newDirectory) {
@@ -515,6 +610,7 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
         m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
     }
     emit progressHashing(directoryPath);
+    reportThroughput();
 }
 
 void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath) {
@@ -524,6 +620,7 @@ void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath) {
         m_scannerGlobal->addVerifiedDirectory(directoryPath);
     }
     emit progressHashing(directoryPath);
+    reportThroughput();
 }
 
 void LibraryScanner::slotTrackExists(const QString& trackPath) {
@@ -534,13 +631,20 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
+void LibraryScanner::slotTrackModified(const QString& trackPath) {
+    ScopedTimer timer("LibraryScanner::slotTrackModified");
+    reimportTrackMetadata(trackPath);
+}
+
+void LibraryScanner::slotAddNewTrack(const QString& trackPath,
+        const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo& imported) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
     ScopedTimer timer("LibraryScanner::addNewTrack");
     // For statistics tracking and to detect moved tracks
     TrackPointer pTrack = m_trackDao.addTracksAddFile(
             trackPath,
-            false);
+            false,
+            &imported);
     if (pTrack) {
         DEBUG_ASSERT(!pTrack->isDirty());
         // The track's actual location might differ from the
@@ -549,6 +653,7 @@ void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
         // Acknowledge successful track addition
         if (m_scannerGlobal) {
             m_scannerGlobal->trackAdded(trackLocation);
+            m_scannerGlobal->rowsWritten(1);
         }
         // Signal the main instance of TrackDAO, that there is
         // a new track in the database.
@@ -565,6 +670,266 @@ void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
                 << "Failed to add track to library:"
                 << trackPath;
     }
+    if (++m_numTracksInTransaction >= kMaxTracksPerTransaction) {
+        commitAddedTracks();
+    }
+    reportThroughput();
+}
+
+void LibraryScanner::commitAddedTracks() {
+    ScopedTimer timer("LibraryScanner::commitAddedTracks");
+    // The committed tracks are kept even if the scan is cancelled or
+    // does not finish cleanly, see slotFinishUnhashedScan().
+    m_trackDao.addTracksFinish();
+    m_trackDao.addTracksPrepare();
+    m_numTracksInTransaction = 0;
+}
+
+void LibraryScanner::reportThroughput(bool force) {
+    if (!m_scannerGlobal) {
+        return;
+    }
+    if (!force && m_throughputTimer.elapsed() < kThroughputReportInterval) {
+        return;
+    }
+    m_throughputTimer.restart();
+    const mixxx::Duration elapsed = m_scannerGlobal->timerElapsed();
+    emit progressThroughput(
+            perSecond(m_scannerGlobal->numVisitedDirectories(), elapsed),
+            perSecond(m_scannerGlobal->numVisitedFiles(), elapsed),
+            perSecond(m_scannerGlobal->numWrittenRows(), elapsed));
+}
+
+void LibraryScanner::setLiveSync(bool enabled) {
+    emit liveSyncRequested(enabled);
+}
+
+void LibraryScanner::slotSetLiveSync(bool enabled) {
+    kLogger.info()
+            << (enabled ? "Enabling" : "Disabling")
+            << "live sync of the library";
+    m_liveSync = enabled;
+    m_liveSyncFailed = false;
+    if (!m_liveSync) {
+        m_pWatcher->unwatchAll();
+        m_pendingSyncDirectoryPaths.clear();
+        return;
+    }
+    // The library might have been modified while it was not watched.
+    // The scan starts watching all directories after it has finished.
+    scan();
+}
+
+void LibraryScanner::watchLibraryDirectories() {
+    if (!m_liveSync || m_liveSyncFailed) {
+        return;
+    }
+    const QList<mixxx::FileInfo> rootDirs = m_directoryDao.loadAllDirectories();
+    QSet<QString> directoryPaths;
+    for (const auto& rootDir : rootDirs) {
+        if (rootDir.exists() && rootDir.isDir()) {
+            directoryPaths.insert(rootDir.location());
+        }
+    }
+    // All subdirectories have been hashed by the scan
+    const auto directoryHashes = m_libraryHashDao.getDirectoryHashes();
+    for (auto i = directoryHashes.constBegin(); i != directoryHashes.constEnd(); ++i) {
+        for (const auto& rootDir : rootDirs) {
+            if (mixxx::FileInfo::isRootSubCanonicalLocation(
+                        rootDir.location(), i.key())) {
+                directoryPaths.insert(i.key());
+                break;
+            }
+        }
+    }
+
+    QStringList removedDirectoryPaths;
+    for (const auto& directoryPath : m_pWatcher->watchedDirectories()) {
+        if (!directoryPaths.remove(directoryPath)) {
+            removedDirectoryPaths.append(directoryPath);
+        }
+    }
+    m_pWatcher->unwatch(removedDirectoryPaths);
+    if (!m_pWatcher->watch(directoryPaths.values())) {
+        liveSyncFailed();
+        return;
+    }
+    kLogger.info()
+            << "Watching"
+            << m_pWatcher->watchedDirectories().size()
+            << "library directories for changes";
+}
+
+void LibraryScanner::liveSyncFailed() {
+    kLogger.warning()
+            << "Unable to watch all library directories for changes."
+            << "Raise the limit of watches (fs.inotify.max_user_watches)"
+            << "and enable live sync again.";
+    m_liveSyncFailed = true;
+    m_pWatcher->unwatchAll();
+    m_pendingSyncDirectoryPaths.clear();
+    // The hashes of the directories include the size and the time
+    // of modification of all files. A scan finds all changes that
+    // might have been missed.
+    scan();
+}
+
+void LibraryScanner::slotSyncDirectories(const QStringList& directoryPaths) {
+    if (!m_liveSync || m_liveSyncFailed) {
+        return;
+    }
+    if (m_scannerGlobal) {
+        // Postpone until the scan has finished to avoid that both
+        // modify the same tracks concurrently.
+        for (const auto& directoryPath : directoryPaths) {
+            m_pendingSyncDirectoryPaths.insert(directoryPath);
+        }
+        return;
+    }
+    ScopedTimer timer("LibraryScanner::slotSyncDirectories");
+    PerformanceTimer elapsedTimer;
+    elapsedTimer.start();
+
+    const QList<mixxx::FileInfo> rootDirs = m_directoryDao.loadAllDirectories();
+    QSet<TrackId> changedTrackIds;
+    QStringList newDirectoryPaths;
+    m_trackDao.addTracksPrepare();
+    for (const auto& directoryPath : directoryPaths) {
+        const bool inLibrary = std::any_of(
+                rootDirs.constBegin(),
+                rootDirs.constEnd(),
+                [&directoryPath](const mixxx::FileInfo& rootDir) {
+                    return mixxx::FileInfo::isRootSubCanonicalLocation(
+                            rootDir.location(), directoryPath);
+                });
+        if (!inLibrary) {
+            // The directory has been removed from the library
+            m_pWatcher->unwatch(QStringList{directoryPath});
+            continue;
+        }
+        syncDirectory(directoryPath, &changedTrackIds, &newDirectoryPaths);
+    }
+    m_trackDao.addTracksFinish();
+
+    // Update BaseTrackCache via signals connected to the main TrackDAO.
+    if (!changedTrackIds.isEmpty()) {
+        emit tracksChanged(changedTrackIds);
+    }
+    if (!m_pWatcher->watch(newDirectoryPaths)) {
+        liveSyncFailed();
+        return;
+    }
+    kLogger.debug()
+            << "Synchronized"
+            << directoryPaths.size()
+            << "changed and"
+            << newDirectoryPaths.size()
+            << "new directories:"
+            << elapsedTimer.elapsed().debugMillisWithUnit();
+}
+
+void LibraryScanner::syncDirectory(const QString& directoryPath,
+        QSet<TrackId>* pChangedTrackIds,
+        QStringList* pNewDirectoryPaths) {
+    const mixxx::FileInfo dirInfo(directoryPath);
+    if (!dirInfo.exists() || !dirInfo.isDir()) {
+        // The directory has been deleted or moved away together with
+        // all its subdirectories.
+        const auto trackLocations =
+                m_trackDao.getTrackLocationsInDirectoryWithSourceSynchronizedAt(
+                        directoryPath, true);
+        pChangedTrackIds->unite(
+                m_trackDao.markTrackLocationsAsDeleted(trackLocations.keys()));
+        // Forget the hash to rescan the directory if it reappears. The
+        // watched subdirectories are reported on their own.
+        m_libraryHashDao.updateDirectoryStatuses(
+                QStringList{directoryPath}, true, false);
+        m_libraryHashDao.removeDeletedDirectoryHashes();
+        return;
+    }
+
+    // List the directory exactly like RecursiveScanDirectoryTask to
+    // calculate the same hash.
+    auto dir = dirInfo.toQDir();
+    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    QDirIterator it(dir);
+    QCryptographicHash hasher(QCryptographicHash::Sha256);
+    QRegExp supportedExtensionsRegex(SoundSourceProxy::getSupportedFileNamesRegex());
+    const QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
+
+    // The tracks that remain in this map after listing the directory
+    // have been deleted or renamed.
+    QHash<QString, QDateTime> trackLocations =
+            m_trackDao.getTrackLocationsInDirectoryWithSourceSynchronizedAt(
+                    dirInfo.location(), false);
+    QStringList verifiedTrackLocations;
+    while (it.hasNext()) {
+        QString currentFile = it.next();
+        QFileInfo currentFileInfo = it.fileInfo();
+
+        if (currentFileInfo.isFile()) {
+            if (supportedExtensionsRegex.indexIn(currentFileInfo.fileName()) == -1) {
+                continue;
+            }
+            ScannerUtil::addFileToDirectoryHash(&hasher, currentFile, currentFileInfo);
+            const QString trackLocation = mixxx::FileInfo(currentFileInfo).location();
+            const auto i = trackLocations.find(trackLocation);
+            if (i == trackLocations.end()) {
+                TrackPointer pTrack = m_trackDao.addTracksAddFile(trackLocation, false);
+                if (pTrack) {
+                    emit trackAdded(pTrack);
+                }
+                continue;
+            }
+            if (ScannerUtil::isFileModifiedSince(currentFileInfo, i.value())) {
+                reimportTrackMetadata(trackLocation);
+            }
+            verifiedTrackLocations.append(trackLocation);
+            trackLocations.erase(i);
+        } else {
+            if (directoryBlacklist.contains(currentFile)) {
+                continue;
+            }
+            // Known subdirectories are watched on their own
+            const QString subdirLocation = mixxx::FileInfo(currentFileInfo).location();
+            if (mixxx::isValidCacheKey(m_libraryHashDao.getDirectoryHash(subdirLocation))) {
+                continue;
+            }
+            syncDirectory(subdirLocation, pChangedTrackIds, pNewDirectoryPaths);
+            pNewDirectoryPaths->append(subdirLocation);
+        }
+    }
+
+    // Restore tracks that have been marked as deleted before, e.g.
+    // when moving files back and forth.
+    if (!verifiedTrackLocations.isEmpty()) {
+        m_trackDao.markTrackLocationsAsVerified(verifiedTrackLocations);
+    }
+    pChangedTrackIds->unite(
+            m_trackDao.markTrackLocationsAsDeleted(trackLocations.keys()));
+
+    // Store the hash to skip this directory during the next scan
+    const mixxx::cache_key_t newHash = mixxx::cacheKeyFromMessageDigest(hasher.result());
+    const mixxx::cache_key_t prevHash = m_libraryHashDao.getDirectoryHash(dirInfo.location());
+    if (mixxx::isValidCacheKey(prevHash)) {
+        m_libraryHashDao.updateDirectoryHash(dirInfo.location(), newHash, 0);
+    } else {
+        m_libraryHashDao.saveDirectoryHash(dirInfo.location(), newHash);
+    }
+}
+
+void LibraryScanner::reimportTrackMetadata(const QString& trackLocation) {
+    TrackPointer pTrack = m_trackDao.getTrackByRef(
+            TrackRef::fromFilePath(trackLocation));
+    if (!pTrack) {
+        return;
+    }
+    kLogger.debug()
+            << "Importing metadata of modified file"
+            << trackLocation;
+    // The modified track is saved when the last reference is released
+    SoundSourceProxy(pTrack).updateTrackFromSource(
+            SoundSourceProxy::UpdateTrackFromSourceMode::Again);
 }
 
 bool LibraryScanner::changeScannerState(ScannerState newState) {
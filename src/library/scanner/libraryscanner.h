@@ -8,6 +8,7 @@
 #include <QString>
 #include <QThread>
 #include <QThreadPool>
+#include <memory>
 
 #include "library/dao/analysisdao.h"
 #include "library/dao/cuedao.h"
@@ -16,15 +17,19 @@
 #include "library/dao/playlistdao.h"
 #include "library/dao/trackdao.h"
 #include "library/scanner/scannerglobal.h"
+#include "sources/soundsourceproxy.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/db/dbconnectionpool.h"
+#include "util/performancetimer.h"
 
 class ScannerTask;
 class LibraryScannerDlg;
+class LibraryWatcher;
 
 class LibraryScanner : public QThread {
     FRIEND_TEST(LibraryScannerTest, ScannerRoundtrip);
+    FRIEND_TEST(LibraryScannerTest, KeepAddedTracksOfIncompleteScan);
     Q_OBJECT
   public:
     LibraryScanner(
@@ -40,12 +45,19 @@ class LibraryScanner : public QThread {
     // Call from any thread to cancel the scan.
     void slotCancel();
 
+    // Call from any thread to enable or disable the live sync of the
+    // library directories with the file system.
+    void setLiveSync(bool enabled);
+
   signals:
     void scanStarted();
     void scanFinished();
     void progressHashing(const QString&);
     void progressLoading(const QString& path);
     void progressCoverArt(const QString& file);
+    void progressThroughput(double directoriesPerSecond,
+            double filesPerSecond,
+            double rowsPerSecond);
     void trackAdded(TrackPointer pTrack);
     void tracksChanged(const QSet<TrackId>& changedTrackIds);
     void tracksRelocated(const QList<RelocatedTrack>& relocatedTracks);
@@ -54,6 +66,10 @@ class LibraryScanner : public QThread {
     // loop.
     void startScan();
 
+    // Emitted by setLiveSync() to invoke slotSetLiveSync in the scanner
+    // thread's event loop.
+    void liveSyncRequested(bool enabled);
+
   protected:
     void run() override;
 
@@ -64,13 +80,17 @@ class LibraryScanner : public QThread {
     void slotStartScan();
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
+    void slotSetLiveSync(bool enabled);
+    void slotSyncDirectories(const QStringList& directoryPaths);
 
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
                                    bool newDirectory, mixxx::cache_key_t hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotTrackModified(const QString& trackPath);
+    void slotAddNewTrack(const QString& trackPath,
+            const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo& imported);
 
   private:
     enum ScannerState {
@@ -96,7 +116,32 @@ class LibraryScanner : public QThread {
 
     void cleanUpScan();
 
+    // Commits the tracks that have been added so far and starts
+    // a new transaction.
+    void commitAddedTracks();
+
+    // Emits progressThroughput() at most once per interval unless forced.
+    void reportThroughput(bool force = false);
+
+    // Watches all known directories of the library for changes if live
+    // sync is enabled. Falls back to a full scan if the watches are
+    // exhausted.
+    void watchLibraryDirectories();
+    void liveSyncFailed();
+
+    // Synchronizes the tracks in a single directory with the file system
+    // without descending into known subdirectories. New subdirectories
+    // are synchronized recursively and returned for watching.
+    void syncDirectory(const QString& directoryPath,
+            QSet<TrackId>* pChangedTrackIds,
+            QStringList* pNewDirectoryPaths);
+
+    // Imports the metadata of a track in the library again after its
+    // file has been modified.
+    void reimportTrackMetadata(const QString& trackLocation);
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const UserSettingsPointer m_pConfig;
 
     // The pool of threads used for worker tasks.
     QThreadPool m_pool;
@@ -112,6 +157,22 @@ class LibraryScanner : public QThread {
     // Global scanner state for scan currently in progress.
     ScannerGlobalPointer m_scannerGlobal;
 
+    // The number of tracks that have been added in the current
+    // transaction.
+    int m_numTracksInTransaction;
+
+    PerformanceTimer m_throughputTimer;
+
+    // Only accessed in the LibraryScanner thread. The watcher is
+    // created and destroyed in run().
+    std::unique_ptr<LibraryWatcher> m_pWatcher;
+    bool m_liveSync;
+    // Set when not all directories could be watched. Live sync stays
+    // disabled until it is enabled again.
+    bool m_liveSyncFailed;
+    // Changes that have been reported while a scan is in progress
+    QSet<QString> m_pendingSyncDirectoryPaths;
+
     // The Semaphore guards the state transitions queued to the
     // Qt even Queue in the way, that you cannot start a
     // new scan while the old one is canceled
@@ -32,6 +32,11 @@ LibraryScannerDlg::LibraryScannerDlg(QWidget* parent, Qt::WindowFlags f)
     pCurrent->setWordWrap(true);
     connect(this, &LibraryScannerDlg::progress, pCurrent, &QLabel::setText);
     pLayout->addWidget(pCurrent);
+
+    QLabel* pThroughput = new QLabel(this);
+    pThroughput->setMaximumWidth(600);
+    connect(this, &LibraryScannerDlg::throughput, pThroughput, &QLabel::setText);
+    pLayout->addWidget(pThroughput);
     setLayout(pLayout);
 }
 
@@ -62,6 +67,17 @@ void LibraryScannerDlg::slotUpdateCover(const QString& path) {
     }
 }
 
+void LibraryScannerDlg::slotUpdateThroughput(double directoriesPerSecond,
+        double filesPerSecond,
+        double rowsPerSecond) {
+    if (isVisible()) {
+        emit throughput(tr("%1 directories/s, %2 files/s, %3 database rows/s")
+                                .arg(QString::number(directoriesPerSecond, 'f', 1),
+                                        QString::number(filesPerSecond, 'f', 1),
+                                        QString::number(rowsPerSecond, 'f', 1)));
+    }
+}
+
 void LibraryScannerDlg::slotCancel() {
     qDebug() << "Cancelling library scan...";
     m_bCancelled = true;
@@ -71,6 +87,7 @@ void LibraryScannerDlg::slotCancel() {
 
 void LibraryScannerDlg::slotScanStarted() {
     m_bCancelled = false;
+    emit throughput(QString());
     m_timer.start();
 }
 
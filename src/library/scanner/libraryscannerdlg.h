@@ -15,6 +15,9 @@ class LibraryScannerDlg : public QWidget {
   public slots:
     void slotUpdate(const QString& path);
     void slotUpdateCover(const QString& path);
+    void slotUpdateThroughput(double directoriesPerSecond,
+            double filesPerSecond,
+            double rowsPerSecond);
     void slotCancel();
     void slotScanFinished();
     void slotScanStarted();
@@ -22,6 +25,7 @@ class LibraryScannerDlg : public QWidget {
   signals:
     void scanCancelled();
     void progress(const QString&);
+    void throughput(const QString&);
 
   private:
     PerformanceTimer m_timer;
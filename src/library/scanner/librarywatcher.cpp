@@ -0,0 +1,262 @@
+#include "library/scanner/librarywatcher.h"
+
+#include <QDir>
+
+#if defined(__LINUX__)
+#include <QFile>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <sys/inotify.h>
+#include <unistd.h>
+}
+#endif
+
+#include "moc_librarywatcher.cpp"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryWatcher");
+
+// Changes are reported after this long even if the file system does not
+// settle, e.g. while copying a large collection into the library.
+constexpr mixxx::Duration kMaxBurstDuration = mixxx::Duration::fromSeconds(10);
+
+#if defined(__LINUX__)
+// Modified files are reported once they have been closed, not for each
+// write. IN_ATTRIB covers files that are touched.
+constexpr uint32_t kInotifyMask = IN_ONLYDIR | IN_ATTRIB | IN_CLOSE_WRITE |
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+        IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+} // anonymous namespace
+
+LibraryWatcher::LibraryWatcher(
+        mixxx::Duration settleDelay,
+        QObject* pParent)
+        : QObject(pParent),
+          m_settleDelay(settleDelay),
+#if defined(__LINUX__)
+          m_inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+          m_pNotifier(nullptr),
+#else
+          m_watcher(this),
+          m_recheckTimer(this),
+#endif
+          m_settleTimer(this) {
+    m_settleTimer.setSingleShot(true);
+#if defined(__LINUX__)
+    if (m_inotifyFd < 0) {
+        kLogger.warning()
+                << "Failed to initialize inotify:"
+                << strerror(errno);
+    } else {
+        m_pNotifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_pNotifier,
+                &QSocketNotifier::activated,
+                this,
+                &LibraryWatcher::slotReadEvents);
+    }
+#else
+    connect(&m_watcher,
+            &QFileSystemWatcher::directoryChanged,
+            this,
+            &LibraryWatcher::slotDirectoryChanged);
+    connect(&m_recheckTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::slotRecheck);
+#endif
+    connect(&m_settleTimer,
+            &QTimer::timeout,
+            this,
+            &LibraryWatcher::slotSettled);
+}
+
+LibraryWatcher::~LibraryWatcher() {
+#if defined(__LINUX__)
+    if (m_inotifyFd >= 0) {
+        delete m_pNotifier;
+        // Removes all watches
+        close(m_inotifyFd);
+    }
+#endif
+}
+
+bool LibraryWatcher::watch(const QStringList& directories) {
+    if (directories.isEmpty()) {
+        return true;
+    }
+#if defined(__LINUX__)
+    QStringList failed;
+    for (const auto& directory : directories) {
+        if (!addWatch(directory)) {
+            failed.append(directory);
+        }
+    }
+#else
+    const QStringList failed = m_watcher.addPaths(directories);
+#endif
+    if (failed.isEmpty()) {
+        return true;
+    }
+    // Directories that have been removed in the meantime fail too
+    for (const auto& directory : failed) {
+        if (QDir(directory).exists()) {
+            kLogger.warning()
+                    << "Failed to watch"
+                    << failed.size()
+                    << "of"
+                    << directories.size()
+                    << "directories";
+            return false;
+        }
+    }
+    return true;
+}
+
+void LibraryWatcher::unwatch(const QStringList& directories) {
+#if defined(__LINUX__)
+    for (const auto& directory : directories) {
+        const auto i = m_watchesByDirectory.constFind(directory);
+        if (i != m_watchesByDirectory.constEnd()) {
+            removeWatch(i.value());
+        }
+    }
+#else
+    if (!directories.isEmpty()) {
+        m_watcher.removePaths(directories);
+    }
+#endif
+}
+
+void LibraryWatcher::unwatchAll() {
+    unwatch(watchedDirectories());
+    m_settleTimer.stop();
+    m_changedDirectories.clear();
+}
+
+QStringList LibraryWatcher::watchedDirectories() const {
+#if defined(__LINUX__)
+    return m_watchesByDirectory.keys();
+#else
+    return m_watcher.directories();
+#endif
+}
+
+void LibraryWatcher::setRecheckInterval(mixxx::Duration interval) {
+#if defined(__LINUX__)
+    // inotify reports modified files
+    Q_UNUSED(interval);
+#else
+    if (interval > mixxx::Duration::empty()) {
+        m_recheckTimer.start(static_cast<int>(interval.toIntegerMillis()));
+    } else {
+        m_recheckTimer.stop();
+    }
+#endif
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& directory) {
+    if (m_changedDirectories.isEmpty()) {
+        m_burstTimer.start();
+    }
+    m_changedDirectories.insert(directory);
+    // Postpone the report until the burst is over, but not forever
+    if (m_burstTimer.elapsed() < kMaxBurstDuration) {
+        m_settleTimer.start(static_cast<int>(m_settleDelay.toIntegerMillis()));
+    }
+}
+
+void LibraryWatcher::slotSettled() {
+    if (m_changedDirectories.isEmpty()) {
+        return;
+    }
+    QStringList directories = m_changedDirectories.values();
+    m_changedDirectories.clear();
+    kLogger.debug()
+            << "Changed directories:"
+            << directories;
+    emit directoriesChanged(directories);
+}
+
+#if defined(__LINUX__)
+bool LibraryWatcher::addWatch(const QString& directory) {
+    if (m_inotifyFd < 0) {
+        return false;
+    }
+    if (m_watchesByDirectory.contains(directory)) {
+        return true;
+    }
+    const int watch = inotify_add_watch(m_inotifyFd,
+            QFile::encodeName(directory).constData(),
+            kInotifyMask);
+    if (watch < 0) {
+        return false;
+    }
+    // The same directory might be watched under another path, e.g.
+    // through a symbolic link.
+    const auto i = m_directoriesByWatch.constFind(watch);
+    if (i != m_directoriesByWatch.constEnd()) {
+        m_watchesByDirectory.remove(i.value());
+    }
+    m_directoriesByWatch.insert(watch, directory);
+    m_watchesByDirectory.insert(directory, watch);
+    return true;
+}
+
+void LibraryWatcher::removeWatch(int watch) {
+    const QString directory = m_directoriesByWatch.take(watch);
+    m_watchesByDirectory.remove(directory);
+    // Fails for watches that have already been removed by the kernel
+    inotify_rm_watch(m_inotifyFd, watch);
+}
+
+void LibraryWatcher::slotReadEvents() {
+    // Large enough for many events with long names at once
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while (true) {
+        const ssize_t size = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (size <= 0) {
+            // EAGAIN after all pending events have been read
+            return;
+        }
+        const char* pEvent = buffer;
+        while (pEvent < buffer + size) {
+            const auto* pInotifyEvent =
+                    reinterpret_cast<const struct inotify_event*>(pEvent);
+            pEvent += sizeof(struct inotify_event) + pInotifyEvent->len;
+            if (pInotifyEvent->mask & IN_Q_OVERFLOW) {
+                kLogger.warning()
+                        << "Too many changes at once, checking all directories";
+                for (const auto& directory : watchedDirectories()) {
+                    slotDirectoryChanged(directory);
+                }
+                continue;
+            }
+            const auto i = m_directoriesByWatch.constFind(pInotifyEvent->wd);
+            if (i == m_directoriesByWatch.constEnd()) {
+                // Events that have been queued before the watch was removed
+                continue;
+            }
+            const QString directory = i.value();
+            if (pInotifyEvent->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                // The directory is gone or the path doesn't refer to it
+                // anymore
+                removeWatch(pInotifyEvent->wd);
+            }
+            slotDirectoryChanged(directory);
+        }
+    }
+}
+#else
+void LibraryWatcher::slotRecheck() {
+    for (const auto& directory : watchedDirectories()) {
+        slotDirectoryChanged(directory);
+    }
+}
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+class QSocketNotifier;
+
+/// Watches the directories of the library for changes and reports the
+/// changed directories in batches. Bursts of changes, e.g. while copying
+/// an album into the library, are coalesced until the file system has
+/// settled for a moment.
+///
+/// Directories are watched individually and not recursively. New
+/// subdirectories need to be added when they are discovered.
+///
+/// On Linux the directories are watched with inotify directly, because
+/// QFileSystemWatcher does not report files that are modified in place,
+/// e.g. when a tag editor saves new metadata. Each directory occupies a
+/// watch. The number of watches is limited by the system
+/// (fs.inotify.max_user_watches). All directories are reported if the
+/// event queue overflows.
+///
+/// QFileSystemWatcher is used on all other platforms. It only reports
+/// changes of the directory entries, so files that are modified in place
+/// are missed unless their directory changes with them. Optionally all
+/// directories are reported again periodically to check the modification
+/// times of their files, see setRecheckInterval(). This amounts to a
+/// periodic rescan of the whole library and is disabled by default.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    static constexpr mixxx::Duration kDefaultSettleDelay =
+            mixxx::Duration::fromSeconds(2);
+
+    explicit LibraryWatcher(
+            mixxx::Duration settleDelay = kDefaultSettleDelay,
+            QObject* pParent = nullptr);
+    ~LibraryWatcher() override;
+
+    /// Adds directories to the watch list. Returns false if some of them
+    /// could not be watched, e.g. because the limit of watches has been
+    /// exceeded. Changes of these directories will be missed.
+    bool watch(const QStringList& directories);
+    void unwatch(const QStringList& directories);
+    void unwatchAll();
+
+    QStringList watchedDirectories() const;
+
+    /// Reports all watched directories after each interval, or never if
+    /// the interval is empty. Only effective on platforms without inotify,
+    /// where modified files are not reported otherwise.
+    void setRecheckInterval(mixxx::Duration interval);
+
+  signals:
+    /// The directories whose entries have been added, removed, renamed,
+    /// or modified. Deleted directories are included and have been
+    /// removed from the watch list.
+    void directoriesChanged(const QStringList& directories);
+
+  private slots:
+    void slotDirectoryChanged(const QString& directory);
+    void slotSettled();
+#if defined(__LINUX__)
+    void slotReadEvents();
+#else
+    void slotRecheck();
+#endif
+
+  private:
+    const mixxx::Duration m_settleDelay;
+
+#if defined(__LINUX__)
+    bool addWatch(const QString& directory);
+    void removeWatch(int watch);
+
+    int m_inotifyFd;
+    QSocketNotifier* m_pNotifier;
+    QHash<int, QString> m_directoriesByWatch;
+    QHash<QString, int> m_watchesByDirectory;
+#else
+    QFileSystemWatcher m_watcher;
+    QTimer m_recheckTimer;
+#endif
+    QTimer m_settleTimer;
+    // Measures the duration of the current burst of changes
+    PerformanceTimer m_burstTimer;
+    QSet<QString> m_changedDirectories;
+};
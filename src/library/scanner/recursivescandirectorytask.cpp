@@ -5,6 +5,7 @@
 
 #include "library/scanner/importfilestask.h"
 #include "library/scanner/libraryscanner.h"
+#include "library/scanner/scannerutil.h"
 #include "moc_recursivescandirectorytask.cpp"
 #include "util/timer.h"
 
@@ -57,7 +58,7 @@ void RecursiveScanDirectoryTask::run() {
         if (currentFileInfo.isFile()) {
             const QString& fileName = currentFileInfo.fileName();
             if (supportedExtensionsRegex.indexIn(fileName) != -1) {
-                hasher.addData(currentFile.toUtf8());
+                ScannerUtil::addFileToDirectoryHash(&hasher, currentFile, currentFileInfo);
                 filesToImport.push_back(currentFileInfo);
             } else if (supportedCoverExtensionsRegex.indexIn(fileName) != -1) {
                 possibleCovers.push_back(currentFileInfo);
@@ -73,6 +74,9 @@ void RecursiveScanDirectoryTask::run() {
         }
     }
 
+    m_scannerGlobal->directoryVisited();
+    m_scannerGlobal->filesVisited(static_cast<int>(filesToImport.size()));
+
     // Calculate a hash of the directory's file list.
     const mixxx::cache_key_t newHash = mixxx::cacheKeyFromMessageDigest(hasher.result());
 
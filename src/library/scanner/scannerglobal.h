@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QAtomicInt>
+#include <QDateTime>
 #include <QDir>
 #include <QHash>
 #include <QMutex>
@@ -9,19 +11,23 @@
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "library/scanner/scannerutil.h"
 #include "util/cache.h"
+#include "util/compatibility.h"
 #include "util/fileaccess.h"
 #include "util/performancetimer.h"
 #include "util/task.h"
 
 class ScannerGlobal {
   public:
-    ScannerGlobal(const QSet<QString>& trackLocations,
+    ScannerGlobal(const QHash<QString, QDateTime>& trackLocations,
+            bool reimportModifiedTracks,
             const QHash<QString, mixxx::cache_key_t>& directoryHashes,
             const QRegExp& supportedExtensionsMatcher,
             const QRegExp& supportedCoverExtensionsMatcher,
             const QStringList& directoriesBlacklist)
             : m_trackLocations(trackLocations),
+              m_reimportModifiedTracks(reimportModifiedTracks),
               m_directoryHashes(directoryHashes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
@@ -29,7 +35,8 @@ class ScannerGlobal {
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
-              m_numScannedDirectories(0) {
+              m_numScannedDirectories(0),
+              m_numWrittenRows(0) {
     }
 
     TaskWatcher& getTaskWatcher() {
@@ -41,6 +48,14 @@ class ScannerGlobal {
         return m_trackLocations.contains(trackLocation);
     }
 
+    // Returns whether the metadata of a track in the database should be
+    // imported again, because its file has been modified.
+    bool trackNeedsReimport(const QString& trackLocation, const QFileInfo& fileInfo) const {
+        return m_reimportModifiedTracks &&
+                ScannerUtil::isFileModifiedSince(
+                        fileInfo, m_trackLocations.value(trackLocation));
+    }
+
     // Returns the directory hash if it exists or mixxx::invalidCacheKey() if it doesn't.
     mixxx::cache_key_t directoryHashInDatabase(const QString& directoryPath) const {
         return m_directoryHashes.value(directoryPath, mixxx::invalidCacheKey());
@@ -151,10 +166,34 @@ class ScannerGlobal {
         m_numScannedDirectories++;
     }
 
+    // Throughput statistics. Directories and files are visited
+    // concurrently by the worker threads while all rows are written
+    // by the library scanner thread.
+    int numVisitedDirectories() const {
+        return atomicLoadRelaxed(m_numVisitedDirectories);
+    }
+    void directoryVisited() {
+        m_numVisitedDirectories.fetchAndAddRelaxed(1);
+    }
+    int numVisitedFiles() const {
+        return atomicLoadRelaxed(m_numVisitedFiles);
+    }
+    void filesVisited(int count) {
+        m_numVisitedFiles.fetchAndAddRelaxed(count);
+    }
+    int numWrittenRows() const {
+        return m_numWrittenRows;
+    }
+    void rowsWritten(int count) {
+        m_numWrittenRows += count;
+    }
+
   private:
     TaskWatcher m_watcher;
 
-    QSet<QString> m_trackLocations;
+    // The time stamps of the last metadata synchronization by location
+    QHash<QString, QDateTime> m_trackLocations;
+    const bool m_reimportModifiedTracks;
     QHash<QString, mixxx::cache_key_t> m_directoryHashes;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
@@ -195,6 +234,9 @@ class ScannerGlobal {
     // Stats tracking.
     PerformanceTimer m_timer;
     int m_numScannedDirectories;
+    QAtomicInt m_numVisitedDirectories;
+    QAtomicInt m_numVisitedFiles;
+    int m_numWrittenRows;
 };
 
 typedef QSharedPointer<ScannerGlobal> ScannerGlobalPointer;
@@ -4,6 +4,7 @@
 #include <QRunnable>
 
 #include "library/scanner/scannerglobal.h"
+#include "sources/soundsourceproxy.h"
 
 class LibraryScanner;
 
@@ -23,7 +24,9 @@ class ScannerTask : public QObject, public QRunnable {
                                    bool newDirectory, mixxx::cache_key_t hash);
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    void trackModified(const QString& filePath);
+    void addNewTrack(const QString& filePath,
+            const SoundSourceProxy::ImportedTrackMetadataAndCoverInfo& imported);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QStringList>
 
@@ -27,6 +30,27 @@ class ScannerUtil {
         return blacklist;
     }
 
+    /// Adds an audio file to the hash of its directory. The size and the
+    /// time of the last modification are included to detect files that
+    /// have been modified, e.g. retagged, without being renamed.
+    static void addFileToDirectoryHash(
+            QCryptographicHash* pHasher,
+            const QString& filePath,
+            const QFileInfo& fileInfo) {
+        pHasher->addData(filePath.toUtf8());
+        pHasher->addData(QByteArray::number(fileInfo.size()));
+        pHasher->addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    }
+
+    /// Returns true if the file has been modified after the metadata of the
+    /// corresponding track has been imported or exported the last time.
+    static bool isFileModifiedSince(
+            const QFileInfo& fileInfo,
+            const QDateTime& sourceSynchronizedAt) {
+        return sourceSynchronizedAt.isValid() &&
+                fileInfo.lastModified().toUTC() > sourceSynchronizedAt;
+    }
+
   private:
     ScannerUtil() {}
 };
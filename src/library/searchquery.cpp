@@ -1,6 +1,7 @@
 #include "library/searchquery.h"
 
 #include <QtDebug>
+#include <cmath>
 
 #include "library/dao/trackschema.h"
 #include "library/queryutil.h"
@@ -89,6 +90,24 @@ bool AndNode::match(const TrackPointer& pTrack) const {
     return true;
 }
 
+bool AndNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    // An empty AND node always evaluates to true! This
+    // is consistent with the generated SQL query.
+    *pMatches = index.fullMask();
+    TrackColumnIndex::RowMask nodeMatches;
+    for (const auto& pNode : m_nodes) {
+        if (!pNode->matchIndex(index, &nodeMatches)) {
+            return false;
+        }
+        for (std::size_t row = 0; row < pMatches->size(); ++row) {
+            (*pMatches)[row] &= nodeMatches[row];
+        }
+    }
+    return true;
+}
+
 QString AndNode::toSql() const {
     QStringList queryFragments;
     queryFragments.reserve(static_cast<int>(m_nodes.size()));
@@ -118,6 +137,27 @@ bool OrNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool OrNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    // See match()
+    VERIFY_OR_DEBUG_ASSERT(!m_nodes.empty()) {
+        *pMatches = index.fullMask();
+        return true;
+    }
+    *pMatches = index.emptyMask();
+    TrackColumnIndex::RowMask nodeMatches;
+    for (const auto& pNode : m_nodes) {
+        if (!pNode->matchIndex(index, &nodeMatches)) {
+            return false;
+        }
+        for (std::size_t row = 0; row < pMatches->size(); ++row) {
+            (*pMatches)[row] |= nodeMatches[row];
+        }
+    }
+    return true;
+}
+
 QString OrNode::toSql() const {
     QStringList queryFragments;
     queryFragments.reserve(static_cast<int>(m_nodes.size()));
@@ -134,15 +174,28 @@ bool NotNode::match(const TrackPointer& pTrack) const {
     return !m_pNode->match(pTrack);
 }
 
+bool NotNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    if (!m_pNode->matchIndex(index, pMatches)) {
+        return false;
+    }
+    for (auto& match : *pMatches) {
+        match = !match;
+    }
+    return true;
+}
+
 QString NotNode::toSql() const {
     QString sql(m_pNode->toSql());
     if (sql.isEmpty()) {
         return QString();
     } else {
-        // The component term needs to be wrapped into parentheses,
-        // but the whole expression does not. The composite node is
-        // always responsible for proper wrapping into parentheses!
-        return "NOT (" % sql % ")";
+        // The component term is wrapped by COALESCE(), but the whole
+        // expression does not need parentheses. A comparison with NULL
+        // is NULL and would still be NULL when negated, i.e. not match.
+        // Treat it as false like match() does.
+        return "NOT COALESCE(" % sql % ", 0)";
     }
 }
 
@@ -171,6 +224,21 @@ bool TextFilterNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool TextFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    *pMatches = index.emptyMask();
+    for (const auto& sqlColumn : m_sqlColumns) {
+        const int column = index.column(sqlColumn);
+        if (column < 0 || !index.isTextColumn(column)) {
+            return false;
+        }
+        // The argument has already been folded like the indexed values
+        index.matchText(column, m_argument, pMatches);
+    }
+    return true;
+}
+
 QString TextFilterNode::toSql() const {
     FieldEscaper escaper(m_database);
     QString argument = m_argument;
@@ -202,6 +270,21 @@ bool NullOrEmptyTextFilterNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool NullOrEmptyTextFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    *pMatches = index.emptyMask();
+    if (!m_sqlColumns.isEmpty()) {
+        // only use the major column
+        const int column = index.column(m_sqlColumns.first());
+        if (column < 0 || !index.isTextColumn(column)) {
+            return false;
+        }
+        index.matchNullOrEmptyText(column, pMatches);
+    }
+    return true;
+}
+
 QString NullOrEmptyTextFilterNode::toSql() const {
     if (!m_sqlColumns.isEmpty()) {
         // only use the major column
@@ -217,7 +300,7 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
           m_matchInitialized(false) {
 }
 
-bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+const std::vector<TrackId>& CrateFilterNode::matchingTrackIds() const {
     if (!m_matchInitialized) {
         CrateTrackSelectResult crateTracks(
                 m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
@@ -228,8 +311,27 @@ bool CrateFilterNode::match(const TrackPointer& pTrack) const {
 
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+    const auto& trackIds = matchingTrackIds();
+    return std::binary_search(trackIds.begin(), trackIds.end(), pTrack->getId());
+}
+
+bool CrateFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    // Crates are not indexed, but the tracks in matching crates are
+    // selected by a single (small) query.
+    *pMatches = index.emptyMask();
+    for (const auto& trackId : matchingTrackIds()) {
+        const auto row = index.row(trackId);
+        if (row >= 0) {
+            (*pMatches)[row] = 1;
+        }
+    }
+    return true;
 }
 
 QString CrateFilterNode::toSql() const {
@@ -243,7 +345,7 @@ NoCrateFilterNode::NoCrateFilterNode(const CrateStorage* pCrateStorage)
           m_matchInitialized(false) {
 }
 
-bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
+const std::vector<TrackId>& NoCrateFilterNode::tracksInCrates() const {
     if (!m_matchInitialized) {
         TrackSelectResult tracks(
                 m_pCrateStorage->selectAllTracksSorted());
@@ -254,8 +356,25 @@ bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
 
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return !std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool NoCrateFilterNode::match(const TrackPointer& pTrack) const {
+    const auto& trackIds = tracksInCrates();
+    return !std::binary_search(trackIds.begin(), trackIds.end(), pTrack->getId());
+}
+
+bool NoCrateFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    *pMatches = index.fullMask();
+    for (const auto& trackId : tracksInCrates()) {
+        const auto row = index.row(trackId);
+        if (row >= 0) {
+            (*pMatches)[row] = 0;
+        }
+    }
+    return true;
 }
 
 QString NoCrateFilterNode::toSql() const {
@@ -317,6 +436,18 @@ double NumericFilterNode::parse(const QString& arg, bool* ok) {
     return arg.toDouble(ok);
 }
 
+bool NumericFilterNode::matchValue(double dValue) const {
+    if (m_bOperatorQuery) {
+        return (m_operator == "=" && dValue == m_dOperatorArgument) ||
+                (m_operator == "<" && dValue < m_dOperatorArgument) ||
+                (m_operator == ">" && dValue > m_dOperatorArgument) ||
+                (m_operator == "<=" && dValue <= m_dOperatorArgument) ||
+                (m_operator == ">=" && dValue >= m_dOperatorArgument);
+    }
+    return m_bRangeQuery && dValue >= m_dRangeLow &&
+            dValue <= m_dRangeHigh;
+}
+
 bool NumericFilterNode::match(const TrackPointer& pTrack) const {
     for (const auto& sqlColumn : m_sqlColumns) {
         QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
@@ -327,23 +458,40 @@ bool NumericFilterNode::match(const TrackPointer& pTrack) const {
             continue;
         }
 
-        double dValue = value.toDouble();
-        if (m_bOperatorQuery) {
-            if ((m_operator == "=" && dValue == m_dOperatorArgument) ||
-                    (m_operator == "<" && dValue < m_dOperatorArgument) ||
-                    (m_operator == ">" && dValue > m_dOperatorArgument) ||
-                    (m_operator == "<=" && dValue <= m_dOperatorArgument) ||
-                    (m_operator == ">=" && dValue >= m_dOperatorArgument)) {
-                return true;
-            }
-        } else if (m_bRangeQuery && dValue >= m_dRangeLow &&
-                dValue <= m_dRangeHigh) {
+        if (matchValue(value.toDouble())) {
             return true;
         }
     }
     return false;
 }
 
+bool NumericFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    if (!m_bNullQuery && !m_bOperatorQuery && !m_bRangeQuery) {
+        // An invalid argument doesn't filter like toSql()
+        *pMatches = index.fullMask();
+        return true;
+    }
+    *pMatches = index.emptyMask();
+    for (const auto& sqlColumn : m_sqlColumns) {
+        const int column = index.column(sqlColumn);
+        // The database compares the numbers of text columns like the
+        // track number as text, e.g. "12" < "3"
+        if (column < 0 || !index.isNumericColumn(column) || index.isTextColumn(column)) {
+            return false;
+        }
+        const std::vector<double>& values = index.numericValues(column);
+        for (std::size_t row = 0; row < values.size(); ++row) {
+            const double dValue = values[row];
+            if (std::isnan(dValue) ? m_bNullQuery : matchValue(dValue)) {
+                (*pMatches)[row] = 1;
+            }
+        }
+    }
+    return true;
+}
+
 QString NumericFilterNode::toSql() const {
     if (m_bNullQuery) {
         for (const auto& sqlColumn : m_sqlColumns) {
@@ -394,6 +542,26 @@ bool NullNumericFilterNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool NullNumericFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    *pMatches = index.emptyMask();
+    if (!m_sqlColumns.isEmpty()) {
+        // only use the major column
+        const int column = index.column(m_sqlColumns.first());
+        if (column < 0 || !index.isNumericColumn(column)) {
+            return false;
+        }
+        const std::vector<double>& values = index.numericValues(column);
+        for (std::size_t row = 0; row < values.size(); ++row) {
+            if (std::isnan(values[row])) {
+                (*pMatches)[row] = 1;
+            }
+        }
+    }
+    return true;
+}
+
 QString NullNumericFilterNode::toSql() const {
     if (!m_sqlColumns.isEmpty()) {
         // only use the major column
@@ -453,6 +621,26 @@ bool KeyFilterNode::match(const TrackPointer& pTrack) const {
     return m_matchKeys.contains(pTrack->getKey());
 }
 
+bool KeyFilterNode::matchIndex(
+        const TrackColumnIndex& index,
+        TrackColumnIndex::RowMask* pMatches) const {
+    const int column = index.column(LIBRARYTABLE_KEY_ID);
+    if (column < 0 || !index.isNumericColumn(column)) {
+        return false;
+    }
+    *pMatches = index.emptyMask();
+    const std::vector<double>& values = index.numericValues(column);
+    for (std::size_t row = 0; row < values.size(); ++row) {
+        if (!std::isnan(values[row]) &&
+                m_matchKeys.contains(
+                        static_cast<mixxx::track::io::key::ChromaticKey>(
+                                static_cast<int>(values[row])))) {
+            (*pMatches)[row] = 1;
+        }
+    }
+    return true;
+}
+
 QString KeyFilterNode::toSql() const {
     QStringList searchClauses;
     for (const auto& matchKey : m_matchKeys) {
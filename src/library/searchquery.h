@@ -9,6 +9,7 @@
 #include <utility>
 #include <vector>
 
+#include "library/trackcolumnindex.h"
 #include "library/trackset/crate/cratestorage.h"
 #include "proto/keys.pb.h"
 #include "track/track_decl.h"
@@ -27,6 +28,14 @@ class QueryNode {
     virtual bool match(const TrackPointer& pTrack) const = 0;
     virtual QString toSql() const = 0;
 
+    /// Evaluates the node for all rows of the index at once and replaces
+    /// the contents of pMatches with the matching rows. Returns false if
+    /// the node cannot be evaluated without the database, e.g. if a
+    /// column is not indexed.
+    virtual bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const = 0;
+
   protected:
     QueryNode() = default;
 
@@ -51,12 +60,18 @@ class OrNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 };
 
 class AndNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 };
 
 class NotNode : public QueryNode {
@@ -68,6 +83,9 @@ class NotNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
     std::unique_ptr<QueryNode> m_pNode;
@@ -81,6 +99,9 @@ class TextFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
     QSqlDatabase m_database;
@@ -98,6 +119,9 @@ class NullOrEmptyTextFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
     QSqlDatabase m_database;
@@ -111,8 +135,13 @@ class CrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
+    const std::vector<TrackId>& matchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
@@ -125,8 +154,13 @@ class NoCrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
+    const std::vector<TrackId>& tracksInCrates() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
@@ -139,6 +173,9 @@ class NumericFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   protected:
     // Single argument constructor for that does not call init()
@@ -153,6 +190,8 @@ class NumericFilterNode : public QueryNode {
   private:
     virtual double parse(const QString& arg, bool* ok);
 
+    bool matchValue(double value) const;
+
     QStringList m_sqlColumns;
     bool m_bOperatorQuery;
     bool m_bNullQuery;
@@ -169,6 +208,9 @@ class NullNumericFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
     QStringList m_sqlColumns;
 };
@@ -187,6 +229,9 @@ class KeyFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override;
 
   private:
     QList<mixxx::track::io::key::ChromaticKey> m_matchKeys;
@@ -212,6 +257,17 @@ class SqlNode : public QueryNode {
         return m_sql;
     }
 
+    bool matchIndex(
+            const TrackColumnIndex& index,
+            TrackColumnIndex::RowMask* pMatches) const override {
+        if (!m_sql.isEmpty()) {
+            // Only the database can evaluate SQL expressions
+            return false;
+        }
+        *pMatches = index.fullMask();
+        return true;
+    }
+
   private:
     QString m_sql;
 };
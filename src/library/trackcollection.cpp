@@ -92,6 +92,12 @@ void TrackCollection::disconnectDatabase() {
     kLogger.info() << "Disconnecting database";
     m_database = QSqlDatabase();
     m_trackDao.finish();
+    m_trackDao.disconnectDatabase();
+    m_playlistDao.disconnectDatabase();
+    m_cueDao.disconnectDatabase();
+    m_directoryDao.disconnectDatabase();
+    m_analysisDao.disconnectDatabase();
+    m_libraryHashDao.disconnectDatabase();
     m_crates.disconnectDatabase();
 }
 
@@ -173,6 +173,11 @@ void TrackCollectionManager::stopLibraryScan() {
     m_pScanner->slotCancel();
 }
 
+void TrackCollectionManager::setLibraryLiveSync(bool enabled) {
+    DEBUG_ASSERT(m_pScanner);
+    m_pScanner->setLiveSync(enabled);
+}
+
 TrackCollectionManager::SaveTrackResult TrackCollectionManager::saveTrack(
         const TrackPointer& pTrack) const {
     VERIFY_OR_DEBUG_ASSERT(pTrack) {
@@ -89,6 +89,7 @@ class TrackCollectionManager: public QObject,
   public slots:
     void startLibraryScan();
     void stopLibraryScan();
+    void setLibraryLiveSync(bool enabled);
 
   private:
     void afterTrackAdded(const TrackPointer& pTrack) const;
@@ -0,0 +1,544 @@
+#include "library/trackcolumnindex.h"
+
+#include <QThread>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+#include "util/assert.h"
+#include "util/db/dbconnection.h"
+#include "util/math.h"
+
+namespace {
+
+constexpr int kNGramLength = 3;
+
+// Changed rows are merged into the existing sort order as long as they
+// are at most this fraction of all rows. Otherwise the rows are sorted
+// again from scratch.
+constexpr int kMaxChangedRowsFraction = 16;
+
+// Sorting fewer rows concurrently is not worth the overhead
+constexpr int kMinRowsPerSortChunk = 32768;
+
+constexpr double kMissingNumericValue = std::numeric_limits<double>::quiet_NaN();
+
+inline quint64 nGramAt(const QString& str, int pos) {
+    DEBUG_ASSERT(pos + kNGramLength <= str.size());
+    return (static_cast<quint64>(str[pos].unicode()) << 32) |
+            (static_cast<quint64>(str[pos + 1].unicode()) << 16) |
+            static_cast<quint64>(str[pos + 2].unicode());
+}
+
+inline bool isSameNumericValue(double lhs, double rhs) {
+    return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+}
+
+// The integer at the start of the text after optional white space like
+// SQLite converts it, or 0 if there is none
+double leadingInteger(const QString& text) {
+    int pos = 0;
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+        negative = text[pos] == '-';
+        ++pos;
+    }
+    double value = 0.0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        value = value * 10 + text[pos].digitValue();
+        ++pos;
+    }
+    return negative ? -value : value;
+}
+
+struct SortChunk {
+    std::ptrdiff_t begin;
+    std::ptrdiff_t end;
+};
+
+/// Sorts chunks of the rows concurrently and merges them pairwise.
+/// The comparison must define a strict total order, i.e. the result
+/// does not depend on the chunks.
+template<typename LessThan>
+void sortRowsConcurrently(std::vector<TrackColumnIndex::Row>* pRows, LessThan lessThan) {
+    const int chunkCount = math_clamp(
+            static_cast<int>(pRows->size() / kMinRowsPerSortChunk),
+            1,
+            math_max(QThread::idealThreadCount(), 1));
+    if (chunkCount == 1) {
+        std::sort(pRows->begin(), pRows->end(), lessThan);
+        return;
+    }
+    const auto numRows = static_cast<std::ptrdiff_t>(pRows->size());
+    std::vector<SortChunk> chunks(chunkCount);
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks[i].begin = numRows * i / chunkCount;
+        chunks[i].end = numRows * (i + 1) / chunkCount;
+    }
+    const auto rows = pRows->begin();
+    QtConcurrent::blockingMap(chunks, [rows, &lessThan](const SortChunk& chunk) {
+        std::sort(rows + chunk.begin, rows + chunk.end, lessThan);
+    });
+    while (chunks.size() > 1) {
+        std::vector<SortChunk> merged;
+        std::vector<std::pair<SortChunk, SortChunk>> pairs;
+        for (std::size_t i = 0; i + 1 < chunks.size(); i += 2) {
+            pairs.emplace_back(chunks[i], chunks[i + 1]);
+            merged.push_back(SortChunk{chunks[i].begin, chunks[i + 1].end});
+        }
+        if (chunks.size() % 2 != 0) {
+            merged.push_back(chunks.back());
+        }
+        QtConcurrent::blockingMap(pairs,
+                [rows, &lessThan](const std::pair<SortChunk, SortChunk>& pair) {
+                    std::inplace_merge(rows + pair.first.begin,
+                            rows + pair.second.begin,
+                            rows + pair.second.end,
+                            lessThan);
+                });
+        chunks.swap(merged);
+    }
+}
+
+} // anonymous namespace
+
+void TrackColumnIndex::addColumn(
+        const QString& name,
+        int field,
+        int types,
+        TextComparator textComparator) {
+    DEBUG_ASSERT(m_trackIds.empty());
+    DEBUG_ASSERT(!m_columnsByName.contains(name));
+    if (types & NGramTextColumn) {
+        types |= TextColumn;
+    }
+    if (types & LeadingIntegerColumn) {
+        types |= NumericColumn;
+    }
+    Column column;
+    column.name = name;
+    column.field = field;
+    column.types = types;
+    column.textComparator = std::move(textComparator);
+    const int columnIndex = static_cast<int>(m_columns.size());
+    m_columns.push_back(std::move(column));
+    m_columnsByName.insert(name, columnIndex);
+    m_columnsByField.insert(field, columnIndex);
+}
+
+void TrackColumnIndex::clear() {
+    for (auto& column : m_columns) {
+        column.valueIdsByValue.clear();
+        column.values.clear();
+        column.foldedValues.clear();
+        column.postings.clear();
+        column.rowValueIds.clear();
+        column.numericValues.clear();
+        column.sortOrderValid = false;
+        column.changedRows.clear();
+        column.rowRanks.clear();
+        column.sortedRows.clear();
+        column.sortKeys.clear();
+        column.sortedValueIds.clear();
+        column.valueRanks.clear();
+    }
+    m_trackIds.clear();
+    m_rowsByTrackId.clear();
+    m_unusedRows.clear();
+}
+
+TrackColumnIndex::RowMask TrackColumnIndex::fullMask() const {
+    RowMask mask(m_trackIds.size());
+    for (std::size_t row = 0; row < m_trackIds.size(); ++row) {
+        mask[row] = m_trackIds[row].isValid() ? 1 : 0;
+    }
+    return mask;
+}
+
+int TrackColumnIndex::internTextValue(Column* pColumn, const QString& value) {
+    const auto it = pColumn->valueIdsByValue.constFind(value);
+    if (it != pColumn->valueIdsByValue.constEnd()) {
+        return it.value();
+    }
+    // Values are never removed until the index is cleared. Edited
+    // values would otherwise require reference counting.
+    const int valueId = static_cast<int>(pColumn->values.size());
+    pColumn->valueIdsByValue.insert(value, valueId);
+    pColumn->values.push_back(value);
+    QString foldedValue = value;
+    mixxx::DbConnection::makeStringLatinLow(&foldedValue);
+    if (pColumn->types & NGramTextColumn) {
+        for (int pos = 0; pos + kNGramLength <= foldedValue.size(); ++pos) {
+            auto& valueIds = pColumn->postings[nGramAt(foldedValue, pos)];
+            // Value ids are appended in ascending order
+            if (valueIds.empty() || valueIds.back() != valueId) {
+                valueIds.push_back(valueId);
+            }
+        }
+    }
+    pColumn->foldedValues.push_back(std::move(foldedValue));
+    return valueId;
+}
+
+void TrackColumnIndex::updateRow(TrackId trackId, const QVector<QVariant>& record) {
+    VERIFY_OR_DEBUG_ASSERT(trackId.isValid()) {
+        return;
+    }
+    Row row = m_rowsByTrackId.value(trackId, -1);
+    if (row < 0) {
+        if (m_unusedRows.empty()) {
+            row = rowCount();
+            m_trackIds.push_back(trackId);
+            for (auto& column : m_columns) {
+                if (column.types & TextColumn) {
+                    column.rowValueIds.push_back(-1);
+                }
+                if (column.types & NumericColumn) {
+                    column.numericValues.push_back(kMissingNumericValue);
+                }
+                markRowChanged(&column, row);
+            }
+        } else {
+            row = m_unusedRows.back();
+            m_unusedRows.pop_back();
+            m_trackIds[row] = trackId;
+        }
+        m_rowsByTrackId.insert(trackId, row);
+    }
+
+    for (auto& column : m_columns) {
+        const QVariant value = record.value(column.field);
+        bool changed = false;
+        if (column.types & TextColumn) {
+            const int valueId = value.isNull()
+                    ? -1
+                    : internTextValue(&column, value.toString());
+            if (column.rowValueIds[row] != valueId) {
+                column.rowValueIds[row] = valueId;
+                changed = true;
+            }
+        }
+        if (column.types & NumericColumn) {
+            bool ok = false;
+            double numericValue = value.toDouble(&ok);
+            if (value.isNull()) {
+                numericValue = kMissingNumericValue;
+            } else if (column.types & LeadingIntegerColumn) {
+                numericValue = leadingInteger(value.toString());
+            } else if (!ok) {
+                numericValue = kMissingNumericValue;
+            }
+            if (!isSameNumericValue(column.numericValues[row], numericValue)) {
+                column.numericValues[row] = numericValue;
+                changed = true;
+            }
+        }
+        if (changed) {
+            markRowChanged(&column, row);
+        }
+    }
+}
+
+void TrackColumnIndex::removeRow(TrackId trackId) {
+    const auto it = m_rowsByTrackId.find(trackId);
+    if (it == m_rowsByTrackId.end()) {
+        return;
+    }
+    const Row row = it.value();
+    m_rowsByTrackId.erase(it);
+    m_trackIds[row] = TrackId();
+    m_unusedRows.push_back(row);
+}
+
+void TrackColumnIndex::matchText(
+        int column, const QString& foldedArgument, RowMask* pMatches) const {
+    const Column& col = m_columns[column];
+    DEBUG_ASSERT(col.types & TextColumn);
+    DEBUG_ASSERT(pMatches->size() == m_trackIds.size());
+
+    // Find the matching values first. There are usually far less
+    // distinct values than rows.
+    std::vector<quint8> matchingValues(col.values.size(), 0);
+    if ((col.types & NGramTextColumn) && foldedArgument.size() >= kNGramLength) {
+        // Only values that contain all n-grams of the argument are
+        // candidates.
+        std::vector<int> candidates = col.postings.value(nGramAt(foldedArgument, 0));
+        std::vector<int> intersection;
+        for (int pos = 1;
+                pos + kNGramLength <= foldedArgument.size() && !candidates.empty();
+                ++pos) {
+            const auto it = col.postings.constFind(nGramAt(foldedArgument, pos));
+            if (it == col.postings.constEnd()) {
+                candidates.clear();
+                break;
+            }
+            intersection.clear();
+            std::set_intersection(
+                    candidates.begin(),
+                    candidates.end(),
+                    it.value().begin(),
+                    it.value().end(),
+                    std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+        for (const int valueId : candidates) {
+            // The n-grams might appear in a different order
+            if (col.foldedValues[valueId].contains(foldedArgument)) {
+                matchingValues[valueId] = 1;
+            }
+        }
+    } else {
+        for (std::size_t valueId = 0; valueId < col.foldedValues.size(); ++valueId) {
+            if (col.foldedValues[valueId].contains(foldedArgument)) {
+                matchingValues[valueId] = 1;
+            }
+        }
+    }
+
+    for (std::size_t row = 0; row < col.rowValueIds.size(); ++row) {
+        const int valueId = col.rowValueIds[row];
+        if (valueId >= 0 && matchingValues[valueId]) {
+            (*pMatches)[row] = 1;
+        }
+    }
+}
+
+void TrackColumnIndex::matchNullOrEmptyText(int column, RowMask* pMatches) const {
+    const Column& col = m_columns[column];
+    DEBUG_ASSERT(col.types & TextColumn);
+    DEBUG_ASSERT(pMatches->size() == m_trackIds.size());
+    for (std::size_t row = 0; row < col.rowValueIds.size(); ++row) {
+        const int valueId = col.rowValueIds[row];
+        if (valueId < 0 || col.values[valueId].isEmpty()) {
+            (*pMatches)[row] = 1;
+        }
+    }
+}
+
+void TrackColumnIndex::markRowChanged(Column* pColumn, Row row) {
+    if (!pColumn->sortOrderValid) {
+        return;
+    }
+    if (pColumn->changedRows.size() * kMaxChangedRowsFraction >= m_trackIds.size()) {
+        // Too many changes for repositioning
+        pColumn->sortOrderValid = false;
+        pColumn->changedRows.clear();
+        return;
+    }
+    // Duplicates are removed when sorting
+    pColumn->changedRows.push_back(row);
+}
+
+const std::vector<int>& TrackColumnIndex::rowRanks(int column) {
+    Column* pColumn = &m_columns[column];
+    updateSortOrder(pColumn);
+    return pColumn->rowRanks;
+}
+
+const std::vector<TrackColumnIndex::Row>& TrackColumnIndex::sortedRows(int column) {
+    Column* pColumn = &m_columns[column];
+    updateSortOrder(pColumn);
+    return pColumn->sortedRows;
+}
+
+void TrackColumnIndex::invalidateSortOrder(int column) {
+    m_columns[column].sortOrderValid = false;
+    m_columns[column].changedRows.clear();
+    // The comparator might sort the values differently now
+    m_columns[column].sortedValueIds.clear();
+    m_columns[column].valueRanks.clear();
+}
+
+void TrackColumnIndex::sortRows(
+        std::vector<Row>* pRows, const std::vector<ColumnOrder>& columnOrders) {
+    struct RankOrder {
+        const std::vector<int>* pRanks;
+        bool ascending;
+    };
+    std::vector<RankOrder> rankOrders;
+    rankOrders.reserve(columnOrders.size());
+    for (const auto& columnOrder : columnOrders) {
+        rankOrders.push_back(RankOrder{
+                &rowRanks(columnOrder.column),
+                columnOrder.order == Qt::AscendingOrder});
+    }
+    sortRowsConcurrently(pRows, [&rankOrders](Row lhs, Row rhs) {
+        for (const auto& rankOrder : rankOrders) {
+            const int lhsRank = (*rankOrder.pRanks)[lhs];
+            const int rhsRank = (*rankOrder.pRanks)[rhs];
+            if (lhsRank != rhsRank) {
+                return rankOrder.ascending ? lhsRank < rhsRank : lhsRank > rhsRank;
+            }
+        }
+        return lhs < rhs;
+    });
+}
+
+void TrackColumnIndex::updateSortOrder(Column* pColumn) {
+    if (pColumn->sortOrderValid && pColumn->changedRows.empty()) {
+        return;
+    }
+    if (pColumn->types & NumericColumn) {
+        updateNumericSortOrder(pColumn);
+    } else {
+        updateTextSortOrder(pColumn);
+    }
+    pColumn->sortOrderValid = true;
+    pColumn->changedRows.clear();
+}
+
+void TrackColumnIndex::updateTextValueRanks(Column* pColumn) {
+    const int numValues = static_cast<int>(pColumn->values.size());
+    const int numSortedValues = static_cast<int>(pColumn->sortedValueIds.size());
+    if (numSortedValues == numValues &&
+            static_cast<int>(pColumn->valueRanks.size()) == numValues) {
+        return;
+    }
+
+    const auto compareValues = [pColumn](int lhs, int rhs) {
+        if (pColumn->textComparator) {
+            return pColumn->textComparator(
+                    pColumn->values[lhs], pColumn->values[rhs]);
+        }
+        return pColumn->sortKeys[lhs].compare(pColumn->sortKeys[rhs]);
+    };
+    const auto lessValue = [&compareValues](int lhs, int rhs) {
+        return compareValues(lhs, rhs) < 0;
+    };
+
+    if (!pColumn->textComparator) {
+        // Collate each value only once
+        pColumn->sortKeys.reserve(numValues);
+        for (int valueId = static_cast<int>(pColumn->sortKeys.size());
+                valueId < numValues;
+                ++valueId) {
+            pColumn->sortKeys.push_back(m_collator.sortKey(pColumn->values[valueId]));
+        }
+    }
+
+    // Values are never removed and new values have higher ids than
+    // all sorted values, i.e. equal values stay in the order of their ids.
+    if ((numValues - numSortedValues) * kMaxChangedRowsFraction > numSortedValues) {
+        pColumn->sortedValueIds.resize(numValues);
+        std::iota(pColumn->sortedValueIds.begin(), pColumn->sortedValueIds.end(), 0);
+        std::stable_sort(
+                pColumn->sortedValueIds.begin(),
+                pColumn->sortedValueIds.end(),
+                lessValue);
+    } else {
+        for (int valueId = numSortedValues; valueId < numValues; ++valueId) {
+            const auto pos = std::upper_bound(
+                    pColumn->sortedValueIds.begin(),
+                    pColumn->sortedValueIds.end(),
+                    valueId,
+                    lessValue);
+            pColumn->sortedValueIds.insert(pos, valueId);
+        }
+    }
+
+    pColumn->valueRanks.resize(numValues);
+    int rank = 0;
+    for (int i = 0; i < numValues; ++i) {
+        if (i > 0 &&
+                compareValues(pColumn->sortedValueIds[i - 1],
+                        pColumn->sortedValueIds[i]) != 0) {
+            ++rank;
+        }
+        pColumn->valueRanks[pColumn->sortedValueIds[i]] = rank;
+    }
+}
+
+void TrackColumnIndex::updateTextSortOrder(Column* pColumn) {
+    // Only the distinct values are compared
+    updateTextValueRanks(pColumn);
+
+    // Missing values are sorted first like NULL by the database
+    const int numRows = rowCount();
+    pColumn->rowRanks.resize(numRows);
+    std::vector<int> rankCounts(pColumn->values.size() + 1, 0);
+    for (Row row = 0; row < numRows; ++row) {
+        const int valueId = pColumn->rowValueIds[row];
+        const int rank = valueId < 0 ? -1 : pColumn->valueRanks[valueId];
+        pColumn->rowRanks[row] = rank;
+        ++rankCounts[rank + 1];
+    }
+
+    // Counting sort of the rows by their ranks, which keeps rows with
+    // equal ranks in ascending order
+    int offset = 0;
+    for (auto& count : rankCounts) {
+        const int rankOffset = offset;
+        offset += count;
+        count = rankOffset;
+    }
+    pColumn->sortedRows.resize(numRows);
+    for (Row row = 0; row < numRows; ++row) {
+        pColumn->sortedRows[rankCounts[pColumn->rowRanks[row] + 1]++] = row;
+    }
+}
+
+void TrackColumnIndex::updateNumericSortOrder(Column* pColumn) {
+    // Missing values are sorted first like NULL by the database
+    const std::vector<double>& values = pColumn->numericValues;
+    const auto sortValue = [&values](Row row) {
+        const double value = values[row];
+        return std::isnan(value) ? -std::numeric_limits<double>::infinity() : value;
+    };
+    const auto lessRow = [&sortValue](Row lhs, Row rhs) {
+        const double lhsValue = sortValue(lhs);
+        const double rhsValue = sortValue(rhs);
+        return lhsValue < rhsValue || (lhsValue == rhsValue && lhs < rhs);
+    };
+
+    const int numRows = rowCount();
+    if (pColumn->sortOrderValid) {
+        // Reposition the changed rows: Remove them from the sort order,
+        // sort them, and merge them back
+        std::vector<Row>& changedRows = pColumn->changedRows;
+        std::sort(changedRows.begin(), changedRows.end());
+        changedRows.erase(
+                std::unique(changedRows.begin(), changedRows.end()),
+                changedRows.end());
+        RowMask changed(numRows, 0);
+        for (const Row row : changedRows) {
+            changed[row] = 1;
+        }
+        std::vector<Row> unchangedRows;
+        unchangedRows.reserve(numRows);
+        for (const Row row : pColumn->sortedRows) {
+            if (!changed[row]) {
+                unchangedRows.push_back(row);
+            }
+        }
+        std::sort(changedRows.begin(), changedRows.end(), lessRow);
+        pColumn->sortedRows.clear();
+        pColumn->sortedRows.reserve(numRows);
+        std::merge(unchangedRows.begin(),
+                unchangedRows.end(),
+                changedRows.begin(),
+                changedRows.end(),
+                std::back_inserter(pColumn->sortedRows),
+                lessRow);
+    } else {
+        pColumn->sortedRows.resize(numRows);
+        std::iota(pColumn->sortedRows.begin(), pColumn->sortedRows.end(), 0);
+        sortRowsConcurrently(&pColumn->sortedRows, lessRow);
+    }
+    DEBUG_ASSERT(static_cast<int>(pColumn->sortedRows.size()) == numRows);
+
+    pColumn->rowRanks.resize(numRows);
+    int rank = 0;
+    for (int i = 0; i < numRows; ++i) {
+        const Row row = pColumn->sortedRows[i];
+        if (i > 0 && sortValue(pColumn->sortedRows[i - 1]) != sortValue(row)) {
+            ++rank;
+        }
+        pColumn->rowRanks[row] = rank;
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+#include <vector>
+
+#include "track/trackid.h"
+#include "util/string.h"
+
+/// An in-memory columnar index of the searchable and sortable columns
+/// of a BaseTrackCache.
+///
+/// Each row holds the values of a single track. Text values are interned
+/// per column and also stored case- and diacritic-folded like the
+/// LIKE operator of the database compares them. Substring searches
+/// are narrowed down by trigram postings of the folded values before
+/// scanning the rows. Sort orders are computed once per column and only
+/// the rows that have changed since are repositioned when needed again.
+///
+/// Filters are evaluated for all rows at once into a RowMask, i.e. by
+/// tight loops over plain arrays instead of a query per keystroke.
+class TrackColumnIndex final {
+  public:
+    typedef int Row;
+
+    /// One byte per row. Plain bytes are faster to scan and to combine
+    /// than packed bits.
+    typedef std::vector<quint8> RowMask;
+
+    /// Compares two values of a text column for sorting.
+    typedef std::function<int(const QString&, const QString&)> TextComparator;
+
+    /// A column and its direction when sorting by multiple columns.
+    struct ColumnOrder {
+        int column;
+        Qt::SortOrder order;
+    };
+
+    enum ColumnType {
+        /// Text that is searched by substrings
+        TextColumn = 0x1,
+        /// Text with trigram postings for faster substring searches.
+        /// Not worth the memory for columns with mostly unique values,
+        /// e.g. the location. Implies TextColumn.
+        NGramTextColumn = 0x2,
+        /// Numbers that are filtered by comparison and sorted numerically.
+        /// Might be combined with text, e.g. for the track number.
+        NumericColumn = 0x4,
+        /// The number of a text is its leading integer like for
+        /// cast(... as integer) in SQL, e.g. 3 for the track number "3/12".
+        /// Implies NumericColumn.
+        LeadingIntegerColumn = 0x8,
+    };
+
+    TrackColumnIndex() = default;
+
+    /// Adds a column for the given field of the records passed to
+    /// updateRow(). Must be called before adding any rows.
+    ///
+    /// Text is sorted by the collation keys of the values unless a
+    /// comparator is given. Numeric columns are sorted by their numbers.
+    void addColumn(
+            const QString& name,
+            int field,
+            int types,
+            TextComparator textComparator = TextComparator());
+
+    /// Returns the column with the given (SQL) name or -1 if the column
+    /// is not indexed.
+    int column(const QString& name) const {
+        return m_columnsByName.value(name, -1);
+    }
+    /// Returns the column of the given field or -1 if the field is
+    /// not indexed.
+    int columnForField(int field) const {
+        return m_columnsByField.value(field, -1);
+    }
+    bool isTextColumn(int column) const {
+        return m_columns[column].types & TextColumn;
+    }
+    bool isNumericColumn(int column) const {
+        return m_columns[column].types & NumericColumn;
+    }
+
+    /// Removes all rows and keeps the columns.
+    void clear();
+
+    /// Inserts or replaces the values of a track.
+    void updateRow(TrackId trackId, const QVector<QVariant>& record);
+    void removeRow(TrackId trackId);
+
+    /// The number of rows including unused rows of removed tracks,
+    /// i.e. the size of a RowMask.
+    int rowCount() const {
+        return static_cast<int>(m_trackIds.size());
+    }
+    /// Returns the row of a track or -1 if the track is not indexed.
+    Row row(TrackId trackId) const {
+        return m_rowsByTrackId.value(trackId, -1);
+    }
+    /// Returns an invalid id for unused rows.
+    TrackId trackId(Row row) const {
+        return m_trackIds[row];
+    }
+
+    RowMask emptyMask() const {
+        return RowMask(m_trackIds.size(), 0);
+    }
+    /// All rows that are in use.
+    RowMask fullMask() const;
+
+    /// The following functions mark matching rows in addition to those
+    /// that are already marked. Unused rows might be marked too.
+
+    /// Marks the rows whose value contains the folded argument, see
+    /// mixxx::DbConnection::makeStringLatinLow().
+    void matchText(int column, const QString& foldedArgument, RowMask* pMatches) const;
+    /// Marks the rows whose value is empty or missing.
+    void matchNullOrEmptyText(int column, RowMask* pMatches) const;
+
+    /// The numeric values of all rows. Missing values and values that
+    /// are not numbers are NaN. Texts without a leading integer are 0 in
+    /// a LeadingIntegerColumn.
+    const std::vector<double>& numericValues(int column) const {
+        return m_columns[column].numericValues;
+    }
+
+    /// Returns the rank of each row in ascending order of the column.
+    /// Rows with equal values have the same rank.
+    const std::vector<int>& rowRanks(int column);
+    /// Returns all rows in ascending order of the column. Rows with
+    /// equal values are in ascending order.
+    const std::vector<Row>& sortedRows(int column);
+    /// Sorts the given rows by the ranks of multiple columns. Ties are
+    /// in ascending order of the rows. Large numbers of rows are sorted
+    /// concurrently.
+    void sortRows(std::vector<Row>* pRows, const std::vector<ColumnOrder>& columnOrders);
+    /// Discards the sort order of a column, e.g. if the comparator
+    /// depends on a setting that has been changed.
+    void invalidateSortOrder(int column);
+
+  private:
+    struct Column {
+        QString name;
+        int field;
+        int types;
+        TextComparator textComparator;
+
+        // Text values
+        QHash<QString, int> valueIdsByValue;
+        std::vector<QString> values;
+        std::vector<QString> foldedValues;
+        // Maps trigrams of the folded values to the ascending ids of
+        // the values that contain them
+        QHash<quint64, std::vector<int>> postings;
+        // -1 for missing values
+        std::vector<int> rowValueIds;
+
+        std::vector<double> numericValues;
+
+        // The sort order needs to be rebuilt if not valid. Otherwise
+        // only the changed rows need to be repositioned.
+        bool sortOrderValid = false;
+        std::vector<Row> changedRows;
+        std::vector<int> rowRanks;
+        std::vector<Row> sortedRows;
+
+        // Text values in ascending order and their ranks. Collation keys
+        // are only needed without a comparator.
+        std::vector<QCollatorSortKey> sortKeys;
+        std::vector<int> sortedValueIds;
+        std::vector<int> valueRanks;
+    };
+
+    int internTextValue(Column* pColumn, const QString& value);
+    void markRowChanged(Column* pColumn, Row row);
+    void updateSortOrder(Column* pColumn);
+    void updateTextValueRanks(Column* pColumn);
+    void updateTextSortOrder(Column* pColumn);
+    void updateNumericSortOrder(Column* pColumn);
+
+    const mixxx::StringCollator m_collator;
+
+    std::vector<Column> m_columns;
+    QHash<QString, int> m_columnsByName;
+    QHash<int, int> m_columnsByField;
+
+    std::vector<TrackId> m_trackIds;
+    QHash<TrackId, Row> m_rowsByTrackId;
+    std::vector<Row> m_unusedRows;
+};
@@ -176,6 +176,7 @@ void DlgPrefLibrary::initializeDirList() {
 
 void DlgPrefLibrary::slotResetToDefaults() {
     checkBox_library_scan->setChecked(false);
+    checkBox_library_live_sync->setChecked(false);
     checkBox_SyncTrackMetadataExport->setChecked(false);
     checkBox_SeratoMetadataExport->setChecked(false);
     checkBox_use_relative_path->setChecked(false);
@@ -196,6 +197,8 @@ void DlgPrefLibrary::slotUpdate() {
     initializeDirList();
     checkBox_library_scan->setChecked(m_pConfig->getValue(
             ConfigKey("[Library]","RescanOnStartup"), false));
+    checkBox_library_live_sync->setChecked(m_pConfig->getValue(
+            ConfigKey("[Library]", "LiveSync"), false));
     checkBox_SyncTrackMetadataExport->setChecked(m_pConfig->getValue(
             ConfigKey("[Library]","SyncTrackMetadataExport"), false));
     checkBox_SeratoMetadataExport->setChecked(m_pConfig->getValue(
@@ -363,6 +366,12 @@ void DlgPrefLibrary::slotSeratoMetadataExportClicked(bool checked) {
 void DlgPrefLibrary::slotApply() {
     m_pConfig->set(ConfigKey("[Library]","RescanOnStartup"),
                 ConfigValue((int)checkBox_library_scan->isChecked()));
+    const bool liveSync = checkBox_library_live_sync->isChecked();
+    if (liveSync != m_pConfig->getValue(ConfigKey("[Library]", "LiveSync"), false)) {
+        m_pConfig->set(ConfigKey("[Library]", "LiveSync"),
+                ConfigValue(static_cast<int>(liveSync)));
+        m_pLibrary->trackCollectionManager()->setLibraryLiveSync(liveSync);
+    }
     m_pConfig->set(ConfigKey("[Library]","SyncTrackMetadataExport"),
                 ConfigValue((int)checkBox_SyncTrackMetadataExport->isChecked()));
     m_pConfig->set(ConfigKey("[Library]", "SeratoMetadataExport"),
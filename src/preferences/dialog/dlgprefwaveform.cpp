@@ -112,6 +112,10 @@ DlgPrefWaveform::DlgPrefWaveform(
             QOverload<double>::of(&QDoubleSpinBox::valueChanged),
             this,
             &DlgPrefWaveform::slotSetVisualGainHigh);
+    connect(adaptiveFrameRateCheckBox,
+            &QCheckBox::toggled,
+            this,
+            &DlgPrefWaveform::slotSetAdaptiveFrameRate);
     connect(normalizeOverviewCheckBox,
             &QCheckBox::toggled,
             this,
@@ -154,6 +158,7 @@ void DlgPrefWaveform::slotUpdate() {
 
     frameRateSpinBox->setValue(factory->getFrameRate());
     frameRateSlider->setValue(factory->getFrameRate());
+    adaptiveFrameRateCheckBox->setChecked(factory->isAdaptiveFrameRate());
     endOfTrackWarningTimeSpinBox->setValue(factory->getEndOfTrackWarningTime());
     endOfTrackWarningTimeSlider->setValue(factory->getEndOfTrackWarningTime());
     synchronizeZoomCheckBox->setChecked(factory->isZoomSync());
@@ -222,6 +227,7 @@ void DlgPrefWaveform::slotResetToDefaults() {
 
     // 30FPS is the default
     frameRateSlider->setValue(30);
+    adaptiveFrameRateCheckBox->setChecked(false);
     endOfTrackWarningTimeSlider->setValue(30);
 
     // Waveform caching enabled.
@@ -262,6 +268,10 @@ void DlgPrefWaveform::slotSetDefaultZoom(int index) {
     WaveformWidgetFactory::instance()->setDefaultZoom(index + 1);
 }
 
+void DlgPrefWaveform::slotSetAdaptiveFrameRate(bool adaptive) {
+    WaveformWidgetFactory::instance()->setAdaptiveFrameRate(adaptive);
+}
+
 void DlgPrefWaveform::slotSetZoomSynchronization(bool checked) {
     WaveformWidgetFactory::instance()->setZoomSync(checked);
 }
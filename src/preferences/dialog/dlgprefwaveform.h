@@ -26,6 +26,7 @@ class DlgPrefWaveform : public DlgPreferencePage, public Ui::DlgPrefWaveformDlg
 
   private slots:
     void slotSetFrameRate(int frameRate);
+    void slotSetAdaptiveFrameRate(bool adaptive);
     void slotSetWaveformType(int index);
     void slotSetWaveformOverviewType(int index);
     void slotSetDefaultZoom(int index);
@@ -26,6 +26,18 @@ class WaveformSettings {
                 ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"), enabled);
     }
 
+    // Compresses the cached waveforms at the cost of mapping them
+    // into memory on demand
+    bool waveformCacheCompressionEnabled() const {
+        return m_pConfig->getValue<bool>(
+                ConfigKey("[Library]", "EnableWaveformCacheCompression"), false);
+    }
+
+    void setWaveformCacheCompressionEnabled(bool enabled) {
+        m_pConfig->setValue<bool>(
+                ConfigKey("[Library]", "EnableWaveformCacheCompression"), enabled);
+    }
+
   private:
     UserSettingsPointer m_pConfig;
 };
@@ -516,8 +516,32 @@ SoundSourceProxy::importTrackMetadataAndCoverImage(
             pCoverImage);
 }
 
+//static
+SoundSourceProxy::ImportedTrackMetadataAndCoverInfo
+SoundSourceProxy::importNewTrackMetadataAndCoverInfoFromFile(
+        mixxx::FileAccess trackFileAccess) {
+    ImportedTrackMetadataAndCoverInfo imported;
+    if (!trackFileAccess.info().checkFileExists()) {
+        return imported;
+    }
+    // A temporary track object that is not managed by GlobalTrackCache
+    QImage coverImage;
+    imported.result = SoundSourceProxy(Track::newTemporary(std::move(trackFileAccess)))
+                              .importTrackMetadataAndCoverImage(
+                                      &imported.trackMetadata,
+                                      &coverImage);
+    if (!coverImage.isNull()) {
+        // Like CoverInfoGuesser for embedded cover art
+        imported.embeddedCoverInfo.source = CoverInfo::GUESSED;
+        imported.embeddedCoverInfo.type = CoverInfo::METADATA;
+        imported.embeddedCoverInfo.setImage(coverImage);
+    }
+    return imported;
+}
+
 bool SoundSourceProxy::updateTrackFromSource(
-        UpdateTrackFromSourceMode mode) {
+        UpdateTrackFromSourceMode mode,
+        const ImportedTrackMetadataAndCoverInfo* pImported) {
     DEBUG_ASSERT(m_pTrack);
 
     if (getUrl().isEmpty()) {
@@ -579,11 +603,24 @@ bool SoundSourceProxy::updateTrackFromSource(
         }
     }
 
-    // Parse the tags stored in the audio file
-    auto metadataImportedFromSource =
-            importTrackMetadataAndCoverImage(
-                    &trackMetadata,
-                    pCoverImg);
+    // Parse the tags stored in the audio file unless this has already
+    // been done for a new track. The defaults for the metadata of a new
+    // track are empty.
+    std::pair<mixxx::MetadataSource::ImportResult, QDateTime> metadataImportedFromSource;
+    // The embedded cover art that has been imported in advance
+    const CoverInfoRelative* pImportedCoverInfo = nullptr;
+    if (pImported && !headerParsed) {
+        metadataImportedFromSource = pImported->result;
+        trackMetadata = pImported->trackMetadata;
+        if (pImported->embeddedCoverInfo.hasImage()) {
+            pImportedCoverInfo = &pImported->embeddedCoverInfo;
+        }
+    } else {
+        metadataImportedFromSource =
+                importTrackMetadataAndCoverImage(
+                        &trackMetadata,
+                        pCoverImg);
+    }
     if (metadataImportedFromSource.first ==
             mixxx::MetadataSource::ImportResult::Failed) {
         kLogger.warning()
@@ -711,11 +748,12 @@ bool SoundSourceProxy::updateTrackFromSource(
 
     if (pCoverImg) {
         // If the pointer is not null then the cover art should be guessed
-        auto coverInfo =
-                CoverInfoGuesser().guessCoverInfo(
-                        m_pTrack->getFileInfo(),
-                        m_pTrack->getAlbum(),
-                        *pCoverImg);
+        auto coverInfo = pImportedCoverInfo
+                ? *pImportedCoverInfo
+                : CoverInfoGuesser().guessCoverInfo(
+                          m_pTrack->getFileInfo(),
+                          m_pTrack->getAlbum(),
+                          *pCoverImg);
         DEBUG_ASSERT(coverInfo.source == CoverInfo::GUESSED);
         m_pTrack->setCoverInfo(coverInfo);
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "library/coverart.h"
 #include "preferences/usersettings.h"
 #include "sources/soundsourceproviderregistry.h"
 #include "track/track_decl.h"
@@ -103,6 +104,31 @@ class SoundSourceProxy {
             mixxx::TrackMetadata* pTrackMetadata,
             QImage* pCoverImage) const;
 
+    /// Track metadata and embedded cover art that have been imported
+    /// from a file in advance.
+    struct ImportedTrackMetadataAndCoverInfo {
+        std::pair<mixxx::MetadataSource::ImportResult, QDateTime> result =
+                std::make_pair(mixxx::MetadataSource::ImportResult::Unavailable,
+                        QDateTime());
+        mixxx::TrackMetadata trackMetadata;
+        /// The digest and color of the embedded cover art, if any. The
+        /// decoded image itself is dropped, it is loaded again by
+        /// CoverArtCache when needed.
+        CoverInfoRelative embeddedCoverInfo;
+    };
+
+    /// Import both track metadata and embedded cover art from a file that
+    /// is not yet referenced by any track in the library, e.g. by the
+    /// worker threads of the library scanner.
+    ///
+    /// This function is thread-safe and can be invoked from any thread.
+    /// Unlike importTrackMetadataAndCoverImageFromFile() it does not keep
+    /// GlobalTrackCache locked while parsing the file, because metadata
+    /// is only exported into files of tracks that are in the library.
+    /// Multiple files can be imported concurrently.
+    static ImportedTrackMetadataAndCoverInfo importNewTrackMetadataAndCoverInfoFromFile(
+            mixxx::FileAccess trackFileAccess);
+
     /// Controls which (metadata/coverart) and how tags are (re-)imported from
     /// audio files when creating a SoundSourceProxy.
     enum class UpdateTrackFromSourceMode {
@@ -140,9 +166,15 @@ class SoundSourceProxy {
     /// properly. The application log will contain warning messages for a detailed
     /// analysis in case unexpected behavior has been reported.
     ///
+    /// If the metadata and embedded cover art of the file have already been
+    /// imported by importNewTrackMetadataAndCoverInfoFromFile() they are
+    /// used instead of parsing the file again. They are ignored if the
+    /// track's metadata has already been imported before.
+    ///
     /// Returns true if the track has been modified and false otherwise.
     bool updateTrackFromSource(
-            UpdateTrackFromSourceMode mode = UpdateTrackFromSourceMode::Default);
+            UpdateTrackFromSourceMode mode = UpdateTrackFromSourceMode::Default,
+            const ImportedTrackMetadataAndCoverInfo* pImported = nullptr);
 
     /// Opening the audio source through the proxy will update the
     /// audio properties of the corresponding track object. Returns
@@ -213,3 +245,5 @@ class SoundSourceProxy {
     // that keeps it alive.
     mixxx::AudioSourcePointer m_pAudioSource;
 };
+
+Q_DECLARE_METATYPE(SoundSourceProxy::ImportedTrackMetadataAndCoverInfo);
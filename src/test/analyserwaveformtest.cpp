@@ -1,12 +1,18 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
+
 #include <QDir>
 #include <QtDebug>
+#include <cmath>
+#include <utility>
+#include <vector>
 
 #include "test/mixxxtest.h"
 
 #include "analyzer/analyzerwaveform.h"
 #include "library/dao/analysisdao.h"
 #include "track/track.h"
+#include "util/math.h"
 
 #define BIGBUF_SIZE (1024 * 1024) //Megabyte
 #define CANARY_SIZE (1024 * 4)
@@ -84,4 +90,91 @@ TEST_F(AnalyzerWaveformTest, canary) {
     }
 }
 
+void fillSignal(CSAMPLE* pBuffer, int numSamples) {
+    // A mix of a low, a mid and a high frequency with a varying envelope
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const float envelope = 0.5f + 0.5f * std::sin(i * 0.0001f);
+        const float low = std::sin(i * 0.01f);
+        const float mid = 0.5f * std::sin(i * 0.2f);
+        const float high = 0.25f * std::sin(i * 1.3f);
+        pBuffer[i * 2] = envelope * (low + mid + high);
+        pBuffer[i * 2 + 1] = envelope * (low - mid + high);
+    }
+}
+
+// The strides must not depend on how the samples are split into chunks
+TEST_F(AnalyzerWaveformTest, chunkSizeIndependent) {
+    fillSignal(bigbuf, BIGBUF_SIZE);
+
+    aw.initialize(tio, tio->getSampleRate(), BIGBUF_SIZE);
+    aw.processSamples(bigbuf, BIGBUF_SIZE);
+    aw.storeResults(tio);
+    aw.cleanup();
+
+    TrackPointer pChunkedTrack = Track::newTemporary();
+    pChunkedTrack->setAudioProperties(
+            mixxx::audio::ChannelCount(2),
+            mixxx::audio::SampleRate(44100),
+            mixxx::audio::Bitrate(),
+            mixxx::Duration::fromMillis(1000));
+    AnalyzerWaveform chunkedAnalyzer(config(), QSqlDatabase());
+    chunkedAnalyzer.initialize(pChunkedTrack, pChunkedTrack->getSampleRate(), BIGBUF_SIZE);
+    // Odd chunk sizes that are not aligned to the blocks or the strides
+    const int chunkSizes[] = {2, 1022, 4098, 30, 8190};
+    int offset = 0;
+    for (int i = 0; offset < BIGBUF_SIZE; ++i) {
+        const int chunkSize = math_min(chunkSizes[i % 5], BIGBUF_SIZE - offset);
+        chunkedAnalyzer.processSamples(bigbuf + offset, chunkSize);
+        offset += chunkSize;
+    }
+    chunkedAnalyzer.storeResults(pChunkedTrack);
+    chunkedAnalyzer.cleanup();
+
+    const std::pair<ConstWaveformPointer, ConstWaveformPointer> waveforms[] = {
+            {tio->getWaveform(), pChunkedTrack->getWaveform()},
+            {tio->getWaveformSummary(), pChunkedTrack->getWaveformSummary()},
+    };
+    for (const auto& waveform : waveforms) {
+        ASSERT_TRUE(waveform.first);
+        ASSERT_TRUE(waveform.second);
+        ASSERT_EQ(waveform.first->getDataSize(), waveform.second->getDataSize());
+        for (int i = 0; i < waveform.first->getDataSize(); ++i) {
+            EXPECT_EQ(waveform.first->data()[i].m_i, waveform.second->data()[i].m_i);
+        }
+    }
+    // The signal is not silent
+    EXPECT_GT(tio->getWaveform()->getAll(tio->getWaveform()->getDataSize() / 2), 0);
+}
+
+// Measures the throughput in seconds of audio analyzed per second with
+// chunks of the given size
+static void BM_AnalyzerWaveform(benchmark::State& state) {
+    constexpr int kSampleRate = 44100;
+    constexpr int kSeconds = 60;
+    constexpr int kNumSamples = kSampleRate * 2 * kSeconds;
+    const int chunkSize = static_cast<int>(state.range(0));
+    std::vector<CSAMPLE> buffer(kNumSamples);
+    fillSignal(buffer.data(), kNumSamples);
+
+    UserSettingsPointer pConfig(new UserSettings(QString()));
+    AnalyzerWaveform analyzer(pConfig, QSqlDatabase());
+    TrackPointer pTrack = Track::newTemporary();
+    pTrack->setAudioProperties(
+            mixxx::audio::ChannelCount(2),
+            mixxx::audio::SampleRate(kSampleRate),
+            mixxx::audio::Bitrate(),
+            mixxx::Duration::fromSeconds(kSeconds));
+    for (auto _ : state) {
+        analyzer.initialize(pTrack, pTrack->getSampleRate(), kNumSamples);
+        for (int offset = 0; offset < kNumSamples; offset += chunkSize) {
+            analyzer.processSamples(buffer.data() + offset,
+                    math_min(chunkSize, kNumSamples - offset));
+        }
+        analyzer.cleanup();
+    }
+    state.counters["AudioSecondsPerSecond"] = benchmark::Counter(
+            kSeconds, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_AnalyzerWaveform)->Range(1024, 16384);
+
 } // namespace
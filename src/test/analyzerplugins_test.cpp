@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "analyzer/constants.h"
+#include "analyzer/plugins/analyzerqueenmarybeats.h"
+#include "analyzer/plugins/analyzerqueenmarykey.h"
+#include "analyzer/plugins/analyzersoundtouchbeats.h"
+#include "util/math.h"
+#include "util/sample.h"
+#if defined __KEYFINDER__
+#include "analyzer/plugins/analyzerkeyfinder.h"
+#endif
+
+namespace {
+
+constexpr mixxx::audio::SampleRate kSampleRate = mixxx::audio::SampleRate(44100);
+constexpr SINT kTrackLengthFrames = 20 * 44100;
+constexpr double kBpm = 120.0;
+
+// The plugins analyze a mono downmix. Feeding them the downmix of the
+// analyzer thread must not change their results.
+class AnalyzerPluginsTest : public testing::Test {
+  protected:
+    AnalyzerPluginsTest()
+            : m_stereoSamples(kTrackLengthFrames * mixxx::kAnalysisChannels),
+              m_monoSamples(kTrackLengthFrames) {
+        // Clicks of a decaying 1 kHz tone on each beat over an A major
+        // chord. The channels differ, so that the downmix matters.
+        const SINT framesPerBeat = static_cast<SINT>(kSampleRate * 60.0 / kBpm);
+        for (SINT frame = 0; frame < kTrackLengthFrames; ++frame) {
+            const double time = static_cast<double>(frame) / kSampleRate;
+            const double chord = 0.1 *
+                    (std::sin(2 * M_PI * 220.0 * time) +
+                            std::sin(2 * M_PI * 277.18 * time) +
+                            std::sin(2 * M_PI * 329.63 * time));
+            const double clickTime =
+                    static_cast<double>(frame % framesPerBeat) / kSampleRate;
+            const double click = 0.5 * std::exp(-clickTime * 200.0) *
+                    std::sin(2 * M_PI * 1000.0 * clickTime);
+            m_stereoSamples[frame * 2] = static_cast<CSAMPLE>(chord + click);
+            m_stereoSamples[frame * 2 + 1] = static_cast<CSAMPLE>(chord - 0.5 * click);
+        }
+        SampleUtil::downmixStereoToMono(
+                m_monoSamples.data(), m_stereoSamples.data(), kTrackLengthFrames);
+    }
+
+    // Feeds the samples in blocks like the analyzer thread
+    void analyzeStereo(mixxx::AnalyzerPlugin* pPlugin) const {
+        ASSERT_TRUE(pPlugin->initialize(kSampleRate));
+        for (SINT frame = 0; frame < kTrackLengthFrames; frame += mixxx::kAnalysisFramesPerChunk) {
+            const SINT frameCount = math_min(
+                    mixxx::kAnalysisFramesPerChunk, kTrackLengthFrames - frame);
+            ASSERT_TRUE(pPlugin->processSamples(
+                    &m_stereoSamples[frame * mixxx::kAnalysisChannels],
+                    static_cast<int>(frameCount * mixxx::kAnalysisChannels)));
+        }
+        ASSERT_TRUE(pPlugin->finalize());
+    }
+
+    void analyzeMono(mixxx::AnalyzerPlugin* pPlugin) const {
+        ASSERT_TRUE(pPlugin->initialize(kSampleRate));
+        for (SINT frame = 0; frame < kTrackLengthFrames; frame += mixxx::kAnalysisFramesPerChunk) {
+            const SINT frameCount = math_min(
+                    mixxx::kAnalysisFramesPerChunk, kTrackLengthFrames - frame);
+            ASSERT_TRUE(pPlugin->processMonoSamples(&m_monoSamples[frame], frameCount));
+        }
+        ASSERT_TRUE(pPlugin->finalize());
+    }
+
+    std::vector<CSAMPLE> m_stereoSamples;
+    std::vector<CSAMPLE> m_monoSamples;
+};
+
+TEST_F(AnalyzerPluginsTest, SoundTouchBeatsMono) {
+    mixxx::AnalyzerSoundTouchBeats stereoPlugin;
+    analyzeStereo(&stereoPlugin);
+    mixxx::AnalyzerSoundTouchBeats monoPlugin;
+    analyzeMono(&monoPlugin);
+
+    ASSERT_TRUE(stereoPlugin.getBpm().isValid());
+    EXPECT_EQ(stereoPlugin.getBpm(), monoPlugin.getBpm());
+}
+
+TEST_F(AnalyzerPluginsTest, QueenMaryBeatsMono) {
+    mixxx::AnalyzerQueenMaryBeats stereoPlugin;
+    analyzeStereo(&stereoPlugin);
+    mixxx::AnalyzerQueenMaryBeats monoPlugin;
+    analyzeMono(&monoPlugin);
+
+    ASSERT_FALSE(stereoPlugin.getBeats().isEmpty());
+    EXPECT_EQ(stereoPlugin.getBeats(), monoPlugin.getBeats());
+}
+
+TEST_F(AnalyzerPluginsTest, QueenMaryKeyMono) {
+    mixxx::AnalyzerQueenMaryKey stereoPlugin;
+    analyzeStereo(&stereoPlugin);
+    mixxx::AnalyzerQueenMaryKey monoPlugin;
+    analyzeMono(&monoPlugin);
+
+    ASSERT_FALSE(stereoPlugin.getKeyChanges().isEmpty());
+    EXPECT_EQ(stereoPlugin.getKeyChanges(), monoPlugin.getKeyChanges());
+}
+
+#if defined __KEYFINDER__
+TEST_F(AnalyzerPluginsTest, KeyFinderMono) {
+    mixxx::AnalyzerKeyFinder stereoPlugin;
+    analyzeStereo(&stereoPlugin);
+    mixxx::AnalyzerKeyFinder monoPlugin;
+    analyzeMono(&monoPlugin);
+
+    ASSERT_FALSE(stereoPlugin.getKeyChanges().isEmpty());
+    EXPECT_EQ(stereoPlugin.getKeyChanges(), monoPlugin.getKeyChanges());
+}
+#endif
+
+} // namespace
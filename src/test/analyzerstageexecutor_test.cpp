@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "analyzer/analyzerstageexecutor.h"
+
+namespace {
+
+const int kNumStages = 6;
+
+TEST(AnalyzerStageExecutorTest, CompleteProcessesAllStages) {
+    AnalyzerStageExecutor executor;
+    std::vector<int> invocations(kNumStages, 0);
+    AnalyzerStageExecutor::Batch batch(
+            kNumStages,
+            [&invocations](int stageIndex) {
+                ++invocations[stageIndex];
+            });
+    executor.submit(&batch, nullptr);
+    EXPECT_TRUE(executor.hasStealableStages());
+    executor.complete(&batch);
+    EXPECT_FALSE(executor.hasStealableStages());
+    for (int i = 0; i < kNumStages; ++i) {
+        EXPECT_EQ(1, invocations[i]);
+    }
+}
+
+TEST(AnalyzerStageExecutorTest, StealStages) {
+    AnalyzerStageExecutor executor;
+    std::vector<std::atomic<int>> invocations(kNumStages);
+    std::atomic<int> stolenStages(0);
+    const auto stealingThreadId = std::this_thread::get_id();
+    AnalyzerStageExecutor::Batch batch(
+            kNumStages,
+            [&](int stageIndex) {
+                if (std::this_thread::get_id() == stealingThreadId) {
+                    ++stolenStages;
+                }
+                ++invocations[stageIndex];
+            });
+    executor.submit(&batch, nullptr);
+
+    // The stages are stolen by this thread before the
+    // submitting thread completes the batch
+    executor.stealStages();
+    EXPECT_EQ(kNumStages, stolenStages.load());
+    EXPECT_FALSE(executor.hasStealableStages());
+
+    std::thread submittingThread([&executor, &batch] {
+        executor.complete(&batch);
+    });
+    submittingThread.join();
+    for (int i = 0; i < kNumStages; ++i) {
+        EXPECT_EQ(1, invocations[i].load());
+    }
+}
+
+TEST(AnalyzerStageExecutorTest, StealConcurrently) {
+    AnalyzerStageExecutor executor;
+    const int kNumBatches = 100;
+    std::vector<std::atomic<int>> invocations(kNumStages);
+    std::atomic<bool> done(false);
+    std::thread stealingThread([&executor, &done] {
+        while (!done.load()) {
+            executor.stealStages();
+        }
+    });
+    for (int i = 0; i < kNumBatches; ++i) {
+        AnalyzerStageExecutor::Batch batch(
+                kNumStages,
+                [&invocations](int stageIndex) {
+                    ++invocations[stageIndex];
+                });
+        executor.submit(&batch, nullptr);
+        executor.complete(&batch);
+        // All stages of the batch have been finished
+        for (int j = 0; j < kNumStages; ++j) {
+            EXPECT_EQ(i + 1, invocations[j].load());
+        }
+    }
+    done.store(true);
+    stealingThread.join();
+}
+
+} // namespace
@@ -0,0 +1,360 @@
+#include <gtest/gtest.h>
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtDebug>
+
+#include "library/basetrackcache.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "library/searchquery.h"
+#include "library/searchqueryparser.h"
+#include "test/librarytest.h"
+#include "track/keyutils.h"
+#include "util/db/sqltransaction.h"
+
+namespace {
+
+const QString kTableName = QStringLiteral("library_cache_view");
+
+const QStringList kColumns = {
+        LIBRARYTABLE_ID,
+        LIBRARYTABLE_TIMESPLAYED,
+        LIBRARYTABLE_ALBUMARTIST,
+        LIBRARYTABLE_ALBUM,
+        LIBRARYTABLE_ARTIST,
+        LIBRARYTABLE_TITLE,
+        LIBRARYTABLE_YEAR,
+        LIBRARYTABLE_RATING,
+        LIBRARYTABLE_GENRE,
+        LIBRARYTABLE_COMPOSER,
+        LIBRARYTABLE_GROUPING,
+        LIBRARYTABLE_TRACKNUMBER,
+        LIBRARYTABLE_KEY,
+        LIBRARYTABLE_KEY_ID,
+        LIBRARYTABLE_BPM,
+        LIBRARYTABLE_DURATION,
+        TRACKLOCATIONSTABLE_LOCATION,
+        LIBRARYTABLE_COMMENT};
+
+struct TestTrack {
+    QString title;
+    QVariant artist;
+    QVariant album;
+    QVariant year;
+    QVariant genre;
+    QVariant trackNumber;
+    mixxx::track::io::key::ChromaticKey key;
+    QVariant bpm;
+    double duration;
+    int timesPlayed;
+    int rating;
+    QVariant comment;
+};
+
+// Null values, empty strings, duplicates, case and diacritics in the
+// values that are filtered and sorted. The titles are unique and used
+// as the last sort column to avoid ties.
+const QVector<TestTrack> kTracks = {
+        {"Alpha", "Abba", "Gold", "1992", "Pop", "1",
+                mixxx::track::io::key::A_MINOR, 120.0, 200.0, 3, 4, QVariant()},
+        {"bravo", "Abba", "Gold", "1992", "Pop", "12",
+                mixxx::track::io::key::C_MAJOR, 128.0, 170.0, 0, 5, "live"},
+        {"Charlie", "Beatles", "Abbey Road", "1969", "rock", "3/12",
+                mixxx::track::io::key::A_MINOR, 95.5, 260.0, 1, 3, "Remastered"},
+        {"Delta", QVariant(), QVariant(), QVariant(), QVariant(), QVariant(),
+                mixxx::track::io::key::INVALID, QVariant(), 90.0, 0, 0, QVariant()},
+        {"Echo", "", "Mix", "", "Electronic", "2",
+                mixxx::track::io::key::F_SHARP_MINOR, 174.0, 400.0, 7, 2, ""},
+        {"Foxtrot", "Röyksopp", "Melody A.M.", "2001", "Electronic", "7",
+                mixxx::track::io::key::E_MINOR, 110.0, 320.0, 2, 4, "Poor leno"},
+        {"Golf", "The Beatles", "Abbey Road", "1969", "Rock", "10",
+                mixxx::track::io::key::C_MAJOR, 130.0, 180.0, 0, 1, QVariant()},
+        {"hotel", "Chemical Brothers", "Surrender", "1999", "electronic", "03",
+                mixxx::track::io::key::G_MINOR, 130.0, 360.0, 12, 5, "Party"},
+};
+
+// Track titles by crate name
+const QMap<QString, QStringList> kCrates = {
+        {"party", {"Alpha", "bravo", "Foxtrot"}},
+        {"chill", {"Charlie"}},
+        {"Rock Classics", {"hotel"}},
+};
+
+} // anonymous namespace
+
+class BaseTrackCacheTest : public LibraryTest {
+  protected:
+    BaseTrackCacheTest() {
+        createView();
+        insertTracks();
+        insertCrates();
+        m_pCache = std::make_unique<BaseTrackCache>(
+                internalCollection(), kTableName, LIBRARYTABLE_ID, kColumns, false);
+        m_pCache->buildIndex();
+    }
+
+    QList<SortColumn> sortColumns(
+            const QList<QPair<QString, Qt::SortOrder>>& columnOrders) const {
+        QList<SortColumn> sortColumns;
+        for (const auto& columnOrder : columnOrders) {
+            sortColumns.append(SortColumn(
+                    m_pCache->fieldIndex(columnOrder.first),
+                    columnOrder.second));
+        }
+        return sortColumns;
+    }
+
+    // The ORDER BY clause like BaseSqlTableModel::setSort() builds it
+    QString orderByClause(const QList<SortColumn>& sortColumns) const {
+        QString orderBy;
+        for (const auto& sc : sortColumns) {
+            orderBy.append(orderBy.isEmpty() ? "ORDER BY " : ", ");
+            orderBy.append(m_pCache->columnSortForFieldIndex(sc.m_column));
+            orderBy.append(sc.m_order == Qt::AscendingOrder ? " ASC" : " DESC");
+        }
+        return orderBy;
+    }
+
+    // The tracks that the database selects like BaseTrackCache does if
+    // the index can't answer the query
+    QVector<TrackId> selectTrackIds(
+            const QueryNode& query, const QString& orderByClause) const {
+        QString filter;
+        const QString querySql = query.toSql();
+        if (!querySql.isEmpty()) {
+            filter = QString("WHERE (%1)").arg(querySql);
+        }
+        QSqlQuery sqlQuery(internalCollection()->database());
+        sqlQuery.setForwardOnly(true);
+        EXPECT_TRUE(sqlQuery.exec(QString("SELECT %1 FROM %2 %3 %4")
+                                          .arg(LIBRARYTABLE_ID,
+                                                  kTableName,
+                                                  filter,
+                                                  orderByClause)))
+                << sqlQuery.lastError().text();
+        QVector<TrackId> trackIds;
+        while (sqlQuery.next()) {
+            trackIds.append(TrackId(sqlQuery.value(0)));
+        }
+        return trackIds;
+    }
+
+    QStringList titles(const QVector<TrackId>& trackIds) const {
+        const int titleField = m_pCache->fieldIndex(LIBRARYTABLE_TITLE);
+        QStringList titles;
+        for (const auto& trackId : trackIds) {
+            titles.append(m_pCache->data(trackId, titleField).toString());
+        }
+        return titles;
+    }
+
+    QSet<TrackId> m_trackIds;
+    QHash<QString, TrackId> m_trackIdsByTitle;
+    std::unique_ptr<BaseTrackCache> m_pCache;
+
+  private:
+    // The view of MixxxLibraryFeature
+    void createView() {
+        QStringList qualifiedColumns;
+        for (const auto& column : kColumns) {
+            qualifiedColumns.append(mixxx::trackschema::tableForColumn(column) +
+                    QLatin1Char('.') + column);
+        }
+        QSqlQuery query(internalCollection()->database());
+        query.prepare(QString(
+                "CREATE TEMPORARY VIEW IF NOT EXISTS %1 AS "
+                "SELECT %2 FROM library "
+                "INNER JOIN track_locations ON library.location = track_locations.id")
+                              .arg(kTableName, qualifiedColumns.join(",")));
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
+    }
+
+    void insertTracks() {
+        const QSqlDatabase db = internalCollection()->database();
+        SqlTransaction transaction(db);
+        QSqlQuery locationQuery(db);
+        locationQuery.prepare(
+                "INSERT INTO track_locations "
+                "(location, directory, filename, filesize, fs_deleted, needs_verification) "
+                "VALUES (:location, :directory, :filename, 0, 0, 0)");
+        QSqlQuery libraryQuery(db);
+        libraryQuery.prepare(
+                "INSERT INTO library "
+                "(title, artist, album, year, genre, tracknumber, key, key_id, bpm, "
+                "duration, timesplayed, rating, comment, location, mixxx_deleted) "
+                "VALUES (:title, :artist, :album, :year, :genre, :tracknumber, "
+                ":key, :key_id, :bpm, :duration, :timesplayed, :rating, :comment, "
+                ":location, 0)");
+        for (const auto& track : kTracks) {
+            const QString directory = QStringLiteral("/music");
+            const QString fileName = track.title + QStringLiteral(".mp3");
+            locationQuery.bindValue(":location", directory + '/' + fileName);
+            locationQuery.bindValue(":directory", directory);
+            locationQuery.bindValue(":filename", fileName);
+            ASSERT_TRUE(locationQuery.exec()) << locationQuery.lastError().text();
+            libraryQuery.bindValue(":title", track.title);
+            libraryQuery.bindValue(":artist", track.artist);
+            libraryQuery.bindValue(":album", track.album);
+            libraryQuery.bindValue(":year", track.year);
+            libraryQuery.bindValue(":genre", track.genre);
+            libraryQuery.bindValue(":tracknumber", track.trackNumber);
+            if (track.key == mixxx::track::io::key::INVALID) {
+                libraryQuery.bindValue(":key", QVariant());
+                libraryQuery.bindValue(":key_id", QVariant());
+            } else {
+                libraryQuery.bindValue(":key",
+                        KeyUtils::keyToString(track.key,
+                                KeyUtils::KeyNotation::Traditional));
+                libraryQuery.bindValue(":key_id", static_cast<int>(track.key));
+            }
+            libraryQuery.bindValue(":bpm", track.bpm);
+            libraryQuery.bindValue(":duration", track.duration);
+            libraryQuery.bindValue(":timesplayed", track.timesPlayed);
+            libraryQuery.bindValue(":rating", track.rating);
+            libraryQuery.bindValue(":comment", track.comment);
+            libraryQuery.bindValue(":location", locationQuery.lastInsertId());
+            ASSERT_TRUE(libraryQuery.exec()) << libraryQuery.lastError().text();
+            const TrackId trackId(libraryQuery.lastInsertId());
+            m_trackIds.insert(trackId);
+            m_trackIdsByTitle.insert(track.title, trackId);
+        }
+        transaction.commit();
+    }
+
+    void insertCrates() {
+        for (auto it = kCrates.begin(); it != kCrates.end(); ++it) {
+            Crate crate;
+            crate.setName(it.key());
+            CrateId crateId;
+            ASSERT_TRUE(internalCollection()->insertCrate(crate, &crateId));
+            QList<TrackId> trackIds;
+            for (const auto& title : it.value()) {
+                trackIds.append(m_trackIdsByTitle.value(title));
+            }
+            ASSERT_TRUE(internalCollection()->addCrateTracks(crateId, trackIds));
+        }
+    }
+};
+
+TEST_F(BaseTrackCacheTest, IndexAgreesWithDatabase) {
+    const QStringList queries = {
+            // All tracks
+            "",
+            // Text of the search columns, shorter than the n-grams,
+            // case and diacritics
+            "abba",
+            "ABBEY",
+            "ro",
+            "royksopp",
+            "\"abbey road\"",
+            "-beatles",
+            "beatles -the",
+            // Text filters
+            "artist:abba",
+            "title:o",
+            "album:\"melody a.m.\"",
+            "genre:electronic",
+            "comment:re",
+            // Negated comparisons with NULL
+            "-comment:live",
+            "location:/music/golf",
+            // Empty or NULL text
+            "artist:\"\"",
+            "comment:\"\"",
+            // Numbers
+            "bpm:>120",
+            "bpm:<=110",
+            "bpm:100-130",
+            "played:>0",
+            "rating:>=4",
+            "duration:>3m",
+            "-bpm:>120",
+            // NULL numbers
+            "bpm:\"\"",
+            "-bpm:\"\"",
+            // Keys
+            "key:Am",
+            "~key:Am",
+            "key:\"\"",
+            "-key:C",
+            // Crates, also matched by untagged terms
+            "crate:party",
+            "crate:\"\"",
+            "-crate:party",
+            "party",
+            "rock",
+            // Combinations
+            "genre:electronic bpm:<150",
+            "crate:party rating:5",
+    };
+    const QList<QList<QPair<QString, Qt::SortOrder>>> orders = {
+            {{LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_TITLE, Qt::DescendingOrder}},
+            {{LIBRARYTABLE_ARTIST, Qt::AscendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_ARTIST, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_ALBUM, Qt::AscendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::DescendingOrder}},
+            {{LIBRARYTABLE_GENRE, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_YEAR, Qt::AscendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_YEAR, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::DescendingOrder}},
+            {{LIBRARYTABLE_TRACKNUMBER, Qt::AscendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_TRACKNUMBER, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_KEY, Qt::AscendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_KEY, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_BPM, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+            {{LIBRARYTABLE_RATING, Qt::AscendingOrder},
+                    {LIBRARYTABLE_YEAR, Qt::DescendingOrder},
+                    {LIBRARYTABLE_TITLE, Qt::AscendingOrder}},
+    };
+
+    for (const auto& query : queries) {
+        const std::unique_ptr<QueryNode> pQuery =
+                m_pCache->m_pQueryParser->parseQuery(
+                        query, m_pCache->m_searchColumns, QString());
+        for (const auto& order : orders) {
+            const QList<SortColumn> sorts = sortColumns(order);
+            const QString orderBy = orderByClause(sorts);
+            m_pCache->m_trackOrder.resize(0);
+            ASSERT_TRUE(m_pCache->filterAndSortInIndex(
+                    m_trackIds, *pQuery, orderBy, sorts, 0))
+                    << query.toStdString() << " " << orderBy.toStdString();
+            EXPECT_EQ(titles(selectTrackIds(*pQuery, orderBy)),
+                    titles(m_pCache->m_trackOrder))
+                    << query.toStdString() << " " << orderBy.toStdString();
+        }
+    }
+}
+
+TEST_F(BaseTrackCacheTest, NumericTextFiltersFallBackToDatabase) {
+    // The database compares the year and the track number as text
+    const QStringList queries = {
+            "year:1992",
+            "year:>1990",
+            "track:>5",
+            "track:1-9",
+    };
+    const QList<SortColumn> sorts =
+            sortColumns({{LIBRARYTABLE_TITLE, Qt::AscendingOrder}});
+    for (const auto& query : queries) {
+        const std::unique_ptr<QueryNode> pQuery =
+                m_pCache->m_pQueryParser->parseQuery(
+                        query, m_pCache->m_searchColumns, QString());
+        m_pCache->m_trackOrder.resize(0);
+        EXPECT_FALSE(m_pCache->filterAndSortInIndex(
+                m_trackIds, *pQuery, orderByClause(sorts), sorts, 0))
+                << query.toStdString();
+    }
+}
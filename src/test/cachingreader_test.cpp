@@ -0,0 +1,326 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "control/controlobject.h"
+#include "engine/cachingreader/cachingreader.h"
+#include "engine/cachingreader/cachingreaderdiskcache.h"
+#include "engine/engineworkerscheduler.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+
+namespace {
+
+const QString kGroup = QStringLiteral("[Channel1]");
+
+const int kTimeoutMillis = 5000;
+
+class CachingReaderTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    CachingReaderTest()
+            : m_budgetLimitBytes(CachingReaderChunkBudget::limitBytes()),
+              m_trackLoaded(false) {
+        m_scheduler.start();
+    }
+
+    ~CachingReaderTest() override {
+        // The worker must be stopped before the scheduler
+        m_pReader.reset();
+        // The budget is shared with other tests
+        CachingReaderChunkBudget::setLimitBytes(m_budgetLimitBytes);
+    }
+
+    static QString testFilePath(const QString& fileName) {
+        return QDir::currentPath() + "/src/test/" + fileName;
+    }
+
+    void createReader() {
+        m_pReader = std::make_unique<CachingReader>(
+                kGroup, config(), CachingReader::Role::Deck);
+        m_pReader->setScheduler(&m_scheduler);
+        QObject::connect(m_pReader.get(),
+                &CachingReader::trackLoaded,
+                [this] {
+                    m_trackLoaded = true;
+                });
+    }
+
+    // Issues the hints and runs the worker like a callback of the engine
+    void callback(const HintVector& hints = HintVector()) {
+        m_pReader->hintAndMaybeWake(hints);
+        m_scheduler.runWorkers();
+    }
+
+    // Calls back until the condition holds or the timeout has expired
+    template<typename Condition>
+    bool waitFor(Condition condition, const HintVector& hints = HintVector()) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < kTimeoutMillis) {
+            callback(hints);
+            m_pReader->process();
+            if (condition()) {
+                return true;
+            }
+            QThread::msleep(1);
+        }
+        return false;
+    }
+
+    bool loadTrack(const QString& filePath) {
+        m_trackLoaded = false;
+        m_pTrack = Track::newTemporary(filePath);
+        m_pReader->newTrack(m_pTrack);
+        if (!waitFor([this] { return m_trackLoaded.load(); })) {
+            return false;
+        }
+        // The status update is sent before the signal
+        m_pReader->process();
+        return true;
+    }
+
+    static Hint hint(SINT frame, SINT frameCount, int priority) {
+        Hint hint;
+        hint.frame = frame;
+        hint.frameCount = frameCount;
+        hint.priority = priority;
+        return hint;
+    }
+
+    CachingReader::ReadResult read(
+            const mixxx::IndexRange& frameIndexRange,
+            mixxx::SampleBuffer* pBuffer) {
+        const SINT numSamples =
+                CachingReaderChunk::frames2samples(frameIndexRange.length());
+        mixxx::SampleBuffer(numSamples).swap(*pBuffer);
+        return m_pReader->read(
+                CachingReaderChunk::frames2samples(frameIndexRange.start()),
+                numSamples,
+                false,
+                pBuffer->data());
+    }
+
+    mixxx::AudioSourcePointer openAudioSource() const {
+        mixxx::AudioSource::OpenParams config;
+        config.setChannelCount(CachingReaderChunk::kChannels);
+        return SoundSourceProxy(m_pTrack).openAudioSource(config);
+    }
+
+    // Decodes the frames like the worker does
+    mixxx::SampleBuffer decode(const mixxx::IndexRange& frameIndexRange) const {
+        const auto pAudioSource = openAudioSource();
+        mixxx::SampleBuffer tempBuffer(
+                pAudioSource->getSignalInfo().frames2samples(
+                        frameIndexRange.length()));
+        mixxx::AudioSourceStereoProxy stereoProxy(
+                pAudioSource,
+                mixxx::SampleBuffer::WritableSlice(tempBuffer));
+        mixxx::SampleBuffer buffer(
+                CachingReaderChunk::frames2samples(frameIndexRange.length()));
+        stereoProxy.readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        frameIndexRange,
+                        mixxx::SampleBuffer::WritableSlice(buffer)));
+        return buffer;
+    }
+
+    static double controlValue(const QString& item) {
+        return ControlObject::get(ConfigKey(kGroup, item));
+    }
+
+    const SINT m_budgetLimitBytes;
+    EngineWorkerScheduler m_scheduler;
+    std::unique_ptr<CachingReader> m_pReader;
+    TrackPointer m_pTrack;
+    std::atomic<bool> m_trackLoaded;
+};
+
+TEST_F(CachingReaderTest, PreloadBeforeFirstRead) {
+    config()->setValue(ConfigKey(kGroup, "preload_track"), true);
+    createReader();
+    ASSERT_TRUE(loadTrack(testFilePath("sine-30.wav")));
+    ASSERT_TRUE(waitFor([] {
+        return controlValue("preload_progress") == 1.0;
+    }));
+
+    // Across chunk boundaries in the middle of the track without any
+    // preceding hints
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            10 * CachingReaderChunk::kFrames + 100,
+            2 * CachingReaderChunk::kFrames);
+    mixxx::SampleBuffer buffer;
+    ASSERT_EQ(CachingReader::ReadResult::AVAILABLE,
+            read(frameIndexRange, &buffer));
+    const mixxx::SampleBuffer expected = decode(frameIndexRange);
+    for (SINT i = 0; i < buffer.size(); ++i) {
+        ASSERT_EQ(expected.data()[i], buffer.data()[i]) << i;
+    }
+
+    // Read from the preload buffer, not from chunks
+    callback();
+    EXPECT_EQ(0.0, controlValue("cache_hits"));
+    EXPECT_EQ(0.0, controlValue("cache_misses"));
+}
+
+TEST_F(CachingReaderTest, NoPreloadByDefault) {
+    createReader();
+    ASSERT_TRUE(loadTrack(testFilePath("sine-30.wav")));
+    callback();
+    EXPECT_EQ(0.0, controlValue("preload_progress"));
+
+    // Nothing has been hinted yet
+    mixxx::SampleBuffer buffer;
+    EXPECT_EQ(CachingReader::ReadResult::UNAVAILABLE,
+            read(mixxx::IndexRange::forward(
+                         10 * CachingReaderChunk::kFrames,
+                         CachingReaderChunk::kFrames),
+                    &buffer));
+    callback();
+    EXPECT_EQ(1.0, controlValue("cache_misses"));
+}
+
+TEST_F(CachingReaderTest, PrefetchReplacesChunksThatLeftThePlayWindow) {
+    // A pool of 4 chunks that does not grow
+    config()->setValue(ConfigKey(kGroup, "cache_initial_chunks"), 4);
+    CachingReaderChunkBudget::setLimitBytes(0);
+    createReader();
+    ASSERT_TRUE(loadTrack(testFilePath("sine-30.wav")));
+
+    const auto playFrameIndexRange = mixxx::IndexRange::forward(
+            0, 4 * CachingReaderChunk::kFrames);
+    HintVector playHints;
+    playHints.append(hint(playFrameIndexRange.start(),
+            playFrameIndexRange.length(),
+            Hint::kPriorityImmediate));
+    const auto cueFrameIndexRange = mixxx::IndexRange::forward(
+            20 * CachingReaderChunk::kFrames, CachingReaderChunk::kFrames);
+    HintVector cueHints;
+    cueHints.append(hint(cueFrameIndexRange.start(),
+            cueFrameIndexRange.length(),
+            Hint::kPriorityPrefetch));
+    HintVector playAndCueHints = playHints;
+    playAndCueHints.append(cueHints.constData(), cueHints.size());
+
+    mixxx::SampleBuffer buffer;
+    ASSERT_TRUE(waitFor([&] {
+        return read(playFrameIndexRange, &buffer) ==
+                CachingReader::ReadResult::AVAILABLE;
+    },
+            playHints));
+
+    // The play window occupies the whole pool and must not be evicted
+    // for the cue point
+    for (int i = 0; i < 10; ++i) {
+        callback(playAndCueHints);
+        ASSERT_EQ(CachingReader::ReadResult::AVAILABLE,
+                read(playFrameIndexRange, &buffer));
+    }
+    EXPECT_EQ(CachingReader::ReadResult::UNAVAILABLE,
+            read(cueFrameIndexRange, &buffer));
+
+    // After the play position has left the chunks their priority decays
+    // and the cue point is prefetched
+    EXPECT_TRUE(waitFor([&] {
+        return read(cueFrameIndexRange, &buffer) ==
+                CachingReader::ReadResult::AVAILABLE;
+    },
+            cueHints));
+    callback();
+    EXPECT_LT(0.0, controlValue("cache_evictions"));
+}
+
+TEST_F(CachingReaderTest, ShrinkPoolOnEject) {
+    config()->setValue(ConfigKey(kGroup, "cache_initial_chunks"), 4);
+    const SINT allocatedBytes = CachingReaderChunkBudget::allocatedBytes();
+    createReader();
+    ASSERT_TRUE(loadTrack(testFilePath("sine-30.wav")));
+
+    // Reading more chunks than initially allocated grows the pool
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            0, 8 * CachingReaderChunk::kFrames);
+    HintVector hints;
+    hints.append(hint(frameIndexRange.start(),
+            frameIndexRange.length(),
+            Hint::kPriorityImmediate));
+    mixxx::SampleBuffer buffer;
+    ASSERT_TRUE(waitFor([&] {
+        return read(frameIndexRange, &buffer) ==
+                CachingReader::ReadResult::AVAILABLE;
+    },
+            hints));
+    callback();
+    EXPECT_LE(8.0, controlValue("cache_chunks"));
+
+    // Ejecting the track frees all additional chunks
+    m_pReader->newTrack(TrackPointer());
+    EXPECT_TRUE(waitFor([&] {
+        return controlValue("cache_chunks") == 4.0 &&
+                CachingReaderChunkBudget::allocatedBytes() ==
+                allocatedBytes + 4 * CachingReaderChunkBudget::bytesPerChunk();
+    }));
+}
+
+TEST_F(CachingReaderTest, RestoreChunkFromDiskCache) {
+    config()->setValue(ConfigKey("[Master]", "chunk_disk_cache"), true);
+    createReader();
+    const auto pDiskCache = CachingReaderDiskCache::open(config());
+    ASSERT_TRUE(pDiskCache);
+    // Only compressed files are cached
+    const QString filePath = testFilePath("id3-test-data/cover-test-vbr.mp3");
+    ASSERT_TRUE(loadTrack(filePath));
+
+    const SINT chunkIndex = 2;
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            chunkIndex * CachingReaderChunk::kFrames,
+            CachingReaderChunk::kFrames);
+    HintVector hints;
+    hints.append(hint(frameIndexRange.start(),
+            frameIndexRange.length(),
+            Hint::kPriorityImmediate));
+    const auto readChunk = [&](mixxx::SampleBuffer* pBuffer) {
+        return waitFor([&] {
+            return read(frameIndexRange, pBuffer) ==
+                    CachingReader::ReadResult::AVAILABLE;
+        },
+                hints);
+    };
+
+    // The worker stores the decoded chunk
+    mixxx::SampleBuffer decoded;
+    ASSERT_TRUE(readChunk(&decoded));
+    pDiskCache->waitForPendingStores();
+    EXPECT_LT(0, pDiskCache->sizeBytes());
+
+    // ...and restores it after the track has been reloaded
+    ASSERT_TRUE(loadTrack(filePath));
+    mixxx::SampleBuffer restored;
+    ASSERT_TRUE(readChunk(&restored));
+    for (SINT i = 0; i < decoded.size(); ++i) {
+        ASSERT_EQ(decoded.data()[i], restored.data()[i]) << i;
+    }
+
+    // Samples that differ from the decoded ones prove that the chunk is
+    // read from the disk cache
+    mixxx::SampleBuffer marked(CachingReaderChunk::kSamples);
+    marked.fill(0.5f);
+    ASSERT_TRUE(pDiskCache->store(
+            CachingReaderDiskCache::trackKey(m_pTrack, openAudioSource()),
+            chunkIndex,
+            mixxx::ReadableSampleFrames(
+                    frameIndexRange,
+                    mixxx::SampleBuffer::ReadableSlice(
+                            marked, 0, CachingReaderChunk::kSamples))));
+    ASSERT_TRUE(loadTrack(filePath));
+    ASSERT_TRUE(readChunk(&restored));
+    for (SINT i = 0; i < restored.size(); ++i) {
+        ASSERT_EQ(0.5f, restored.data()[i]) << i;
+    }
+}
+
+} // namespace
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+
+namespace {
+
+class CachingReaderChunkBudgetTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_limitBytes = CachingReaderChunkBudget::limitBytes();
+        // Other tests might have created readers with their initial chunks
+        m_allocatedChunks = CachingReaderChunkBudget::allocatedBytes() /
+                CachingReaderChunkBudget::bytesPerChunk();
+        CachingReaderChunkBudget::setLimitBytes(
+                (m_allocatedChunks + 10) * CachingReaderChunkBudget::bytesPerChunk());
+    }
+
+    void TearDown() override {
+        CachingReaderChunkBudget::setLimitBytes(m_limitBytes);
+    }
+
+    SINT m_limitBytes;
+    SINT m_allocatedChunks;
+};
+
+TEST_F(CachingReaderChunkBudgetTest, ReserveWithinLimit) {
+    EXPECT_EQ(4, CachingReaderChunkBudget::tryReserve(4));
+    EXPECT_EQ(6, CachingReaderChunkBudget::tryReserve(16));
+    EXPECT_EQ(0, CachingReaderChunkBudget::tryReserve(1));
+
+    CachingReaderChunkBudget::release(3);
+    EXPECT_EQ(3, CachingReaderChunkBudget::tryReserve(16));
+
+    CachingReaderChunkBudget::release(10);
+    EXPECT_EQ(m_allocatedChunks * CachingReaderChunkBudget::bytesPerChunk(),
+            CachingReaderChunkBudget::allocatedBytes());
+}
+
+TEST_F(CachingReaderChunkBudgetTest, ReserveUnlimitedExceedsLimit) {
+    CachingReaderChunkBudget::reserveUnlimited(20);
+    EXPECT_EQ(0, CachingReaderChunkBudget::tryReserve(1));
+
+    CachingReaderChunkBudget::release(15);
+    EXPECT_EQ(5, CachingReaderChunkBudget::tryReserve(16));
+
+    CachingReaderChunkBudget::release(10);
+    EXPECT_EQ(m_allocatedChunks * CachingReaderChunkBudget::bytesPerChunk(),
+            CachingReaderChunkBudget::allocatedBytes());
+}
+
+} // namespace
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "engine/cachingreader/cachingreaderdiskcache.h"
+
+namespace {
+
+const SINT kFrames = 1024;
+const SINT kSamples = kFrames * 2;
+const QString kTrackKey = QStringLiteral("track");
+
+class CachingReaderDiskCacheTest : public testing::Test {
+  protected:
+    CachingReaderDiskCacheTest()
+            : m_samples(kSamples) {
+        for (SINT i = 0; i < kSamples; ++i) {
+            m_samples.data()[i] = static_cast<CSAMPLE>(i) / kSamples;
+        }
+    }
+
+    mixxx::ReadableSampleFrames sampleFrames(SINT chunkIndex) const {
+        return mixxx::ReadableSampleFrames(
+                mixxx::IndexRange::forward(chunkIndex * kFrames, kFrames),
+                mixxx::SampleBuffer::ReadableSlice(m_samples, 0, kSamples));
+    }
+
+    QString filePath(SINT chunkIndex) const {
+        return QDir(m_dir.path()).filePath(
+                QStringLiteral("%1/%2.chunk").arg(kTrackKey).arg(chunkIndex));
+    }
+
+    QTemporaryDir m_dir;
+    mixxx::SampleBuffer m_samples;
+};
+
+TEST_F(CachingReaderDiskCacheTest, StoreAndLoad) {
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    ASSERT_TRUE(cache.store(kTrackKey, 3, sampleFrames(3)));
+
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_EQ(mixxx::IndexRange::forward(3 * kFrames, kFrames),
+            cache.load(kTrackKey, 3, mixxx::SampleBuffer::WritableSlice(buffer)));
+    for (SINT i = 0; i < kSamples; ++i) {
+        EXPECT_EQ(m_samples.data()[i], buffer.data()[i]);
+    }
+
+    // Not cached
+    EXPECT_TRUE(cache.load(kTrackKey, 4, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+    EXPECT_TRUE(cache.load(QStringLiteral("other"), 3, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+}
+
+TEST_F(CachingReaderDiskCacheTest, LoadAfterRestart) {
+    {
+        CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+        ASSERT_TRUE(cache.store(kTrackKey, 0, sampleFrames(0)));
+    }
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_FALSE(cache.load(kTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+    EXPECT_LT(0, cache.sizeBytes());
+}
+
+TEST_F(CachingReaderDiskCacheTest, DiscardCorruptFile) {
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    ASSERT_TRUE(cache.store(kTrackKey, 0, sampleFrames(0)));
+
+    // Flip a bit of the last sample
+    QFile file(filePath(0));
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.seek(file.size() - 1));
+    char byte;
+    ASSERT_TRUE(file.getChar(&byte));
+    ASSERT_TRUE(file.seek(file.size() - 1));
+    ASSERT_TRUE(file.putChar(byte ^ 0x01));
+    file.close();
+
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_TRUE(cache.load(kTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+    EXPECT_FALSE(QFile::exists(filePath(0)));
+    EXPECT_EQ(0, cache.sizeBytes());
+}
+
+TEST_F(CachingReaderDiskCacheTest, DiscardModifiedHeader) {
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    ASSERT_TRUE(cache.store(kTrackKey, 0, sampleFrames(0)));
+
+    // Shift the frame index range of the chunk, i.e. the start and end
+    // that follow the magic number, the version and the chunk index
+    QFile file(filePath(0));
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    qint64 frameIndexRange[2];
+    ASSERT_TRUE(file.seek(16));
+    ASSERT_EQ(static_cast<qint64>(sizeof(frameIndexRange)),
+            file.read(reinterpret_cast<char*>(frameIndexRange), sizeof(frameIndexRange)));
+    ASSERT_EQ(0, frameIndexRange[0]);
+    ASSERT_EQ(kFrames, frameIndexRange[1]);
+    frameIndexRange[0] += kFrames;
+    frameIndexRange[1] += kFrames;
+    ASSERT_TRUE(file.seek(16));
+    ASSERT_EQ(static_cast<qint64>(sizeof(frameIndexRange)),
+            file.write(reinterpret_cast<const char*>(frameIndexRange), sizeof(frameIndexRange)));
+    file.close();
+
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_TRUE(cache.load(kTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+    EXPECT_FALSE(QFile::exists(filePath(0)));
+}
+
+TEST_F(CachingReaderDiskCacheTest, DiscardFileOfOtherTrack) {
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    ASSERT_TRUE(cache.store(kTrackKey, 0, sampleFrames(0)));
+
+    const QString otherTrackKey = QStringLiteral("other");
+    ASSERT_TRUE(QDir(m_dir.path()).mkdir(otherTrackKey));
+    ASSERT_TRUE(QFile::copy(filePath(0),
+            QDir(m_dir.path()).filePath(otherTrackKey + "/0.chunk")));
+
+    // Detected by the checksum after a restart
+    CachingReaderDiskCache restartedCache(m_dir.path(), 1024 * 1024);
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_TRUE(restartedCache.load(otherTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+    EXPECT_FALSE(restartedCache.load(kTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+}
+
+TEST_F(CachingReaderDiskCacheTest, StoreInBackground) {
+    CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+    cache.storeInBackground(kTrackKey, 1, sampleFrames(1));
+    cache.waitForPendingStores();
+
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_EQ(mixxx::IndexRange::forward(kFrames, kFrames),
+            cache.load(kTrackKey, 1, mixxx::SampleBuffer::WritableSlice(buffer)));
+    for (SINT i = 0; i < kSamples; ++i) {
+        EXPECT_EQ(m_samples.data()[i], buffer.data()[i]);
+    }
+    // No temporary files are left behind
+    EXPECT_EQ(QStringList{QStringLiteral("1.chunk")},
+            QDir(QDir(m_dir.path()).filePath(kTrackKey)).entryList(QDir::Files));
+}
+
+TEST_F(CachingReaderDiskCacheTest, EvictLeastRecentlyUsed) {
+    // Room for 2 files
+    const qint64 fileSize = [this] {
+        CachingReaderDiskCache cache(m_dir.path(), 1024 * 1024);
+        cache.store(kTrackKey, 0, sampleFrames(0));
+        return QFile(filePath(0)).size();
+    }();
+    CachingReaderDiskCache cache(m_dir.path(), 2 * fileSize);
+    ASSERT_TRUE(cache.store(kTrackKey, 1, sampleFrames(1)));
+
+    // Use chunk 0 more recently than chunk 1
+    mixxx::SampleBuffer buffer(kSamples);
+    EXPECT_FALSE(cache.load(kTrackKey, 0, mixxx::SampleBuffer::WritableSlice(buffer)).empty());
+
+    ASSERT_TRUE(cache.store(kTrackKey, 2, sampleFrames(2)));
+    EXPECT_TRUE(QFile::exists(filePath(0)));
+    EXPECT_FALSE(QFile::exists(filePath(1)));
+    EXPECT_TRUE(QFile::exists(filePath(2)));
+    EXPECT_EQ(2 * fileSize, cache.sizeBytes());
+}
+
+} // namespace
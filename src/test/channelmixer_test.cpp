@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QVector>
+#include <array>
+#include <utility>
+
+#include "engine/channelmixer.h"
+#include "util/sample.h"
+
+namespace {
+
+constexpr SINT kBufferSize = 1024;
+
+class ChannelMixerTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        for (int c = 0; c < kNumChannels; ++c) {
+            CSAMPLE* pBuffer = SampleUtil::alloc(kBufferSize);
+            for (SINT i = 0; i < kBufferSize; ++i) {
+                pBuffer[i] = (c + 1) * 0.01f + (i % 3) * 0.001f;
+            }
+            m_buffers.append(pBuffer);
+        }
+        m_pOutput = SampleUtil::alloc(kBufferSize);
+        m_pExpected = SampleUtil::alloc(kBufferSize);
+    }
+
+    void TearDown() override {
+        for (CSAMPLE* pBuffer : qAsConst(m_buffers)) {
+            SampleUtil::free(pBuffer);
+        }
+        SampleUtil::free(m_pOutput);
+        SampleUtil::free(m_pExpected);
+    }
+
+    static constexpr int kNumChannels = 37;
+
+    QVector<CSAMPLE*> m_buffers;
+    CSAMPLE* m_pOutput;
+    CSAMPLE* m_pExpected;
+};
+
+TEST_F(ChannelMixerTest, mixChannels) {
+    for (int numChannels = 0; numChannels <= kNumChannels; ++numChannels) {
+        SampleUtil::clear(m_pExpected, kBufferSize);
+        for (int c = 0; c < numChannels; ++c) {
+            SampleUtil::add(m_pExpected, m_buffers[c], kBufferSize);
+        }
+        SampleUtil::fill(m_pOutput, 1.0f, kBufferSize);
+
+        ChannelMixer::mixChannels(m_pOutput, m_buffers.constData(), numChannels, kBufferSize);
+
+        for (SINT i = 0; i < kBufferSize; ++i) {
+            EXPECT_FLOAT_EQ(m_pExpected[i], m_pOutput[i]);
+        }
+    }
+}
+
+// The mixing loop of the former channelmixer_autogen.cpp: One branch per
+// number of active channels up to 32, each summing the buffers from left
+// to right with an unsigned loop counter, and a slow path beyond.
+template<std::size_t... kIndices>
+void autogenMix(CSAMPLE* pOutput,
+        const CSAMPLE* const* pInputs,
+        unsigned int iBufferSize,
+        std::index_sequence<kIndices...>) {
+    // Local copies like pBuffer0, pBuffer1, ... of the generated code
+    const CSAMPLE* pBuffer[] = {pInputs[kIndices]...};
+    for (unsigned int i = 0; i < iBufferSize; ++i) {
+        pOutput[i] = (... + pBuffer[kIndices][i]);
+    }
+}
+
+typedef void (*AutogenMixFunction)(
+        CSAMPLE* pOutput, const CSAMPLE* const* pInputs, unsigned int iBufferSize);
+
+template<std::size_t kNumInputs>
+void autogenMixN(CSAMPLE* pOutput, const CSAMPLE* const* pInputs, unsigned int iBufferSize) {
+    autogenMix(pOutput, pInputs, iBufferSize, std::make_index_sequence<kNumInputs>());
+}
+
+template<std::size_t... kIndices>
+constexpr std::array<AutogenMixFunction, sizeof...(kIndices)> autogenMixFunctions(
+        std::index_sequence<kIndices...>) {
+    return {{&autogenMixN<kIndices + 1>...}};
+}
+
+void autogenMixChannels(CSAMPLE* pOutput,
+        const CSAMPLE* const* pInputs,
+        int numInputs,
+        unsigned int iBufferSize) {
+    static constexpr auto kMixFunctions =
+            autogenMixFunctions(std::make_index_sequence<32>());
+    if (numInputs == 0) {
+        SampleUtil::clear(pOutput, iBufferSize);
+    } else if (numInputs <= static_cast<int>(kMixFunctions.size())) {
+        kMixFunctions[numInputs - 1](pOutput, pInputs, iBufferSize);
+    } else {
+        SampleUtil::clear(pOutput, iBufferSize);
+        for (int c = 0; c < numInputs; ++c) {
+            SampleUtil::add(pOutput, pInputs[c], iBufferSize);
+        }
+    }
+}
+
+TEST_F(ChannelMixerTest, autogenMixChannels) {
+    // The baseline of the benchmarks must mix correctly, too
+    for (int numChannels = 0; numChannels <= kNumChannels; ++numChannels) {
+        ChannelMixer::mixChannels(m_pExpected, m_buffers.constData(), numChannels, kBufferSize);
+        autogenMixChannels(m_pOutput, m_buffers.constData(), numChannels, kBufferSize);
+        for (SINT i = 0; i < kBufferSize; ++i) {
+            EXPECT_FLOAT_EQ(m_pExpected[i], m_pOutput[i]);
+        }
+    }
+}
+
+template<bool kAutogen>
+static void BM_MixChannels(benchmark::State& state) {
+    const int numChannels = static_cast<int>(state.range(0));
+    const SINT size = static_cast<SINT>(state.range(1));
+    QVector<CSAMPLE*> buffers;
+    for (int c = 0; c < numChannels; ++c) {
+        buffers.append(SampleUtil::alloc(size));
+        SampleUtil::fill(buffers.last(), 0.1f, size);
+    }
+    CSAMPLE* pOutput = SampleUtil::alloc(size);
+
+    while (state.KeepRunning()) {
+        if (kAutogen) {
+            autogenMixChannels(pOutput,
+                    buffers.constData(),
+                    numChannels,
+                    static_cast<unsigned int>(size));
+        } else {
+            ChannelMixer::mixChannels(pOutput, buffers.constData(), numChannels, size);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    for (CSAMPLE* pBuffer : qAsConst(buffers)) {
+        SampleUtil::free(pBuffer);
+    }
+    SampleUtil::free(pOutput);
+}
+
+static void MixChannelsArguments(benchmark::internal::Benchmark* b) {
+    // Beyond 32 channels the former code took the slow path
+    for (int numChannels : {1, 2, 3, 4, 8, 16, 32, 40}) {
+        for (int size : {256, 2048}) {
+            b->Args({numChannels, size});
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_MixChannels, true)->Apply(MixChannelsArguments);
+BENCHMARK_TEMPLATE(BM_MixChannels, false)->Apply(MixChannelsArguments);
+
+} // namespace
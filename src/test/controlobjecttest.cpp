@@ -2,6 +2,8 @@
 #include <QtDebug>
 
 #include "control/controlobject.h"
+#include "control/controlpotmeter.h"
+#include "control/controlslot.h"
 #include "util/memory.h"
 #include "test/mixxxtest.h"
 
@@ -85,4 +87,112 @@ TEST_F(ControlObjectTest, Persistence_ValidValue) {
     EXPECT_DOUBLE_EQ(5.0, co.get());
 }
 
+TEST_F(ControlObjectTest, SlotGetSet) {
+    ControlSlot slot = co1->slot();
+    ASSERT_TRUE(slot.isValid());
+    co1->set(1.0);
+    EXPECT_DOUBLE_EQ(1.0, slot.get());
+    slot.set(2.0);
+    EXPECT_DOUBLE_EQ(2.0, co1->get());
+    // Every control owns a distinct slot
+    EXPECT_NE(co1->slot().index(), co2->slot().index());
+}
+
+TEST_F(ControlObjectTest, SlotNotificationIsDeferred) {
+    int changedCount = 0;
+    double changedValue = 0.0;
+    QObject::connect(co1.get(),
+            &ControlObject::valueChanged,
+            [&changedCount, &changedValue](double value) {
+                ++changedCount;
+                changedValue = value;
+            });
+    ControlSlot::flushNotifications();
+    changedCount = 0;
+
+    co1->slot().set(3.0);
+    co1->slot().set(4.0);
+    EXPECT_EQ(0, changedCount);
+
+    // Multiple writes are coalesced into a single notification
+    ControlSlot::flushNotifications();
+    EXPECT_EQ(1, changedCount);
+    EXPECT_DOUBLE_EQ(4.0, changedValue);
+
+    ControlSlot::flushNotifications();
+    EXPECT_EQ(1, changedCount);
+
+    // Nops are ignored
+    co1->slot().set(4.0);
+    ControlSlot::flushNotifications();
+    EXPECT_EQ(1, changedCount);
+}
+
+TEST_F(ControlObjectTest, SlotValueChangeRequest) {
+    double requestedValue = 0.0;
+    co1->connectValueChangeRequest(
+            co1.get(),
+            [this, &requestedValue](double value) {
+                requestedValue = value;
+                co1->setAndConfirm(value * 2);
+            },
+            Qt::DirectConnection);
+
+    co1->slot().set(3.0);
+    // Not stored until confirmed
+    EXPECT_DOUBLE_EQ(0.0, co1->get());
+    EXPECT_DOUBLE_EQ(0.0, requestedValue);
+
+    ControlSlot::flushNotifications();
+    EXPECT_DOUBLE_EQ(3.0, requestedValue);
+    EXPECT_DOUBLE_EQ(6.0, co1->get());
+}
+
+TEST_F(ControlObjectTest, SlotReleased) {
+    EXPECT_FALSE(ControlSlot().isValid());
+    const ControlSlot slot = co2->slot();
+    const int slotCount = ControlSlot::count();
+    co2.reset();
+    EXPECT_FALSE(slot.isValid());
+    EXPECT_EQ(slotCount - 1, ControlSlot::count());
+}
+
+TEST_F(ControlObjectTest, SlotReusedByOtherControl) {
+    const ControlSlot slot = co2->slot();
+    const int handle = slot.handle();
+    co2.reset();
+    // The next control gets the released slot
+    ControlObject co3(ConfigKey("[Channel1]", "co3"));
+    ASSERT_EQ(slot.index(), co3.slot().index());
+    co3.set(1.0);
+
+    // Stale handles don't access the new owner
+    EXPECT_FALSE(slot.isValid());
+    EXPECT_FALSE(ControlSlot::fromHandle(handle).isValid());
+    EXPECT_DOUBLE_EQ(0.0, slot.get());
+    slot.set(2.0);
+    EXPECT_DOUBLE_EQ(1.0, co3.get());
+
+    EXPECT_NE(handle, co3.slot().handle());
+    EXPECT_TRUE(ControlSlot::fromHandle(co3.slot().handle()).isValid());
+}
+
+TEST_F(ControlObjectTest, SlotBypassesBehavior) {
+    ControlPotmeter potmeter(ConfigKey("[Channel1]", "potmeter"), 0.0, 1.0);
+    potmeter.slot().set(2.0);
+    EXPECT_DOUBLE_EQ(2.0, potmeter.get());
+
+    // Requests are not filtered either
+    double requestedValue = 0.0;
+    potmeter.connectValueChangeRequest(
+            &potmeter,
+            [&requestedValue](double value) {
+                requestedValue = value;
+            },
+            Qt::DirectConnection);
+    potmeter.slot().set(3.0);
+    ControlSlot::flushNotifications();
+    EXPECT_DOUBLE_EQ(3.0, requestedValue);
+}
+
 } // namespace
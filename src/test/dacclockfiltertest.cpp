@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include "waveform/dacclockfilter.h"
+
+namespace {
+
+constexpr double kPeriodMicros = 10100.0;
+
+class DacClockFilterTest : public testing::Test {
+  protected:
+    // Feeds DAC times with the given jitter into the filter and returns the
+    // RMS of the deviation of the corrected intervals from the period.
+    double observeJitteredClock(double jitterMicros, int count) {
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<double> jitter(-jitterMicros, jitterMicros);
+        double sumOfSquares = 0.0;
+        int sumCount = 0;
+        for (int i = 0; i < count; ++i) {
+            m_time += kPeriodMicros;
+            const double observedTime = m_time + jitter(generator);
+            const double correctedTime = observedTime +
+                    m_filter.observe(observedTime - m_lastObservedTime);
+            // Let the filter settle first
+            if (i > 100) {
+                const double deviation = correctedTime - m_lastCorrectedTime - kPeriodMicros;
+                sumOfSquares += deviation * deviation;
+                ++sumCount;
+            }
+            m_lastObservedTime = observedTime;
+            m_lastCorrectedTime = correctedTime;
+        }
+        return std::sqrt(sumOfSquares / sumCount);
+    }
+
+    DacClockFilter m_filter;
+    double m_time = 0.0;
+    double m_lastObservedTime = 0.0;
+    double m_lastCorrectedTime = 0.0;
+};
+
+TEST_F(DacClockFilterTest, SmoothsJitter) {
+    const double jitterMicros = 1000.0;
+    // The RMS of the uniformly distributed jitter of two time stamps
+    const double observedRms = jitterMicros * std::sqrt(2.0 / 3.0);
+    const double correctedRms = observeJitteredClock(jitterMicros, 2000);
+    EXPECT_LT(correctedRms, observedRms / 4);
+    EXPECT_NEAR(kPeriodMicros, m_filter.periodMicros(), 50.0);
+}
+
+TEST_F(DacClockFilterTest, TracksClockWithoutJitter) {
+    EXPECT_FALSE(m_filter.isValid());
+    observeJitteredClock(0.0, 200);
+    EXPECT_TRUE(m_filter.isValid());
+    EXPECT_DOUBLE_EQ(kPeriodMicros, m_filter.periodMicros());
+    EXPECT_DOUBLE_EQ(0.0, m_filter.jitterMicros());
+}
+
+TEST_F(DacClockFilterTest, RestartsAfterXrun) {
+    observeJitteredClock(500.0, 200);
+    // A few buffers have been dropped
+    EXPECT_DOUBLE_EQ(0.0, m_filter.observe(kPeriodMicros * 4));
+    EXPECT_DOUBLE_EQ(kPeriodMicros * 4, m_filter.periodMicros());
+    EXPECT_DOUBLE_EQ(0.0, m_filter.jitterMicros());
+}
+
+TEST_F(DacClockFilterTest, RestartsAfterBufferSizeChange) {
+    observeJitteredClock(500.0, 200);
+    // The buffer size has been doubled
+    EXPECT_DOUBLE_EQ(0.0, m_filter.observe(kPeriodMicros * 2));
+    EXPECT_DOUBLE_EQ(kPeriodMicros * 2, m_filter.periodMicros());
+
+    // And halved again
+    EXPECT_DOUBLE_EQ(0.0, m_filter.observe(kPeriodMicros));
+    EXPECT_DOUBLE_EQ(kPeriodMicros, m_filter.periodMicros());
+}
+
+TEST_F(DacClockFilterTest, Reset) {
+    observeJitteredClock(500.0, 200);
+    m_filter.reset();
+    EXPECT_FALSE(m_filter.isValid());
+    // The first interval after a reset is unknown
+    EXPECT_DOUBLE_EQ(0.0, m_filter.observe(kPeriodMicros * 1.2));
+    EXPECT_FALSE(m_filter.isValid());
+}
+
+} // namespace
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <QSqlQuery>
+
 #include "library/dao/settingsdao.h"
 #include "test/mixxxdbtest.h"
 #include "util/db/dbconnectionpooler.h"
@@ -20,3 +22,21 @@ TEST_F(DbConnectionPoolTest, MoveSemantics) {
     EXPECT_TRUE(p1.isPooling());
     EXPECT_FALSE(p2.isPooling());
 }
+
+TEST_F(DbConnectionPoolTest, TunedConnection) {
+    const MixxxDb mixxxDb(config());
+    const mixxx::DbConnectionPooler dbConnectionPooler(mixxxDb.connectionPool());
+    QSqlQuery query(mixxx::DbConnectionPooled(mixxxDb.connectionPool()));
+
+    ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(QString("wal"), query.value(0).toString());
+    // NORMAL
+    ASSERT_TRUE(query.exec("PRAGMA synchronous"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(1, query.value(0).toInt());
+    // MEMORY
+    ASSERT_TRUE(query.exec("PRAGMA temp_store"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(2, query.value(0).toInt());
+}
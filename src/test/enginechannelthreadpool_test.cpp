@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <QVector>
+#include <atomic>
+
+#include "engine/enginechannelthreadpool.h"
+
+namespace {
+
+TEST(EngineChannelThreadPoolTest, RunsEveryJobOnce) {
+    EngineChannelThreadPool pool(3);
+    for (int numJobs = 0; numJobs <= 9; ++numJobs) {
+        for (int batch = 0; batch < 100; ++batch) {
+            QVector<int> calls(numJobs, 0);
+            pool.run(numJobs, [&calls](int index) {
+                ++calls[index];
+            });
+            // All jobs must be finished when run() returns
+            for (int i = 0; i < numJobs; ++i) {
+                ASSERT_EQ(1, calls[i]) << "job " << i << " of " << numJobs;
+            }
+        }
+    }
+}
+
+TEST(EngineChannelThreadPoolTest, RunsInlineWithoutThreads) {
+    EngineChannelThreadPool pool(0);
+    EXPECT_EQ(0, pool.numThreads());
+    std::atomic<int> sum(0);
+    pool.run(4, [&sum](int index) {
+        sum += index;
+    });
+    EXPECT_EQ(6, sum.load());
+}
+
+} // namespace
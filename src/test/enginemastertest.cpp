@@ -2,12 +2,14 @@
 #include <gmock/gmock.h>
 
 #include <QtDebug>
+#include <vector>
 
 #include "control/controlproxy.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/enginemaster.h"
 #include "test/mixxxtest.h"
 #include "test/signalpathtest.h"
+#include "track/beatfactory.h"
 #include "util/defs.h"
 #include "util/sample.h"
 #include "util/types.h"
@@ -391,4 +393,71 @@ TEST_F(EngineMasterTest, ThreeChannelPFLOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+// Plays three decks of which the first two are synced while the third one
+// seeks quantized into the phase of the sync leader. The only difference
+// between two instances is the number of channel threads.
+class SyncedDecksSignalPath : public BaseSignalPathTest {
+  public:
+    explicit SyncedDecksSignalPath(int numChannelThreads)
+            : BaseSignalPathTest(numChannelThreads) {
+        loadTrackWithBpm(m_pMixerDeck1, mixxx::Bpm(120));
+        loadTrackWithBpm(m_pMixerDeck2, mixxx::Bpm(124));
+        loadTrackWithBpm(m_pMixerDeck3, mixxx::Bpm(128));
+    }
+
+    // Returns the master output of all processed buffers.
+    std::vector<CSAMPLE> render() {
+        std::vector<CSAMPLE> output;
+        ControlObject::set(ConfigKey(m_sGroup1, "sync_mode"),
+                static_cast<double>(SyncMode::LeaderExplicit));
+        ControlObject::set(ConfigKey(m_sGroup2, "sync_enabled"), 1.0);
+        ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+        ControlObject::set(ConfigKey(m_sGroup2, "play"), 1.0);
+        ControlObject::set(ConfigKey(m_sGroup3, "play"), 1.0);
+        // Deck 3 is independent and processed in parallel.
+        processBuffers(&output, 4);
+
+        // Seeking with quantize enabled looks up the phase of the leader.
+        ControlObject::set(ConfigKey(m_sGroup3, "quantize"), 1.0);
+        ControlObject::set(ConfigKey(m_sGroup3, "playposition"), 0.25);
+        processBuffers(&output, 4);
+
+        // So does a queued phase seek without quantize.
+        ControlObject::set(ConfigKey(m_sGroup3, "quantize"), 0.0);
+        ControlObject::set(ConfigKey(m_sGroup3, "beatsync_phase"), 1.0);
+        processBuffers(&output, 4);
+        return output;
+    }
+
+  private:
+    void TestBody() override {
+    }
+
+    void loadTrackWithBpm(Deck* pDeck, mixxx::Bpm bpm) {
+        const QString kTrackLocationTest = QDir::currentPath() + "/src/test/sine-30.wav";
+        TrackPointer pTrack(Track::newTemporary(kTrackLocationTest));
+        loadTrack(pDeck, pTrack);
+        pTrack->trySetBeats(BeatFactory::makeBeatGrid(
+                pTrack->getSampleRate(), bpm, mixxx::audio::kStartFramePos));
+    }
+
+    void processBuffers(std::vector<CSAMPLE>* pOutput, int count) {
+        for (int i = 0; i < count; ++i) {
+            ProcessBuffer();
+            const CSAMPLE* pMaster = m_pEngineMaster->getMasterBuffer();
+            pOutput->insert(pOutput->end(), pMaster, pMaster + kProcessBufferSize);
+        }
+    }
+};
+
+TEST(EngineMasterParallelTest, SyncedAndQuantizedDecksMatchSerial) {
+    const std::vector<CSAMPLE> serialOutput = SyncedDecksSignalPath(0).render();
+    const std::vector<CSAMPLE> parallelOutput = SyncedDecksSignalPath(2).render();
+
+    ASSERT_EQ(serialOutput.size(), parallelOutput.size());
+    for (std::size_t i = 0; i < serialOutput.size(); ++i) {
+        ASSERT_EQ(serialOutput[i], parallelOutput[i]) << "at sample " << i;
+    }
+}
+
 }  // namespace
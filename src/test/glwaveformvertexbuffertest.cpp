@@ -0,0 +1,272 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QtDebug>
+#include <cmath>
+
+#include "util/math.h"
+#include "util/memory.h"
+#include "waveform/renderers/glwaveformvertexbuffer.h"
+
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+
+namespace {
+
+constexpr int kWidth = 1024;
+constexpr int kHeight = 128;
+
+/// An offscreen OpenGL 2.1 context with a framebuffer of the size of a
+/// typical waveform widget. Tests are skipped if it is not available,
+/// e.g. on build servers without a display.
+class OffscreenGLContext {
+  public:
+    OffscreenGLContext() {
+        QSurfaceFormat format;
+        format.setVersion(2, 1);
+        m_context.setFormat(format);
+        if (!m_context.create()) {
+            return;
+        }
+        m_surface.setFormat(m_context.format());
+        m_surface.create();
+        if (!m_surface.isValid() || !m_context.makeCurrent(&m_surface)) {
+            return;
+        }
+        m_pFunctions = m_context.versionFunctions<QOpenGLFunctions_2_1>();
+        if (!m_pFunctions || !m_pFunctions->initializeOpenGLFunctions()) {
+            return;
+        }
+        m_pFbo = std::make_unique<QOpenGLFramebufferObject>(kWidth, kHeight);
+        if (!m_pFbo->isValid() || !m_pFbo->bind()) {
+            m_pFbo.reset();
+        }
+    }
+
+    ~OffscreenGLContext() {
+        if (m_pFbo) {
+            m_pFbo.reset();
+            m_context.doneCurrent();
+        }
+    }
+
+    bool isValid() const {
+        return m_pFbo != nullptr;
+    }
+
+    QOpenGLFunctions_2_1* gl() const {
+        return m_pFunctions;
+    }
+
+    QImage toImage() const {
+        return m_pFbo->toImage();
+    }
+
+  private:
+    QOpenGLContext m_context;
+    QOffscreenSurface m_surface;
+    QOpenGLFunctions_2_1* m_pFunctions = nullptr;
+    std::unique_ptr<QOpenGLFramebufferObject> m_pFbo;
+};
+
+WaveformPointer createWaveform(int seconds) {
+    constexpr int kSampleRate = 44100;
+    auto pWaveform = WaveformPointer(new Waveform(
+            kSampleRate, kSampleRate * 2 * seconds, 441, -1));
+    WaveformData* data = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        data[i].filtered.low = static_cast<unsigned char>((i * 7) % 256);
+        data[i].filtered.mid = static_cast<unsigned char>((i * 13) % 256);
+        data[i].filtered.high = static_cast<unsigned char>((i * 29) % 256);
+        data[i].filtered.all = static_cast<unsigned char>((i * 31) % 256);
+    }
+    pWaveform->updatePyramid(pWaveform->getDataSize());
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    return pWaveform;
+}
+
+GLWaveformVertexBuffer::DrawParameters drawParameters(
+        const Waveform& waveform, double visualSamplePerPixel) {
+    GLWaveformVertexBuffer::DrawParameters parameters;
+    parameters.firstVisualIndex = waveform.getDataSize() / 4;
+    parameters.lastVisualIndex = parameters.firstVisualIndex +
+            2 * kWidth * visualSamplePerPixel;
+    parameters.visualSamplePerPixel = visualSamplePerPixel;
+    parameters.axesColor = QVector4D(1.0f, 1.0f, 1.0f, 1.0f);
+    parameters.signalColor = QVector4D(1.0f, 0.5f, 0.0f, 1.0f);
+    parameters.lowColor = QVector4D(1.0f, 0.0f, 0.0f, 1.0f);
+    parameters.midColor = QVector4D(0.0f, 1.0f, 0.0f, 1.0f);
+    parameters.highColor = QVector4D(0.0f, 0.0f, 1.0f, 1.0f);
+    return parameters;
+}
+
+class GLWaveformVertexBufferTest : public testing::Test {
+  protected:
+    OffscreenGLContext m_context;
+};
+
+TEST_F(GLWaveformVertexBufferTest, DrawsSignal) {
+    if (!m_context.isValid()) {
+        GTEST_SKIP() << "No offscreen OpenGL context available";
+    }
+    GLWaveformVertexBuffer vertexBuffer;
+    ASSERT_TRUE(vertexBuffer.initialize());
+    WaveformPointer pWaveform = createWaveform(60);
+    vertexBuffer.setWaveform(pWaveform);
+
+    QOpenGLFunctions_2_1* gl = m_context.gl();
+    gl->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    gl->glClear(GL_COLOR_BUFFER_BIT);
+    vertexBuffer.draw(GLWaveformVertexBuffer::ColorType::RGB,
+            drawParameters(*pWaveform, 4.0));
+    gl->glFinish();
+
+    const QImage image = m_context.toImage();
+    int coloredPixels = 0;
+    for (int x = 0; x < image.width(); ++x) {
+        if (image.pixel(x, image.height() / 2) != qRgb(0, 0, 0)) {
+            ++coloredPixels;
+        }
+    }
+    // The center line is covered by the signal
+    EXPECT_GT(coloredPixels, image.width() / 2);
+}
+
+// Scrolls the displayed range by one pixel, as during playback, and
+// wraps around at the end of the track
+void scroll(GLWaveformVertexBuffer::DrawParameters* pParameters, const Waveform& waveform) {
+    const double displayedRange =
+            pParameters->lastVisualIndex - pParameters->firstVisualIndex;
+    pParameters->firstVisualIndex += 2 * pParameters->visualSamplePerPixel;
+    if (pParameters->firstVisualIndex + displayedRange > waveform.getDataSize()) {
+        pParameters->firstVisualIndex = 0.0;
+    }
+    pParameters->lastVisualIndex = pParameters->firstVisualIndex + displayedRange;
+}
+
+const float kHeightScaleFactor = 255.0f / sqrtf(255 * 255 * 3);
+
+// The immediate mode drawing of GLWaveformRendererRGB::draw() with the
+// center alignment. The renderer itself can't be set up without a
+// WaveformWidgetFactory, so its draw loop is replicated here. It submits
+// two vertices with the color calculated on the CPU per channel and
+// visual frame of the pyramid level that matches the zoom.
+void drawImmediateModeRGB(QOpenGLFunctions_2_1* gl,
+        const Waveform& waveform,
+        const GLWaveformVertexBuffer::DrawParameters& parameters) {
+    const int pyramidLevel = waveform.getPyramidLevel(parameters.visualSamplePerPixel);
+    const int dataSize = waveform.getPyramidDataSize(pyramidLevel);
+    const WaveformData* data = waveform.getPyramidData(pyramidLevel);
+
+    auto firstVisualIndex = static_cast<GLfloat>(
+            parameters.firstVisualIndex / (1 << pyramidLevel));
+    auto lastVisualIndex = static_cast<GLfloat>(
+            parameters.lastVisualIndex / (1 << pyramidLevel));
+    const auto lineWidth = static_cast<GLfloat>(
+            (1 << pyramidLevel) / parameters.visualSamplePerPixel + 1.5);
+
+    const auto firstIndex = static_cast<int>(firstVisualIndex + 0.5);
+    firstVisualIndex = firstIndex - firstIndex % 2;
+    const auto lastIndex = static_cast<int>(lastVisualIndex + 0.5);
+    lastVisualIndex = lastIndex + lastIndex % 2;
+
+    gl->glEnable(GL_BLEND);
+    gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    gl->glMatrixMode(GL_PROJECTION);
+    gl->glLoadIdentity();
+    gl->glOrtho(firstVisualIndex, lastVisualIndex, -255.0, 255.0, -10.0, 10.0);
+    gl->glMatrixMode(GL_MODELVIEW);
+    gl->glLoadIdentity();
+    gl->glScalef(1.0f, parameters.allGain, 1.0f);
+
+    gl->glLineWidth(1.2f);
+    gl->glDisable(GL_LINE_SMOOTH);
+    gl->glBegin(GL_LINES);
+    gl->glColor4f(parameters.axesColor.x(),
+            parameters.axesColor.y(),
+            parameters.axesColor.z(),
+            parameters.axesColor.w());
+    gl->glVertex2f(firstVisualIndex, 0);
+    gl->glVertex2f(lastVisualIndex, 0);
+    gl->glEnd();
+
+    gl->glLineWidth(lineWidth);
+    gl->glEnable(GL_LINE_SMOOTH);
+    gl->glBegin(GL_LINES);
+    const auto drawChannel = [&](const WaveformData& datum, float visualIndex, float sign) {
+        const float low = parameters.lowGain * static_cast<float>(datum.filtered.low);
+        const float mid = parameters.midGain * static_cast<float>(datum.filtered.mid);
+        const float high = parameters.highGain * static_cast<float>(datum.filtered.high);
+        const float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
+        const float red = low * parameters.lowColor.x() +
+                mid * parameters.midColor.x() + high * parameters.highColor.x();
+        const float green = low * parameters.lowColor.y() +
+                mid * parameters.midColor.y() + high * parameters.highColor.y();
+        const float blue = low * parameters.lowColor.z() +
+                mid * parameters.midColor.z() + high * parameters.highColor.z();
+        const float max = math_max3(red, green, blue);
+        if (max > 0.0f) {
+            gl->glColor4f(red / max, green / max, blue / max, 0.8f);
+            gl->glVertex2f(visualIndex, 0.0f);
+            gl->glVertex2f(visualIndex, sign * all);
+        }
+    };
+    const int firstDrawnIndex = math_max(static_cast<int>(firstVisualIndex), 0);
+    const int lastDrawnIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
+    for (int visualIndex = firstDrawnIndex; visualIndex < lastDrawnIndex; visualIndex += 2) {
+        drawChannel(data[visualIndex], static_cast<float>(visualIndex), 1.0f);
+        drawChannel(data[visualIndex + 1], static_cast<float>(visualIndex), -1.0f);
+    }
+    gl->glEnd();
+}
+
+static void BM_ImmediateModeDraw(benchmark::State& state) {
+    OffscreenGLContext context;
+    if (!context.isValid()) {
+        state.SkipWithError("No offscreen OpenGL context available");
+        return;
+    }
+    const double visualSamplePerPixel = static_cast<double>(state.range(0));
+    WaveformPointer pWaveform = createWaveform(300);
+    auto parameters = drawParameters(*pWaveform, visualSamplePerPixel);
+    QOpenGLFunctions_2_1* gl = context.gl();
+    for (auto _ : state) {
+        gl->glClear(GL_COLOR_BUFFER_BIT);
+        scroll(&parameters, *pWaveform);
+        drawImmediateModeRGB(gl, *pWaveform, parameters);
+        gl->glFinish();
+    }
+}
+BENCHMARK(BM_ImmediateModeDraw)->Range(1, 64);
+
+static void BM_VertexBufferDraw(benchmark::State& state) {
+    OffscreenGLContext context;
+    if (!context.isValid()) {
+        state.SkipWithError("No offscreen OpenGL context available");
+        return;
+    }
+    GLWaveformVertexBuffer vertexBuffer;
+    if (!vertexBuffer.initialize()) {
+        state.SkipWithError("Failed to initialize the vertex buffer");
+        return;
+    }
+    const double visualSamplePerPixel = static_cast<double>(state.range(0));
+    WaveformPointer pWaveform = createWaveform(300);
+    vertexBuffer.setWaveform(pWaveform);
+    auto parameters = drawParameters(*pWaveform, visualSamplePerPixel);
+    QOpenGLFunctions_2_1* gl = context.gl();
+    for (auto _ : state) {
+        gl->glClear(GL_COLOR_BUFFER_BIT);
+        scroll(&parameters, *pWaveform);
+        vertexBuffer.draw(GLWaveformVertexBuffer::ColorType::RGB, parameters);
+        gl->glFinish();
+    }
+}
+BENCHMARK(BM_VertexBufferDraw)->Range(1, 64);
+
+} // anonymous namespace
+
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
@@ -1,10 +1,27 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QDir>
+#include <QSqlQuery>
+
 #include "test/librarytest.h"
 
 #include "library/scanner/libraryscanner.h"
 
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+int numTracksInLibrary(const QSqlDatabase& database) {
+    QSqlQuery query(database);
+    if (!query.exec("SELECT COUNT(*) FROM library") || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+} // anonymous namespace
+
 class LibraryScannerTest : public LibraryTest {
   protected:
     LibraryScannerTest()
@@ -52,3 +69,37 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+TEST_F(LibraryScannerTest, KeepAddedTracksOfIncompleteScan) {
+    m_libraryScanner.m_libraryHashDao.initialize(dbConnection());
+    m_libraryScanner.m_cueDao.initialize(dbConnection());
+    m_libraryScanner.m_trackDao.initialize(dbConnection());
+    m_libraryScanner.m_playlistDao.initialize(dbConnection());
+    m_libraryScanner.m_analysisDao.initialize(dbConnection());
+    m_libraryScanner.m_directoryDao.initialize(dbConnection());
+    m_libraryScanner.m_scannerGlobal = ScannerGlobalPointer(
+            new ScannerGlobal(QHash<QString, QDateTime>(),
+                    false,
+                    QHash<QString, mixxx::cache_key_t>(),
+                    QRegExp(),
+                    QRegExp(),
+                    QStringList()));
+    m_libraryScanner.m_state = LibraryScanner::SCANNING;
+    m_libraryScanner.m_trackDao.addTracksPrepare();
+    ASSERT_EQ(0, numTracksInLibrary(dbConnection()));
+
+    // One track in a batch that has already been committed and one in the
+    // pending batch
+    m_libraryScanner.slotAddNewTrack(kTestDir.absoluteFilePath("cover-test-png.mp3"),
+            SoundSourceProxy::ImportedTrackMetadataAndCoverInfo());
+    m_libraryScanner.commitAddedTracks();
+    m_libraryScanner.slotAddNewTrack(kTestDir.absoluteFilePath("cover-test-jpg.mp3"),
+            SoundSourceProxy::ImportedTrackMetadataAndCoverInfo());
+
+    // A task failed without the scan being cancelled
+    m_libraryScanner.m_scannerGlobal->clearScanFinishedCleanly();
+    m_libraryScanner.slotFinishUnhashedScan();
+
+    EXPECT_EQ(2, numTracksInLibrary(dbConnection()));
+    EXPECT_EQ(LibraryScanner::IDLE, m_libraryScanner.m_state);
+}
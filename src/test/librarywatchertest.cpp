@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "library/scanner/librarywatcher.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+const mixxx::Duration kSettleDelay = mixxx::Duration::fromMillis(50);
+
+const int kTimeoutMillis = 5000;
+
+class LibraryWatcherTest : public MixxxTest {
+  protected:
+    bool createFile(const QString& filePath) const {
+        QFile file(filePath);
+        return file.open(QIODevice::WriteOnly);
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(LibraryWatcherTest, CoalesceChanges) {
+    const QString subdirPath = QDir(m_dir.path()).filePath("sub");
+    ASSERT_TRUE(QDir(m_dir.path()).mkdir("sub"));
+
+    LibraryWatcher watcher(kSettleDelay);
+    ASSERT_TRUE(watcher.watch(QStringList{m_dir.path(), subdirPath}));
+    EXPECT_EQ(2, watcher.watchedDirectories().size());
+
+    QSignalSpy spy(&watcher, &LibraryWatcher::directoriesChanged);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(createFile(QDir(subdirPath).filePath(QString("%1.mp3").arg(i))));
+    }
+    ASSERT_TRUE(createFile(QDir(m_dir.path()).filePath("a.mp3")));
+
+    // A single report for the whole burst
+    ASSERT_TRUE(spy.wait(kTimeoutMillis));
+    ASSERT_EQ(1, spy.count());
+    QStringList directories = spy.at(0).at(0).toStringList();
+    directories.sort();
+    EXPECT_EQ(QStringList({m_dir.path(), subdirPath}), directories);
+}
+
+TEST_F(LibraryWatcherTest, DeletedDirectory) {
+    const QString subdirPath = QDir(m_dir.path()).filePath("sub");
+    ASSERT_TRUE(QDir(m_dir.path()).mkdir("sub"));
+
+    LibraryWatcher watcher(kSettleDelay);
+    ASSERT_TRUE(watcher.watch(QStringList{subdirPath}));
+
+    QSignalSpy spy(&watcher, &LibraryWatcher::directoriesChanged);
+    ASSERT_TRUE(QDir(subdirPath).removeRecursively());
+
+    ASSERT_TRUE(spy.wait(kTimeoutMillis));
+    EXPECT_EQ(QStringList{subdirPath}, spy.at(0).at(0).toStringList());
+    EXPECT_TRUE(watcher.watchedDirectories().isEmpty());
+}
+
+#if defined(__LINUX__)
+TEST_F(LibraryWatcherTest, ModifiedFile) {
+    const QString filePath = QDir(m_dir.path()).filePath("a.mp3");
+    ASSERT_TRUE(createFile(filePath));
+
+    LibraryWatcher watcher(kSettleDelay);
+    ASSERT_TRUE(watcher.watch(QStringList{m_dir.path()}));
+
+    // Saved in place like by a tag editor without changing the entries
+    // of the directory
+    QSignalSpy spy(&watcher, &LibraryWatcher::directoriesChanged);
+    {
+        QFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_EQ(4, file.write("ID3\x04"));
+    }
+
+    ASSERT_TRUE(spy.wait(kTimeoutMillis));
+    EXPECT_EQ(QStringList{m_dir.path()}, spy.at(0).at(0).toStringList());
+}
+#else
+TEST_F(LibraryWatcherTest, RecheckOnlyIfEnabled) {
+    LibraryWatcher watcher(kSettleDelay);
+    ASSERT_TRUE(watcher.watch(QStringList{m_dir.path()}));
+
+    // Nothing is reported without changes by default
+    QSignalSpy spy(&watcher, &LibraryWatcher::directoriesChanged);
+    EXPECT_FALSE(spy.wait(static_cast<int>(kSettleDelay.toIntegerMillis()) * 4));
+
+    watcher.setRecheckInterval(kSettleDelay);
+    ASSERT_TRUE(spy.wait(kTimeoutMillis));
+    EXPECT_EQ(QStringList{m_dir.path()}, spy.at(0).at(0).toStringList());
+}
+#endif
+
+TEST_F(LibraryWatcherTest, UnwatchAll) {
+    LibraryWatcher watcher(kSettleDelay);
+    ASSERT_TRUE(watcher.watch(QStringList{m_dir.path()}));
+
+    QSignalSpy spy(&watcher, &LibraryWatcher::directoriesChanged);
+    ASSERT_TRUE(createFile(QDir(m_dir.path()).filePath("a.mp3")));
+    watcher.unwatchAll();
+    EXPECT_TRUE(watcher.watchedDirectories().isEmpty());
+
+    EXPECT_FALSE(spy.wait(static_cast<int>(kSettleDelay.toIntegerMillis()) * 4));
+}
+
+} // namespace
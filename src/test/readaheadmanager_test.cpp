@@ -19,7 +19,7 @@ const QString kGroup = "[test]";
 class StubReader : public CachingReader {
   public:
     StubReader()
-            : CachingReader(kGroup, UserSettingsPointer()) {
+            : CachingReader(kGroup, UserSettingsPointer(), CachingReader::Role::Deck) {
     }
 
     CachingReader::ReadResult read(SINT startSample, SINT numSamples, bool reverse,
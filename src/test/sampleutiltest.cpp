@@ -3,9 +3,11 @@
 
 #include <QtDebug>
 #include <QList>
+#include <QVector>
 #include <QPair>
 
 #include "util/sample.h"
+#include "util/sample_simd.h"
 #include "util/timer.h"
 
 namespace {
@@ -303,6 +305,28 @@ TEST_F(SampleUtilTest, sumAbsPerChannel) {
     }
 }
 
+TEST_F(SampleUtilTest, maxAbsPerChannel) {
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        int j = evenBuffers[i];
+        CSAMPLE* buffer = buffers[j];
+        int size = sizes[j];
+        FillBuffer(buffer, 0.5f, size);
+        SampleUtil::applyAlternatingGain(buffer, -1.0, 2.0, size);
+        if (size >= 4) {
+            buffer[size - 2] = -0.75f;
+        }
+        CSAMPLE fMaxL = 0, fMaxR = 0;
+        SampleUtil::maxAbsPerChannel(&fMaxL, &fMaxR, buffer, size);
+        EXPECT_FLOAT_EQ(size >= 4 ? 0.75f : 0.5f, fMaxL);
+        EXPECT_FLOAT_EQ(1.0f, fMaxR);
+        // The maxima are only raised
+        fMaxL = 2.0f;
+        SampleUtil::maxAbsPerChannel(&fMaxL, &fMaxR, buffer, size);
+        EXPECT_FLOAT_EQ(2.0f, fMaxL);
+        EXPECT_FLOAT_EQ(1.0f, fMaxR);
+    }
+}
+
 TEST_F(SampleUtilTest, interleaveBuffer) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
@@ -350,6 +374,25 @@ TEST_F(SampleUtilTest, deinterleaveBuffer) {
     }
 }
 
+TEST_F(SampleUtilTest, downmixStereoToMono) {
+    for (int i = 0; i < buffers.size(); ++i) {
+        CSAMPLE* buffer = buffers[i];
+        int size = sizes[i];
+        CSAMPLE* stereo = SampleUtil::alloc(size * 2);
+        for (int j = 0; j < size; j++) {
+            stereo[j * 2] = j;
+            stereo[j * 2 + 1] = 0.5f * j;
+        }
+        SampleUtil::downmixStereoToMono(buffer, stereo, size);
+
+        for (int j = 0; j < size; j++) {
+            EXPECT_FLOAT_EQ(buffer[j], 0.75f * j);
+        }
+
+        SampleUtil::free(stereo);
+    }
+}
+
 TEST_F(SampleUtilTest, reverse) {
     if (buffers.size() > 0 && sizes[0] > 10) {
         CSAMPLE* buffer = buffers[1];
@@ -397,6 +440,98 @@ TEST_F(SampleUtilTest, copyReverse) {
     }
 }
 
+TEST_F(SampleUtilTest, simdKernelsMatchGeneric) {
+    using namespace mixxx::sample_simd;
+    const Kernels* pGeneric = kernels(Level::Generic);
+    ASSERT_NE(nullptr, pGeneric);
+    for (int level = 1; level < kNumLevels; ++level) {
+        const Kernels* pKernels = kernels(static_cast<Level>(level));
+        if (!pKernels) {
+            // Not supported by this build or CPU
+            continue;
+        }
+        for (int i = 0; i < buffers.size(); ++i) {
+            const int size = sizes[i];
+            CSAMPLE* pSrc1 = SampleUtil::alloc(size);
+            CSAMPLE* pSrc2 = SampleUtil::alloc(size);
+            CSAMPLE* pSrc3 = SampleUtil::alloc(size);
+            CSAMPLE* pExpected = SampleUtil::alloc(size);
+            CSAMPLE* pActual = SampleUtil::alloc(size);
+            QVector<SAMPLE> s16(size);
+            for (int j = 0; j < size; ++j) {
+                pSrc1[j] = (j % 7) * 0.3f - 1.0f;
+                pSrc2[j] = (j % 5) * -0.2f + 0.5f;
+                pSrc3[j] = (j % 3) * 0.1f;
+                s16[j] = static_cast<SAMPLE>((j * 977) % 65536 - 32768);
+            }
+
+            SampleUtil::copy(pExpected, pSrc1, size);
+            SampleUtil::copy(pActual, pSrc1, size);
+            pGeneric->applyRampingGain(pExpected, 0.1f, 0.001f, size);
+            pKernels->applyRampingGain(pActual, 0.1f, 0.001f, size);
+            for (int j = 0; j < size; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            SampleUtil::copy(pExpected, pSrc1, size);
+            SampleUtil::copy(pActual, pSrc1, size);
+            pGeneric->addWithRampingGain(pExpected, pSrc2, 1.0f, -0.001f, size);
+            pKernels->addWithRampingGain(pActual, pSrc2, 1.0f, -0.001f, size);
+            for (int j = 0; j < size; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            pGeneric->copyWithRampingGain(pExpected, pSrc2, 0.5f, 0.0005f, size);
+            pKernels->copyWithRampingGain(pActual, pSrc2, 0.5f, 0.0005f, size);
+            for (int j = 0; j < size / 2 * 2; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            SampleUtil::copy(pExpected, pSrc1, size);
+            SampleUtil::copy(pActual, pSrc1, size);
+            pGeneric->add2WithGain(pExpected, pSrc2, 0.7f, pSrc3, 1.3f, size);
+            pKernels->add2WithGain(pActual, pSrc2, 0.7f, pSrc3, 1.3f, size);
+            for (int j = 0; j < size; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            SampleUtil::copy(pExpected, pSrc1, size);
+            SampleUtil::copy(pActual, pSrc1, size);
+            pGeneric->add3WithGain(pExpected, pSrc1, 0.2f, pSrc2, 0.7f, pSrc3, 1.3f, size);
+            pKernels->add3WithGain(pActual, pSrc1, 0.2f, pSrc2, 0.7f, pSrc3, 1.3f, size);
+            for (int j = 0; j < size; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            CSAMPLE expectedL, expectedR, actualL, actualR;
+            EXPECT_EQ(pGeneric->sumAbsPerChannel(&expectedL, &expectedR, pSrc1, size),
+                    pKernels->sumAbsPerChannel(&actualL, &actualR, pSrc1, size));
+            EXPECT_NEAR(expectedL, actualL, 1e-3f);
+            EXPECT_NEAR(expectedR, actualR, 1e-3f);
+            EXPECT_EQ(pGeneric->sumAbsPerChannel(&expectedL, &expectedR, pSrc3, size),
+                    pKernels->sumAbsPerChannel(&actualL, &actualR, pSrc3, size));
+
+            expectedL = expectedR = actualL = actualR = 0.1f;
+            pGeneric->maxAbsPerChannel(&expectedL, &expectedR, pSrc1, size);
+            pKernels->maxAbsPerChannel(&actualL, &actualR, pSrc1, size);
+            EXPECT_FLOAT_EQ(expectedL, actualL);
+            EXPECT_FLOAT_EQ(expectedR, actualR);
+
+            pGeneric->convertS16ToFloat32(pExpected, s16.constData(), size);
+            pKernels->convertS16ToFloat32(pActual, s16.constData(), size);
+            for (int j = 0; j < size; ++j) {
+                EXPECT_FLOAT_EQ(pExpected[j], pActual[j]);
+            }
+
+            SampleUtil::free(pSrc1);
+            SampleUtil::free(pSrc2);
+            SampleUtil::free(pSrc3);
+            SampleUtil::free(pExpected);
+            SampleUtil::free(pActual);
+        }
+    }
+}
+
 static void BM_MemCpy(benchmark::State& state) {
     SINT size = static_cast<SINT>(state.range(0));
     CSAMPLE* buffer = SampleUtil::alloc(size);
@@ -583,4 +718,147 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Runs the benchmark for each SIMD level (second argument) and buffer size
+// (first argument). Levels that are not supported by the CPU are skipped.
+static void SimdLevelArguments(benchmark::internal::Benchmark* b) {
+    for (int level = 0; level < mixxx::sample_simd::kNumLevels; ++level) {
+        for (int size = 64; size <= 4096; size *= 8) {
+            b->Args({size, level});
+        }
+    }
+}
+
+static const mixxx::sample_simd::Kernels* simdKernels(benchmark::State& state) {
+    const auto level = static_cast<mixxx::sample_simd::Level>(state.range(1));
+    const mixxx::sample_simd::Kernels* pKernels =
+            mixxx::sample_simd::kernels(level);
+    if (pKernels) {
+        state.SetLabel(mixxx::sample_simd::levelName(level));
+    } else {
+        state.SkipWithError("Not supported");
+    }
+    return pKernels;
+}
+
+static void BM_SimdApplyRampingGain(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->applyRampingGain(buffer, 1.0f, 0.0f, size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SimdApplyRampingGain)->Apply(SimdLevelArguments);
+
+static void BM_SimdAddWithRampingGain(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.0f, size);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->addWithRampingGain(buffer, buffer2, 1.1f, 0.001f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_SimdAddWithRampingGain)->Apply(SimdLevelArguments);
+
+static void BM_SimdCopyWithRampingGain(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.0f, size);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->copyWithRampingGain(buffer, buffer2, 1.1f, 0.001f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_SimdCopyWithRampingGain)->Apply(SimdLevelArguments);
+
+static void BM_SimdAdd2WithGain(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.0f, size);
+    CSAMPLE* buffer3 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer3, 0.0f, size);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->add2WithGain(buffer, buffer2, 1.1f, buffer3, 1.1f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+    SampleUtil::free(buffer3);
+}
+BENCHMARK(BM_SimdAdd2WithGain)->Apply(SimdLevelArguments);
+
+static void BM_SimdAdd3WithGain(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.0f, size);
+    CSAMPLE* buffer3 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer3, 0.0f, size);
+    CSAMPLE* buffer4 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer4, 0.0f, size);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->add3WithGain(buffer, buffer2, 1.1f, buffer3, 1.1f, buffer4, 1.1f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+    SampleUtil::free(buffer3);
+    SampleUtil::free(buffer4);
+}
+BENCHMARK(BM_SimdAdd3WithGain)->Apply(SimdLevelArguments);
+
+static void BM_SimdSumAbsPerChannel(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+    CSAMPLE absL;
+    CSAMPLE absR;
+
+    while (pKernels && state.KeepRunning()) {
+        benchmark::DoNotOptimize(pKernels->sumAbsPerChannel(&absL, &absR, buffer, size));
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SimdSumAbsPerChannel)->Apply(SimdLevelArguments);
+
+static void BM_SimdConvertS16ToFloat32(benchmark::State& state) {
+    const mixxx::sample_simd::Kernels* pKernels = simdKernels(state);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    QVector<SAMPLE> s16(size, 1000);
+
+    while (pKernels && state.KeepRunning()) {
+        pKernels->convertS16ToFloat32(buffer, s16.constData(), size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SimdConvertS16ToFloat32)->Apply(SimdLevelArguments);
+
 }  // namespace
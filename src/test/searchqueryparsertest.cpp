@@ -105,7 +105,7 @@ TEST_F(SearchQueryParserTest, OneTermMultipleColumnsNegation) {
     EXPECT_FALSE(pQuery->match(pTrack));
 
     EXPECT_STREQ(
-        qPrintable(QString("NOT ((artist LIKE '%asdf%') OR (album LIKE '%asdf%'))")),
+        qPrintable(QString("NOT COALESCE((artist LIKE '%asdf%') OR (album LIKE '%asdf%'), 0)")),
         qPrintable(pQuery->toSql()));
 }
 
@@ -174,7 +174,7 @@ TEST_F(SearchQueryParserTest, MultipleTermsMultipleColumnsNegation) {
     EXPECT_STREQ(
         qPrintable(QString(
             "((artist LIKE '%asdf%') OR (album LIKE '%asdf%')) "
-            "AND (NOT ((artist LIKE '%zxcv%') OR (album LIKE '%zxcv%')))")),
+            "AND (NOT COALESCE((artist LIKE '%zxcv%') OR (album LIKE '%zxcv%'), 0))")),
         qPrintable(pQuery->toSql()));
 }
 
@@ -359,7 +359,7 @@ TEST_F(SearchQueryParserTest, TextFilterNegation) {
     EXPECT_FALSE(pQuery->match(pTrack));
 
     EXPECT_STREQ(
-        qPrintable(QString("NOT (comment LIKE '%asdf%')")),
+        qPrintable(QString("NOT COALESCE(comment LIKE '%asdf%', 0)")),
         qPrintable(pQuery->toSql()));
 }
 
@@ -414,7 +414,7 @@ TEST_F(SearchQueryParserTest, NumericFilterNegation) {
     EXPECT_FALSE(pQuery->match(pTrack));
 
     EXPECT_STREQ(
-        qPrintable(QString("NOT (bpm = 127.12)")),
+        qPrintable(QString("NOT COALESCE(bpm = 127.12, 0)")),
         qPrintable(pQuery->toSql()));
 }
 
@@ -987,6 +987,6 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
 
     EXPECT_STREQ(
                  qPrintable("(" + m_crateFilterQuery.arg(searchTermAEsc) +
-                            ") AND (NOT (" + m_crateFilterQuery.arg(searchTermB) + "))"),
+                            ") AND (NOT COALESCE(" + m_crateFilterQuery.arg(searchTermB) + ", 0))"),
                  qPrintable(pQueryB->toSql()));
 }
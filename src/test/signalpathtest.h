@@ -58,7 +58,9 @@ class TestEngineMaster : public EngineMaster {
 
 class BaseSignalPathTest : public MixxxTest, SoundSourceProviderRegistration {
   protected:
-    BaseSignalPathTest() {
+    explicit BaseSignalPathTest(int numChannelThreads = 0) {
+        m_pConfig->setValue(ConfigKey(m_sMasterGroup, "num_channel_threads"),
+                numChannelThreads);
         m_pGuiTick = std::make_unique<GuiTick>();
         m_pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
         m_pNumDecks = new ControlObject(ConfigKey(m_sMasterGroup, "num_decks"));
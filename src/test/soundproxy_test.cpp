@@ -254,6 +254,24 @@ TEST_F(SoundSourceProxyTest, readNoTitle) {
     EXPECT_EQ("test22kMono", pTrack3->getTitle());
 }
 
+TEST_F(SoundSourceProxyTest, updateTrackFromImportedMetadata) {
+    auto pTrack1 = Track::newTemporary(kTestDir, "cover-test-jpg.mp3");
+    EXPECT_TRUE(SoundSourceProxy(pTrack1).updateTrackFromSource());
+
+    // Imported in advance, e.g. by the library scanner
+    const auto imported = SoundSourceProxy::importNewTrackMetadataAndCoverInfoFromFile(
+            mixxx::FileAccess(mixxx::FileInfo(kTestDir, "cover-test-jpg.mp3")));
+    EXPECT_EQ(mixxx::MetadataSource::ImportResult::Succeeded, imported.result.first);
+    EXPECT_TRUE(imported.embeddedCoverInfo.hasImage());
+
+    auto pTrack2 = Track::newTemporary(kTestDir, "cover-test-jpg.mp3");
+    EXPECT_TRUE(SoundSourceProxy(pTrack2).updateTrackFromSource(
+            SoundSourceProxy::UpdateTrackFromSourceMode::Default,
+            &imported));
+    EXPECT_EQ(pTrack1->getMetadata(), pTrack2->getMetadata());
+    EXPECT_EQ(pTrack1->getCoverInfo(), pTrack2->getCoverInfo());
+}
+
 TEST_F(SoundSourceProxyTest, TOAL_TPE2) {
     auto pTrack = Track::newTemporary(kTestDir, "TOAL_TPE2.mp3");
     SoundSourceProxy proxy(pTrack);
@@ -0,0 +1,254 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QSqlError>
+#include <QTemporaryDir>
+
+#include "library/dao/playlistdao.h"
+#include "test/mixxxdbtest.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/db/sqlqueryfinisher.h"
+#include "util/db/sqlstatementcache.h"
+#include "util/db/sqltransaction.h"
+
+namespace {
+
+const QString kSelectTrackLocation =
+        QStringLiteral("SELECT location FROM track_locations WHERE id=:id");
+
+class SqlStatementCacheTest : public MixxxDbTest {
+  protected:
+    SqlStatementCacheTest() {
+        m_cache.setDatabase(dbConnection());
+    }
+
+    SqlStatementCache m_cache;
+};
+
+TEST_F(SqlStatementCacheTest, ReuseFinishedStatement) {
+    const QSqlResult* pResult;
+    {
+        QSqlQuery query = m_cache.prepare(kSelectTrackLocation);
+        const SqlQueryFinisher finisher(query);
+        query.bindValue(":id", 1);
+        ASSERT_TRUE(query.exec());
+        pResult = query.result();
+    }
+    QSqlQuery query = m_cache.prepare(kSelectTrackLocation);
+    EXPECT_EQ(pResult, query.result());
+    EXPECT_EQ(1, m_cache.size());
+}
+
+TEST_F(SqlStatementCacheTest, PrepareActiveStatementSeparately) {
+    QSqlQuery outerQuery = m_cache.prepare(kSelectTrackLocation);
+    outerQuery.bindValue(":id", 1);
+    ASSERT_TRUE(outerQuery.exec());
+    ASSERT_TRUE(outerQuery.isActive());
+
+    QSqlQuery innerQuery = m_cache.prepare(kSelectTrackLocation);
+    EXPECT_NE(outerQuery.result(), innerQuery.result());
+    innerQuery.bindValue(":id", 2);
+    EXPECT_TRUE(innerQuery.exec());
+    EXPECT_EQ(1, m_cache.size());
+}
+
+TEST_F(SqlStatementCacheTest, EvictLeastRecentlyUsed) {
+    SqlStatementCache cache(2);
+    cache.setDatabase(dbConnection());
+    const QSqlResult* pResult = cache.prepare(
+            QStringLiteral("SELECT id FROM library")).result();
+    cache.prepare(QStringLiteral("SELECT id FROM track_locations"));
+    // Touch the first statement to keep it
+    EXPECT_EQ(pResult, cache.prepare(QStringLiteral("SELECT id FROM library")).result());
+    cache.prepare(QStringLiteral("SELECT id FROM Playlists"));
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(pResult, cache.prepare(QStringLiteral("SELECT id FROM library")).result());
+    EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(SqlStatementCacheTest, ShrinkCapacity) {
+    m_cache.prepare(QStringLiteral("SELECT id FROM library"));
+    m_cache.prepare(QStringLiteral("SELECT id FROM track_locations"));
+    ASSERT_EQ(2, m_cache.size());
+    m_cache.setCapacity(1);
+    EXPECT_EQ(1, m_cache.size());
+    m_cache.setCapacity(0);
+    EXPECT_EQ(0, m_cache.size());
+    // Statements are still prepared, but not cached
+    QSqlQuery query = m_cache.prepare(kSelectTrackLocation);
+    query.bindValue(":id", 1);
+    EXPECT_TRUE(query.exec());
+    EXPECT_EQ(0, m_cache.size());
+}
+
+TEST_F(SqlStatementCacheTest, DoNotCacheFailedStatement) {
+    QSqlQuery query = m_cache.prepare(QStringLiteral("SELECT id FROM no_such_table"));
+    EXPECT_FALSE(query.exec());
+    EXPECT_EQ(0, m_cache.size());
+}
+
+TEST_F(SqlStatementCacheTest, ClearOnDatabaseChange) {
+    m_cache.prepare(kSelectTrackLocation);
+    ASSERT_EQ(1, m_cache.size());
+    m_cache.setDatabase(dbConnection());
+    EXPECT_EQ(0, m_cache.size());
+}
+
+// A file database with a library of the given size. The connection
+// profile is tuned if requested.
+class LibraryFixture {
+  public:
+    LibraryFixture(int trackCount, bool tuned)
+            : m_pDbConnectionPool(mixxx::DbConnectionPool::create(
+                      params(m_dir.filePath("mixxxdb.sqlite"), tuned),
+                      "SqlStatementCacheBenchmark")),
+              m_dbConnectionPooler(m_pDbConnectionPool) {
+        MixxxDb::initDatabaseSchema(database());
+        insertTracks(trackCount);
+    }
+
+    QSqlDatabase database() const {
+        return mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    }
+
+  private:
+    static mixxx::DbConnection::Params params(const QString& filePath, bool tuned) {
+        mixxx::DbConnection::Params params;
+        params.type = "QSQLITE";
+        params.filePath = filePath;
+        params.tuning.enabled = tuned;
+        if (tuned) {
+            params.tuning.mmapSizeBytes = 256 * 1024 * 1024;
+            params.tuning.cacheSizeKiB = 32 * 1024;
+        }
+        return params;
+    }
+
+    void insertTracks(int trackCount) {
+        const QSqlDatabase db = database();
+        SqlTransaction transaction(db);
+        QSqlQuery locationQuery(db);
+        locationQuery.prepare(
+                "INSERT INTO track_locations "
+                "(location, directory, filename, filesize, fs_deleted, needs_verification) "
+                "VALUES (:location, :directory, :filename, 0, 0, 0)");
+        QSqlQuery libraryQuery(db);
+        libraryQuery.prepare(
+                "INSERT INTO library "
+                "(artist, title, album, year, genre, location, bpm, duration, mixxx_deleted) "
+                "VALUES (:artist, :title, :album, :year, :genre, :location, :bpm, :duration, 0)");
+        for (int i = 0; i < trackCount; ++i) {
+            const QString directory = QString("/music/artist%1").arg(i % 500);
+            const QString fileName = QString("track%1.mp3").arg(i);
+            locationQuery.bindValue(":location", directory + '/' + fileName);
+            locationQuery.bindValue(":directory", directory);
+            locationQuery.bindValue(":filename", fileName);
+            if (!locationQuery.exec()) {
+                qWarning() << locationQuery.lastError();
+                return;
+            }
+            libraryQuery.bindValue(":artist", QString("Artist %1").arg(i % 500));
+            libraryQuery.bindValue(":title", QString("Title %1").arg(i));
+            libraryQuery.bindValue(":album", QString("Album %1").arg(i % 2000));
+            libraryQuery.bindValue(":year", QString::number(1970 + i % 50));
+            libraryQuery.bindValue(":genre", QString("Genre %1").arg(i % 40));
+            libraryQuery.bindValue(":location", locationQuery.lastInsertId());
+            libraryQuery.bindValue(":bpm", 80.0 + i % 100);
+            libraryQuery.bindValue(":duration", 120.0 + i % 300);
+            if (!libraryQuery.exec()) {
+                qWarning() << libraryQuery.lastError();
+                return;
+            }
+        }
+        transaction.commit();
+    }
+
+    QTemporaryDir m_dir;
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const mixxx::DbConnectionPooler m_dbConnectionPooler;
+};
+
+constexpr int kBenchmarkTrackCount = 20000;
+
+// Loading the library like BaseTrackCache does. The argument selects
+// the tuned connection profile.
+static void BM_LibraryLoad(benchmark::State& state) {
+    const LibraryFixture fixture(kBenchmarkTrackCount, state.range(0) != 0);
+    QSqlQuery query(fixture.database());
+    query.setForwardOnly(true);
+    for (auto _ : state) {
+        query.exec(
+                "SELECT library.id, artist, title, album, year, genre, bpm, duration, "
+                "track_locations.location FROM library "
+                "INNER JOIN track_locations ON library.location=track_locations.id "
+                "WHERE mixxx_deleted=0");
+        int rows = 0;
+        while (query.next()) {
+            benchmark::DoNotOptimize(query.value(0));
+            ++rows;
+        }
+        query.finish();
+        state.counters["rows"] = rows;
+    }
+}
+BENCHMARK(BM_LibraryLoad)->Arg(0)->Arg(1);
+
+// A search for a different term in each iteration like while typing
+static void BM_LibrarySearch(benchmark::State& state) {
+    const LibraryFixture fixture(kBenchmarkTrackCount, state.range(0) != 0);
+    QSqlQuery query(fixture.database());
+    query.setForwardOnly(true);
+    query.prepare(
+            "SELECT id FROM library "
+            "WHERE mixxx_deleted=0 AND (artist LIKE :term OR title LIKE :term)");
+    int i = 0;
+    for (auto _ : state) {
+        query.bindValue(":term", QString("%%1%").arg(i++ % 1000));
+        query.exec();
+        while (query.next()) {
+            benchmark::DoNotOptimize(query.value(0));
+        }
+        query.finish();
+    }
+}
+BENCHMARK(BM_LibrarySearch)->Arg(0)->Arg(1);
+
+// Prepares the statements with or without caching them
+class BenchmarkPlaylistDAO : public PlaylistDAO {
+  public:
+    explicit BenchmarkPlaylistDAO(bool cacheStatements) {
+        if (!cacheStatements) {
+            m_statementCache.setCapacity(0);
+        }
+    }
+};
+
+// Inserting, moving and removing tracks of a playlist. The first
+// argument selects the tuned connection profile, the second one
+// caches the statements of PlaylistDAO.
+static void BM_PlaylistEdit(benchmark::State& state) {
+    const LibraryFixture fixture(kBenchmarkTrackCount, state.range(0) != 0);
+    BenchmarkPlaylistDAO playlistDao(state.range(1) != 0);
+    playlistDao.initialize(fixture.database());
+    const int playlistId = playlistDao.createPlaylist("Benchmark");
+    QList<TrackId> trackIds;
+    for (int i = 1; i <= 500; ++i) {
+        trackIds.append(TrackId(i));
+    }
+    playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+    int i = 0;
+    for (auto _ : state) {
+        const int position = 1 + i % 500;
+        playlistDao.insertTrackIntoPlaylist(TrackId(501 + i % 1000), playlistId, position);
+        playlistDao.moveTrack(playlistId, position, 1 + (i * 7) % 500);
+        playlistDao.removeTrackFromPlaylist(playlistId, 1 + (i * 13) % 500);
+        ++i;
+    }
+}
+BENCHMARK(BM_PlaylistEdit)
+        ->Args({0, 0})
+        ->Args({0, 1})
+        ->Args({1, 0})
+        ->Args({1, 1});
+
+} // namespace
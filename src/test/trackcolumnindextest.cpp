@@ -0,0 +1,369 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <cmath>
+
+#include "library/trackcolumnindex.h"
+
+namespace {
+
+enum Field {
+    kArtist = 0,
+    kLocation = 1,
+    kBpm = 2,
+    kNumFields = 3,
+};
+
+QVector<QVariant> makeRecord(
+        const QVariant& artist,
+        const QVariant& location,
+        const QVariant& bpm) {
+    QVector<QVariant> record(kNumFields);
+    record[kArtist] = artist;
+    record[kLocation] = location;
+    record[kBpm] = bpm;
+    return record;
+}
+
+int countMatches(const TrackColumnIndex::RowMask& mask) {
+    int count = 0;
+    for (const auto match : mask) {
+        count += match ? 1 : 0;
+    }
+    return count;
+}
+
+class TrackColumnIndexTest : public testing::Test {
+  protected:
+    TrackColumnIndexTest() {
+        m_index.addColumn("artist", kArtist, TrackColumnIndex::NGramTextColumn);
+        m_index.addColumn("location", kLocation, TrackColumnIndex::TextColumn);
+        m_index.addColumn("bpm", kBpm, TrackColumnIndex::NumericColumn);
+    }
+
+    TrackColumnIndex::RowMask matchText(
+            const QString& columnName, const QString& foldedArgument) const {
+        auto mask = m_index.emptyMask();
+        m_index.matchText(m_index.column(columnName), foldedArgument, &mask);
+        return mask;
+    }
+
+    TrackColumnIndex m_index;
+};
+
+TEST_F(TrackColumnIndexTest, Columns) {
+    EXPECT_EQ(0, m_index.column("artist"));
+    EXPECT_EQ(1, m_index.columnForField(kLocation));
+    EXPECT_EQ(-1, m_index.column("title"));
+    EXPECT_EQ(-1, m_index.columnForField(kNumFields));
+    // N-grams imply text
+    EXPECT_TRUE(m_index.isTextColumn(m_index.column("artist")));
+    EXPECT_FALSE(m_index.isNumericColumn(m_index.column("artist")));
+    EXPECT_TRUE(m_index.isNumericColumn(m_index.column("bpm")));
+}
+
+TEST_F(TrackColumnIndexTest, MatchText) {
+    m_index.updateRow(TrackId(1), makeRecord("Beyoncé", "/music/a.mp3", 120));
+    m_index.updateRow(TrackId(2), makeRecord("Daft Punk", "/music/b.mp3", 124));
+    m_index.updateRow(TrackId(3), makeRecord("Punk Rock Band", "/other/c.mp3", 180));
+
+    // Trigram postings
+    auto mask = matchText("artist", "punk");
+    EXPECT_EQ(2, countMatches(mask));
+    EXPECT_TRUE(mask[m_index.row(TrackId(2))]);
+    EXPECT_TRUE(mask[m_index.row(TrackId(3))]);
+
+    // All trigrams match, but not in this order
+    EXPECT_EQ(0, countMatches(matchText("artist", "unkpun")));
+
+    // Folded case and diacritics
+    mask = matchText("artist", "beyonce");
+    EXPECT_EQ(1, countMatches(mask));
+    EXPECT_TRUE(mask[m_index.row(TrackId(1))]);
+
+    // Shorter than a trigram
+    EXPECT_EQ(2, countMatches(matchText("artist", "k")));
+
+    // Without n-grams
+    EXPECT_EQ(2, countMatches(matchText("location", "/music/")));
+
+    EXPECT_EQ(0, countMatches(matchText("artist", "nothing")));
+}
+
+TEST_F(TrackColumnIndexTest, MatchNullOrEmptyText) {
+    m_index.updateRow(TrackId(1), makeRecord("Artist", "/a.mp3", 120));
+    m_index.updateRow(TrackId(2), makeRecord(QVariant(), "/b.mp3", 120));
+    m_index.updateRow(TrackId(3), makeRecord("", "/c.mp3", 120));
+
+    auto mask = m_index.emptyMask();
+    m_index.matchNullOrEmptyText(m_index.column("artist"), &mask);
+    EXPECT_EQ(2, countMatches(mask));
+    EXPECT_FALSE(mask[m_index.row(TrackId(1))]);
+
+    // Missing values never match, not even an empty substring
+    EXPECT_EQ(2, countMatches(matchText("artist", "")));
+}
+
+TEST_F(TrackColumnIndexTest, NumericValues) {
+    m_index.updateRow(TrackId(1), makeRecord("A", "/a.mp3", 120.5));
+    m_index.updateRow(TrackId(2), makeRecord("B", "/b.mp3", QVariant()));
+    m_index.updateRow(TrackId(3), makeRecord("C", "/c.mp3", "fast"));
+
+    const auto& values = m_index.numericValues(m_index.column("bpm"));
+    ASSERT_EQ(3u, values.size());
+    EXPECT_EQ(120.5, values[m_index.row(TrackId(1))]);
+    EXPECT_TRUE(std::isnan(values[m_index.row(TrackId(2))]));
+    EXPECT_TRUE(std::isnan(values[m_index.row(TrackId(3))]));
+}
+
+TEST_F(TrackColumnIndexTest, LeadingIntegerValues) {
+    // Configured like the track number by BaseTrackCache
+    TrackColumnIndex index;
+    index.addColumn("tracknumber",
+            kLocation,
+            TrackColumnIndex::TextColumn | TrackColumnIndex::LeadingIntegerColumn);
+    const int column = index.column("tracknumber");
+    EXPECT_TRUE(index.isTextColumn(column));
+    EXPECT_TRUE(index.isNumericColumn(column));
+
+    // Like cast(tracknumber as integer) by SQLite
+    index.updateRow(TrackId(1), makeRecord(QVariant(), "3/12", QVariant()));
+    index.updateRow(TrackId(2), makeRecord(QVariant(), " 12", QVariant()));
+    index.updateRow(TrackId(3), makeRecord(QVariant(), "A1", QVariant()));
+    index.updateRow(TrackId(4), makeRecord(QVariant(), "-2", QVariant()));
+    index.updateRow(TrackId(5), makeRecord(QVariant(), QVariant(), QVariant()));
+    index.updateRow(TrackId(6), makeRecord(QVariant(), "4.5", QVariant()));
+
+    const auto& values = index.numericValues(column);
+    EXPECT_EQ(3.0, values[index.row(TrackId(1))]);
+    EXPECT_EQ(12.0, values[index.row(TrackId(2))]);
+    EXPECT_EQ(0.0, values[index.row(TrackId(3))]);
+    EXPECT_EQ(-2.0, values[index.row(TrackId(4))]);
+    EXPECT_TRUE(std::isnan(values[index.row(TrackId(5))]));
+    EXPECT_EQ(4.0, values[index.row(TrackId(6))]);
+
+    // Missing values first, "3/12" is sorted between 0 and 12
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({4, 3, 2, 0, 5, 1}),
+            index.sortedRows(column));
+}
+
+TEST_F(TrackColumnIndexTest, SortYearAsText) {
+    // Configured like the year by BaseTrackCache. The database sorts
+    // lower(year) as text, not as numbers.
+    TrackColumnIndex index;
+    index.addColumn("year", kLocation, TrackColumnIndex::TextColumn);
+    EXPECT_FALSE(index.isNumericColumn(index.column("year")));
+
+    index.updateRow(TrackId(1), makeRecord(QVariant(), "99", QVariant()));
+    index.updateRow(TrackId(2), makeRecord(QVariant(), "2001", QVariant()));
+    index.updateRow(TrackId(3), makeRecord(QVariant(), "1999-05-01", QVariant()));
+    index.updateRow(TrackId(4), makeRecord(QVariant(), "1999", QVariant()));
+    index.updateRow(TrackId(5), makeRecord(QVariant(), QVariant(), QVariant()));
+
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({4, 3, 2, 1, 0}),
+            index.sortedRows(index.column("year")));
+}
+
+TEST_F(TrackColumnIndexTest, SortOrder) {
+    m_index.updateRow(TrackId(1), makeRecord("b", "/a.mp3", 130));
+    m_index.updateRow(TrackId(2), makeRecord("a", "/b.mp3", QVariant()));
+    m_index.updateRow(TrackId(3), makeRecord(QVariant(), "/c.mp3", 120));
+    m_index.updateRow(TrackId(4), makeRecord("a", "/d.mp3", 120));
+
+    const int artist = m_index.column("artist");
+    auto ranks = m_index.rowRanks(artist);
+    // Missing values first, equal values share a rank
+    EXPECT_EQ(-1, ranks[m_index.row(TrackId(3))]);
+    EXPECT_EQ(ranks[m_index.row(TrackId(2))], ranks[m_index.row(TrackId(4))]);
+    EXPECT_LT(ranks[m_index.row(TrackId(4))], ranks[m_index.row(TrackId(1))]);
+    // Stable for equal values
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({2, 1, 3, 0}),
+            m_index.sortedRows(artist));
+
+    const int bpm = m_index.column("bpm");
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({1, 2, 3, 0}),
+            m_index.sortedRows(bpm));
+    ranks = m_index.rowRanks(bpm);
+    EXPECT_EQ(ranks[2], ranks[3]);
+    EXPECT_LT(ranks[1], ranks[2]);
+}
+
+TEST_F(TrackColumnIndexTest, CustomComparator) {
+    TrackColumnIndex index;
+    index.addColumn("artist",
+            kArtist,
+            TrackColumnIndex::TextColumn,
+            [](const QString& lhs, const QString& rhs) {
+                // Descending
+                return rhs.compare(lhs);
+            });
+    index.updateRow(TrackId(1), makeRecord("a", "", 0));
+    index.updateRow(TrackId(2), makeRecord("c", "", 0));
+    index.updateRow(TrackId(3), makeRecord("b", "", 0));
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({1, 2, 0}),
+            index.sortedRows(index.column("artist")));
+}
+
+TEST_F(TrackColumnIndexTest, UpdateAndRemoveRows) {
+    m_index.updateRow(TrackId(1), makeRecord("b", "/a.mp3", 120));
+    m_index.updateRow(TrackId(2), makeRecord("c", "/b.mp3", 130));
+    const int artist = m_index.column("artist");
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({0, 1}),
+            m_index.sortedRows(artist));
+
+    // Changing a value repositions the row
+    m_index.updateRow(TrackId(2), makeRecord("a", "/b.mp3", 130));
+    EXPECT_EQ(2, m_index.rowCount());
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({1, 0}),
+            m_index.sortedRows(artist));
+    EXPECT_EQ(0, countMatches(matchText("artist", "c")));
+
+    // Removed rows are not in use anymore and get reused
+    m_index.removeRow(TrackId(1));
+    EXPECT_EQ(-1, m_index.row(TrackId(1)));
+    EXPECT_FALSE(m_index.trackId(0).isValid());
+    EXPECT_EQ(1, countMatches(m_index.fullMask()));
+    m_index.updateRow(TrackId(3), makeRecord("d", "/c.mp3", 140));
+    EXPECT_EQ(2, m_index.rowCount());
+    EXPECT_EQ(0, m_index.row(TrackId(3)));
+    EXPECT_EQ(TrackId(3), m_index.trackId(0));
+    EXPECT_EQ(1, countMatches(matchText("artist", "d")));
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({1, 0}),
+            m_index.sortedRows(artist));
+
+    m_index.clear();
+    EXPECT_EQ(0, m_index.rowCount());
+    EXPECT_EQ(0, m_index.column("artist"));
+}
+
+TEST_F(TrackColumnIndexTest, SortRows) {
+    m_index.updateRow(TrackId(1), makeRecord("a", "/a.mp3", 120));
+    m_index.updateRow(TrackId(2), makeRecord("b", "/b.mp3", 130));
+    m_index.updateRow(TrackId(3), makeRecord("a", "/c.mp3", 130));
+    m_index.updateRow(TrackId(4), makeRecord("b", "/d.mp3", 130));
+
+    std::vector<TrackColumnIndex::Row> rows = {0, 1, 2, 3};
+    m_index.sortRows(&rows,
+            {{m_index.column("bpm"), Qt::DescendingOrder},
+                    {m_index.column("artist"), Qt::AscendingOrder}});
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({2, 1, 3, 0}), rows);
+
+    // A subset of the rows
+    rows = {3, 0};
+    m_index.sortRows(&rows, {{m_index.column("bpm"), Qt::AscendingOrder}});
+    EXPECT_EQ(std::vector<TrackColumnIndex::Row>({0, 3}), rows);
+}
+
+TEST_F(TrackColumnIndexTest, IncrementalSortOrder) {
+    const int numRows = 1000;
+    std::vector<QVector<QVariant>> records;
+    for (int i = 0; i < numRows; ++i) {
+        records.push_back(makeRecord(QString("Artist %1").arg((i * 7919) % 101),
+                "",
+                (i * 104729) % 97));
+    }
+    for (int i = 0; i < numRows; ++i) {
+        m_index.updateRow(TrackId(i + 1), records[i]);
+    }
+    const int artist = m_index.column("artist");
+    const int bpm = m_index.column("bpm");
+    m_index.sortedRows(artist);
+    m_index.sortedRows(bpm);
+
+    // Change a few rows with new and existing values and add some more
+    for (int i = 0; i < 20; ++i) {
+        const int row = (i * 313) % numRows;
+        records[row] = makeRecord(
+                i % 2 ? QString("New Artist %1").arg(i) : QString("Artist 1"),
+                "",
+                i % 3 ? QVariant(i * 10) : QVariant());
+        m_index.updateRow(TrackId(row + 1), records[row]);
+    }
+    for (int i = 0; i < 5; ++i) {
+        records.push_back(makeRecord(QString("Added %1").arg(i), "", 100 - i));
+        m_index.updateRow(TrackId(numRows + i + 1), records.back());
+    }
+
+    // The same sort order as from scratch
+    TrackColumnIndex expected;
+    expected.addColumn("artist", kArtist, TrackColumnIndex::NGramTextColumn);
+    expected.addColumn("location", kLocation, TrackColumnIndex::TextColumn);
+    expected.addColumn("bpm", kBpm, TrackColumnIndex::NumericColumn);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        expected.updateRow(TrackId(static_cast<int>(i) + 1), records[i]);
+    }
+    EXPECT_EQ(expected.sortedRows(artist), m_index.sortedRows(artist));
+    EXPECT_EQ(expected.sortedRows(bpm), m_index.sortedRows(bpm));
+    EXPECT_EQ(expected.rowRanks(bpm), m_index.rowRanks(bpm));
+}
+
+void fillIndex(TrackColumnIndex* pIndex, int numRows) {
+    pIndex->addColumn("artist", kArtist, TrackColumnIndex::NGramTextColumn);
+    pIndex->addColumn("location", kLocation, TrackColumnIndex::TextColumn);
+    pIndex->addColumn("bpm", kBpm, TrackColumnIndex::NumericColumn);
+    for (int i = 0; i < numRows; ++i) {
+        pIndex->updateRow(TrackId(i + 1),
+                makeRecord(QString("Artist %1").arg(i % 997),
+                        QString("/music/%1/track%2.mp3").arg(i % 97).arg(i),
+                        60 + (i % 120)));
+    }
+}
+
+static void BM_MatchText(benchmark::State& state) {
+    TrackColumnIndex index;
+    fillIndex(&index, static_cast<int>(state.range(0)));
+    const int artist = index.column("artist");
+    for (auto _ : state) {
+        auto mask = index.emptyMask();
+        index.matchText(artist, "ist 42", &mask);
+        benchmark::DoNotOptimize(mask);
+    }
+}
+BENCHMARK(BM_MatchText)->Range(1024, 65536);
+
+static void BM_SortedRows(benchmark::State& state) {
+    TrackColumnIndex index;
+    fillIndex(&index, static_cast<int>(state.range(0)));
+    const int artist = index.column("artist");
+    for (auto _ : state) {
+        index.invalidateSortOrder(artist);
+        benchmark::DoNotOptimize(index.sortedRows(artist));
+    }
+}
+BENCHMARK(BM_SortedRows)->Range(1024, 262144);
+
+static void BM_SortedRowsIncrementally(benchmark::State& state) {
+    TrackColumnIndex index;
+    const int numRows = static_cast<int>(state.range(0));
+    fillIndex(&index, numRows);
+    const int bpm = index.column("bpm");
+    index.sortedRows(bpm);
+    int i = 0;
+    for (auto _ : state) {
+        // A single edited track
+        const int row = (++i * 7919) % numRows;
+        index.updateRow(TrackId(row + 1), makeRecord("", "", 60 + (i % 120)));
+        benchmark::DoNotOptimize(index.sortedRows(bpm));
+    }
+}
+BENCHMARK(BM_SortedRowsIncrementally)->Range(1024, 262144);
+
+static void BM_SortRows(benchmark::State& state) {
+    TrackColumnIndex index;
+    fillIndex(&index, static_cast<int>(state.range(0)));
+    const std::vector<TrackColumnIndex::ColumnOrder> columnOrders = {
+            {index.column("bpm"), Qt::DescendingOrder},
+            {index.column("artist"), Qt::AscendingOrder}};
+    std::vector<TrackColumnIndex::Row> rows(index.rowCount());
+    for (auto _ : state) {
+        for (int row = 0; row < index.rowCount(); ++row) {
+            rows[row] = index.rowCount() - row - 1;
+        }
+        index.sortRows(&rows, columnOrders);
+        benchmark::DoNotOptimize(rows);
+    }
+}
+BENCHMARK(BM_SortRows)->Range(1024, 262144);
+
+} // anonymous namespace
@@ -56,3 +56,29 @@ TEST_F(TrackDAOTest, detectMovedTracks) {
     QSet<QString> trackLocations = trackDAO.getAllTrackLocations();
     EXPECT_THAT(trackLocations, UnorderedElementsAre(newFile.location(), otherFile.location()));
 }
+
+TEST_F(TrackDAOTest, getTrackLocationsInDirectory) {
+    TrackDAO& trackDAO = internalCollection()->getTrackDAO();
+
+    const QString dirPath = QDir::tempPath() + QStringLiteral("/lib/dir1");
+    mixxx::FileInfo file(QDir(dirPath), QStringLiteral("file.mp3"));
+    mixxx::FileInfo subdirFile(QDir(dirPath + QStringLiteral("/sub")), QStringLiteral("file.mp3"));
+    // Same prefix, but not a subdirectory
+    mixxx::FileInfo otherFile(QDir(dirPath + QStringLiteral("0")), QStringLiteral("file.mp3"));
+
+    TrackPointer pTrack = Track::newTemporary(mixxx::FileAccess(file));
+    const QDateTime sourceSynchronizedAt = QDateTime::fromMSecsSinceEpoch(1000000, Qt::UTC);
+    pTrack->setSourceSynchronizedAt(sourceSynchronizedAt);
+    internalCollection()->addTrack(pTrack, false);
+    internalCollection()->addTrack(Track::newTemporary(mixxx::FileAccess(subdirFile)), false);
+    internalCollection()->addTrack(Track::newTemporary(mixxx::FileAccess(otherFile)), false);
+
+    const auto locations =
+            trackDAO.getTrackLocationsInDirectoryWithSourceSynchronizedAt(dirPath, false);
+    EXPECT_THAT(locations.keys(), UnorderedElementsAre(file.location()));
+    EXPECT_EQ(sourceSynchronizedAt, locations.value(file.location()));
+
+    EXPECT_THAT(trackDAO.getTrackLocationsInDirectoryWithSourceSynchronizedAt(dirPath, true)
+                        .keys(),
+            UnorderedElementsAre(file.location(), subdirFile.location()));
+}
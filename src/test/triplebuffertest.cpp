@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "util/triplebuffer.h"
+
+namespace {
+
+TEST(TripleBufferTest, ConsumeLatest) {
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.consume());
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+    EXPECT_TRUE(buffer.consume());
+    EXPECT_EQ(2, buffer.readBuffer());
+
+    // Nothing new has been published
+    EXPECT_FALSE(buffer.consume());
+    EXPECT_EQ(2, buffer.readBuffer());
+
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+    EXPECT_TRUE(buffer.consume());
+    EXPECT_EQ(3, buffer.readBuffer());
+}
+
+TEST(TripleBufferTest, WriterNeverTouchesReadBuffer) {
+    TripleBuffer<int> buffer;
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    ASSERT_TRUE(buffer.consume());
+    const int* pRead = &buffer.readBuffer();
+    for (int i = 2; i < 10; ++i) {
+        EXPECT_NE(pRead, &buffer.writeBuffer());
+        buffer.writeBuffer() = i;
+        buffer.publish();
+    }
+    EXPECT_EQ(1, *pRead);
+}
+
+TEST(TripleBufferTest, ConcurrentReaderSeesConsistentValues) {
+    struct Value {
+        int first = 0;
+        int second = 0;
+    };
+    TripleBuffer<Value> buffer;
+    constexpr int kCount = 100000;
+
+    std::thread writer([&buffer] {
+        for (int i = 1; i <= kCount; ++i) {
+            buffer.writeBuffer().first = i;
+            buffer.writeBuffer().second = -i;
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    while (last < kCount) {
+        if (buffer.consume()) {
+            const Value& value = buffer.readBuffer();
+            ASSERT_EQ(-value.first, value.second);
+            ASSERT_GT(value.first, last);
+            last = value.first;
+        }
+    }
+    writer.join();
+    EXPECT_FALSE(buffer.consume());
+}
+
+} // namespace
@@ -0,0 +1,211 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "util/memory.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformfile.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+
+// The size of the end marker that follows the last block
+constexpr int kEndMarkerBytes = 8;
+
+std::unique_ptr<Waveform> createWaveform(int seconds) {
+    auto pWaveform = std::make_unique<Waveform>(
+            kSampleRate, kSampleRate * 2 * seconds, 441, -1);
+    WaveformData* data = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        // Quiet passages compress well
+        const int envelope = (i / 4096) % 2 ? 1 : 255;
+        data[i].filtered.low = static_cast<unsigned char>((i * 7) % envelope);
+        data[i].filtered.mid = static_cast<unsigned char>((i * 13) % envelope);
+        data[i].filtered.high = static_cast<unsigned char>((i * 29) % envelope);
+        data[i].filtered.all = static_cast<unsigned char>((i * 31) % envelope);
+    }
+    pWaveform->updatePyramid(pWaveform->getDataSize());
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    return pWaveform;
+}
+
+bool writeFile(const QString& fileName, const QByteArray& data) {
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+class WaveformFileTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_pWaveform = createWaveform(60);
+    }
+
+    QString filePath() const {
+        return m_dir.filePath("waveform");
+    }
+
+    void expectEqualWaveform(const Waveform& actual) const {
+        const Waveform& expected = *m_pWaveform;
+        EXPECT_TRUE(actual.isValid());
+        EXPECT_EQ(expected.getDataSize(), actual.getCompletion());
+        EXPECT_DOUBLE_EQ(expected.getAudioVisualRatio(), actual.getAudioVisualRatio());
+        EXPECT_EQ(expected.getTextureStride(), actual.getTextureStride());
+        EXPECT_EQ(0, actual.getTextureSize() % actual.getTextureStride());
+        EXPECT_LE(actual.getDataSize(), actual.getTextureSize());
+        EXPECT_EQ(Waveform::SaveState::Saved, actual.saveState());
+        ASSERT_EQ(expected.getPyramidLevelCount(), actual.getPyramidLevelCount());
+        for (int level = 0; level < expected.getPyramidLevelCount(); ++level) {
+            ASSERT_EQ(expected.getPyramidDataSize(level), actual.getPyramidDataSize(level));
+            for (int i = 0; i < expected.getPyramidDataSize(level); ++i) {
+                ASSERT_EQ(expected.getPyramidData(level)[i].m_i,
+                        actual.getPyramidData(level)[i].m_i);
+            }
+        }
+    }
+
+    QTemporaryDir m_dir;
+    std::unique_ptr<Waveform> m_pWaveform;
+};
+
+TEST_F(WaveformFileTest, MapUncompressed) {
+    ASSERT_TRUE(writeFile(filePath(), WaveformFile::toByteArray(*m_pWaveform)));
+
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    ASSERT_TRUE(pLoaded);
+    EXPECT_TRUE(pLoaded->isMapped());
+    expectEqualWaveform(*pLoaded);
+}
+
+TEST_F(WaveformFileTest, LoadCompressed) {
+    const QByteArray compressed = WaveformFile::toByteArray(
+            *m_pWaveform, WaveformFile::Compression::Zlib);
+    EXPECT_LT(compressed.size(), WaveformFile::toByteArray(*m_pWaveform).size());
+    ASSERT_TRUE(writeFile(filePath(), compressed));
+
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    ASSERT_TRUE(pLoaded);
+    EXPECT_FALSE(pLoaded->isMapped());
+    expectEqualWaveform(*pLoaded);
+}
+
+TEST_F(WaveformFileTest, HeaderChecksum) {
+    QByteArray data = WaveformFile::toByteArray(*m_pWaveform);
+    QBuffer buffer(&data);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    EXPECT_NE(-1, WaveformFile::headerChecksum(&buffer));
+
+    // Waveforms stored by older versions are not recognized
+    QByteArray legacyData = qCompress(m_pWaveform->toByteArray());
+    QBuffer legacyBuffer(&legacyData);
+    ASSERT_TRUE(legacyBuffer.open(QIODevice::ReadOnly));
+    EXPECT_EQ(-1, WaveformFile::headerChecksum(&legacyBuffer));
+}
+
+TEST_F(WaveformFileTest, RejectCorruptBlock) {
+    QByteArray data = WaveformFile::toByteArray(
+            *m_pWaveform, WaveformFile::Compression::Zlib);
+    data[data.size() - 1] = static_cast<char>(data[data.size() - 1] ^ 0xff);
+    ASSERT_TRUE(writeFile(filePath(), data));
+
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    EXPECT_FALSE(pLoaded);
+}
+
+TEST_F(WaveformFileTest, MapWithoutVerifyingBlocks) {
+    QByteArray data = WaveformFile::toByteArray(*m_pWaveform);
+    // A single bit in the middle of the data
+    const int i = data.size() / 2;
+    data[i] = static_cast<char>(data[i] ^ 0x01);
+    ASSERT_TRUE(writeFile(filePath(), data));
+
+    // The blocks of a completely written file are not paged in
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    ASSERT_TRUE(pLoaded);
+    EXPECT_TRUE(pLoaded->isMapped());
+}
+
+TEST_F(WaveformFileTest, RejectCorruptMappedBlock) {
+    QByteArray data = WaveformFile::toByteArray(*m_pWaveform);
+    // A single bit in the middle of the data
+    const int i = data.size() / 2;
+    data[i] = static_cast<char>(data[i] ^ 0x01);
+    // Without the end marker the file may not have been written completely
+    data.chop(kEndMarkerBytes);
+    ASSERT_TRUE(writeFile(filePath(), data));
+
+    // The header is intact and the file would be mapped
+    QFile file(filePath());
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    EXPECT_NE(-1, WaveformFile::headerChecksum(&file));
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    EXPECT_FALSE(pLoaded);
+}
+
+TEST_F(WaveformFileTest, RejectTruncatedFile) {
+    QByteArray data = WaveformFile::toByteArray(*m_pWaveform);
+    data.chop(kEndMarkerBytes + 1);
+    ASSERT_TRUE(writeFile(filePath(), data));
+
+    std::unique_ptr<Waveform> pLoaded(WaveformFile::load(filePath()));
+    EXPECT_FALSE(pLoaded);
+}
+
+// Loading a waveform the way it was stored before WaveformFile, with the
+// length of the track in minutes as argument
+static void BM_LoadCompressedProtobuf(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("waveform");
+    if (!writeFile(fileName, qCompress(createWaveform(
+                                     static_cast<int>(state.range(0)) * 60)
+                                               ->toByteArray()))) {
+        state.SkipWithError("Failed to write waveform");
+        return;
+    }
+    for (auto _ : state) {
+        QFile file(fileName);
+        file.open(QIODevice::ReadOnly);
+        Waveform waveform(qUncompress(file.readAll()));
+        benchmark::DoNotOptimize(waveform.getAll(waveform.getDataSize() / 2));
+    }
+}
+BENCHMARK(BM_LoadCompressedProtobuf)->Range(1, 120)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadWaveformFile(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("waveform");
+    if (!writeFile(fileName, WaveformFile::toByteArray(*createWaveform(
+                                     static_cast<int>(state.range(0)) * 60)))) {
+        state.SkipWithError("Failed to write waveform");
+        return;
+    }
+    for (auto _ : state) {
+        std::unique_ptr<Waveform> pWaveform(WaveformFile::load(fileName));
+        benchmark::DoNotOptimize(pWaveform->getAll(pWaveform->getDataSize() / 2));
+    }
+}
+BENCHMARK(BM_LoadWaveformFile)->Range(1, 120)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadCompressedWaveformFile(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("waveform");
+    if (!writeFile(fileName,
+                WaveformFile::toByteArray(
+                        *createWaveform(static_cast<int>(state.range(0)) * 60),
+                        WaveformFile::Compression::Zlib))) {
+        state.SkipWithError("Failed to write waveform");
+        return;
+    }
+    for (auto _ : state) {
+        std::unique_ptr<Waveform> pWaveform(WaveformFile::load(fileName));
+        benchmark::DoNotOptimize(pWaveform->getAll(pWaveform->getDataSize() / 2));
+    }
+}
+BENCHMARK(BM_LoadCompressedWaveformFile)->Range(1, 120)->Unit(benchmark::kMillisecond);
+
+} // namespace
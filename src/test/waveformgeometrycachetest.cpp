@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <QImage>
+#include <QtDebug>
+#include <typeinfo>
+
+#include "util/time.h"
+#include "waveform/renderers/waveformgeometrycache.h"
+#include "waveform/renderers/waveformrasterizer.h"
+
+namespace {
+
+class WaveformGeometryCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        mixxx::Time::setTestMode(true);
+        mixxx::Time::setTestElapsedTime(mixxx::Duration::fromSeconds(1));
+        m_pWaveform = ConstWaveformPointer(new Waveform());
+        m_style.pRendererType = &typeid(int);
+        m_style.colors = {qRgb(255, 0, 0)};
+    }
+
+    void TearDown() override {
+        mixxx::Time::setTestMode(false);
+    }
+
+    WaveformGeometryParams params(double firstDisplayedPosition) const {
+        WaveformGeometryParams params;
+        params.waveform = m_pWaveform;
+        params.trackPixelCount = 10000;
+        params.firstDisplayedPosition = firstDisplayedPosition;
+        params.lastDisplayedPosition = firstDisplayedPosition + 0.1;
+        params.length = 1000;
+        params.guardPixels = 64;
+        return params;
+    }
+
+    std::shared_ptr<const WaveformGeometry> geometry(
+            const WaveformGeometryParams& params, int lineCount = 1000) const {
+        auto pGeometry = std::make_shared<WaveformGeometry>();
+        pGeometry->params = params;
+        for (int i = 0; i < lineCount; ++i) {
+            // Across the whole breadth
+            pGeometry->addLine(i, 0, i, 1, qRgb(255, 0, 0));
+        }
+        return pGeometry;
+    }
+
+    ConstWaveformPointer m_pWaveform;
+    WaveformGeometryStyle m_style;
+    // The renderers that insert the geometries
+    const int m_deck1 = 0;
+    const int m_deck2 = 0;
+};
+
+TEST_F(WaveformGeometryCacheTest, FindShifted) {
+    WaveformGeometryCache cache;
+    const auto pGeometry = geometry(params(0.5));
+    cache.insert(&m_deck1, m_style, pGeometry);
+
+    int shift = 0;
+    // 20 pixels later
+    EXPECT_EQ(pGeometry, cache.find(m_style, params(0.502), &shift));
+    EXPECT_EQ(-20, shift);
+    // Beyond the guard pixels
+    EXPECT_EQ(nullptr, cache.find(m_style, params(0.51), &shift));
+
+    WaveformGeometryStyle otherStyle = m_style;
+    otherStyle.colors = {qRgb(0, 255, 0)};
+    EXPECT_EQ(nullptr, cache.find(otherStyle, params(0.5), &shift));
+}
+
+TEST_F(WaveformGeometryCacheTest, ReplaceSameLayout) {
+    WaveformGeometryCache cache;
+    cache.insert(&m_deck1, m_style, geometry(params(0.5)));
+    const auto pGeometry = geometry(params(0.501));
+    cache.insert(&m_deck1, m_style, pGeometry);
+    EXPECT_EQ(1, cache.size());
+
+    int shift = 0;
+    EXPECT_EQ(pGeometry, cache.find(m_style, params(0.5), &shift));
+    EXPECT_EQ(10, shift);
+
+    // Another zoom level is kept separately
+    WaveformGeometryParams zoomed = params(0.5);
+    zoomed.trackPixelCount *= 2;
+    cache.insert(&m_deck1, m_style, geometry(zoomed));
+    EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(WaveformGeometryCacheTest, ShareBetweenBreadthsAndLengths) {
+    WaveformGeometryCache cache;
+    // A tall waveform generates the geometry
+    const auto pGeometry = geometry(params(0.5));
+    cache.insert(&m_deck1, m_style, pGeometry);
+
+    // A flat and shorter waveform of the same track and zoom draws it too
+    WaveformGeometryParams shorter = params(0.5);
+    shorter.length = 500;
+    int shift = 0;
+    EXPECT_EQ(pGeometry, cache.find(m_style, shorter, &shift));
+    EXPECT_EQ(0, shift);
+    EXPECT_EQ(1, cache.size());
+
+    // Both scale the lines to their own breadth
+    for (const int breadth : {100, 40}) {
+        WaveformRasterizer rasterizer;
+        const QImage& image = rasterizer.rasterize(
+                *pGeometry, shift, QSize(shorter.length, breadth), Qt::Horizontal, 1.0);
+        EXPECT_EQ(QSize(shorter.length, breadth), image.size());
+        EXPECT_EQ(qRgb(255, 0, 0), image.pixel(10, 0)) << "breadth" << breadth;
+        EXPECT_EQ(qRgb(255, 0, 0), image.pixel(10, breadth - 1)) << "breadth" << breadth;
+    }
+
+    // A longer waveform is not covered
+    WaveformGeometryParams longer = params(0.5);
+    longer.length = 1200;
+    EXPECT_EQ(nullptr, cache.find(m_style, longer, &shift));
+}
+
+TEST_F(WaveformGeometryCacheTest, KeepGeometryOfEachRenderer) {
+    WaveformGeometryCache cache;
+    // Two decks play the same track at different positions
+    const auto pGeometry1 = geometry(params(0.5));
+    cache.insert(&m_deck1, m_style, pGeometry1);
+    const auto pGeometry2 = geometry(params(0.7));
+    cache.insert(&m_deck2, m_style, pGeometry2);
+    EXPECT_EQ(2, cache.size());
+
+    int shift = 0;
+    EXPECT_EQ(pGeometry1, cache.find(m_style, params(0.5), &shift));
+    EXPECT_EQ(pGeometry2, cache.find(m_style, params(0.7), &shift));
+
+    // Each deck only replaces its own geometry
+    const auto pGeometry3 = geometry(params(0.501));
+    cache.insert(&m_deck1, m_style, pGeometry3);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(pGeometry3, cache.find(m_style, params(0.5), &shift));
+    EXPECT_EQ(pGeometry2, cache.find(m_style, params(0.7), &shift));
+}
+
+TEST_F(WaveformGeometryCacheTest, BoundMemoryUsage) {
+    const auto pGeometry = geometry(params(0.5));
+    const std::size_t geometryMemory = sizeof(WaveformGeometry) + pGeometry->memoryUsage();
+    WaveformGeometryCache cache(geometryMemory * 2);
+    for (int i = 0; i < 5; ++i) {
+        WaveformGeometryParams zoomed = params(0.5);
+        zoomed.trackPixelCount += i;
+        cache.insert(&m_deck1, m_style, geometry(zoomed));
+        EXPECT_LE(cache.memoryUsage(), geometryMemory * 2);
+    }
+    EXPECT_EQ(2, cache.size());
+
+    // The least recently used one has been dropped
+    int shift = 0;
+    WaveformGeometryParams zoomed = params(0.5);
+    zoomed.trackPixelCount += 4;
+    EXPECT_NE(nullptr, cache.find(m_style, zoomed, &shift));
+    zoomed.trackPixelCount -= 2;
+    EXPECT_EQ(nullptr, cache.find(m_style, zoomed, &shift));
+}
+
+TEST_F(WaveformGeometryCacheTest, DropIdle) {
+    WaveformGeometryCache cache;
+    cache.insert(&m_deck1, m_style, geometry(params(0.5)));
+
+    mixxx::Time::setTestElapsedTime(mixxx::Duration::fromSeconds(10));
+    WaveformGeometryParams zoomed = params(0.5);
+    zoomed.trackPixelCount *= 2;
+    cache.insert(&m_deck1, m_style, geometry(zoomed));
+
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST_F(WaveformGeometryCacheTest, DropIdleWithoutInsert) {
+    WaveformGeometryCache cache;
+    cache.insert(&m_deck1, m_style, geometry(params(0.5)));
+    cache.insert(&m_deck2, m_style, geometry(params(0.7)));
+
+    // Only the first deck keeps drawing while it is paused
+    int shift = 0;
+    for (int seconds = 2; seconds <= 10; ++seconds) {
+        mixxx::Time::setTestElapsedTime(mixxx::Duration::fromSeconds(seconds));
+        EXPECT_NE(nullptr, cache.find(m_style, params(0.5), &shift));
+    }
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(nullptr, cache.find(m_style, params(0.7), &shift));
+}
+
+TEST_F(WaveformGeometryCacheTest, Requests) {
+    WaveformGeometryCache cache;
+    EXPECT_FALSE(cache.isRequested(m_style, params(0.5)));
+
+    cache.setRequested(&m_deck1, m_style, params(0.5));
+    EXPECT_TRUE(cache.isRequested(m_style, params(0.5)));
+    EXPECT_FALSE(cache.isRequested(m_style, params(0.501)));
+
+    // Fulfilled
+    cache.insert(&m_deck1, m_style, geometry(params(0.5)));
+    EXPECT_FALSE(cache.isRequested(m_style, params(0.5)));
+
+    // Dropped
+    cache.setRequested(&m_deck2, m_style, params(0.502));
+    cache.dropRequest(&m_deck2);
+    EXPECT_FALSE(cache.isRequested(m_style, params(0.502)));
+
+    // Outdated
+    cache.setRequested(&m_deck1, m_style, params(0.503));
+    mixxx::Time::setTestElapsedTime(mixxx::Duration::fromSeconds(2));
+    EXPECT_FALSE(cache.isRequested(m_style, params(0.503)));
+}
+
+} // namespace
@@ -0,0 +1,249 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QtDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "waveform/renderers/waveformrasterizer.h"
+
+namespace {
+
+constexpr int kLength = 1024;
+constexpr int kBreadth = 128;
+
+/// Three bands of lines, like WaveformRendererFilteredSignal generates them
+/// for a waveform of the given breadth
+WaveformGeometry createGeometry(int length, int breadth, QRgb lowColor, QRgb midColor, QRgb highColor) {
+    WaveformGeometry geometry;
+    geometry.params.length = length;
+    const QRgb colors[] = {lowColor, midColor, highColor};
+    for (int band = 0; band < 3; ++band) {
+        for (int x = 0; x < length; ++x) {
+            // Leave gaps where the band is silent
+            if ((x * (band + 3)) % 17 == 0) {
+                continue;
+            }
+            const int amplitude = ((x * 7 + band * 13) % (breadth / 2)) / (band + 1);
+            // In units of the breadth
+            geometry.addLine(x,
+                    static_cast<double>(breadth / 2 - amplitude) / breadth,
+                    x,
+                    static_cast<double>(breadth / 2 + amplitude) / breadth,
+                    colors[band]);
+        }
+    }
+    return geometry;
+}
+
+/// Returns the line scaled to the breadth like WaveformRendererSignalBase
+/// does
+QLineF scaledLine(const QLineF& line, int breadth) {
+    return QLineF(line.x1(),
+            std::floor(line.y1() * breadth),
+            line.x2(),
+            std::floor(line.y2() * breadth));
+}
+
+/// Draws the lines like WaveformRendererSignalBase does with other paint
+/// engines than the raster engine.
+QImage drawLines(const WaveformGeometry& geometry,
+        int breadth,
+        int shift,
+        Qt::Orientation orientation) {
+    const QSize size = orientation == Qt::Horizontal
+            ? QSize(geometry.params.length, breadth)
+            : QSize(breadth, geometry.params.length);
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing, false);
+    if (orientation == Qt::Vertical) {
+        painter.setTransform(QTransform(0, 1, 1, 0, 0, 0));
+    }
+    painter.translate(shift, 0);
+    QVector<QLineF> lines(geometry.lines.size());
+    std::transform(geometry.lines.cbegin(),
+            geometry.lines.cend(),
+            lines.begin(),
+            [breadth](const QLineF& line) {
+                return scaledLine(line, breadth);
+            });
+    QPen pen;
+    pen.setCapStyle(Qt::FlatCap);
+    pen.setWidthF(geometry.lineWidth);
+    int begin = 0;
+    while (begin < geometry.lines.size()) {
+        int end = begin + 1;
+        while (end < geometry.lines.size() && geometry.colors[end] == geometry.colors[begin]) {
+            ++end;
+        }
+        pen.setColor(QColor::fromRgba(geometry.colors[begin]));
+        painter.setPen(pen);
+        painter.drawLines(lines.constData() + begin, end - begin);
+        begin = end;
+    }
+    return image;
+}
+
+/// QPainter rounds differently when blending translucent colors
+constexpr int kMaxChannelDifference = 1;
+
+/// Marks the pixels at both ends of each line within the column of the
+/// line. The aliased rasterization of QPainter may or may not cover the
+/// end point of a line, and rounds its first pixel differently. The mask
+/// is indexed by position * breadth + the position across the waveform.
+std::vector<bool> lineEndMask(const WaveformGeometry& geometry, int breadth, int shift) {
+    const int length = geometry.params.length;
+    std::vector<bool> mask(static_cast<std::size_t>(length) * breadth, false);
+    for (const QLineF& unscaledLine : geometry.lines) {
+        const QLineF line = scaledLine(unscaledLine, breadth);
+        const int x = static_cast<int>(std::floor(line.x1())) + shift;
+        if (x < 0 || x >= length) {
+            continue;
+        }
+        const int top = static_cast<int>(std::floor(std::min(line.y1(), line.y2())));
+        const int bottom = static_cast<int>(std::floor(std::max(line.y1(), line.y2())));
+        for (const int y : {top - 1, top, bottom - 1, bottom}) {
+            if (y >= 0 && y < breadth) {
+                mask[static_cast<std::size_t>(x) * breadth + y] = true;
+            }
+        }
+    }
+    return mask;
+}
+
+/// Returns the number of pixels with a color channel that differs by more
+/// than kMaxChannelDifference between both images, except for the pixels
+/// at the ends of the lines. Those only differ in coverage, so all other
+/// pixels must match, including the pixels of missing or extra lines.
+int differingPixelCount(const QImage& expected,
+        const QImage& actual,
+        const WaveformGeometry& geometry,
+        int breadth,
+        int shift,
+        Qt::Orientation orientation) {
+    EXPECT_EQ(expected.size(), actual.size());
+    const std::vector<bool> mask = lineEndMask(geometry, breadth, shift);
+    int count = 0;
+    int lineEndCount = 0;
+    for (int y = 0; y < expected.height(); ++y) {
+        for (int x = 0; x < expected.width(); ++x) {
+            const QRgb pixel1 = expected.pixel(x, y);
+            const QRgb pixel2 = actual.pixel(x, y);
+            const int difference = std::max({
+                    std::abs(qRed(pixel1) - qRed(pixel2)),
+                    std::abs(qGreen(pixel1) - qGreen(pixel2)),
+                    std::abs(qBlue(pixel1) - qBlue(pixel2)),
+                    std::abs(qAlpha(pixel1) - qAlpha(pixel2))});
+            if (difference <= kMaxChannelDifference) {
+                continue;
+            }
+            const int position = orientation == Qt::Horizontal ? x : y;
+            const int across = orientation == Qt::Horizontal ? y : x;
+            if (mask[static_cast<std::size_t>(position) * breadth + across]) {
+                ++lineEndCount;
+            } else {
+                ++count;
+            }
+        }
+    }
+    qDebug() << lineEndCount << "of" << geometry.lines.size() * 4
+             << "line end pixels differ from QPainter";
+    return count;
+}
+
+TEST(WaveformRasterizerTest, OpaqueLinesMatchQPainter) {
+    const WaveformGeometry geometry = createGeometry(
+            kLength, kBreadth, qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255));
+    for (const auto orientation : {Qt::Horizontal, Qt::Vertical}) {
+        for (const int shift : {0, 5, -7}) {
+            WaveformRasterizer rasterizer;
+            const QImage& image = rasterizer.rasterize(
+                    geometry, shift, QSize(kLength, kBreadth), orientation, 1.0);
+            EXPECT_EQ(0,
+                    differingPixelCount(drawLines(geometry, kBreadth, shift, orientation),
+                            image,
+                            geometry,
+                            kBreadth,
+                            shift,
+                            orientation))
+                    << "orientation" << orientation << "shift" << shift;
+        }
+    }
+}
+
+TEST(WaveformRasterizerTest, TranslucentLinesMatchQPainter) {
+    // The bands are blended over each other in order
+    const WaveformGeometry geometry = createGeometry(kLength,
+            kBreadth,
+            qRgba(255, 0, 0, 200),
+            qRgba(0, 255, 0, 128),
+            qRgba(0, 0, 255, 60));
+    WaveformRasterizer rasterizer;
+    for (const auto orientation : {Qt::Horizontal, Qt::Vertical}) {
+        const QImage& image = rasterizer.rasterize(
+                geometry, 0, QSize(kLength, kBreadth), orientation, 1.0);
+        EXPECT_EQ(0,
+                differingPixelCount(drawLines(geometry, kBreadth, 0, orientation),
+                        image,
+                        geometry,
+                        kBreadth,
+                        0,
+                        orientation))
+                << "orientation" << orientation;
+    }
+}
+
+TEST(WaveformRasterizerTest, ReuseForSmallerGeometry) {
+    WaveformRasterizer rasterizer;
+    rasterizer.rasterize(
+            createGeometry(kLength, kBreadth, qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255)),
+            0,
+            QSize(kLength, kBreadth),
+            Qt::Horizontal,
+            1.0);
+    // Nothing of the previous frame must remain
+    WaveformGeometry geometry;
+    geometry.params.length = kLength / 2;
+    geometry.addLine(10, 0, 10, 1, qRgb(255, 255, 255));
+    const QImage& image = rasterizer.rasterize(
+            geometry, 0, QSize(kLength / 2, kBreadth / 2), Qt::Horizontal, 1.0);
+    EXPECT_EQ(QSize(kLength / 2, kBreadth / 2), image.size());
+    EXPECT_EQ(0,
+            differingPixelCount(drawLines(geometry, kBreadth / 2, 0, Qt::Horizontal),
+                    image,
+                    geometry,
+                    kBreadth / 2,
+                    0,
+                    Qt::Horizontal));
+}
+
+static void BM_DrawLines(benchmark::State& state) {
+    const WaveformGeometry geometry = createGeometry(
+            state.range(0), kBreadth, qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(drawLines(geometry, kBreadth, 0, Qt::Horizontal));
+    }
+}
+BENCHMARK(BM_DrawLines)->Range(512, 4096);
+
+static void BM_Rasterize(benchmark::State& state) {
+    const WaveformGeometry geometry = createGeometry(
+            state.range(0), kBreadth, qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255));
+    WaveformRasterizer rasterizer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rasterizer.rasterize(geometry,
+                0,
+                QSize(static_cast<int>(state.range(0)), kBreadth),
+                Qt::Horizontal,
+                1.0));
+    }
+}
+BENCHMARK(BM_Rasterize)->Range(512, 4096);
+
+} // namespace
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "waveform/waveformrendergovernor.h"
+
+namespace {
+
+using Decision = WaveformRenderGovernor::Decision;
+
+constexpr int kFrameIntervalMicros = 1000000 / 60;
+
+class WaveformRenderGovernorTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_governor.setEnabled(true);
+        m_governor.setFrameIntervalMicros(kFrameIntervalMicros);
+    }
+
+    // Renders the given number of frames with a single widget and returns
+    // how many times it has been rendered.
+    int renderFrames(int frames, bool changed, bool background, int renderTimeMicros) {
+        int rendered = 0;
+        for (int i = 0; i < frames; ++i) {
+            if (m_governor.decide(0, changed, background) == Decision::Render) {
+                ++rendered;
+            }
+            m_governor.frameRendered(renderTimeMicros);
+        }
+        return rendered;
+    }
+
+    WaveformRenderGovernor m_governor;
+};
+
+TEST_F(WaveformRenderGovernorTest, RenderEverythingWhenDisabled) {
+    m_governor.setEnabled(false);
+    EXPECT_EQ(100, renderFrames(100, false, true, kFrameIntervalMicros));
+    EXPECT_EQ(1, m_governor.backgroundDivider());
+}
+
+TEST_F(WaveformRenderGovernorTest, SkipUnchanged) {
+    // Unchanged widgets are refreshed at 4 fps
+    EXPECT_EQ(4, renderFrames(60, false, false, 0));
+    EXPECT_EQ(60, renderFrames(60, true, false, 0));
+}
+
+TEST_F(WaveformRenderGovernorTest, ThrottleBackgroundOverBudget) {
+    // Rendering takes the whole frame interval
+    renderFrames(200, true, false, kFrameIntervalMicros);
+    EXPECT_EQ(8, m_governor.backgroundDivider());
+    // Foreground widgets are never throttled
+    EXPECT_EQ(80, renderFrames(80, true, false, kFrameIntervalMicros));
+    EXPECT_EQ(10, renderFrames(80, true, true, kFrameIntervalMicros));
+
+    // The render time has dropped again
+    renderFrames(400, true, false, 0);
+    EXPECT_EQ(1, m_governor.backgroundDivider());
+    EXPECT_EQ(80, renderFrames(80, true, true, 0));
+}
+
+TEST_F(WaveformRenderGovernorTest, KeepDividerWithinBudget) {
+    // Between the headroom and the budget nothing changes
+    renderFrames(200, true, false, kFrameIntervalMicros / 3);
+    EXPECT_EQ(1, m_governor.backgroundDivider());
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <algorithm>
+
+#include "util/math.h"
+#include "util/memory.h"
+#include "waveform/waveform.h"
+
+namespace {
+
+class WaveformTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        // One minute of stereo audio
+        const int sampleRate = 44100;
+        m_pWaveform = std::make_unique<Waveform>(
+                sampleRate, sampleRate * 2 * 60, 441, -1);
+    }
+
+    void fillData(int seed) {
+        WaveformData* data = m_pWaveform->data();
+        for (int i = 0; i < m_pWaveform->getDataSize(); ++i) {
+            data[i].filtered.low = static_cast<unsigned char>((i * 7 + seed) % 256);
+            data[i].filtered.mid = static_cast<unsigned char>((i * 13 + seed) % 256);
+            data[i].filtered.high = static_cast<unsigned char>((i * 29 + seed) % 256);
+            data[i].filtered.all = static_cast<unsigned char>((i * 31 + seed) % 256);
+        }
+    }
+
+    static void expectEqualLevels(const Waveform& expected, const Waveform& actual) {
+        ASSERT_EQ(expected.getPyramidLevelCount(), actual.getPyramidLevelCount());
+        for (int level = 0; level < expected.getPyramidLevelCount(); ++level) {
+            ASSERT_EQ(expected.getPyramidDataSize(level), actual.getPyramidDataSize(level));
+            for (int i = 0; i < expected.getPyramidDataSize(level); ++i) {
+                EXPECT_EQ(expected.getPyramidData(level)[i].m_i,
+                        actual.getPyramidData(level)[i].m_i);
+            }
+        }
+    }
+
+    std::unique_ptr<Waveform> m_pWaveform;
+};
+
+TEST_F(WaveformTest, PyramidLevelSizes) {
+    ASSERT_GT(m_pWaveform->getPyramidLevelCount(), 1);
+    EXPECT_EQ(m_pWaveform->getDataSize(), m_pWaveform->getPyramidDataSize(0));
+    for (int level = 1; level < m_pWaveform->getPyramidLevelCount(); ++level) {
+        const int frameCount = m_pWaveform->getPyramidDataSize(level - 1) / 2;
+        EXPECT_EQ(2 * ((frameCount + 1) / 2), m_pWaveform->getPyramidDataSize(level));
+    }
+}
+
+TEST_F(WaveformTest, PyramidMax) {
+    fillData(0);
+    m_pWaveform->updatePyramid(m_pWaveform->getDataSize());
+
+    const WaveformData* data = m_pWaveform->data();
+    const WaveformData* max = m_pWaveform->getPyramidData(1);
+    // Frame 0 of level 1 covers the frames 0 and 1, i.e. the visual
+    // samples 0 and 2 of the left channel
+    EXPECT_EQ(math_max(data[0].filtered.low, data[2].filtered.low), max[0].filtered.low);
+    EXPECT_EQ(math_max(data[1].filtered.high, data[3].filtered.high), max[1].filtered.high);
+}
+
+TEST_F(WaveformTest, PyramidIncrementalUpdate) {
+    fillData(1);
+    Waveform expected(44100, 44100 * 2 * 60, 441, -1);
+    std::copy(m_pWaveform->data(),
+            m_pWaveform->data() + m_pWaveform->getDataSize(),
+            expected.data());
+    expected.updatePyramid(expected.getDataSize());
+
+    // Chunks of an odd number of frames to cover partially completed
+    // frames of the coarser levels
+    for (int completion = 0; completion < m_pWaveform->getDataSize(); completion += 346) {
+        m_pWaveform->updatePyramid(completion);
+    }
+    m_pWaveform->updatePyramid(m_pWaveform->getDataSize());
+
+    expectEqualLevels(expected, *m_pWaveform);
+}
+
+TEST_F(WaveformTest, PyramidLevelForZoom) {
+    EXPECT_EQ(0, m_pWaveform->getPyramidLevel(0.5));
+    EXPECT_EQ(0, m_pWaveform->getPyramidLevel(1.9));
+    EXPECT_EQ(1, m_pWaveform->getPyramidLevel(2.0));
+    EXPECT_EQ(2, m_pWaveform->getPyramidLevel(5.0));
+    EXPECT_EQ(m_pWaveform->getPyramidLevelCount() - 1,
+            m_pWaveform->getPyramidLevel(1000000.0));
+}
+
+TEST_F(WaveformTest, PyramidSerialization) {
+    fillData(2);
+    m_pWaveform->updatePyramid(m_pWaveform->getDataSize());
+
+    Waveform restored(m_pWaveform->toByteArray());
+    expectEqualLevels(*m_pWaveform, restored);
+}
+
+} // namespace
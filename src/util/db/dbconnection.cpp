@@ -1,5 +1,6 @@
 #include <QSqlDriver>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #ifdef __SQLITE3__
 #include <sqlite3.h>
@@ -310,18 +311,69 @@ bool initDatabase(const QSqlDatabase& database, mixxx::StringCollator* pCollator
     return true;
 }
 
+#ifdef __SQLITE3__
+void execPragma(const QSqlDatabase& database, const QString& pragma) {
+    QSqlQuery query(database);
+    if (!query.exec(pragma)) {
+        kLogger.warning()
+                << "Failed to execute"
+                << pragma
+                << query.lastError();
+        return;
+    }
+    if (query.next() && kLogger.debugEnabled()) {
+        kLogger.debug()
+                << pragma
+                << "->"
+                << query.value(0);
+    }
+}
+#endif // __SQLITE3__
+
+// Tuning is optional. Connections remain functional if it fails.
+void tuneDatabase(const QSqlDatabase& database, const DbConnection::Tuning& tuning) {
+    DEBUG_ASSERT(database.isOpen());
+#ifdef __SQLITE3__
+    if (!tuning.enabled) {
+        return;
+    }
+    // Readers don't block the writer and vice versa, e.g. the library
+    // can be browsed while the scanner is writing. In-memory databases
+    // silently keep their journal mode.
+    execPragma(database, QStringLiteral("PRAGMA journal_mode=WAL"));
+    // Committed transactions might be lost on power failure in WAL mode,
+    // but the database remains consistent.
+    execPragma(database, QStringLiteral("PRAGMA synchronous=NORMAL"));
+    execPragma(database, QStringLiteral("PRAGMA temp_store=MEMORY"));
+    if (tuning.mmapSizeBytes > 0) {
+        execPragma(database,
+                QStringLiteral("PRAGMA mmap_size=%1").arg(tuning.mmapSizeBytes));
+    }
+    if (tuning.cacheSizeKiB > 0) {
+        // Negative values are in KiB instead of pages
+        execPragma(database,
+                QStringLiteral("PRAGMA cache_size=-%1").arg(tuning.cacheSizeKiB));
+    }
+#else
+    Q_UNUSED(database);
+    Q_UNUSED(tuning);
+#endif // __SQLITE3__
+}
+
 } // anonymous namespace
 
 DbConnection::DbConnection(
         const Params& params,
         const QString& connectionName)
-    : m_sqlDatabase(createDatabase(params, connectionName)) {
+    : m_sqlDatabase(createDatabase(params, connectionName)),
+      m_tuning(params.tuning) {
 }
 
 DbConnection::DbConnection(
         const DbConnection& prototype,
         const QString& connectionName)
-    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
+    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)),
+      m_tuning(prototype.m_tuning) {
 }
 
 DbConnection::~DbConnection() {
@@ -349,6 +401,7 @@ bool DbConnection::open() {
         m_sqlDatabase.close();
         return false; // abort
     }
+    tuneDatabase(m_sqlDatabase, m_tuning);
     return true;
 }
 
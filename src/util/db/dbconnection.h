@@ -22,6 +22,17 @@ class DbConnection final {
 
     static void makeStringLatinLow(QString* string);
 
+    // Performance settings that are applied to each connection after
+    // opening it. Only supported for SQLite.
+    struct Tuning {
+        // WAL journaling with synchronous=NORMAL and temp_store=MEMORY
+        bool enabled = false;
+        // Memory-mapped I/O, 0 = disabled
+        qint64 mmapSizeBytes = 0;
+        // Page cache of each connection, 0 = default
+        int cacheSizeKiB = 0;
+    };
+
     struct Params {
         QString type;
         QString connectOptions;
@@ -29,6 +40,7 @@ class DbConnection final {
         QString filePath;
         QString userName;
         QString password;
+        Tuning tuning;
     };
 
     // All constructors are reserved for DbConnectionPool!!
@@ -62,6 +74,7 @@ class DbConnection final {
     DbConnection(const DbConnection&&) = delete;
 
     QSqlDatabase m_sqlDatabase;
+    const Tuning m_tuning;
     mixxx::StringCollator m_collator;
 };
 
@@ -0,0 +1,55 @@
+#include "util/db/sqlstatementcache.h"
+
+#include "util/assert.h"
+
+SqlStatementCache::SqlStatementCache(int capacity)
+        : m_capacity(capacity) {
+    DEBUG_ASSERT(m_capacity >= 0);
+}
+
+void SqlStatementCache::setDatabase(const QSqlDatabase& database) {
+    clear();
+    m_database = database;
+}
+
+void SqlStatementCache::setCapacity(int capacity) {
+    DEBUG_ASSERT(capacity >= 0);
+    m_capacity = capacity;
+    evictExceedingEntries();
+}
+
+void SqlStatementCache::evictExceedingEntries() {
+    while (static_cast<int>(m_entries.size()) > m_capacity) {
+        m_entriesByStatement.remove(m_entries.back().statement);
+        m_entries.pop_back();
+    }
+}
+
+void SqlStatementCache::clear() {
+    m_entriesByStatement.clear();
+    m_entries.clear();
+}
+
+QSqlQuery SqlStatementCache::prepare(const QString& statement) {
+    const auto it = m_entriesByStatement.constFind(statement);
+    if (it != m_entriesByStatement.constEnd()) {
+        const auto entry = it.value();
+        if (!entry->query.isActive()) {
+            m_entries.splice(m_entries.begin(), m_entries, entry);
+            return entry->query;
+        }
+        // Still in use
+        QSqlQuery query(m_database);
+        query.prepare(statement);
+        return query;
+    }
+
+    QSqlQuery query(m_database);
+    if (!query.prepare(statement)) {
+        return query;
+    }
+    m_entries.push_front(Entry{statement, query});
+    m_entriesByStatement.insert(statement, m_entries.begin());
+    evictExceedingEntries();
+    return query;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <list>
+
+// A least recently used cache of prepared statements for a single
+// database connection. Parsing and planning a statement takes longer
+// than executing most of the simple statements of the DAOs.
+//
+// The returned queries are implicitly shared with the cache. They must
+// be finished after use, e.g. by SqlQueryFinisher, to become available
+// again. A statement that is still active, e.g. when it is executed
+// recursively, is prepared into a separate query.
+class SqlStatementCache final {
+  public:
+    static constexpr int kDefaultCapacity = 64;
+
+    explicit SqlStatementCache(int capacity = kDefaultCapacity);
+
+    // Drops all cached statements of the previous connection
+    void setDatabase(const QSqlDatabase& database);
+
+    // Evicts the least recently used statements that exceed the new
+    // capacity. A capacity of 0 disables caching.
+    void setCapacity(int capacity);
+
+    // Returns the prepared query. If preparing fails the query is
+    // returned anyway, but not cached. Executing it reports the error.
+    QSqlQuery prepare(const QString& statement);
+
+    void clear();
+
+    int size() const {
+        return static_cast<int>(m_entries.size());
+    }
+
+  private:
+    void evictExceedingEntries();
+
+    struct Entry {
+        QString statement;
+        QSqlQuery query;
+    };
+    typedef std::list<Entry> Entries;
+
+    QSqlDatabase m_database;
+    int m_capacity;
+
+    // Most recently used first
+    Entries m_entries;
+    QHash<QString, Entries::iterator> m_entriesByStatement;
+};
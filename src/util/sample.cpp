@@ -3,6 +3,7 @@
 
 #include "util/sample.h"
 #include "util/math.h"
+#include "util/sample_simd.h"
 
 #ifdef __WINDOWS__
 #include <QtGlobal>
@@ -18,6 +19,10 @@ typedef qint32 int32_t;
 // using scons optimize=native.
 // "SINT i" is the preferred loop index type that should allow vectorization in
 // general. Unfortunately there are exceptions where "int i" is required for some reasons.
+//
+// The hottest loops used for mixing are dispatched at runtime to kernels
+// compiled for the best instruction set of the running CPU, see
+// util/sample_simd.h. Their generic variants are the reference implementation.
 
 namespace {
 
@@ -140,13 +145,8 @@ void SampleUtil::applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            // a loop counter i += 2 prevents vectorizing.
-            pBuffer[i * 2] *= gain;
-            pBuffer[i * 2 + 1] *= gain;
-        }
+        mixxx::sample_simd::activeKernels().applyRampingGain(
+                pBuffer, start_gain, gain_delta, numSamples);
     } else {
         // note: LOOP VECTORIZED.
         for (int i = 0; i < numSamples; ++i) {
@@ -249,12 +249,8 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
+        mixxx::sample_simd::activeKernels().addWithRampingGain(
+                pDest, pSrc, start_gain, gain_delta, numSamples);
     } else {
         // note: LOOP VECTORIZED.
         for (int i = 0; i < numSamples; ++i) {
@@ -276,10 +272,8 @@ void SampleUtil::add2WithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
-    }
+    mixxx::sample_simd::activeKernels().add2WithGain(
+            pDest, pSrc1, gain1, pSrc2, gain2, numSamples);
 }
 
 // static
@@ -299,10 +293,8 @@ void SampleUtil::add3WithGain(CSAMPLE* pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
-    }
+    mixxx::sample_simd::activeKernels().add3WithGain(
+            pDest, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, numSamples);
 }
 
 // static
@@ -347,12 +339,8 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i" (not SINT i)
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
+        mixxx::sample_simd::activeKernels().copyWithRampingGain(
+                pDest, pSrc, start_gain, gain_delta, numSamples);
     } else {
         // note: LOOP VECTORIZED.
         for (SINT i = 0; i < numSamples; ++i) {
@@ -372,11 +360,8 @@ void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
     // is the highest valid sample. Note that this means that although some
     // sample values convert to -1.0, none will convert to +1.0.
     DEBUG_ASSERT(-SAMPLE_MINIMUM >= SAMPLE_MAXIMUM);
-    const CSAMPLE kConversionFactor = SAMPLE_MINIMUM * -1.0f;
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = CSAMPLE(pSrc[i]) / kConversionFactor;
-    }
+    mixxx::sample_simd::activeKernels().convertS16ToFloat32(
+            pDest, pSrc, numSamples);
 }
 
 //static
@@ -397,34 +382,25 @@ void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
-
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
+    const int clipped = mixxx::sample_simd::activeKernels().sumAbsPerChannel(
+            pfAbsL, pfAbsR, pBuffer, numSamples);
     SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
+    if (clipped & SampleUtil::CLIPPING_LEFT) {
         clipping |= SampleUtil::CLIPPING_LEFT;
     }
-    if (clippedR > 0) {
+    if (clipped & SampleUtil::CLIPPING_RIGHT) {
         clipping |= SampleUtil::CLIPPING_RIGHT;
     }
     return clipping;
 }
 
+// static
+void SampleUtil::maxAbsPerChannel(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR, const CSAMPLE* pBuffer, SINT numSamples) {
+    mixxx::sample_simd::activeKernels().maxAbsPerChannel(
+            pfMaxL, pfMaxR, pBuffer, numSamples);
+}
+
 // static
 void SampleUtil::copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
@@ -524,6 +500,18 @@ void SampleUtil::mixStereoToMono(CSAMPLE* pBuffer, SINT numSamples) {
     }
 }
 
+// static
+void SampleUtil::downmixStereoToMono(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames) {
+    const CSAMPLE_GAIN mixScale = CSAMPLE_GAIN_ONE
+            / (CSAMPLE_GAIN_ONE + CSAMPLE_GAIN_ONE);
+    // note: LOOP VECTORIZED
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[i] = (pSrc[i * 2] + pSrc[i * 2 + 1]) * mixScale;
+    }
+}
+
 // static
 void SampleUtil::doubleMonoToDualMono(CSAMPLE* pBuffer, SINT numFrames) {
     // backward loop
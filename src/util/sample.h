@@ -201,6 +201,11 @@ class SampleUtil {
     static CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
             const CSAMPLE* pBuffer, SINT numSamples);
 
+    // Raises pfMaxL to the maximum of the absolute values of l and pfMaxR
+    // to the maximum of the absolute values of r in pBuffer.
+    static void maxAbsPerChannel(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+            const CSAMPLE* pBuffer, SINT numSamples);
+
     // Copies every sample in pSrc to pDest, limiting the values in pDest
     // to the valid range of CSAMPLE. pDest and pSrc must not overlap.
     static void copyClampBuffer(CSAMPLE* pDest, const CSAMPLE* pSrc,
@@ -235,6 +240,12 @@ class SampleUtil {
     // In place version of the above.
     static void mixStereoToMono(CSAMPLE* pBuffer, SINT numSamples);
 
+    // Mix a stereo buffer down to a mono buffer with the same method.
+    // (numFrames * 2) samples will be read from pSrc
+    // (numFrames) samples will be written into pDest
+    static void downmixStereoToMono(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numFrames);
+
     // In-place doubles the mono samples in pBuffer to dual mono samples.
     // (numFrames) samples will be read from pBuffer
     // (numFrames * 2) samples will be written into pBuffer
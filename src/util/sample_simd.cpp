@@ -0,0 +1,198 @@
+#include "util/sample_simd.h"
+
+#include "util/logger.h"
+
+// The generic kernels are the reference implementation for all SIMD
+// variants. They are the former inner loops of SampleUtil and are
+// auto vectorized for the baseline instruction set of the build.
+// See the notes about "LOOP VECTORIZED" in sample.cpp.
+
+namespace mixxx {
+
+namespace sample_simd {
+
+namespace {
+
+const Logger kLogger("SampleSimd");
+
+void applyRampingGainGeneric(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        // a loop counter i += 2 prevents vectorizing.
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void addWithRampingGainGeneric(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void copyWithRampingGainGeneric(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED only with "int i" (not SINT i)
+    for (int i = 0; i < numSamples / 2; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void add2WithGainGeneric(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGainGeneric(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+int sumAbsPerChannelGeneric(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        // Replacing the code with a bool clipped will prevent vetorizing
+        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL > 0 ? 1 : 0) | (clippedR > 0 ? 2 : 0);
+}
+
+void maxAbsPerChannelGeneric(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    CSAMPLE fMaxL = *pfMaxL;
+    CSAMPLE fMaxR = *pfMaxR;
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples / 2; ++i) {
+        fMaxL = math_max(fMaxL, std::fabs(pBuffer[i * 2]));
+        fMaxR = math_max(fMaxR, std::fabs(pBuffer[i * 2 + 1]));
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+void convertS16ToFloat32Generic(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = SAMPLE_MINIMUM * -1.0f;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) / kConversionFactor;
+    }
+}
+
+constexpr Kernels kGenericKernels = {
+        applyRampingGainGeneric,
+        addWithRampingGainGeneric,
+        copyWithRampingGainGeneric,
+        add2WithGainGeneric,
+        add3WithGainGeneric,
+        sumAbsPerChannelGeneric,
+        maxAbsPerChannelGeneric,
+        convertS16ToFloat32Generic,
+};
+
+} // anonymous namespace
+
+const char* levelName(Level level) {
+    switch (level) {
+    case Level::Generic:
+        return "Generic";
+    case Level::SSE2:
+        return "SSE2";
+    case Level::AVX2:
+        return "AVX2";
+    case Level::AVX512:
+        return "AVX512";
+    case Level::NEON:
+        return "NEON";
+    }
+    return "Unknown";
+}
+
+const Kernels* genericKernels() {
+    return &kGenericKernels;
+}
+
+const Kernels* kernels(Level level) {
+    switch (level) {
+    case Level::Generic:
+        return genericKernels();
+    case Level::SSE2:
+    case Level::AVX2:
+    case Level::AVX512:
+        return x86Kernels(level);
+    case Level::NEON:
+        return neonKernels();
+    }
+    return nullptr;
+}
+
+Level detectedLevel() {
+    static const Level s_level = []() {
+        // Prefer the widest available instruction set
+        for (int i = kNumLevels - 1; i > 0; --i) {
+            const auto level = static_cast<Level>(i);
+            if (kernels(level)) {
+                kLogger.info() << "Using" << levelName(level) << "sample kernels";
+                return level;
+            }
+        }
+        kLogger.info() << "Using generic sample kernels";
+        return Level::Generic;
+    }();
+    return s_level;
+}
+
+} // namespace sample_simd
+
+} // namespace mixxx
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "util/platform.h"
+#include "util/types.h"
+
+// Runtime dispatched kernels for the hot loops of SampleUtil.
+//
+// We ship a single binary that is compiled for a conservative baseline
+// instruction set (SSE2 on x86-64). The kernels declared here are additionally
+// compiled for wider instruction sets and the best variant supported by the
+// CPU is picked once on first use via CPUID. The generic variant is the plain
+// C++ reference implementation that relies on auto vectorization.
+//
+// The kernels implement only the inner loops. All shortcuts for special gain
+// values (zero/one) are handled by the SampleUtil wrappers before dispatching.
+namespace mixxx {
+
+namespace sample_simd {
+
+enum class Level {
+    Generic = 0,
+    SSE2,
+    AVX2,
+    AVX512,
+    NEON,
+};
+
+constexpr int kNumLevels = static_cast<int>(Level::NEON) + 1;
+
+const char* levelName(Level level);
+
+struct Kernels {
+    // Multiplies the stereo frame i with (startGain + gainDelta * i).
+    // Only numSamples / 2 frames are processed.
+    void (*applyRampingGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numSamples);
+    // Adds the stereo frame i of pSrc multiplied with
+    // (startGain + gainDelta * i) to pDest.
+    void (*addWithRampingGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numSamples);
+    // Copies the stereo frame i of pSrc multiplied with
+    // (startGain + gainDelta * i) to pDest.
+    void (*copyWithRampingGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numSamples);
+    void (*add2WithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1,
+            CSAMPLE_GAIN gain1,
+            const CSAMPLE* pSrc2,
+            CSAMPLE_GAIN gain2,
+            SINT numSamples);
+    void (*add3WithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1,
+            CSAMPLE_GAIN gain1,
+            const CSAMPLE* pSrc2,
+            CSAMPLE_GAIN gain2,
+            const CSAMPLE* pSrc3,
+            CSAMPLE_GAIN gain3,
+            SINT numSamples);
+    // Returns the clipping flags as in SampleUtil::CLIP_STATUS
+    int (*sumAbsPerChannel)(CSAMPLE* pfAbsL,
+            CSAMPLE* pfAbsR,
+            const CSAMPLE* pBuffer,
+            SINT numSamples);
+    // Raises *pfMaxL and *pfMaxR to the maximum absolute value of the
+    // left and right channel
+    void (*maxAbsPerChannel)(CSAMPLE* pfMaxL,
+            CSAMPLE* pfMaxR,
+            const CSAMPLE* pBuffer,
+            SINT numSamples);
+    void (*convertS16ToFloat32)(CSAMPLE* pDest,
+            const SAMPLE* pSrc,
+            SINT numSamples);
+};
+
+/// Returns the kernels for the given level or nullptr if the level is either
+/// not compiled in or not supported by the CPU we are running on.
+const Kernels* kernels(Level level);
+
+/// The best level supported by this build and the running CPU.
+Level detectedLevel();
+
+/// The kernels used by SampleUtil. They are selected once on first use.
+inline const Kernels& activeKernels() {
+    static const Kernels* const s_pKernels = kernels(detectedLevel());
+    return *s_pKernels;
+}
+
+// Per instruction set tables, defined in the corresponding translation units.
+// They return nullptr if the instruction set is not available for the target
+// architecture.
+const Kernels* genericKernels();
+const Kernels* x86Kernels(Level level);
+const Kernels* neonKernels();
+
+} // namespace sample_simd
+
+} // namespace mixxx
@@ -0,0 +1,244 @@
+#include "util/sample_simd.h"
+
+// NEON is mandatory on AArch64 and optional on 32-bit ARM where it is
+// enabled with -mfpu=neon, see CMakeLists.txt.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIXXX_SAMPLE_SIMD_NEON
+#endif
+
+#ifdef MIXXX_SAMPLE_SIMD_NEON
+
+#include <arm_neon.h>
+
+// See sample_simd_x86.cpp for how the ramping gain kernels are vectorized.
+
+namespace mixxx {
+
+namespace sample_simd {
+
+namespace {
+
+inline float32x4_t initialFrameIndex() {
+    const float kIndex[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    return vld1q_f32(kIndex);
+}
+
+void applyRampingGainNeon(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const float32x4_t vStart = vdupq_n_f32(startGain);
+    const float32x4_t vStep = vdupq_n_f32(2.0f);
+    float32x4_t vIndex = initialFrameIndex();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t vGain = vaddq_f32(vStart, vmulq_n_f32(vIndex, gainDelta));
+        vst1q_f32(pBuffer + i * 2, vmulq_f32(vld1q_f32(pBuffer + i * 2), vGain));
+        vIndex = vaddq_f32(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void addWithRampingGainNeon(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const float32x4_t vStart = vdupq_n_f32(startGain);
+    const float32x4_t vStep = vdupq_n_f32(2.0f);
+    float32x4_t vIndex = initialFrameIndex();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t vGain = vaddq_f32(vStart, vmulq_n_f32(vIndex, gainDelta));
+        const float32x4_t vSrc = vmulq_f32(vld1q_f32(pSrc + i * 2), vGain);
+        vst1q_f32(pDest + i * 2, vaddq_f32(vld1q_f32(pDest + i * 2), vSrc));
+        vIndex = vaddq_f32(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void copyWithRampingGainNeon(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const float32x4_t vStart = vdupq_n_f32(startGain);
+    const float32x4_t vStep = vdupq_n_f32(2.0f);
+    float32x4_t vIndex = initialFrameIndex();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t vGain = vaddq_f32(vStart, vmulq_n_f32(vIndex, gainDelta));
+        vst1q_f32(pDest + i * 2, vmulq_f32(vld1q_f32(pSrc + i * 2), vGain));
+        vIndex = vaddq_f32(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void add2WithGainNeon(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t vDest = vld1q_f32(pDest + i);
+        vDest = vmlaq_n_f32(vDest, vld1q_f32(pSrc1 + i), gain1);
+        vDest = vmlaq_n_f32(vDest, vld1q_f32(pSrc2 + i), gain2);
+        vst1q_f32(pDest + i, vDest);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t vDest = vld1q_f32(pDest + i);
+        vDest = vmlaq_n_f32(vDest, vld1q_f32(pSrc1 + i), gain1);
+        vDest = vmlaq_n_f32(vDest, vld1q_f32(pSrc2 + i), gain2);
+        vDest = vmlaq_n_f32(vDest, vld1q_f32(pSrc3 + i), gain3);
+        vst1q_f32(pDest + i, vDest);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+int sumAbsPerChannelNeon(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const float32x4_t vPeak = vdupq_n_f32(CSAMPLE_PEAK);
+    // Even lanes accumulate the left, odd lanes the right channel
+    float32x4_t vSum = vdupq_n_f32(0.0f);
+    uint32x4_t vClipped = vdupq_n_u32(0);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t vAbs = vabsq_f32(vld1q_f32(pBuffer + i * 2));
+        vSum = vaddq_f32(vSum, vAbs);
+        vClipped = vorrq_u32(vClipped, vcgtq_f32(vAbs, vPeak));
+    }
+    float sums[4];
+    vst1q_f32(sums, vSum);
+    uint32_t clipped[4];
+    vst1q_u32(clipped, vClipped);
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    bool clippedL = (clipped[0] | clipped[2]) != 0;
+    bool clippedR = (clipped[1] | clipped[3]) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL ? 1 : 0) | (clippedR ? 2 : 0);
+}
+
+void maxAbsPerChannelNeon(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    // Even lanes hold the left, odd lanes the right channel
+    const float initial[4] = {*pfMaxL, *pfMaxR, *pfMaxL, *pfMaxR};
+    float32x4_t vMax = vld1q_f32(initial);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        vMax = vmaxq_f32(vMax, vabsq_f32(vld1q_f32(pBuffer + i * 2)));
+    }
+    float maxima[4];
+    vst1q_f32(maxima, vMax);
+    CSAMPLE fMaxL = math_max(maxima[0], maxima[2]);
+    CSAMPLE fMaxR = math_max(maxima[1], maxima[3]);
+    for (; i < numFrames; ++i) {
+        fMaxL = math_max(fMaxL, std::fabs(pBuffer[i * 2]));
+        fMaxR = math_max(fMaxR, std::fabs(pBuffer[i * 2 + 1]));
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+void convertS16ToFloat32Neon(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    // Multiplying with the inverse power of two is exact
+    const CSAMPLE kConversionFactor = 1.0f / (SAMPLE_MINIMUM * -1.0f);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t vS16 = vld1q_s16(pSrc + i);
+        const float32x4_t vLo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(vS16)));
+        const float32x4_t vHi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(vS16)));
+        vst1q_f32(pDest + i, vmulq_n_f32(vLo, kConversionFactor));
+        vst1q_f32(pDest + i + 4, vmulq_n_f32(vHi, kConversionFactor));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) * kConversionFactor;
+    }
+}
+
+constexpr Kernels kNeonKernels = {
+        applyRampingGainNeon,
+        addWithRampingGainNeon,
+        copyWithRampingGainNeon,
+        add2WithGainNeon,
+        add3WithGainNeon,
+        sumAbsPerChannelNeon,
+        maxAbsPerChannelNeon,
+        convertS16ToFloat32Neon,
+};
+
+} // anonymous namespace
+
+const Kernels* neonKernels() {
+    return &kNeonKernels;
+}
+
+} // namespace sample_simd
+
+} // namespace mixxx
+
+#else // MIXXX_SAMPLE_SIMD_NEON
+
+namespace mixxx {
+
+namespace sample_simd {
+
+const Kernels* neonKernels() {
+    return nullptr;
+}
+
+} // namespace sample_simd
+
+} // namespace mixxx
+
+#endif // MIXXX_SAMPLE_SIMD_NEON
@@ -0,0 +1,797 @@
+#include "util/sample_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+        ((defined(__i386__) || defined(_M_IX86)) && defined(__SSE2__))
+#define MIXXX_SAMPLE_SIMD_X86
+#endif
+
+#ifdef MIXXX_SAMPLE_SIMD_X86
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC allows to use all intrinsics without changing the target architecture
+#define SIMD_TARGET(isa)
+#else
+// GCC and Clang compile the function for the given instruction set,
+// independent of the baseline architecture set by -march.
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// All loads and stores are unaligned, because the buffers passed to
+// SampleUtil are frequently offset into larger buffers. On all CPUs
+// supporting AVX, unaligned access to aligned memory is as fast as aligned
+// access.
+//
+// The ramping gain kernels process stereo frames. Each vector covers
+// (width / 2) frames and every gain value is duplicated for the left and
+// right channel. The gain is calculated as startGain + gainDelta * i with
+// exact integer frame indices held as float, just like the generic variant,
+// to avoid accumulating rounding errors over the buffer.
+
+namespace mixxx {
+
+namespace sample_simd {
+
+namespace {
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return false;
+    }
+    // The OS must save the YMM registers on context switches
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // Includes the check for OS support of the YMM registers
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuSupportsAvx512() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    if (!cpuSupportsAvx2()) {
+        return false;
+    }
+    // The OS must save the opmask and ZMM registers on context switches
+    if ((_xgetbv(0) & 0xe6) != 0xe6) {
+        return false;
+    }
+    int info[4];
+    __cpuidex(info, 7, 0);
+    const bool avx512f = (info[1] & (1 << 16)) != 0;
+    const bool avx512bw = (info[1] & (1 << 30)) != 0;
+    return avx512f && avx512bw;
+#else
+    // Includes the check for OS support of the ZMM registers
+    return __builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512bw");
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SSE2 (4 samples = 2 stereo frames per vector)
+/////////////////////////////////////////////////////////////////////////////
+
+SIMD_TARGET("sse2")
+void applyRampingGainSse2(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m128 vStart = _mm_set1_ps(startGain);
+    const __m128 vDelta = _mm_set1_ps(gainDelta);
+    const __m128 vStep = _mm_set1_ps(2.0f);
+    __m128 vIndex = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 vGain = _mm_add_ps(vStart, _mm_mul_ps(vDelta, vIndex));
+        _mm_storeu_ps(pBuffer + i * 2,
+                _mm_mul_ps(_mm_loadu_ps(pBuffer + i * 2), vGain));
+        vIndex = _mm_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+SIMD_TARGET("sse2")
+void addWithRampingGainSse2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m128 vStart = _mm_set1_ps(startGain);
+    const __m128 vDelta = _mm_set1_ps(gainDelta);
+    const __m128 vStep = _mm_set1_ps(2.0f);
+    __m128 vIndex = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 vGain = _mm_add_ps(vStart, _mm_mul_ps(vDelta, vIndex));
+        const __m128 vSrc = _mm_mul_ps(_mm_loadu_ps(pSrc + i * 2), vGain);
+        _mm_storeu_ps(pDest + i * 2,
+                _mm_add_ps(_mm_loadu_ps(pDest + i * 2), vSrc));
+        vIndex = _mm_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("sse2")
+void copyWithRampingGainSse2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m128 vStart = _mm_set1_ps(startGain);
+    const __m128 vDelta = _mm_set1_ps(gainDelta);
+    const __m128 vStep = _mm_set1_ps(2.0f);
+    __m128 vIndex = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 vGain = _mm_add_ps(vStart, _mm_mul_ps(vDelta, vIndex));
+        _mm_storeu_ps(pDest + i * 2,
+                _mm_mul_ps(_mm_loadu_ps(pSrc + i * 2), vGain));
+        vIndex = _mm_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("sse2")
+void add2WithGainSse2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    const __m128 vGain1 = _mm_set1_ps(gain1);
+    const __m128 vGain2 = _mm_set1_ps(gain2);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 vSum = _mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(pSrc1 + i), vGain1),
+                _mm_mul_ps(_mm_loadu_ps(pSrc2 + i), vGain2));
+        _mm_storeu_ps(pDest + i, _mm_add_ps(_mm_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+SIMD_TARGET("sse2")
+void add3WithGainSse2(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    const __m128 vGain1 = _mm_set1_ps(gain1);
+    const __m128 vGain2 = _mm_set1_ps(gain2);
+    const __m128 vGain3 = _mm_set1_ps(gain3);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 vSum = _mm_add_ps(
+                _mm_add_ps(
+                        _mm_mul_ps(_mm_loadu_ps(pSrc1 + i), vGain1),
+                        _mm_mul_ps(_mm_loadu_ps(pSrc2 + i), vGain2)),
+                _mm_mul_ps(_mm_loadu_ps(pSrc3 + i), vGain3));
+        _mm_storeu_ps(pDest + i, _mm_add_ps(_mm_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+SIMD_TARGET("sse2")
+int sumAbsPerChannelSse2(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    // Clear the sign bit for abs()
+    const __m128 vAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 vPeak = _mm_set1_ps(CSAMPLE_PEAK);
+    // Even lanes accumulate the left, odd lanes the right channel
+    __m128 vSum = _mm_setzero_ps();
+    __m128 vClipped = _mm_setzero_ps();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 vAbs = _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2), vAbsMask);
+        vSum = _mm_add_ps(vSum, vAbs);
+        vClipped = _mm_or_ps(vClipped, _mm_cmpgt_ps(vAbs, vPeak));
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, vSum);
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    const int clippedMask = _mm_movemask_ps(vClipped);
+    bool clippedL = (clippedMask & 0x5) != 0;
+    bool clippedR = (clippedMask & 0xa) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL ? 1 : 0) | (clippedR ? 2 : 0);
+}
+
+SIMD_TARGET("sse2")
+void maxAbsPerChannelSse2(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m128 vAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    // Even lanes hold the left, odd lanes the right channel
+    __m128 vMax = _mm_setr_ps(*pfMaxL, *pfMaxR, *pfMaxL, *pfMaxR);
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        vMax = _mm_max_ps(vMax, _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2), vAbsMask));
+    }
+    alignas(16) float maxima[4];
+    _mm_store_ps(maxima, vMax);
+    CSAMPLE fMaxL = math_max(maxima[0], maxima[2]);
+    CSAMPLE fMaxR = math_max(maxima[1], maxima[3]);
+    for (; i < numFrames; ++i) {
+        fMaxL = math_max(fMaxL, std::fabs(pBuffer[i * 2]));
+        fMaxR = math_max(fMaxR, std::fabs(pBuffer[i * 2 + 1]));
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+SIMD_TARGET("sse2")
+void convertS16ToFloat32Sse2(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    // Multiplying with the inverse power of two is exact
+    const CSAMPLE kConversionFactor = 1.0f / (SAMPLE_MINIMUM * -1.0f);
+    const __m128 vFactor = _mm_set1_ps(kConversionFactor);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i vS16 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc + i));
+        // Sign extend by unpacking into the upper half and shifting back
+        const __m128i vLo = _mm_srai_epi32(_mm_unpacklo_epi16(vS16, vS16), 16);
+        const __m128i vHi = _mm_srai_epi32(_mm_unpackhi_epi16(vS16, vS16), 16);
+        _mm_storeu_ps(pDest + i, _mm_mul_ps(_mm_cvtepi32_ps(vLo), vFactor));
+        _mm_storeu_ps(pDest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(vHi), vFactor));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) * kConversionFactor;
+    }
+}
+
+constexpr Kernels kSse2Kernels = {
+        applyRampingGainSse2,
+        addWithRampingGainSse2,
+        copyWithRampingGainSse2,
+        add2WithGainSse2,
+        add3WithGainSse2,
+        sumAbsPerChannelSse2,
+        maxAbsPerChannelSse2,
+        convertS16ToFloat32Sse2,
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AVX2 (8 samples = 4 stereo frames per vector)
+/////////////////////////////////////////////////////////////////////////////
+
+SIMD_TARGET("avx2")
+void applyRampingGainAvx2(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m256 vStart = _mm256_set1_ps(startGain);
+    const __m256 vDelta = _mm256_set1_ps(gainDelta);
+    const __m256 vStep = _mm256_set1_ps(4.0f);
+    __m256 vIndex = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 vGain = _mm256_add_ps(vStart, _mm256_mul_ps(vDelta, vIndex));
+        _mm256_storeu_ps(pBuffer + i * 2,
+                _mm256_mul_ps(_mm256_loadu_ps(pBuffer + i * 2), vGain));
+        vIndex = _mm256_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+SIMD_TARGET("avx2")
+void addWithRampingGainAvx2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m256 vStart = _mm256_set1_ps(startGain);
+    const __m256 vDelta = _mm256_set1_ps(gainDelta);
+    const __m256 vStep = _mm256_set1_ps(4.0f);
+    __m256 vIndex = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 vGain = _mm256_add_ps(vStart, _mm256_mul_ps(vDelta, vIndex));
+        const __m256 vSrc = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i * 2), vGain);
+        _mm256_storeu_ps(pDest + i * 2,
+                _mm256_add_ps(_mm256_loadu_ps(pDest + i * 2), vSrc));
+        vIndex = _mm256_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("avx2")
+void copyWithRampingGainAvx2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m256 vStart = _mm256_set1_ps(startGain);
+    const __m256 vDelta = _mm256_set1_ps(gainDelta);
+    const __m256 vStep = _mm256_set1_ps(4.0f);
+    __m256 vIndex = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 vGain = _mm256_add_ps(vStart, _mm256_mul_ps(vDelta, vIndex));
+        _mm256_storeu_ps(pDest + i * 2,
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc + i * 2), vGain));
+        vIndex = _mm256_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("avx2")
+void add2WithGainAvx2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    const __m256 vGain1 = _mm256_set1_ps(gain1);
+    const __m256 vGain2 = _mm256_set1_ps(gain2);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256 vSum = _mm256_add_ps(
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc1 + i), vGain1),
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc2 + i), vGain2));
+        _mm256_storeu_ps(pDest + i, _mm256_add_ps(_mm256_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+SIMD_TARGET("avx2")
+void add3WithGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    const __m256 vGain1 = _mm256_set1_ps(gain1);
+    const __m256 vGain2 = _mm256_set1_ps(gain2);
+    const __m256 vGain3 = _mm256_set1_ps(gain3);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256 vSum = _mm256_add_ps(
+                _mm256_add_ps(
+                        _mm256_mul_ps(_mm256_loadu_ps(pSrc1 + i), vGain1),
+                        _mm256_mul_ps(_mm256_loadu_ps(pSrc2 + i), vGain2)),
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc3 + i), vGain3));
+        _mm256_storeu_ps(pDest + i, _mm256_add_ps(_mm256_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+SIMD_TARGET("avx2")
+int sumAbsPerChannelAvx2(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m256 vAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 vPeak = _mm256_set1_ps(CSAMPLE_PEAK);
+    __m256 vSum = _mm256_setzero_ps();
+    __m256 vClipped = _mm256_setzero_ps();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 vAbs = _mm256_and_ps(_mm256_loadu_ps(pBuffer + i * 2), vAbsMask);
+        vSum = _mm256_add_ps(vSum, vAbs);
+        vClipped = _mm256_or_ps(vClipped, _mm256_cmp_ps(vAbs, vPeak, _CMP_GT_OQ));
+    }
+    alignas(32) float sums[8];
+    _mm256_store_ps(sums, vSum);
+    CSAMPLE fAbsL = (sums[0] + sums[2]) + (sums[4] + sums[6]);
+    CSAMPLE fAbsR = (sums[1] + sums[3]) + (sums[5] + sums[7]);
+    const int clippedMask = _mm256_movemask_ps(vClipped);
+    bool clippedL = (clippedMask & 0x55) != 0;
+    bool clippedR = (clippedMask & 0xaa) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL ? 1 : 0) | (clippedR ? 2 : 0);
+}
+
+SIMD_TARGET("avx2")
+void maxAbsPerChannelAvx2(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m256 vAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 vMax = _mm256_setr_ps(*pfMaxL, *pfMaxR, *pfMaxL, *pfMaxR,
+            *pfMaxL, *pfMaxR, *pfMaxL, *pfMaxR);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        vMax = _mm256_max_ps(vMax,
+                _mm256_and_ps(_mm256_loadu_ps(pBuffer + i * 2), vAbsMask));
+    }
+    alignas(32) float maxima[8];
+    _mm256_store_ps(maxima, vMax);
+    CSAMPLE fMaxL = math_max(math_max(maxima[0], maxima[2]), math_max(maxima[4], maxima[6]));
+    CSAMPLE fMaxR = math_max(math_max(maxima[1], maxima[3]), math_max(maxima[5], maxima[7]));
+    for (; i < numFrames; ++i) {
+        fMaxL = math_max(fMaxL, std::fabs(pBuffer[i * 2]));
+        fMaxR = math_max(fMaxR, std::fabs(pBuffer[i * 2 + 1]));
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+SIMD_TARGET("avx2")
+void convertS16ToFloat32Avx2(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = 1.0f / (SAMPLE_MINIMUM * -1.0f);
+    const __m256 vFactor = _mm256_set1_ps(kConversionFactor);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256i vS32 = _mm256_cvtepi16_epi32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc + i)));
+        _mm256_storeu_ps(pDest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(vS32), vFactor));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) * kConversionFactor;
+    }
+}
+
+constexpr Kernels kAvx2Kernels = {
+        applyRampingGainAvx2,
+        addWithRampingGainAvx2,
+        copyWithRampingGainAvx2,
+        add2WithGainAvx2,
+        add3WithGainAvx2,
+        sumAbsPerChannelAvx2,
+        maxAbsPerChannelAvx2,
+        convertS16ToFloat32Avx2,
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AVX-512 (16 samples = 8 stereo frames per vector)
+/////////////////////////////////////////////////////////////////////////////
+
+SIMD_TARGET("avx512f")
+void applyRampingGainAvx512(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m512 vStart = _mm512_set1_ps(startGain);
+    const __m512 vDelta = _mm512_set1_ps(gainDelta);
+    const __m512 vStep = _mm512_set1_ps(8.0f);
+    __m512 vIndex = _mm512_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f,
+            4.0f, 4.0f, 5.0f, 5.0f, 6.0f, 6.0f, 7.0f, 7.0f);
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m512 vGain = _mm512_add_ps(vStart, _mm512_mul_ps(vDelta, vIndex));
+        _mm512_storeu_ps(pBuffer + i * 2,
+                _mm512_mul_ps(_mm512_loadu_ps(pBuffer + i * 2), vGain));
+        vIndex = _mm512_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+SIMD_TARGET("avx512f")
+void addWithRampingGainAvx512(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m512 vStart = _mm512_set1_ps(startGain);
+    const __m512 vDelta = _mm512_set1_ps(gainDelta);
+    const __m512 vStep = _mm512_set1_ps(8.0f);
+    __m512 vIndex = _mm512_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f,
+            4.0f, 4.0f, 5.0f, 5.0f, 6.0f, 6.0f, 7.0f, 7.0f);
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m512 vGain = _mm512_add_ps(vStart, _mm512_mul_ps(vDelta, vIndex));
+        const __m512 vSrc = _mm512_mul_ps(_mm512_loadu_ps(pSrc + i * 2), vGain);
+        _mm512_storeu_ps(pDest + i * 2,
+                _mm512_add_ps(_mm512_loadu_ps(pDest + i * 2), vSrc));
+        vIndex = _mm512_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("avx512f")
+void copyWithRampingGainAvx512(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m512 vStart = _mm512_set1_ps(startGain);
+    const __m512 vDelta = _mm512_set1_ps(gainDelta);
+    const __m512 vStep = _mm512_set1_ps(8.0f);
+    __m512 vIndex = _mm512_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f,
+            4.0f, 4.0f, 5.0f, 5.0f, 6.0f, 6.0f, 7.0f, 7.0f);
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m512 vGain = _mm512_add_ps(vStart, _mm512_mul_ps(vDelta, vIndex));
+        _mm512_storeu_ps(pDest + i * 2,
+                _mm512_mul_ps(_mm512_loadu_ps(pSrc + i * 2), vGain));
+        vIndex = _mm512_add_ps(vIndex, vStep);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SIMD_TARGET("avx512f")
+void add2WithGainAvx512(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    const __m512 vGain1 = _mm512_set1_ps(gain1);
+    const __m512 vGain2 = _mm512_set1_ps(gain2);
+    SINT i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m512 vSum = _mm512_add_ps(
+                _mm512_mul_ps(_mm512_loadu_ps(pSrc1 + i), vGain1),
+                _mm512_mul_ps(_mm512_loadu_ps(pSrc2 + i), vGain2));
+        _mm512_storeu_ps(pDest + i, _mm512_add_ps(_mm512_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+SIMD_TARGET("avx512f")
+void add3WithGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    const __m512 vGain1 = _mm512_set1_ps(gain1);
+    const __m512 vGain2 = _mm512_set1_ps(gain2);
+    const __m512 vGain3 = _mm512_set1_ps(gain3);
+    SINT i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m512 vSum = _mm512_add_ps(
+                _mm512_add_ps(
+                        _mm512_mul_ps(_mm512_loadu_ps(pSrc1 + i), vGain1),
+                        _mm512_mul_ps(_mm512_loadu_ps(pSrc2 + i), vGain2)),
+                _mm512_mul_ps(_mm512_loadu_ps(pSrc3 + i), vGain3));
+        _mm512_storeu_ps(pDest + i, _mm512_add_ps(_mm512_loadu_ps(pDest + i), vSum));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+SIMD_TARGET("avx512f")
+int sumAbsPerChannelAvx512(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    const __m512 vPeak = _mm512_set1_ps(CSAMPLE_PEAK);
+    __m512 vSum = _mm512_setzero_ps();
+    __mmask16 clippedMask = 0;
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m512 vAbs = _mm512_abs_ps(_mm512_loadu_ps(pBuffer + i * 2));
+        vSum = _mm512_add_ps(vSum, vAbs);
+        clippedMask |= _mm512_cmp_ps_mask(vAbs, vPeak, _CMP_GT_OQ);
+    }
+    // Even lanes hold the left, odd lanes the right channel
+    alignas(64) float sums[16];
+    _mm512_store_ps(sums, vSum);
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    for (int lane = 0; lane < 16; lane += 2) {
+        fAbsL += sums[lane];
+        fAbsR += sums[lane + 1];
+    }
+    bool clippedL = (clippedMask & 0x5555) != 0;
+    bool clippedR = (clippedMask & 0xaaaa) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL ? 1 : 0) | (clippedR ? 2 : 0);
+}
+
+SIMD_TARGET("avx512f")
+void maxAbsPerChannelAvx512(CSAMPLE* pfMaxL,
+        CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    // Even lanes hold the left, odd lanes the right channel
+    __m512 vMax = _mm512_mask_blend_ps(0xaaaa,
+            _mm512_set1_ps(*pfMaxL),
+            _mm512_set1_ps(*pfMaxR));
+    SINT i = 0;
+    // The zero masked variant avoids the false -Wmaybe-uninitialized
+    // warning of GCC 12, see convertS16ToFloat32Avx512()
+    const __mmask16 kAllLanes = 0xffff;
+    for (; i + 8 <= numFrames; i += 8) {
+        vMax = _mm512_maskz_max_ps(kAllLanes,
+                vMax,
+                _mm512_abs_ps(_mm512_loadu_ps(pBuffer + i * 2)));
+    }
+    alignas(64) float maxima[16];
+    _mm512_store_ps(maxima, vMax);
+    CSAMPLE fMaxL = maxima[0];
+    CSAMPLE fMaxR = maxima[1];
+    for (int lane = 2; lane < 16; lane += 2) {
+        fMaxL = math_max(fMaxL, maxima[lane]);
+        fMaxR = math_max(fMaxR, maxima[lane + 1]);
+    }
+    for (; i < numFrames; ++i) {
+        fMaxL = math_max(fMaxL, std::fabs(pBuffer[i * 2]));
+        fMaxR = math_max(fMaxR, std::fabs(pBuffer[i * 2 + 1]));
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+void convertS16ToFloat32Avx512(CSAMPLE* M_RESTRICT pDest,
+        const SAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = 1.0f / (SAMPLE_MINIMUM * -1.0f);
+    const __m512 vFactor = _mm512_set1_ps(kConversionFactor);
+    SINT i = 0;
+    // The zero masked variants avoid false -Wmaybe-uninitialized warnings
+    // in the intrinsics headers of GCC 12, where the unmasked variants are
+    // implemented with an undefined pass through vector.
+    const __mmask16 kAllLanes = 0xffff;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m512i vS32 = _mm512_maskz_cvtepi16_epi32(kAllLanes,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i)));
+        _mm512_storeu_ps(pDest + i,
+                _mm512_mul_ps(_mm512_maskz_cvtepi32_ps(kAllLanes, vS32), vFactor));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) * kConversionFactor;
+    }
+}
+
+constexpr Kernels kAvx512Kernels = {
+        applyRampingGainAvx512,
+        addWithRampingGainAvx512,
+        copyWithRampingGainAvx512,
+        add2WithGainAvx512,
+        add3WithGainAvx512,
+        sumAbsPerChannelAvx512,
+        maxAbsPerChannelAvx512,
+        convertS16ToFloat32Avx512,
+};
+
+} // anonymous namespace
+
+const Kernels* x86Kernels(Level level) {
+    switch (level) {
+    case Level::SSE2:
+        // SSE2 is the baseline of all x86 builds, see CMakeLists.txt
+        return &kSse2Kernels;
+    case Level::AVX2: {
+        static const bool s_supported = cpuSupportsAvx2();
+        return s_supported ? &kAvx2Kernels : nullptr;
+    }
+    case Level::AVX512: {
+        static const bool s_supported = cpuSupportsAvx512();
+        return s_supported ? &kAvx512Kernels : nullptr;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace sample_simd
+
+} // namespace mixxx
+
+#else // MIXXX_SAMPLE_SIMD_X86
+
+namespace mixxx {
+
+namespace sample_simd {
+
+const Kernels* x86Kernels(Level /*level*/) {
+    return nullptr;
+}
+
+} // namespace sample_simd
+
+} // namespace mixxx
+
+#endif // MIXXX_SAMPLE_SIMD_X86
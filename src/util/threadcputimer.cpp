@@ -100,6 +100,43 @@ mixxx::Duration ThreadCpuTimer::restart()
     return mixxx::Duration::fromNanos(sec * Q_INT64_C(1000000000) + frac);
 }
 
+////////////////////////////// Windows //////////////////////////////
+#elif defined(Q_OS_WIN)
+
+// The user and kernel time of the thread in units of 100 ns
+static inline qint64 getThreadTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(),
+                &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    return static_cast<qint64>(kernel.QuadPart + user.QuadPart);
+}
+
+void ThreadCpuTimer::start()
+{
+    t1 = getThreadTime();
+    t2 = 0;
+}
+
+mixxx::Duration ThreadCpuTimer::elapsed() const
+{
+    return mixxx::Duration::fromNanos((getThreadTime() - t1) * 100);
+}
+
+mixxx::Duration ThreadCpuTimer::restart()
+{
+    const qint64 t = t1;
+    t1 = getThreadTime();
+    return mixxx::Duration::fromNanos((t1 - t) * 100);
+}
+
 ////////////////////////////// Default //////////////////////////////
 #else
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "util/class.h"
+
+/// A lock-free triple buffer that hands the latest value from a single
+/// writer thread to a single reader thread.
+///
+/// The writer fills the write buffer and publishes it, the reader consumes
+/// the latest published buffer. Neither side ever blocks or waits for the
+/// other one. Values that are published while the reader is still busy
+/// with a previous one are overwritten, i.e. the reader always gets the
+/// most recent value and skips outdated ones.
+///
+/// The buffers are reused, so a writer that fills containers in place
+/// doesn't allocate once they have grown to their working size.
+template<typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer()
+            : m_writeIndex(0),
+              m_readIndex(1),
+              m_middle(2) {
+    }
+
+    /// The buffer that is filled by the writer.
+    T& writeBuffer() {
+        return m_buffers[m_writeIndex];
+    }
+
+    /// Hands the write buffer over to the reader and continues with the
+    /// buffer that has been published before if it has not been consumed.
+    void publish() {
+        m_writeIndex = m_middle.exchange(
+                               m_writeIndex | kFreshBit, std::memory_order_acq_rel) &
+                kIndexMask;
+    }
+
+    /// Makes the latest published buffer the read buffer. Returns false if
+    /// nothing has been published since the last call, in which case the
+    /// read buffer is left untouched.
+    bool consume() {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFreshBit)) {
+            return false;
+        }
+        // Only the reader clears the fresh bit, so it is still set
+        m_readIndex = m_middle.exchange(
+                              m_readIndex, std::memory_order_acq_rel) &
+                kIndexMask;
+        return true;
+    }
+
+    /// The buffer that has been consumed last by the reader. Initially
+    /// default constructed.
+    const T& readBuffer() const {
+        return m_buffers[m_readIndex];
+    }
+    T& readBuffer() {
+        return m_buffers[m_readIndex];
+    }
+
+  private:
+    static constexpr int kIndexMask = 0x3;
+    static constexpr int kFreshBit = 0x4;
+
+    std::array<T, 3> m_buffers;
+
+    // Only accessed by the writer
+    int m_writeIndex;
+    // Only accessed by the reader
+    int m_readIndex;
+    // The index of the buffer in between that is exchanged by both
+    std::atomic<int> m_middle;
+
+    DISALLOW_COPY_AND_ASSIGN(TripleBuffer);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "util/alphabetafilter.h"
+
+// Smooths the time stamps at which the buffers of the audio callbacks reach
+// the DAC. The observed time stamps jitter with the scheduling of the audio
+// thread and the accuracy of the time info of the audio API, while the DAC
+// consumes the buffers in regular intervals. The filter tracks the phase
+// (position) and the buffer period (velocity) of the DAC clock.
+class DacClockFilter {
+  public:
+    DacClockFilter()
+            : m_observations(0),
+              m_jitterMicros(0.0) {
+    }
+
+    // Forgets the clock, e.g. after the audio device has been restarted.
+    void reset() {
+        m_observations = 0;
+        m_jitterMicros = 0.0;
+    }
+
+    // Adds the observation that the current buffer reaches the DAC
+    // intervalMicros after the previous one. Returns the correction that is
+    // added to the observed DAC time of the current buffer.
+    double observe(double intervalMicros) {
+        if (m_observations == 0) {
+            // The interval to the previous buffer is unknown
+            ++m_observations;
+            return 0.0;
+        }
+        if (m_observations == 1 ||
+                intervalMicros <= periodMicros() / kMaxPeriodFactor ||
+                intervalMicros >= periodMicros() * kMaxPeriodFactor) {
+            // Start over after xruns or when the buffer size has changed
+            m_filter.init(1.0, intervalMicros, kAlpha, kBeta);
+            m_observations = 2;
+            m_jitterMicros = 0.0;
+            return 0.0;
+        }
+        ++m_observations;
+        m_jitterMicros = intervalMicros -
+                (m_filter.predictedPosition() + m_filter.predictedVelocity());
+        m_filter.observation(intervalMicros);
+        return m_filter.predictedPosition();
+    }
+
+    bool isValid() const {
+        return m_observations > 1;
+    }
+
+    // The filtered interval between two buffers
+    double periodMicros() const {
+        return m_filter.predictedVelocity();
+    }
+
+    // The difference between the observed and the predicted DAC time of the
+    // last buffer
+    double jitterMicros() const {
+        return m_jitterMicros;
+    }
+
+  private:
+    // Critically damped gains that settle after about 16 buffers
+    static constexpr double kAlpha = 1.0 / 8;
+    static constexpr double kBeta = kAlpha * kAlpha / (2.0 - kAlpha);
+    // Detects at least a doubled or halved buffer size
+    static constexpr double kMaxPeriodFactor = 1.5;
+
+    AlphaBetaFilter m_filter;
+    int m_observations;
+    double m_jitterMicros;
+};
@@ -2,6 +2,7 @@
 
 #include "waveform/guitick.h"
 #include "control/controlobject.h"
+#include "control/controlslot.h"
 
 GuiTick::GuiTick() {
     m_pCOGuiTickTime = std::make_unique<ControlObject>(ConfigKey("[Master]", "guiTickTime"));
@@ -12,6 +13,10 @@ GuiTick::GuiTick() {
 // this is called from WaveformWidgetFactory::render in the main thread with the
 // configured waveform frame rate
 void GuiTick::process() {
+    // Batched notifications for all values that have been
+    // set by slot since the last tick
+    ControlSlot::flushNotifications();
+
     m_cpuTimeLastTick += m_cpuTimer.restart();
     double cpuTimeLastTickSeconds = m_cpuTimeLastTick.toDoubleSeconds();
     m_pCOGuiTickTime->set(cpuTimeLastTickSeconds);
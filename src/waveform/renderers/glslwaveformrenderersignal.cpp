@@ -115,13 +115,21 @@ bool GLSLWaveformRendererSignal::loadTexture() {
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
     if (waveform != nullptr && data != nullptr) {
-        // Waveform ensures that getTextureSize is a multiple of
-        // getTextureStride so there is no rounding here.
+        // The shaders expect a square texture. Waveform ensures that
+        // getTextureSize is a multiple of getTextureStride so there is no
+        // rounding here. Mapped waveforms are only padded to full rows.
         int textureWidth = waveform->getTextureStride();
         int textureHeight = waveform->getTextureSize() / waveform->getTextureStride();
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
+        if (textureHeight == textureWidth) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, data);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureWidth, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, textureHeight,
+                            GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
         int error = glGetError();
         if (error) {
             qDebug() << "GLSLWaveformRendererSignal::loadTexture - glTexImage2D error" << error;
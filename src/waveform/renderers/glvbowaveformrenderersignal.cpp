@@ -0,0 +1,110 @@
+#include "waveform/renderers/glvbowaveformrenderersignal.h"
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+
+#include "track/track.h"
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/waveform.h"
+
+GLVBOWaveformRendererSignal::GLVBOWaveformRendererSignal(
+        WaveformWidgetRenderer* waveformWidgetRenderer,
+        ColorType colorType)
+        : WaveformRendererSignalBase(waveformWidgetRenderer),
+          m_colorType(colorType),
+          m_vertexBufferValid(false) {
+}
+
+GLVBOWaveformRendererSignal::~GLVBOWaveformRendererSignal() {
+}
+
+void GLVBOWaveformRendererSignal::onSetup(const QDomNode& /*node*/) {
+}
+
+void GLVBOWaveformRendererSignal::onInitializeGL() {
+    GLWaveformRenderer::onInitializeGL();
+    m_vertexBufferValid = m_vertexBuffer.initialize();
+}
+
+void GLVBOWaveformRendererSignal::draw(QPainter* painter, QPaintEvent* /*event*/) {
+    maybeInitializeGL();
+    if (!m_vertexBufferValid) {
+        return;
+    }
+
+    TrackPointer pTrack = m_waveformRenderer->getTrackInfo();
+    ConstWaveformPointer pWaveform;
+    if (pTrack) {
+        pWaveform = pTrack->getWaveform();
+    }
+    // Only upload the whole waveform if it has been replaced, e.g. after
+    // loading a track or when the analysis has started
+    if (pWaveform != m_vertexBuffer.getWaveform()) {
+        m_vertexBuffer.setWaveform(pWaveform);
+    }
+    if (!pWaveform || pWaveform->getDataSize() <= 1) {
+        return;
+    }
+    // Upload the visual samples that have been analyzed since the last frame
+    m_vertexBuffer.update();
+
+    GLWaveformVertexBuffer::DrawParameters parameters;
+    parameters.firstVisualIndex =
+            m_waveformRenderer->getFirstDisplayedPosition() * pWaveform->getDataSize();
+    parameters.lastVisualIndex =
+            m_waveformRenderer->getLastDisplayedPosition() * pWaveform->getDataSize();
+    parameters.visualSamplePerPixel = m_waveformRenderer->getVisualSamplePerPixel();
+    getGains(&parameters.allGain,
+            &parameters.lowGain,
+            &parameters.midGain,
+            &parameters.highGain);
+    parameters.alignment = m_alignment;
+    parameters.orientation = m_orientation;
+    parameters.axesColor = QVector4D(
+            static_cast<float>(m_axesColor_r),
+            static_cast<float>(m_axesColor_g),
+            static_cast<float>(m_axesColor_b),
+            static_cast<float>(m_axesColor_a));
+    parameters.signalColor = QVector4D(
+            static_cast<float>(m_signalColor_r),
+            static_cast<float>(m_signalColor_g),
+            static_cast<float>(m_signalColor_b),
+            1.0f);
+    if (m_colorType == ColorType::RGB) {
+        parameters.lowColor = QVector4D(
+                static_cast<float>(m_rgbLowColor_r),
+                static_cast<float>(m_rgbLowColor_g),
+                static_cast<float>(m_rgbLowColor_b),
+                1.0f);
+        parameters.midColor = QVector4D(
+                static_cast<float>(m_rgbMidColor_r),
+                static_cast<float>(m_rgbMidColor_g),
+                static_cast<float>(m_rgbMidColor_b),
+                1.0f);
+        parameters.highColor = QVector4D(
+                static_cast<float>(m_rgbHighColor_r),
+                static_cast<float>(m_rgbHighColor_g),
+                static_cast<float>(m_rgbHighColor_b),
+                1.0f);
+    } else {
+        parameters.lowColor = QVector4D(
+                static_cast<float>(m_lowColor_r),
+                static_cast<float>(m_lowColor_g),
+                static_cast<float>(m_lowColor_b),
+                1.0f);
+        parameters.midColor = QVector4D(
+                static_cast<float>(m_midColor_r),
+                static_cast<float>(m_midColor_g),
+                static_cast<float>(m_midColor_b),
+                1.0f);
+        parameters.highColor = QVector4D(
+                static_cast<float>(m_highColor_r),
+                static_cast<float>(m_highColor_g),
+                static_cast<float>(m_highColor_b),
+                1.0f);
+    }
+
+    painter->beginNativePainting();
+    m_vertexBuffer.draw(m_colorType, parameters);
+    painter->endNativePainting();
+}
+
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "waveform/renderers/glwaveformrenderer.h"
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+
+#include "util/class.h"
+#include "waveform/renderers/glwaveformvertexbuffer.h"
+#include "waveform/renderers/waveformrenderersignalbase.h"
+
+/// Draws the waveform from a GLWaveformVertexBuffer that is uploaded
+/// once per track instead of submitting all visible vertices for each
+/// frame like the GLWaveformRenderer* classes.
+class GLVBOWaveformRendererSignal : public WaveformRendererSignalBase,
+                                    public GLWaveformRenderer {
+  public:
+    typedef GLWaveformVertexBuffer::ColorType ColorType;
+
+    GLVBOWaveformRendererSignal(
+            WaveformWidgetRenderer* waveformWidgetRenderer,
+            ColorType colorType);
+    ~GLVBOWaveformRendererSignal() override;
+
+    void onSetup(const QDomNode& node) override;
+    void onInitializeGL() override;
+    void draw(QPainter* painter, QPaintEvent* event) override;
+
+  private:
+    const ColorType m_colorType;
+    GLWaveformVertexBuffer m_vertexBuffer;
+    bool m_vertexBufferValid;
+
+    DISALLOW_COPY_AND_ASSIGN(GLVBOWaveformRendererSignal);
+};
+
+class GLVBOWaveformRendererSimpleSignal : public GLVBOWaveformRendererSignal {
+  public:
+    explicit GLVBOWaveformRendererSimpleSignal(
+            WaveformWidgetRenderer* waveformWidgetRenderer)
+            : GLVBOWaveformRendererSignal(waveformWidgetRenderer, ColorType::Simple) {
+    }
+};
+
+class GLVBOWaveformRendererFilteredSignal : public GLVBOWaveformRendererSignal {
+  public:
+    explicit GLVBOWaveformRendererFilteredSignal(
+            WaveformWidgetRenderer* waveformWidgetRenderer)
+            : GLVBOWaveformRendererSignal(waveformWidgetRenderer, ColorType::Filtered) {
+    }
+};
+
+class GLVBOWaveformRendererRGBSignal : public GLVBOWaveformRendererSignal {
+  public:
+    explicit GLVBOWaveformRendererRGBSignal(
+            WaveformWidgetRenderer* waveformWidgetRenderer)
+            : GLVBOWaveformRendererSignal(waveformWidgetRenderer, ColorType::RGB) {
+    }
+};
+
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
@@ -37,22 +37,30 @@ void GLWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(
+            m_waveformRenderer->getVisualSamplePerPixel());
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
     if (dataSize <= 1) {
         return;
     }
 
-    const WaveformData* data = waveform->data();
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
     if (data == nullptr) {
         return;
     }
 
+    // The displayed positions are relative to the full resolution data
+    const double visualIndexCount =
+            static_cast<double>(waveform->getDataSize()) / (1 << pyramidLevel);
+
     auto firstVisualIndex = static_cast<GLfloat>(
-            m_waveformRenderer->getFirstDisplayedPosition() * dataSize);
+            m_waveformRenderer->getFirstDisplayedPosition() * visualIndexCount);
     auto lastVisualIndex = static_cast<GLfloat>(
-            m_waveformRenderer->getLastDisplayedPosition() * dataSize);
+            m_waveformRenderer->getLastDisplayedPosition() * visualIndexCount);
     const auto lineWidth = static_cast<GLfloat>(
-            1.0 / m_waveformRenderer->getVisualSamplePerPixel() + 1);
+            (1 << pyramidLevel) / m_waveformRenderer->getVisualSamplePerPixel() + 1);
 
     const auto firstIndex = static_cast<int>(firstVisualIndex + 0.5);
     firstVisualIndex = firstIndex - firstIndex%2;
@@ -0,0 +1,271 @@
+#include "waveform/renderers/glwaveformvertexbuffer.h"
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+
+#include <QOpenGLShaderProgram>
+#include <cmath>
+#include <cstddef>
+
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("GLWaveformVertexBuffer");
+
+// The peaks of the left and the right channel, each with its origin
+constexpr int kVerticesPerFrame = 4;
+// The axis is stored in front of the pyramid levels
+constexpr int kAxisVertexCount = 2;
+
+constexpr int kChannelCount = 2;
+
+// Values of the mode uniform in vbosignal.vert
+constexpr int kModeBand = 0;
+constexpr int kModeRGB = 1;
+constexpr int kModeAxis = 2;
+
+int toAlignmentUniform(Qt::Alignment alignment) {
+    if (alignment == Qt::AlignBottom || alignment == Qt::AlignRight) {
+        return 1;
+    } else if (alignment == Qt::AlignTop || alignment == Qt::AlignLeft) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+QVector4D withAlpha(QVector4D color, float alpha) {
+    color.setW(alpha);
+    return color;
+}
+
+} // anonymous namespace
+
+GLWaveformVertexBuffer::GLWaveformVertexBuffer()
+        : m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
+          m_frameLocation(-1),
+          m_sideLocation(-1),
+          m_valueLocation(-1),
+          m_uploadedCompletion(0) {
+    static_assert(sizeof(Vertex) == 3 * 4, "Unexpected padding of vertices");
+}
+
+GLWaveformVertexBuffer::~GLWaveformVertexBuffer() {
+    m_vertexBuffer.destroy();
+}
+
+bool GLWaveformVertexBuffer::initialize() {
+    initializeOpenGLFunctions();
+
+    m_pShaderProgram = std::make_unique<QOpenGLShaderProgram>();
+    if (!m_pShaderProgram->addShaderFromSourceFile(
+                QOpenGLShader::Vertex, ":/shaders/vbosignal.vert") ||
+            !m_pShaderProgram->addShaderFromSourceFile(
+                    QOpenGLShader::Fragment, ":/shaders/vbosignal.frag") ||
+            !m_pShaderProgram->link()) {
+        kLogger.warning()
+                << "Failed to build shaders:"
+                << m_pShaderProgram->log();
+        m_pShaderProgram.reset();
+        return false;
+    }
+    m_frameLocation = m_pShaderProgram->attributeLocation("frame");
+    m_sideLocation = m_pShaderProgram->attributeLocation("side");
+    m_valueLocation = m_pShaderProgram->attributeLocation("value");
+
+    if (!m_vertexBuffer.isCreated()) {
+        m_vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        if (!m_vertexBuffer.create()) {
+            kLogger.warning() << "Failed to create vertex buffer";
+            m_pShaderProgram.reset();
+            return false;
+        }
+    }
+
+    // Upload the current waveform again into the new context
+    ConstWaveformPointer pWaveform = std::move(m_pWaveform);
+    setWaveform(std::move(pWaveform));
+    return true;
+}
+
+int GLWaveformVertexBuffer::levelFrameCount(int level) const {
+    return m_pWaveform->getPyramidDataSize(level) / kChannelCount;
+}
+
+void GLWaveformVertexBuffer::setWaveform(ConstWaveformPointer pWaveform) {
+    m_pWaveform = std::move(pWaveform);
+    m_levelFirstVertex.clear();
+    m_uploadedCompletion = 0;
+    if (!m_pShaderProgram) {
+        // Not initialized yet
+        return;
+    }
+
+    int vertexCount = kAxisVertexCount;
+    if (m_pWaveform) {
+        for (int level = 0; level < m_pWaveform->getPyramidLevelCount(); ++level) {
+            m_levelFirstVertex.push_back(vertexCount);
+            vertexCount += levelFrameCount(level) * kVerticesPerFrame;
+        }
+    }
+
+    m_vertexBuffer.bind();
+    // The size of the levels is fixed, only their content is updated later
+    m_vertexBuffer.allocate(vertexCount * static_cast<int>(sizeof(Vertex)));
+    const Vertex axis[kAxisVertexCount] = {
+            {0.0f, 0.0f, WaveformData(0)},
+            {1.0f, 0.0f, WaveformData(0)},
+    };
+    m_vertexBuffer.write(0, axis, sizeof(axis));
+    m_vertexBuffer.release();
+
+    update();
+}
+
+void GLWaveformVertexBuffer::update() {
+    if (!m_pWaveform || m_levelFirstVertex.empty()) {
+        return;
+    }
+    // The pyramid is updated before the completion
+    const int completion = math_min(
+            m_pWaveform->getCompletion(), m_pWaveform->getDataSize());
+    if (completion <= m_uploadedCompletion) {
+        return;
+    }
+    m_vertexBuffer.bind();
+    for (int level = 0; level < m_pWaveform->getPyramidLevelCount(); ++level) {
+        const int frameStride = 1 << level;
+        // The last frame of a coarser level might have been incomplete
+        const int firstFrame = m_uploadedCompletion / kChannelCount / frameStride;
+        const int endFrame = math_min(
+                (completion / kChannelCount + frameStride - 1) / frameStride,
+                levelFrameCount(level));
+        uploadFrames(level, firstFrame, endFrame);
+    }
+    m_vertexBuffer.release();
+    m_uploadedCompletion = completion;
+}
+
+void GLWaveformVertexBuffer::uploadFrames(int level, int firstFrame, int endFrame) {
+    if (firstFrame >= endFrame) {
+        return;
+    }
+    const WaveformData* data = m_pWaveform->getPyramidData(level);
+    m_vertices.resize((endFrame - firstFrame) * kVerticesPerFrame);
+    Vertex* pVertex = m_vertices.data();
+    for (int frame = firstFrame; frame < endFrame; ++frame) {
+        const auto x = static_cast<GLfloat>(frame);
+        const WaveformData& left = data[frame * kChannelCount];
+        const WaveformData& right = data[frame * kChannelCount + 1];
+        *pVertex++ = {x, 0.0f, left};
+        *pVertex++ = {x, 1.0f, left};
+        *pVertex++ = {x, 0.0f, right};
+        *pVertex++ = {x, -1.0f, right};
+    }
+    const int firstVertex = m_levelFirstVertex[level] + firstFrame * kVerticesPerFrame;
+    m_vertexBuffer.write(firstVertex * static_cast<int>(sizeof(Vertex)),
+            m_vertices.data(),
+            static_cast<int>(m_vertices.size() * sizeof(Vertex)));
+}
+
+void GLWaveformVertexBuffer::draw(ColorType colorType, const DrawParameters& parameters) {
+    if (!m_pShaderProgram || !m_pWaveform || m_levelFirstVertex.empty()) {
+        return;
+    }
+    const int level = m_pWaveform->getPyramidLevel(parameters.visualSamplePerPixel);
+    const int frameStride = 1 << level;
+    const double firstFrame = parameters.firstVisualIndex / kChannelCount / frameStride;
+    const double lastFrame = parameters.lastVisualIndex / kChannelCount / frameStride;
+    if (lastFrame <= firstFrame) {
+        return;
+    }
+    const int frameCount = levelFrameCount(level);
+    const int firstDrawnFrame = math_clamp(
+            static_cast<int>(std::floor(firstFrame)), 0, frameCount);
+    const int endDrawnFrame = math_clamp(
+            static_cast<int>(std::ceil(lastFrame)) + 1, 0, frameCount);
+    const int firstVertex = m_levelFirstVertex[level] + firstDrawnFrame * kVerticesPerFrame;
+    const int vertexCount = (endDrawnFrame - firstDrawnFrame) * kVerticesPerFrame;
+
+    m_pShaderProgram->bind();
+    m_vertexBuffer.bind();
+    glEnableVertexAttribArray(m_frameLocation);
+    glVertexAttribPointer(m_frameLocation, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+            reinterpret_cast<const void*>(offsetof(Vertex, frame)));
+    glEnableVertexAttribArray(m_sideLocation);
+    glVertexAttribPointer(m_sideLocation, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+            reinterpret_cast<const void*>(offsetof(Vertex, side)));
+    // The values are normalized from [0, 255] to [0, 1]
+    glEnableVertexAttribArray(m_valueLocation);
+    glVertexAttribPointer(m_valueLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+            reinterpret_cast<const void*>(offsetof(Vertex, value)));
+
+    const int alignment = toAlignmentUniform(parameters.alignment);
+    m_pShaderProgram->setUniformValue("firstFrame", static_cast<GLfloat>(firstFrame));
+    m_pShaderProgram->setUniformValue("lastFrame", static_cast<GLfloat>(lastFrame));
+    m_pShaderProgram->setUniformValue("alignment", alignment);
+    m_pShaderProgram->setUniformValue("vertical",
+            static_cast<GLint>(parameters.orientation == Qt::Vertical));
+    m_pShaderProgram->setUniformValue("allGain", parameters.allGain);
+    m_pShaderProgram->setUniformValue("lowGain", parameters.lowGain);
+    m_pShaderProgram->setUniformValue("midGain", parameters.midGain);
+    m_pShaderProgram->setUniformValue("highGain", parameters.highGain);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (alignment == 0) {
+        m_pShaderProgram->setUniformValue("mode", kModeAxis);
+        m_pShaderProgram->setUniformValue("bandColor", parameters.axesColor);
+        glLineWidth(1.0f);
+        glDisable(GL_LINE_SMOOTH);
+        glDrawArrays(GL_LINES, 0, kAxisVertexCount);
+    }
+
+    // Each line covers the width of its visual frame
+    glLineWidth(static_cast<GLfloat>(
+            frameStride / parameters.visualSamplePerPixel + 1.0));
+    glEnable(GL_LINE_SMOOTH);
+
+    switch (colorType) {
+    case ColorType::Simple:
+        m_pShaderProgram->setUniformValue("mode", kModeBand);
+        m_pShaderProgram->setUniformValue("bandMask", QVector4D(0, 0, 0, 1));
+        m_pShaderProgram->setUniformValue("bandColor",
+                withAlpha(parameters.signalColor, alignment == 0 ? 0.9f : 0.8f));
+        glDrawArrays(GL_LINES, firstVertex, vertexCount);
+        break;
+    case ColorType::Filtered:
+        m_pShaderProgram->setUniformValue("mode", kModeBand);
+        m_pShaderProgram->setUniformValue("bandMask", QVector4D(1, 0, 0, 0));
+        m_pShaderProgram->setUniformValue("bandColor",
+                withAlpha(parameters.lowColor, 0.8f));
+        glDrawArrays(GL_LINES, firstVertex, vertexCount);
+        m_pShaderProgram->setUniformValue("bandMask", QVector4D(0, 1, 0, 0));
+        m_pShaderProgram->setUniformValue("bandColor",
+                withAlpha(parameters.midColor, 0.85f));
+        glDrawArrays(GL_LINES, firstVertex, vertexCount);
+        m_pShaderProgram->setUniformValue("bandMask", QVector4D(0, 0, 1, 0));
+        m_pShaderProgram->setUniformValue("bandColor",
+                withAlpha(parameters.highColor, 0.9f));
+        glDrawArrays(GL_LINES, firstVertex, vertexCount);
+        break;
+    case ColorType::RGB:
+        m_pShaderProgram->setUniformValue("mode", kModeRGB);
+        m_pShaderProgram->setUniformValue("lowColor", parameters.lowColor);
+        m_pShaderProgram->setUniformValue("midColor", parameters.midColor);
+        m_pShaderProgram->setUniformValue("highColor", parameters.highColor);
+        m_pShaderProgram->setUniformValue("bandColor",
+                QVector4D(0, 0, 0, alignment == 0 ? 0.8f : 0.9f));
+        glDrawArrays(GL_LINES, firstVertex, vertexCount);
+        break;
+    }
+
+    glDisableVertexAttribArray(m_valueLocation);
+    glDisableVertexAttribArray(m_sideLocation);
+    glDisableVertexAttribArray(m_frameLocation);
+    m_vertexBuffer.release();
+    m_pShaderProgram->release();
+}
+
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "waveform/renderers/glwaveformrenderer.h"
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+
+#include <QOpenGLBuffer>
+#include <QVector4D>
+#include <memory>
+#include <vector>
+
+#include "waveform/waveform.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+/// Retained mode drawing of a waveform signal.
+///
+/// All levels of the waveform pyramid are uploaded once into a vertex buffer
+/// object. While the track is analyzed only the newly completed visual samples
+/// are uploaded. Drawing a frame only sets the uniforms for the displayed
+/// range, gains and colors and then draws the displayed part of the level
+/// that matches the zoom with a single glDrawArrays() call per band. The
+/// vertex shader places the vertices and calculates their colors, so the
+/// CPU cost per frame doesn't depend on the number of visual samples.
+///
+/// All functions must be invoked while the OpenGL context is current.
+class GLWaveformVertexBuffer : protected QOpenGLFunctions_2_1 {
+  public:
+    enum class ColorType {
+        Simple,
+        Filtered,
+        RGB,
+    };
+
+    struct DrawParameters {
+        // The displayed range in full resolution visual indices
+        double firstVisualIndex = 0.0;
+        double lastVisualIndex = 0.0;
+        // See WaveformWidgetRenderer::getVisualSamplePerPixel()
+        double visualSamplePerPixel = 1.0;
+
+        float allGain = 1.0f;
+        float lowGain = 1.0f;
+        float midGain = 1.0f;
+        float highGain = 1.0f;
+
+        Qt::Alignment alignment = Qt::AlignCenter;
+        Qt::Orientation orientation = Qt::Horizontal;
+
+        QVector4D axesColor;
+        // Only used by ColorType::Simple
+        QVector4D signalColor;
+        QVector4D lowColor;
+        QVector4D midColor;
+        QVector4D highColor;
+    };
+
+    GLWaveformVertexBuffer();
+    ~GLWaveformVertexBuffer();
+
+    /// Compiles the shaders and creates the buffer.
+    bool initialize();
+
+    const ConstWaveformPointer& getWaveform() const {
+        return m_pWaveform;
+    }
+    /// Replaces the uploaded waveform, which may be null.
+    void setWaveform(ConstWaveformPointer pWaveform);
+
+    /// Uploads the visual samples that have been completed since the
+    /// last update.
+    void update();
+
+    void draw(ColorType colorType, const DrawParameters& parameters);
+
+  private:
+    struct Vertex {
+        GLfloat frame;
+        GLfloat side;
+        WaveformData value;
+    };
+
+    int levelFrameCount(int level) const;
+    void uploadFrames(int level, int firstFrame, int endFrame);
+
+    std::unique_ptr<QOpenGLShaderProgram> m_pShaderProgram;
+    QOpenGLBuffer m_vertexBuffer;
+    int m_frameLocation;
+    int m_sideLocation;
+    int m_valueLocation;
+
+    ConstWaveformPointer m_pWaveform;
+    // The first vertex of each level of the pyramid in m_vertexBuffer
+    std::vector<int> m_levelFirstVertex;
+    // The completion of m_pWaveform that has been uploaded
+    int m_uploadedCompletion;
+    // Reused for uploading to avoid allocations while analyzing
+    std::vector<Vertex> m_vertices;
+};
+
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
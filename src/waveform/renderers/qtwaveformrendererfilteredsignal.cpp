@@ -107,18 +107,22 @@ int QtWaveformRendererFilteredSignal::buildPolygon() {
         return 0;
     }
 
-    const int dataSize = waveform->getDataSize();
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(
+            m_waveformRenderer->getVisualSamplePerPixel());
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
     if (dataSize <= 1) {
         return 0;
     }
 
-    const WaveformData* data = waveform->data();
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
     if (data == nullptr) {
         return 0;
     }
 
-    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
-    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * visualIndexCount;
+    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * visualIndexCount;
 
     m_polygon[0].clear();
     m_polygon[1].clear();
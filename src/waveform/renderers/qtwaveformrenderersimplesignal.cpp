@@ -49,16 +49,24 @@ void QtWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(
+            m_waveformRenderer->getVisualSamplePerPixel());
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
     if (dataSize <= 1) {
         return;
     }
 
-    const WaveformData* data = waveform->data();
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
     if (data == nullptr) {
         return;
     }
 
+    // The displayed positions are relative to the full resolution data
+    const double visualIndexCount =
+            static_cast<double>(waveform->getDataSize()) / (1 << pyramidLevel);
+
     PainterScope PainterScope(painter);
 
     painter->setRenderHint(QPainter::Antialiasing);
@@ -90,8 +98,8 @@ void QtWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         painter->drawLine(0,0,m_waveformRenderer->getLength(),0);
     }
 
-    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
-    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * visualIndexCount;
+    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * visualIndexCount;
     m_polygon.clear();
     m_polygon.reserve(2 * m_waveformRenderer->getLength() + 2);
     m_polygon.append(QPointF(0.0, 0.0));
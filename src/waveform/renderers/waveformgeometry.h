@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QLineF>
+#include <QRgb>
+#include <QVector>
+#include <cmath>
+#include <cstddef>
+
+#include "waveform/waveform.h"
+
+/// The state of a frame that determines the geometry of a waveform signal.
+/// It is copied to the geometry worker and must not refer to the widget.
+struct WaveformGeometryParams {
+    ConstWaveformPointer waveform;
+    int completion = 0;
+    double firstDisplayedPosition = 0.0;
+    double lastDisplayedPosition = 0.0;
+    double trackPixelCount = 0.0;
+    double visualSamplePerPixel = 1.0;
+    int length = 0;
+    /// The number of pixels that are generated beyond both ends of the
+    /// displayed length, so that the geometry can be reused for the
+    /// following frames by shifting it.
+    int guardPixels = 0;
+    Qt::Alignment alignment = Qt::AlignCenter;
+    float allGain = 1.0f;
+    float lowGain = 1.0f;
+    float midGain = 1.0f;
+    float highGain = 1.0f;
+    bool lowKilled = false;
+    bool midKilled = false;
+    bool highKilled = false;
+
+    /// The first pixel to generate, relative to the displayed length.
+    int firstPixel() const {
+        return -guardPixels;
+    }
+    /// The pixel after the last one to generate.
+    int endPixel() const {
+        return length + guardPixels;
+    }
+
+    /// Returns true if the geometry of both only differs by the displayed
+    /// range, the gains and the completion of the waveform. The breadth is
+    /// not part of the params, the lines are generated for a breadth of 1.
+    bool isSameLayout(const WaveformGeometryParams& other) const {
+        return waveform == other.waveform &&
+                trackPixelCount == other.trackPixelCount &&
+                visualSamplePerPixel == other.visualSamplePerPixel &&
+                alignment == other.alignment &&
+                lowKilled == other.lowKilled &&
+                midKilled == other.midKilled &&
+                highKilled == other.highKilled;
+    }
+
+    /// Returns true if both would result in the same geometry.
+    bool isSameFrame(const WaveformGeometryParams& other) const {
+        return waveform == other.waveform &&
+                completion == other.completion &&
+                firstDisplayedPosition == other.firstDisplayedPosition &&
+                lastDisplayedPosition == other.lastDisplayedPosition &&
+                trackPixelCount == other.trackPixelCount &&
+                visualSamplePerPixel == other.visualSamplePerPixel &&
+                length == other.length &&
+                guardPixels == other.guardPixels &&
+                alignment == other.alignment &&
+                allGain == other.allGain &&
+                lowGain == other.lowGain &&
+                midGain == other.midGain &&
+                highGain == other.highGain &&
+                lowKilled == other.lowKilled &&
+                midKilled == other.midKilled &&
+                highKilled == other.highKilled;
+    }
+};
+
+/// The lines of a waveform signal and their colors. Along the waveform the
+/// lines are in pixels, across it they are in units of the breadth, so that
+/// renderers of any breadth can draw them after scaling them. Consecutive
+/// lines of the same color are drawn in one batch.
+struct WaveformGeometry {
+    WaveformGeometryParams params;
+    qreal lineWidth = 1.0;
+    QVector<QLineF> lines;
+    /// The color of each line
+    QVector<QRgb> colors;
+
+    /// The memory allocated for the lines and colors in bytes
+    std::size_t memoryUsage() const {
+        return lines.capacity() * sizeof(QLineF) + colors.capacity() * sizeof(QRgb);
+    }
+
+    void clear() {
+        // Keeps the capacity
+        lines.resize(0);
+        colors.resize(0);
+    }
+
+    void addLine(qreal x1, qreal y1, qreal x2, qreal y2, QRgb color) {
+        lines.append(QLineF(x1, y1, x2, y2));
+        colors.append(color);
+    }
+
+    /// Returns the number of pixels the lines need to be shifted by to be
+    /// drawn for the given frame, or false if the geometry doesn't fit it.
+    /// The geometry fits if it covers the whole length of the frame after
+    /// shifting it, so it can also be drawn by shorter renderers.
+    bool shiftFor(const WaveformGeometryParams& frame, int* pShift) const {
+        if (!params.isSameLayout(frame)) {
+            return false;
+        }
+        const int shift = static_cast<int>(std::round(
+                (params.firstDisplayedPosition - frame.firstDisplayedPosition) *
+                frame.trackPixelCount));
+        if (params.firstPixel() + shift > 0 ||
+                params.endPixel() + shift < frame.length) {
+            return false;
+        }
+        *pShift = shift;
+        return true;
+    }
+};
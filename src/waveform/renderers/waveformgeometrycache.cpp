@@ -0,0 +1,127 @@
+#include "waveform/renderers/waveformgeometrycache.h"
+
+#include <algorithm>
+
+#include "util/counter.h"
+#include "util/stat.h"
+#include "util/time.h"
+
+namespace {
+
+// Drops the geometries of tracks that are not displayed anymore. They keep
+// the whole waveform alive.
+constexpr mixxx::Duration kMaxIdleTime = mixxx::Duration::fromSeconds(5);
+
+// The time the requested geometry usually takes is less than a frame
+constexpr mixxx::Duration kMaxRequestAge = mixxx::Duration::fromMillis(100);
+
+} // anonymous namespace
+
+WaveformGeometryCache::WaveformGeometryCache(std::size_t maxMemoryBytes)
+        : m_maxMemoryBytes(maxMemoryBytes),
+          m_memoryUsage(0) {
+}
+
+std::shared_ptr<const WaveformGeometry> WaveformGeometryCache::find(
+        const WaveformGeometryStyle& style,
+        const WaveformGeometryParams& frame,
+        int* pShift) {
+    // Invoked for every frame, unlike insert() while all decks are paused
+    const mixxx::Duration now = mixxx::Time::elapsed();
+    evict(now);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->style == style && it->pGeometry->shiftFor(frame, pShift)) {
+            it->lastUsed = now;
+            // Move to the front
+            std::rotate(m_entries.begin(), it, it + 1);
+            Counter("WaveformGeometryCache hit")++;
+            return m_entries.front().pGeometry;
+        }
+    }
+    Counter("WaveformGeometryCache miss")++;
+    return nullptr;
+}
+
+void WaveformGeometryCache::insert(const void* pOwner,
+        const WaveformGeometryStyle& style,
+        std::shared_ptr<const WaveformGeometry> pGeometry) {
+    const WaveformGeometryParams& params = pGeometry->params;
+    m_requests.erase(std::remove_if(m_requests.begin(),
+                             m_requests.end(),
+                             [&](const Request& request) {
+                                 return request.style == style &&
+                                         request.params.isSameFrame(params);
+                             }),
+            m_requests.end());
+
+    const auto it = std::find_if(m_entries.begin(),
+            m_entries.end(),
+            [&](const Entry& entry) {
+                return entry.pOwner == pOwner &&
+                        entry.style == style &&
+                        entry.pGeometry->params.isSameLayout(params);
+            });
+    if (it != m_entries.end()) {
+        m_memoryUsage -= it->memoryUsage;
+        m_entries.erase(it);
+    }
+
+    const mixxx::Duration now = mixxx::Time::elapsed();
+    Entry entry;
+    entry.pOwner = pOwner;
+    entry.style = style;
+    entry.memoryUsage = sizeof(WaveformGeometry) + pGeometry->memoryUsage();
+    entry.pGeometry = std::move(pGeometry);
+    entry.lastUsed = now;
+    m_memoryUsage += entry.memoryUsage;
+    m_entries.insert(m_entries.begin(), std::move(entry));
+
+    evict(now);
+    reportMemoryUsage();
+}
+
+bool WaveformGeometryCache::isRequested(const WaveformGeometryStyle& style,
+        const WaveformGeometryParams& params) const {
+    const mixxx::Duration now = mixxx::Time::elapsed();
+    return std::any_of(m_requests.begin(),
+            m_requests.end(),
+            [&](const Request& request) {
+                return request.style == style &&
+                        request.params.isSameFrame(params) &&
+                        now - request.time < kMaxRequestAge;
+            });
+}
+
+void WaveformGeometryCache::setRequested(const void* pRequester,
+        const WaveformGeometryStyle& style,
+        const WaveformGeometryParams& params) {
+    dropRequest(pRequester);
+    m_requests.push_back(Request{pRequester, style, params, mixxx::Time::elapsed()});
+}
+
+void WaveformGeometryCache::dropRequest(const void* pRequester) {
+    m_requests.erase(std::remove_if(m_requests.begin(),
+                             m_requests.end(),
+                             [pRequester](const Request& request) {
+                                 return request.pRequester == pRequester;
+                             }),
+            m_requests.end());
+}
+
+void WaveformGeometryCache::evict(mixxx::Duration now) {
+    // The most recently used entry is kept even if it exceeds the limit
+    while (!m_entries.empty() &&
+            ((m_memoryUsage > m_maxMemoryBytes && m_entries.size() > 1) ||
+                    now - m_entries.back().lastUsed > kMaxIdleTime)) {
+        m_memoryUsage -= m_entries.back().memoryUsage;
+        m_entries.pop_back();
+        Counter("WaveformGeometryCache evicted")++;
+    }
+}
+
+void WaveformGeometryCache::reportMemoryUsage() const {
+    Stat::track(QStringLiteral("WaveformGeometryCache memory usage"),
+            Stat::UNSPECIFIED,
+            Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE | Stat::MIN | Stat::MAX),
+            static_cast<double>(m_memoryUsage));
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QRgb>
+#include <QVector>
+#include <cstddef>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+#include "util/duration.h"
+#include "waveform/renderers/waveformgeometry.h"
+
+/// Renderers of the same style generate the same geometry from the same
+/// params: They are of the same type and use the same signal colors.
+struct WaveformGeometryStyle {
+    const std::type_info* pRendererType = nullptr;
+    QVector<QRgb> colors;
+
+    bool operator==(const WaveformGeometryStyle& other) const {
+        return pRendererType == other.pRendererType &&
+                colors == other.colors;
+    }
+};
+
+/// Shares the geometry of waveform signals between all signal renderers
+/// that draw the same track in the same style and zoom, e.g. when two decks
+/// play the same track in sync, or when a skin shows a deck twice. The
+/// geometry is independent of the breadth of the renderers, which scale it
+/// when drawing it (see WaveformGeometry), and a geometry can be drawn by
+/// all renderers that are not longer than it. Mini waveforms show the whole
+/// track and only share their geometry with mini waveforms of the same
+/// length, because their zoom depends on it.
+///
+/// Each renderer keeps its latest geometry for each layout (see
+/// WaveformGeometryParams::isSameLayout()), so decks that play the same
+/// track at different positions don't replace each other's geometry.
+/// Geometries that have not been used for a while are dropped, as well as
+/// the least recently used ones if the cache grows beyond its memory limit.
+///
+/// Only one of the renderers needs to ask its geometry worker for the next
+/// frame. The others find the pending request in the cache and wait for the
+/// result. Requests that are not fulfilled in time, e.g. because the
+/// requesting widget has been hidden, are ignored.
+///
+/// The cache must only be used from the GUI thread.
+class WaveformGeometryCache {
+  public:
+    static constexpr std::size_t kDefaultMaxMemoryBytes = 32 * 1024 * 1024;
+
+    explicit WaveformGeometryCache(
+            std::size_t maxMemoryBytes = kDefaultMaxMemoryBytes);
+
+    /// Returns a geometry of the given style that can be drawn for the
+    /// frame after shifting it by *pShift pixels, or nullptr.
+    std::shared_ptr<const WaveformGeometry> find(
+            const WaveformGeometryStyle& style,
+            const WaveformGeometryParams& frame,
+            int* pShift);
+
+    /// Adds the geometry of a renderer. It replaces the geometry of the same
+    /// renderer, style and layout and fulfills the requests for it.
+    void insert(const void* pOwner,
+            const WaveformGeometryStyle& style,
+            std::shared_ptr<const WaveformGeometry> pGeometry);
+
+    /// Returns true if the geometry for the given params has been requested
+    /// recently by any renderer.
+    bool isRequested(const WaveformGeometryStyle& style,
+            const WaveformGeometryParams& params) const;
+    /// Records the latest request of a renderer.
+    void setRequested(const void* pRequester,
+            const WaveformGeometryStyle& style,
+            const WaveformGeometryParams& params);
+    /// Drops the request of a renderer, e.g. when it is destroyed.
+    void dropRequest(const void* pRequester);
+
+    /// The memory used by all geometries in bytes
+    std::size_t memoryUsage() const {
+        return m_memoryUsage;
+    }
+    int size() const {
+        return static_cast<int>(m_entries.size());
+    }
+
+  private:
+    struct Entry {
+        const void* pOwner;
+        WaveformGeometryStyle style;
+        std::shared_ptr<const WaveformGeometry> pGeometry;
+        std::size_t memoryUsage;
+        mixxx::Duration lastUsed;
+    };
+
+    struct Request {
+        const void* pRequester;
+        WaveformGeometryStyle style;
+        WaveformGeometryParams params;
+        mixxx::Duration time;
+    };
+
+    void evict(mixxx::Duration now);
+    void reportMemoryUsage() const;
+
+    const std::size_t m_maxMemoryBytes;
+    std::size_t m_memoryUsage;
+    // The most recently used entry first
+    std::vector<Entry> m_entries;
+    std::vector<Request> m_requests;
+};
@@ -0,0 +1,42 @@
+#include "waveform/renderers/waveformgeometryworker.h"
+
+#include "moc_waveformgeometryworker.cpp"
+#include "waveform/renderers/waveformrenderersignalbase.h"
+
+WaveformGeometryWorker::WaveformGeometryWorker(
+        const QString& group,
+        const WaveformRendererSignalBase* pRenderer)
+        : WorkerThread(QStringLiteral("WaveformGeometryWorker %1").arg(group),
+                  // Stay ahead of the library and analysis threads
+                  QThread::HighPriority),
+          m_pRenderer(pRenderer) {
+}
+
+void WaveformGeometryWorker::request(const WaveformGeometryParams& params) {
+    m_requests.writeBuffer() = params;
+    m_requests.publish();
+    wake();
+}
+
+WaveformGeometry* WaveformGeometryWorker::newGeometry() {
+    if (!m_geometries.consume()) {
+        return nullptr;
+    }
+    return &m_geometries.readBuffer();
+}
+
+WorkerThread::TryFetchWorkItemsResult WaveformGeometryWorker::tryFetchWorkItems() {
+    if (m_requests.consume()) {
+        return TryFetchWorkItemsResult::Ready;
+    }
+    return TryFetchWorkItemsResult::Idle;
+}
+
+void WaveformGeometryWorker::doRun() {
+    while (awaitWorkItemsFetched()) {
+        WaveformGeometry& geometry = m_geometries.writeBuffer();
+        geometry.params = m_requests.readBuffer();
+        m_pRenderer->fillGeometry(&geometry);
+        m_geometries.publish();
+    }
+}
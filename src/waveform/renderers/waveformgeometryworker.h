@@ -0,0 +1,41 @@
+#pragma once
+
+#include "util/triplebuffer.h"
+#include "util/workerthread.h"
+#include "waveform/renderers/waveformgeometry.h"
+
+class WaveformRendererSignalBase;
+
+/// Generates the geometry of a waveform signal ahead of time, so that the
+/// GUI thread only needs to submit the lines to the painter.
+///
+/// Each signal renderer, i.e. each deck, owns a worker. Requests and results
+/// are handed over through triple buffers, so neither side waits for the
+/// other one. Requests that have not been picked up when the next one
+/// arrives are dropped.
+class WaveformGeometryWorker : public WorkerThread {
+    Q_OBJECT
+  public:
+    WaveformGeometryWorker(
+            const QString& group,
+            const WaveformRendererSignalBase* pRenderer);
+    ~WaveformGeometryWorker() override = default;
+
+    /// Asks for the geometry of the given frame.
+    void request(const WaveformGeometryParams& params);
+
+    /// The geometry that has been generated since the last call or nullptr.
+    /// It stays valid until the next call. The caller may take its lines and
+    /// colors and leave others in exchange, which the worker then fills.
+    WaveformGeometry* newGeometry();
+
+  protected:
+    void doRun() override;
+    TryFetchWorkItemsResult tryFetchWorkItems() override;
+
+  private:
+    const WaveformRendererSignalBase* const m_pRenderer;
+
+    TripleBuffer<WaveformGeometryParams> m_requests;
+    TripleBuffer<WaveformGeometry> m_geometries;
+};
@@ -0,0 +1,267 @@
+#include "waveform/renderers/waveformrasterizer.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "util/assert.h"
+#include "util/math.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVEFORMRASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Splitting smaller images costs more than it saves
+constexpr int kMinStripPixels = 64 * 1024;
+
+// Blends the premultiplied source over the destination pixel. The
+// division by 255 is exact and gives the same results as the SSE2 variant.
+inline QRgb blendPixel(QRgb dest, QRgb src) {
+    const quint32 invAlpha = 255 - qAlpha(src);
+    quint32 rb = (dest & 0xff00ff) * invAlpha + 0x800080;
+    rb = ((rb + ((rb >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
+    quint32 ag = ((dest >> 8) & 0xff00ff) * invAlpha + 0x800080;
+    ag = (ag + ((ag >> 8) & 0xff00ff)) & 0xff00ff00;
+    return src + rb + ag;
+}
+
+#ifdef WAVEFORMRASTERIZER_SSE2
+// Blends 4 premultiplied source pixels over 4 destination pixels. Masked
+// source pixels are 0 and leave the destination unchanged.
+inline __m128i blendPixels(__m128i dest, __m128i src) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    // 255 - alpha in both 16 bit halves of each pixel
+    __m128i alpha = _mm_srli_epi32(src, 24);
+    alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+    const __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(dest, zero),
+            _mm_unpacklo_epi32(invAlpha, invAlpha));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(dest, zero),
+            _mm_unpackhi_epi32(invAlpha, invAlpha));
+    lo = _mm_add_epi16(lo, half);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_add_epi16(hi, half);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_add_epi8(_mm_packus_epi16(lo, hi), src);
+}
+#endif
+
+// Blends a single color over a run of consecutive pixels
+void blendSpan(QRgb* pDest, int count, QRgb color) {
+    if (qAlpha(color) == 255) {
+        std::fill_n(pDest, count, color);
+        return;
+    }
+    if (qAlpha(color) == 0) {
+        return;
+    }
+    int i = 0;
+#ifdef WAVEFORMRASTERIZER_SSE2
+    const __m128i src = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 4 <= count; i += 4) {
+        __m128i* pPixels = reinterpret_cast<__m128i*>(pDest + i);
+        _mm_storeu_si128(pPixels, blendPixels(_mm_loadu_si128(pPixels), src));
+    }
+#endif
+    for (; i < count; ++i) {
+        pDest[i] = blendPixel(pDest[i], color);
+    }
+}
+
+// Blends the colors of all columns whose span contains the row y over the
+// pixels of that row
+void blendRow(QRgb* pDest,
+        const int* pTop,
+        const int* pBottom,
+        const QRgb* pColor,
+        int y,
+        int count) {
+    int i = 0;
+#ifdef WAVEFORMRASTERIZER_SSE2
+    const __m128i row = _mm_set1_epi32(y);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTop + i));
+        const __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBottom + i));
+        // top <= y < bottom
+        const __m128i mask = _mm_andnot_si128(
+                _mm_cmpgt_epi32(top, row), _mm_cmpgt_epi32(bottom, row));
+        if (_mm_movemask_epi8(mask) == 0) {
+            continue;
+        }
+        const __m128i src = _mm_and_si128(mask,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(pColor + i)));
+        __m128i* pPixels = reinterpret_cast<__m128i*>(pDest + i);
+        _mm_storeu_si128(pPixels, blendPixels(_mm_loadu_si128(pPixels), src));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (pTop[i] <= y && y < pBottom[i]) {
+            pDest[i] = blendPixel(pDest[i], pColor[i]);
+        }
+    }
+}
+
+inline int roundToInt(double value) {
+    return static_cast<int>(std::floor(value + 0.5));
+}
+
+} // anonymous namespace
+
+WaveformRasterizer::WaveformRasterizer()
+        : m_orientation(Qt::Horizontal),
+          m_length(0),
+          m_breadth(0),
+          m_pBits(nullptr),
+          m_pixelsPerLine(0),
+          m_layerCount(0) {
+}
+
+// static
+bool WaveformRasterizer::isPreferredFor(const QPainter* painter) {
+    // Other paint engines, e.g. the OpenGL engine of a QGLWidget, would
+    // need to upload the image for every frame
+    const QPaintEngine* pEngine = painter->paintEngine();
+    return pEngine != nullptr && pEngine->type() == QPaintEngine::Raster;
+}
+
+const QImage& WaveformRasterizer::rasterize(const WaveformGeometry& geometry,
+        int shift,
+        const QSize& size,
+        Qt::Orientation orientation,
+        qreal devicePixelRatio) {
+    m_orientation = orientation;
+    m_length = static_cast<int>(std::ceil(size.width() * devicePixelRatio));
+    m_breadth = static_cast<int>(std::ceil(size.height() * devicePixelRatio));
+    const QSize imageSize = orientation == Qt::Horizontal
+            ? QSize(m_length, m_breadth)
+            : QSize(m_breadth, m_length);
+    if (m_image.size() != imageSize) {
+        m_image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    }
+    m_image.setDevicePixelRatio(devicePixelRatio);
+    if (m_image.isNull()) {
+        return m_image;
+    }
+    m_pBits = reinterpret_cast<QRgb*>(m_image.bits());
+    m_pixelsPerLine = m_image.bytesPerLine() / static_cast<int>(sizeof(QRgb));
+
+    buildLayers(geometry, shift, size.height(), devicePixelRatio);
+
+    const int stripCount = math_clamp(m_length * m_breadth / kMinStripPixels,
+            1,
+            math_max(QThread::idealThreadCount(), 1));
+    m_strips.resize(stripCount);
+    for (int i = 0; i < stripCount; ++i) {
+        m_strips[i].begin = m_length * i / stripCount;
+        m_strips[i].end = m_length * (i + 1) / stripCount;
+    }
+    if (stripCount == 1) {
+        rasterizeStrip(m_strips[0]);
+    } else {
+        QtConcurrent::blockingMap(m_strips, [this](const Strip& strip) {
+            rasterizeStrip(strip);
+        });
+    }
+    return m_image;
+}
+
+WaveformRasterizer::Layer* WaveformRasterizer::addLayer() {
+    if (m_layerCount == static_cast<int>(m_layers.size())) {
+        m_layers.emplace_back();
+    }
+    Layer* pLayer = &m_layers[m_layerCount++];
+    pLayer->top.assign(m_length, 0);
+    pLayer->bottom.assign(m_length, 0);
+    pLayer->color.resize(m_length);
+    pLayer->minTop = INT_MAX;
+    pLayer->maxBottom = 0;
+    return pLayer;
+}
+
+void WaveformRasterizer::buildLayers(const WaveformGeometry& geometry,
+        int shift,
+        qreal breadth,
+        qreal devicePixelRatio) {
+    const QVector<QLineF>& lines = geometry.lines;
+    const QVector<QRgb>& colors = geometry.colors;
+    DEBUG_ASSERT(lines.size() == colors.size());
+
+    m_layerCount = 0;
+    Layer* pLayer = nullptr;
+    int lastBegin = INT_MIN;
+    const double halfWidth = geometry.lineWidth * devicePixelRatio / 2.0;
+    // The lines are in units of the breadth across the waveform
+    const double scaleAcross = breadth * devicePixelRatio;
+    for (int i = 0; i < lines.size(); ++i) {
+        const QLineF& line = lines[i];
+        const double center = (line.x1() + shift) * devicePixelRatio;
+        int begin = roundToInt(center - halfWidth);
+        int end = math_max(roundToInt(center + halfWidth), begin + 1);
+        // Each band starts over at the beginning of the waveform
+        if (pLayer == nullptr || begin < lastBegin) {
+            pLayer = addLayer();
+        }
+        lastBegin = begin;
+
+        begin = math_max(begin, 0);
+        end = math_min(end, m_length);
+        // Like QPainter with a flat cap, the end point is not drawn
+        const int y1 = static_cast<int>(std::floor(line.y1() * scaleAcross));
+        const int y2 = static_cast<int>(std::floor(line.y2() * scaleAcross));
+        const int top = math_clamp(y1 <= y2 ? y1 : y2 + 1, 0, m_breadth);
+        const int bottom = math_clamp(y1 <= y2 ? y2 : y1 + 1, 0, m_breadth);
+        if (begin >= end || top >= bottom) {
+            continue;
+        }
+        const QRgb color = qPremultiply(colors[i]);
+        std::fill(pLayer->top.begin() + begin, pLayer->top.begin() + end, top);
+        std::fill(pLayer->bottom.begin() + begin, pLayer->bottom.begin() + end, bottom);
+        std::fill(pLayer->color.begin() + begin, pLayer->color.begin() + end, color);
+        pLayer->minTop = math_min(pLayer->minTop, top);
+        pLayer->maxBottom = math_max(pLayer->maxBottom, bottom);
+    }
+}
+
+void WaveformRasterizer::rasterizeStrip(const Strip& strip) const {
+    const int count = strip.end - strip.begin;
+    if (m_orientation == Qt::Horizontal) {
+        // The columns of the strip are a part of every scan line
+        for (int y = 0; y < m_breadth; ++y) {
+            std::fill_n(m_pBits + y * m_pixelsPerLine + strip.begin, count, 0);
+        }
+        for (int i = 0; i < m_layerCount; ++i) {
+            const Layer& layer = m_layers[i];
+            for (int y = layer.minTop; y < layer.maxBottom; ++y) {
+                blendRow(m_pBits + y * m_pixelsPerLine + strip.begin,
+                        layer.top.data() + strip.begin,
+                        layer.bottom.data() + strip.begin,
+                        layer.color.data() + strip.begin,
+                        y,
+                        count);
+            }
+        }
+    } else {
+        // Every column is a scan line
+        for (int x = strip.begin; x < strip.end; ++x) {
+            QRgb* pLine = m_pBits + x * m_pixelsPerLine;
+            std::fill_n(pLine, m_breadth, 0);
+            for (int i = 0; i < m_layerCount; ++i) {
+                const Layer& layer = m_layers[i];
+                const int top = layer.top[x];
+                const int bottom = layer.bottom[x];
+                if (top < bottom) {
+                    blendSpan(pLine + top, bottom - top, layer.color[x]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+#include <QVector>
+#include <vector>
+
+#include "waveform/renderers/waveformgeometry.h"
+
+class QPainter;
+
+/// Rasterizes the lines of a WaveformGeometry into an image, for painters
+/// that draw with the software raster engine of Qt.
+///
+/// All lines of a signal renderer are perpendicular to the length of the
+/// waveform and the lines of each band are ordered along it. Every such
+/// run of lines becomes a layer with one span of pixels and one color per
+/// device pixel column. The layers are blended into the image in order,
+/// which gives the same result as drawing the lines with a QPainter without
+/// antialiasing. Only where lines wider than a pixel overlap, the later line
+/// replaces the earlier one instead of being blended over it.
+///
+/// The image is split into strips along the length that are rasterized in
+/// parallel.
+class WaveformRasterizer {
+  public:
+    WaveformRasterizer();
+
+    /// Returns true if drawing the rasterized image with the painter is
+    /// faster than drawing the lines.
+    static bool isPreferredFor(const QPainter* painter);
+
+    /// Rasterizes the lines of the geometry, shifted by the given number of
+    /// pixels along the length and scaled to the breadth of the widget. The
+    /// size is the length and breadth of the widget. The returned image is
+    /// transparent where no line has been drawn and covers the whole widget.
+    /// It is valid until the next invocation.
+    const QImage& rasterize(const WaveformGeometry& geometry,
+            int shift,
+            const QSize& size,
+            Qt::Orientation orientation,
+            qreal devicePixelRatio);
+
+  private:
+    struct Layer {
+        // The span [top, bottom) of each column in device pixels
+        std::vector<int> top;
+        std::vector<int> bottom;
+        // The premultiplied color of each column
+        std::vector<QRgb> color;
+        // The union of all spans
+        int minTop;
+        int maxBottom;
+    };
+
+    struct Strip {
+        int begin;
+        int end;
+    };
+
+    Layer* addLayer();
+    void buildLayers(const WaveformGeometry& geometry,
+            int shift,
+            qreal breadth,
+            qreal devicePixelRatio);
+    void rasterizeStrip(const Strip& strip) const;
+
+    QImage m_image;
+    Qt::Orientation m_orientation;
+    // The size of the image along and across the waveform
+    int m_length;
+    int m_breadth;
+    // The pixels of m_image, fetched in advance because QImage::bits()
+    // must not be called from the strip threads
+    QRgb* m_pBits;
+    int m_pixelsPerLine;
+
+    // Only the first m_layerCount layers are in use, the others are kept
+    // to reuse their memory
+    std::vector<Layer> m_layers;
+    int m_layerCount;
+    QVector<Strip> m_strips;
+};
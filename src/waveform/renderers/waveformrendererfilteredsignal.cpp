@@ -1,5 +1,7 @@
 #include "waveformrendererfilteredsignal.h"
 
+#include <algorithm>
+
 #include "waveformwidgetrenderer.h"
 #include "waveform/waveform.h"
 #include "waveform/waveformwidgetfactory.h"
@@ -12,20 +14,21 @@
 
 WaveformRendererFilteredSignal::WaveformRendererFilteredSignal(
         WaveformWidgetRenderer* waveformWidgetRenderer)
-    : WaveformRendererSignalBase(waveformWidgetRenderer) {
+    : WaveformRendererSignalBase(waveformWidgetRenderer),
+      m_lowColor(0),
+      m_midColor(0),
+      m_highColor(0) {
 }
 
 WaveformRendererFilteredSignal::~WaveformRendererFilteredSignal() {
-}
-
-void WaveformRendererFilteredSignal::onResize() {
-    m_lowLines.resize(m_waveformRenderer->getLength());
-    m_midLines.resize(m_waveformRenderer->getLength());
-    m_highLines.resize(m_waveformRenderer->getLength());
+    stopGeometryWorker();
 }
 
 void WaveformRendererFilteredSignal::onSetup(const QDomNode& node) {
     Q_UNUSED(node);
+    m_lowColor = m_pColors->getLowColor().rgba();
+    m_midColor = m_pColors->getMidColor().rgba();
+    m_highColor = m_pColors->getHighColor().rgba();
 }
 
 void WaveformRendererFilteredSignal::draw(QPainter* painter,
@@ -40,16 +43,6 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == nullptr) {
-        return;
-    }
-
     PainterScope PainterScope(painter);
 
     painter->setRenderHints(QPainter::Antialiasing, false);
@@ -62,35 +55,72 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         painter->setTransform(QTransform(0, 1, 1, 0, 0, 0));
     }
 
-    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
-    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    //draw reference line
+    if (m_alignment == Qt::AlignCenter) {
+        const float halfBreadth = m_waveformRenderer->getBreadth() / 2.0f;
+        painter->setPen(m_pColors->getAxesColor());
+        painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
+    }
+
+    drawGeometry(painter, geometryParams(waveform));
+}
+
+void WaveformRendererFilteredSignal::generateGeometry(WaveformGeometry* pGeometry) const {
+    const WaveformGeometryParams& params = pGeometry->params;
+    const ConstWaveformPointer& waveform = params.waveform;
+
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(params.visualSamplePerPixel);
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
+    if (dataSize <= 1) {
+        return;
+    }
+
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
+    if (data == nullptr) {
+        return;
+    }
+
+    // The displayed positions are relative to the full resolution data
+    const double visualIndexCount =
+            static_cast<double>(waveform->getDataSize()) / (1 << pyramidLevel);
+
+    const double firstVisualIndex = params.firstDisplayedPosition * visualIndexCount;
+    const double lastVisualIndex = params.lastDisplayedPosition * visualIndexCount;
 
     // Represents the # of waveform data points per horizontal pixel.
-    const double gain = (lastVisualIndex - firstVisualIndex) /
-            (double)m_waveformRenderer->getLength();
+    const double gain = (lastVisualIndex - firstVisualIndex) / params.length;
 
     // Per-band gain from the EQ knobs.
-    float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
-    getGains(&allGain, &lowGain, &midGain, &highGain);
-
-    const float breadth = m_waveformRenderer->getBreadth();
+    const float allGain = params.allGain;
+    const float lowGain = params.lowGain;
+    const float midGain = params.midGain;
+    const float highGain = params.highGain;
+
+    // The lines are generated for a breadth of 1 and scaled to the breadth
+    // of the renderer when drawn
+    const float breadth = 1.0f;
     const float halfBreadth = breadth / 2.0f;
 
-    const float heightFactor = m_alignment == Qt::AlignCenter
+    const float heightFactor = params.alignment == Qt::AlignCenter
             ? allGain * halfBreadth / 255.0f
-            : allGain * m_waveformRenderer->getBreadth() / 255.0f;
+            : allGain * breadth / 255.0f;
 
-    //draw reference line
-    if (m_alignment == Qt::AlignCenter) {
-        painter->setPen(m_pColors->getAxesColor());
-        painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
-    }
+    // The lines of each band are collected in their own section, so that
+    // they can be drawn in one batch per band
+    const int pixelCount = params.endPixel() - params.firstPixel();
+    QVector<QLineF>& lines = pGeometry->lines;
+    lines.resize(3 * pixelCount);
+    QLineF* const lowLines = lines.data();
+    QLineF* const midLines = lowLines + pixelCount;
+    QLineF* const highLines = midLines + pixelCount;
 
     int actualLowLineNumber = 0;
     int actualMidLineNumber = 0;
     int actualHighLineNumber = 0;
 
-    for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
+    for (int x = params.firstPixel(); x < params.endPixel(); ++x) {
         // Width of the x position in visual indices.
         const double xSampleWidth = gain * x;
 
@@ -155,85 +185,96 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         }
 
         if (maxLow[0] && maxLow[1]) {
-            switch (m_alignment) {
+            switch (params.alignment) {
                 case Qt::AlignBottom :
                 case Qt::AlignRight :
-                    m_lowLines[actualLowLineNumber].setLine(
+                    lowLines[actualLowLineNumber].setLine(
                         x, breadth,
-                        x, breadth - (int)(heightFactor*lowGain*(float)math_max(maxLow[0],maxLow[1])));
+                        x, breadth - (heightFactor*lowGain*(float)math_max(maxLow[0],maxLow[1])));
                     break;
                 case Qt::AlignTop :
                 case Qt::AlignLeft :
-                    m_lowLines[actualLowLineNumber].setLine(
+                    lowLines[actualLowLineNumber].setLine(
                         x, 0,
-                        x, (int)(heightFactor*lowGain*(float)math_max(maxLow[0],maxLow[1])));
+                        x, (heightFactor*lowGain*(float)math_max(maxLow[0],maxLow[1])));
                     break;
                 default :
-                    m_lowLines[actualLowLineNumber].setLine(
-                        x, (int)(halfBreadth-heightFactor*(float)maxLow[0]*lowGain),
-                        x, (int)(halfBreadth+heightFactor*(float)maxLow[1]*lowGain));
+                    lowLines[actualLowLineNumber].setLine(
+                        x, (halfBreadth-heightFactor*(float)maxLow[0]*lowGain),
+                        x, (halfBreadth+heightFactor*(float)maxLow[1]*lowGain));
                     break;
             }
             actualLowLineNumber++;
         }
         if (maxMid[0] && maxMid[1]) {
-            switch (m_alignment) {
+            switch (params.alignment) {
                 case Qt::AlignBottom :
                 case Qt::AlignRight :
-                    m_midLines[actualMidLineNumber].setLine(
+                    midLines[actualMidLineNumber].setLine(
                         x, breadth,
-                        x, breadth - (int)(heightFactor*midGain*(float)math_max(maxMid[0],maxMid[1])));
+                        x, breadth - (heightFactor*midGain*(float)math_max(maxMid[0],maxMid[1])));
                     break;
                 case Qt::AlignTop :
                 case Qt::AlignLeft :
-                    m_midLines[actualMidLineNumber].setLine(
+                    midLines[actualMidLineNumber].setLine(
                         x, 0,
-                        x, (int)(heightFactor*midGain*(float)math_max(maxMid[0],maxMid[1])));
+                        x, (heightFactor*midGain*(float)math_max(maxMid[0],maxMid[1])));
                     break;
                 default :
-                    m_midLines[actualMidLineNumber].setLine(
-                        x, (int)(halfBreadth-heightFactor*(float)maxMid[0]*midGain),
-                        x, (int)(halfBreadth+heightFactor*(float)maxMid[1]*midGain));
+                    midLines[actualMidLineNumber].setLine(
+                        x, (halfBreadth-heightFactor*(float)maxMid[0]*midGain),
+                        x, (halfBreadth+heightFactor*(float)maxMid[1]*midGain));
                     break;
             }
             actualMidLineNumber++;
         }
         if (maxHigh[0] && maxHigh[1]) {
-            switch (m_alignment) {
+            switch (params.alignment) {
                 case Qt::AlignBottom :
                 case Qt::AlignRight :
-                    m_highLines[actualHighLineNumber].setLine(
+                    highLines[actualHighLineNumber].setLine(
                         x, breadth,
-                        x, breadth - (int)(heightFactor*highGain*(float)math_max(maxHigh[0],maxHigh[1])));
+                        x, breadth - (heightFactor*highGain*(float)math_max(maxHigh[0],maxHigh[1])));
                     break;
                 case Qt::AlignTop :
                 case Qt::AlignLeft :
-                    m_highLines[actualHighLineNumber].setLine(
+                    highLines[actualHighLineNumber].setLine(
                         x, 0,
-                        x, (int)(heightFactor*highGain*(float)math_max(maxHigh[0],maxHigh[1])));
+                        x, (heightFactor*highGain*(float)math_max(maxHigh[0],maxHigh[1])));
                     break;
                 default :
-                    m_highLines[actualHighLineNumber].setLine(
-                        x, (int)(halfBreadth-heightFactor*(float)maxHigh[0]*highGain),
-                        x, (int)(halfBreadth+heightFactor*(float)maxHigh[1]*highGain));
+                    highLines[actualHighLineNumber].setLine(
+                        x, (halfBreadth-heightFactor*(float)maxHigh[0]*highGain),
+                        x, (halfBreadth+heightFactor*(float)maxHigh[1]*highGain));
                     break;
             }
             actualHighLineNumber++;
         }
     }
 
-    double lineThickness = math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel());
-
-    painter->setPen(QPen(QBrush(m_pColors->getLowColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
-    if (m_pLowKillControlObject && m_pLowKillControlObject->get() == 0.0) {
-       painter->drawLines(&m_lowLines[0], actualLowLineNumber);
+    // Drop the killed bands and close the gaps between the sections
+    int lineCount = 0;
+    if (params.lowKilled) {
+        actualLowLineNumber = 0;
     }
-    painter->setPen(QPen(QBrush(m_pColors->getMidColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
-    if (m_pMidKillControlObject && m_pMidKillControlObject->get() == 0.0) {
-        painter->drawLines(&m_midLines[0], actualMidLineNumber);
+    lineCount += actualLowLineNumber;
+    if (!params.midKilled) {
+        std::copy(midLines, midLines + actualMidLineNumber, lowLines + lineCount);
+        lineCount += actualMidLineNumber;
+    } else {
+        actualMidLineNumber = 0;
     }
-    painter->setPen(QPen(QBrush(m_pColors->getHighColor()), lineThickness, Qt::SolidLine, Qt::FlatCap));
-    if (m_pHighKillControlObject && m_pHighKillControlObject->get() == 0.0) {
-        painter->drawLines(&m_highLines[0], actualHighLineNumber);
+    if (!params.highKilled) {
+        std::copy(highLines, highLines + actualHighLineNumber, lowLines + lineCount);
+        lineCount += actualHighLineNumber;
+    } else {
+        actualHighLineNumber = 0;
     }
+    lines.resize(lineCount);
+
+    QVector<QRgb>& colors = pGeometry->colors;
+    colors.resize(lineCount);
+    std::fill_n(colors.begin(), actualLowLineNumber, m_lowColor);
+    std::fill_n(colors.begin() + actualLowLineNumber, actualMidLineNumber, m_midColor);
+    std::fill_n(colors.end() - actualHighLineNumber, actualHighLineNumber, m_highColor);
 }
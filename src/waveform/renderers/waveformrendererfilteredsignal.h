@@ -1,7 +1,6 @@
 #pragma once
 
-#include <vector>
-#include <QLineF>
+#include <QRgb>
 
 #include "util/class.h"
 #include "waveform/renderers/waveformrenderersignalbase.h"
@@ -16,12 +15,13 @@ class WaveformRendererFilteredSignal : public WaveformRendererSignalBase {
 
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
-    virtual void onResize();
+  protected:
+    void generateGeometry(WaveformGeometry* pGeometry) const override;
 
   private:
-    std::vector<QLineF> m_lowLines;
-    std::vector<QLineF> m_midLines;
-    std::vector<QLineF> m_highLines;
+    QRgb m_lowColor;
+    QRgb m_midColor;
+    QRgb m_highColor;
 
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererFilteredSignal);
 };
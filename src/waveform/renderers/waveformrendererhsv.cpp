@@ -15,6 +15,7 @@ WaveformRendererHSV::WaveformRendererHSV(
 }
 
 WaveformRendererHSV::~WaveformRendererHSV() {
+    stopGeometryWorker();
 }
 
 void WaveformRendererHSV::onSetup(const QDomNode& node) {
@@ -33,16 +34,6 @@ void WaveformRendererHSV::draw(QPainter* painter,
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == nullptr) {
-        return;
-    }
-
     PainterScope PainterScope(painter);
 
     painter->setRenderHints(QPainter::Antialiasing, false);
@@ -55,17 +46,45 @@ void WaveformRendererHSV::draw(QPainter* painter,
         painter->setTransform(QTransform(0, 1, 1, 0, 0, 0));
     }
 
-    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
-    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    const float halfBreadth = static_cast<float>(m_waveformRenderer->getBreadth()) / 2.0f;
+
+    //draw reference line
+    painter->setPen(m_pColors->getAxesColor());
+    painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
+
+    drawGeometry(painter, geometryParams(waveform));
+}
+
+void WaveformRendererHSV::generateGeometry(WaveformGeometry* pGeometry) const {
+    const WaveformGeometryParams& params = pGeometry->params;
+    const ConstWaveformPointer& waveform = params.waveform;
+
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(params.visualSamplePerPixel);
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
+    if (dataSize <= 1) {
+        return;
+    }
+
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
+    if (data == nullptr) {
+        return;
+    }
+
+    // The displayed positions are relative to the full resolution data
+    const double visualIndexCount =
+            static_cast<double>(waveform->getDataSize()) / (1 << pyramidLevel);
+
+    const double firstVisualIndex = params.firstDisplayedPosition * visualIndexCount;
+    const double lastVisualIndex = params.lastDisplayedPosition * visualIndexCount;
 
     const double offset = firstVisualIndex;
 
     // Represents the # of waveform data points per horizontal pixel.
-    const double gain = (lastVisualIndex - firstVisualIndex) /
-            (double)m_waveformRenderer->getLength();
+    const double gain = (lastVisualIndex - firstVisualIndex) / params.length;
 
-    float allGain(1.0);
-    getGains(&allGain, nullptr, nullptr, nullptr);
+    const float allGain = params.allGain;
 
     // Save HSV of waveform color. NOTE(rryan): On ARM, qreal is float so it's
     // important we use qreal here and not double or float or else we will get
@@ -73,25 +92,19 @@ void WaveformRendererHSV::draw(QPainter* painter,
     qreal h, s, v;
 
     // Get base color of waveform in the HSV format (s and v isn't use)
-    m_pColors->getLowColor().getHsvF(&h, &s, &v);
+    QColor::fromRgbF(m_lowColor_r, m_lowColor_g, m_lowColor_b).getHsvF(&h, &s, &v);
 
     QColor color;
     float lo, hi, total;
 
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
-
-    const int breadth = m_waveformRenderer->getBreadth();
-    const float halfBreadth = static_cast<float>(breadth) / 2.0f;
+    // The lines are generated for a breadth of 1 and scaled to the breadth
+    // of the renderer when drawn
+    const float breadth = 1.0f;
+    const float halfBreadth = breadth / 2.0f;
 
     const float heightFactor = allGain * halfBreadth / 255.0f;
 
-    //draw reference line
-    painter->setPen(m_pColors->getAxesColor());
-    painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
-
-    for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
+    for (int x = params.firstPixel(); x < params.endPixel(); ++x) {
         // Width of the x position in visual indices.
         const double xSampleWidth = gain * x;
 
@@ -161,26 +174,26 @@ void WaveformRendererHSV::draw(QPainter* painter,
             // Set color
             color.setHsvF(h, 1.0-hi, 1.0-lo);
 
-            pen.setColor(color);
-
-            painter->setPen(pen);
-            switch (m_alignment) {
+            switch (params.alignment) {
                 case Qt::AlignBottom :
                 case Qt::AlignRight :
-                    painter->drawLine(
+                    pGeometry->addLine(
                         x, breadth,
-                        x, breadth - (int)(heightFactor * (float)math_max(maxAll[0],maxAll[1])));
+                        x, breadth - (heightFactor * (float)math_max(maxAll[0],maxAll[1])),
+                        color.rgba());
                     break;
                 case Qt::AlignTop :
                 case Qt::AlignLeft :
-                    painter->drawLine(
+                    pGeometry->addLine(
                         x, 0,
-                        x, (int)(heightFactor * (float)math_max(maxAll[0],maxAll[1])));
+                        x, (heightFactor * (float)math_max(maxAll[0],maxAll[1])),
+                        color.rgba());
                     break;
                 default :
-                    painter->drawLine(
-                        x, (int)(halfBreadth - heightFactor * (float)maxAll[0]),
-                        x, (int)(halfBreadth + heightFactor * (float)maxAll[1]));
+                    pGeometry->addLine(
+                        x, (halfBreadth - heightFactor * (float)maxAll[0]),
+                        x, (halfBreadth + heightFactor * (float)maxAll[1]),
+                        color.rgba());
             }
         }
     }
@@ -13,6 +13,9 @@ class WaveformRendererHSV : public WaveformRendererSignalBase {
 
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
+  protected:
+    void generateGeometry(WaveformGeometry* pGeometry) const override;
+
   private:
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererHSV);
 };
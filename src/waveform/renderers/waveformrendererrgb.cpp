@@ -15,6 +15,7 @@ WaveformRendererRGB::WaveformRendererRGB(
 }
 
 WaveformRendererRGB::~WaveformRendererRGB() {
+    stopGeometryWorker();
 }
 
 void WaveformRendererRGB::onSetup(const QDomNode& /* node */) {
@@ -32,16 +33,6 @@ void WaveformRendererRGB::draw(QPainter* painter,
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == nullptr) {
-        return;
-    }
-
     PainterScope PainterScope(painter);
 
     painter->setRenderHints(QPainter::Antialiasing, false);
@@ -54,35 +45,60 @@ void WaveformRendererRGB::draw(QPainter* painter,
         painter->setTransform(QTransform(0, 1, 1, 0, 0, 0));
     }
 
-    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
-    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    const float halfBreadth = static_cast<float>(m_waveformRenderer->getBreadth()) / 2.0f;
+
+    // Draw reference line
+    painter->setPen(m_pColors->getAxesColor());
+    painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
+
+    drawGeometry(painter, geometryParams(waveform));
+}
+
+void WaveformRendererRGB::generateGeometry(WaveformGeometry* pGeometry) const {
+    const WaveformGeometryParams& params = pGeometry->params;
+    const ConstWaveformPointer& waveform = params.waveform;
+
+    // Draw the level of the waveform pyramid that matches the zoom to
+    // keep the number of drawn visual samples independent of it
+    const int pyramidLevel = waveform->getPyramidLevel(params.visualSamplePerPixel);
+    const int dataSize = waveform->getPyramidDataSize(pyramidLevel);
+    if (dataSize <= 1) {
+        return;
+    }
+
+    const WaveformData* data = waveform->getPyramidData(pyramidLevel);
+    if (data == nullptr) {
+        return;
+    }
+
+    // The displayed positions are relative to the full resolution data
+    const double visualIndexCount =
+            static_cast<double>(waveform->getDataSize()) / (1 << pyramidLevel);
+
+    const double firstVisualIndex = params.firstDisplayedPosition * visualIndexCount;
+    const double lastVisualIndex = params.lastDisplayedPosition * visualIndexCount;
 
     const double offset = firstVisualIndex;
 
     // Represents the # of waveform data points per horizontal pixel.
-    const double gain = (lastVisualIndex - firstVisualIndex) /
-            (double)m_waveformRenderer->getLength();
+    const double gain = (lastVisualIndex - firstVisualIndex) / params.length;
 
     // Per-band gain from the EQ knobs.
-    float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
-    getGains(&allGain, &lowGain, &midGain, &highGain);
+    const float allGain = params.allGain;
+    const float lowGain = params.lowGain;
+    const float midGain = params.midGain;
+    const float highGain = params.highGain;
 
     QColor color;
 
-    QPen pen;
-    pen.setCapStyle(Qt::FlatCap);
-    pen.setWidthF(math_max(1.0, 1.0 / m_waveformRenderer->getVisualSamplePerPixel()));
-
-    const int breadth = m_waveformRenderer->getBreadth();
-    const float halfBreadth = static_cast<float>(breadth) / 2.0f;
+    // The lines are generated for a breadth of 1 and scaled to the breadth
+    // of the renderer when drawn
+    const float breadth = 1.0f;
+    const float halfBreadth = breadth / 2.0f;
 
     const float heightFactor = allGain * halfBreadth / sqrtf(255 * 255 * 3);
 
-    // Draw reference line
-    painter->setPen(m_pColors->getAxesColor());
-    painter->drawLine(QLineF(0, halfBreadth, m_waveformRenderer->getLength(), halfBreadth));
-
-    for (int x = 0; x < m_waveformRenderer->getLength(); ++x) {
+    for (int x = params.firstPixel(); x < params.endPixel(); ++x) {
         // Width of the x position in visual indices.
         const double xSampleWidth = gain * x;
 
@@ -153,26 +169,26 @@ void WaveformRendererRGB::draw(QPainter* painter,
             // Set color
             color.setRgbF(red / max, green / max, blue / max);
 
-            pen.setColor(color);
-
-            painter->setPen(pen);
-            switch (m_alignment) {
+            switch (params.alignment) {
                 case Qt::AlignBottom:
                 case Qt::AlignRight:
-                    painter->drawLine(
+                    pGeometry->addLine(
                         x, breadth,
-                        x, breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                        x, breadth - (heightFactor * sqrtf(math_max(maxAll, maxAllNext))),
+                        color.rgba());
                     break;
                 case Qt::AlignTop:
                 case Qt::AlignLeft:
-                    painter->drawLine(
+                    pGeometry->addLine(
                         x, 0,
-                        x, (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))));
+                        x, (heightFactor * sqrtf(math_max(maxAll, maxAllNext))),
+                        color.rgba());
                     break;
                 default:
-                    painter->drawLine(
-                        x, (int)(halfBreadth - heightFactor * sqrtf(maxAll)),
-                        x, (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)));
+                    pGeometry->addLine(
+                        x, (halfBreadth - heightFactor * sqrtf(maxAll)),
+                        x, (halfBreadth + heightFactor * sqrtf(maxAllNext)),
+                        color.rgba());
             }
         }
     }
@@ -12,6 +12,9 @@ class WaveformRendererRGB : public WaveformRendererSignalBase {
     virtual void onSetup(const QDomNode& node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
+  protected:
+    void generateGeometry(WaveformGeometry* pGeometry) const override;
+
   private:
     DISALLOW_COPY_AND_ASSIGN(WaveformRendererRGB);
 };
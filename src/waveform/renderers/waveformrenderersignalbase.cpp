@@ -1,14 +1,29 @@
 #include "waveformrenderersignalbase.h"
 
 #include <QDomNode>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
 
+#include "waveform/renderers/waveformgeometryworker.h"
 #include "waveform/waveformwidgetfactory.h"
 #include "waveformwidgetrenderer.h"
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/painterscope.h"
 #include "widget/wskincolor.h"
 #include "widget/wwidget.h"
 
+namespace {
+
+// The waveform can scroll by this many pixels until the geometry that has
+// been generated ahead of time doesn't cover the frame anymore
+constexpr int kGuardPixels = 64;
+
+} // anonymous namespace
+
 WaveformRendererSignalBase::WaveformRendererSignalBase(
         WaveformWidgetRenderer* waveformWidgetRenderer)
         : WaveformRendererAbstract(waveformWidgetRenderer),
@@ -50,9 +65,23 @@ WaveformRendererSignalBase::WaveformRendererSignalBase(
 }
 
 WaveformRendererSignalBase::~WaveformRendererSignalBase() {
+    stopGeometryWorker();
     deleteControls();
 }
 
+void WaveformRendererSignalBase::stopGeometryWorker() {
+    if (m_pGeometryWorker) {
+        m_pGeometryWorker->stop();
+        // Blocks at most until the current geometry is done
+        m_pGeometryWorker->wait();
+        m_pGeometryWorker.reset();
+    }
+    if (m_pGeometryCache) {
+        // Let the other renderers request it themselves
+        m_pGeometryCache->dropRequest(this);
+    }
+}
+
 void WaveformRendererSignalBase::deleteControls() {
     if (m_pEQEnabled) {
         delete m_pEQEnabled;
@@ -170,6 +199,21 @@ void WaveformRendererSignalBase::setup(const QDomNode& node,
     signal.getRgbF(&m_signalColor_r, &m_signalColor_g, &m_signalColor_b);
 
     onSetup(node);
+
+    m_pGeometryCache = WaveformWidgetFactory::instance()->getGeometryCache();
+    m_geometryStyle.pRendererType = &typeid(*this);
+    m_geometryStyle.colors = {
+            signal.rgba(),
+            l.rgba(),
+            m.rgba(),
+            h.rgba(),
+            rgbLow.rgba(),
+            rgbMid.rgba(),
+            rgbHigh.rgba(),
+            rgbFilteredLow.rgba(),
+            rgbFilteredMid.rgba(),
+            rgbFilteredHigh.rgba(),
+    };
 }
 
 void WaveformRendererSignalBase::getGains(float* pAllGain, float* pLowGain,
@@ -226,3 +270,139 @@ void WaveformRendererSignalBase::getGains(float* pAllGain, float* pLowGain,
         }
     }
 }
+
+WaveformGeometryParams WaveformRendererSignalBase::geometryParams(
+        const ConstWaveformPointer& pWaveform) {
+    WaveformGeometryParams params;
+    params.waveform = pWaveform;
+    params.completion = pWaveform->getCompletion();
+    params.firstDisplayedPosition = m_waveformRenderer->getFirstDisplayedPosition();
+    params.lastDisplayedPosition = m_waveformRenderer->getLastDisplayedPosition();
+    params.trackPixelCount = m_waveformRenderer->getTrackPixelCount();
+    params.visualSamplePerPixel = m_waveformRenderer->getVisualSamplePerPixel();
+    params.length = m_waveformRenderer->getLength();
+    params.alignment = m_alignment;
+    getGains(&params.allGain, &params.lowGain, &params.midGain, &params.highGain);
+    params.lowKilled = !m_pLowKillControlObject || m_pLowKillControlObject->get() != 0.0;
+    params.midKilled = !m_pMidKillControlObject || m_pMidKillControlObject->get() != 0.0;
+    params.highKilled = !m_pHighKillControlObject || m_pHighKillControlObject->get() != 0.0;
+    return params;
+}
+
+void WaveformRendererSignalBase::fillGeometry(WaveformGeometry* pGeometry) const {
+    pGeometry->clear();
+    pGeometry->lineWidth = math_max(1.0, 1.0 / pGeometry->params.visualSamplePerPixel);
+    generateGeometry(pGeometry);
+}
+
+void WaveformRendererSignalBase::drawGeometry(QPainter* painter,
+        const WaveformGeometryParams& params) {
+    if (!m_pGeometryCache) {
+        // Not set up
+        return;
+    }
+    if (!m_pGeometryWorker) {
+        m_pGeometryWorker = std::make_unique<WaveformGeometryWorker>(
+                m_waveformRenderer->getGroup(), this);
+        m_pGeometryWorker->start();
+    }
+
+    WaveformGeometry* pNewGeometry = m_pGeometryWorker->newGeometry();
+    if (pNewGeometry) {
+        // Take the lines and colors instead of sharing them. Otherwise the
+        // worker would detach them when it reuses the buffer.
+        auto pWorkerGeometry = std::make_shared<WaveformGeometry>(
+                std::move(*pNewGeometry));
+        m_pGeometryCache->insert(this, m_geometryStyle, pWorkerGeometry);
+        if (m_pWorkerGeometry && m_pWorkerGeometry.use_count() == 1) {
+            // Replaced in the cache and not drawn by other renderers, so
+            // the worker can fill it again without allocating
+            pNewGeometry->lines.swap(m_pWorkerGeometry->lines);
+            pNewGeometry->colors.swap(m_pWorkerGeometry->colors);
+        }
+        m_pWorkerGeometry = std::move(pWorkerGeometry);
+    }
+
+    int shift = 0;
+    std::shared_ptr<const WaveformGeometry> pGeometry =
+            m_pGeometryCache->find(m_geometryStyle, params, &shift);
+    if (!pGeometry) {
+        auto pFilledGeometry = std::make_shared<WaveformGeometry>();
+        pFilledGeometry->params = params;
+        fillGeometry(pFilledGeometry.get());
+        pGeometry = pFilledGeometry;
+        shift = 0;
+        m_pGeometryCache->insert(this, m_geometryStyle, pGeometry);
+    }
+
+    // Request the next frame, assuming that the waveform keeps scrolling
+    // at the same speed
+    WaveformGeometryParams next = params;
+    next.guardPixels = kGuardPixels;
+    if (m_lastParams.waveform == params.waveform &&
+            m_lastParams.trackPixelCount == params.trackPixelCount) {
+        const double scroll = params.firstDisplayedPosition -
+                m_lastParams.firstDisplayedPosition;
+        if (std::fabs(scroll * params.trackPixelCount) < kGuardPixels) {
+            next.firstDisplayedPosition += scroll;
+            next.lastDisplayedPosition += scroll;
+        }
+    }
+    m_lastParams = params;
+    // Don't generate the same geometry again while paused, or if another
+    // renderer has already asked for it
+    if (!next.isSameFrame(m_lastRequest)) {
+        if (!m_pGeometryCache->isRequested(m_geometryStyle, next)) {
+            m_pGeometryWorker->request(next);
+            m_pGeometryCache->setRequested(this, m_geometryStyle, next);
+        }
+        m_lastRequest = next;
+    }
+
+    if (WaveformRasterizer::isPreferredFor(painter)) {
+        const QImage& image = m_rasterizer.rasterize(*pGeometry,
+                shift,
+                QSize(params.length, m_waveformRenderer->getBreadth()),
+                m_waveformRenderer->getOrientation(),
+                m_waveformRenderer->getDevicePixelRatio());
+        // The image is already rotated for vertical waveforms
+        PainterScope painterScope(painter);
+        painter->resetTransform();
+        painter->drawImage(QPointF(0, 0), image);
+        return;
+    }
+
+    const QVector<QRgb>& colors = pGeometry->colors;
+    DEBUG_ASSERT(pGeometry->lines.size() == colors.size());
+
+    // Snapped to whole pixels like the rasterizer does at a device pixel
+    // ratio of 1
+    const qreal breadth = m_waveformRenderer->getBreadth();
+    m_scaledLines.resize(pGeometry->lines.size());
+    std::transform(pGeometry->lines.cbegin(),
+            pGeometry->lines.cend(),
+            m_scaledLines.begin(),
+            [breadth](const QLineF& line) {
+                return QLineF(line.x1(),
+                        std::floor(line.y1() * breadth),
+                        line.x2(),
+                        std::floor(line.y2() * breadth));
+            });
+    const QVector<QLineF>& lines = m_scaledLines;
+
+    painter->translate(shift, 0);
+    QPen pen;
+    pen.setCapStyle(Qt::FlatCap);
+    pen.setWidthF(pGeometry->lineWidth);
+    int begin = 0;
+    while (begin < lines.size()) {
+        int end = begin + 1;
+        while (end < lines.size() && colors[end] == colors[begin]) {
+            ++end;
+        }
+        pen.setColor(QColor::fromRgba(colors[begin]));
+        painter->setPen(pen);
+        painter->drawLines(lines.constData() + begin, end - begin);
+        begin = end;
+    }
+}
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <memory>
+
 #include "waveformrendererabstract.h"
 #include "waveformsignalcolors.h"
 #include "skin/legacy/skincontext.h"
+#include "waveform/renderers/waveformgeometry.h"
+#include "waveform/renderers/waveformgeometrycache.h"
+#include "waveform/renderers/waveformrasterizer.h"
 
 class ControlObject;
 class ControlProxy;
+class WaveformGeometryWorker;
 
 class WaveformRendererSignalBase : public WaveformRendererAbstract {
 public:
@@ -20,10 +26,35 @@ public:
 
   protected:
     void deleteControls();
+    // Must be invoked by the destructors of subclasses that implement
+    // generateGeometry(), before their members are destroyed.
+    void stopGeometryWorker();
 
     void getGains(float* pAllGain, float* pLowGain, float* pMidGain,
                   float* highGain);
 
+    // Captures the state of the current frame that generateGeometry()
+    // depends on.
+    WaveformGeometryParams geometryParams(const ConstWaveformPointer& pWaveform);
+
+    // Draws the lines of the signal for the current frame. The lines are
+    // usually generated ahead of time by a geometry worker and only shifted
+    // into place and scaled to the breadth of the renderer. The geometry is
+    // shared with all other renderers of the same style that draw the same
+    // track with the same zoom, see WaveformGeometryCache. It is only
+    // generated on the calling thread if none fits the frame, e.g. after
+    // seeking, zooming or widening the renderer. With the software raster
+    // engine of Qt the lines are rasterized into an image that is drawn
+    // instead.
+    void drawGeometry(QPainter* painter, const WaveformGeometryParams& params);
+
+    // Adds the lines of the signal for pGeometry->params. This is invoked
+    // on the geometry worker thread and must only depend on the params and
+    // on members that are not changed after setup().
+    virtual void generateGeometry(WaveformGeometry* pGeometry) const {
+        Q_UNUSED(pGeometry);
+    }
+
   protected:
     ControlProxy* m_pEQEnabled;
     ControlProxy* m_pLowFilterControlObject;
@@ -48,4 +79,22 @@ public:
     qreal m_rgbLowFilteredColor_r, m_rgbLowFilteredColor_g, m_rgbLowFilteredColor_b;
     qreal m_rgbMidFilteredColor_r, m_rgbMidFilteredColor_g, m_rgbMidFilteredColor_b;
     qreal m_rgbHighFilteredColor_r, m_rgbHighFilteredColor_g, m_rgbHighFilteredColor_b;
+
+  private:
+    void fillGeometry(WaveformGeometry* pGeometry) const;
+
+    std::unique_ptr<WaveformGeometryWorker> m_pGeometryWorker;
+    // Shared with WaveformWidgetFactory, which may be destroyed first
+    std::shared_ptr<WaveformGeometryCache> m_pGeometryCache;
+    WaveformGeometryStyle m_geometryStyle;
+    // The latest geometry of the worker. Its buffers are handed back to the
+    // worker once the cache has replaced it and nobody draws it anymore.
+    std::shared_ptr<WaveformGeometry> m_pWorkerGeometry;
+    WaveformGeometryParams m_lastParams;
+    WaveformGeometryParams m_lastRequest;
+    WaveformRasterizer m_rasterizer;
+    // The lines of the drawn geometry scaled to the breadth of the renderer
+    QVector<QLineF> m_scaledLines;
+
+    friend class WaveformGeometryWorker;
 };
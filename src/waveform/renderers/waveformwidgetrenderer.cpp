@@ -107,6 +107,7 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     // For a valid track to render we need
     m_trackSamples = static_cast<int>(m_pTrackSamplesControlObject->get());
     if (m_trackSamples <= 0) {
+        updateFrameState();
         return;
     }
 
@@ -165,6 +166,7 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     } else {
         m_playPos = -1; // disable renderers
     }
+    updateFrameState();
 
     //qDebug() << "WaveformWidgetRenderer::onPreRender" <<
     //        "m_group" << m_group <<
@@ -174,10 +176,31 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     //        "m_gain" << m_gain;
 }
 
+void WaveformWidgetRenderer::updateFrameState() {
+    FrameState state;
+    TrackPointer pTrack = m_pTrack;
+    if (pTrack) {
+        state.pTrack = pTrack.get();
+        ConstWaveformPointer pWaveform = pTrack->getWaveform();
+        if (pWaveform) {
+            state.completion = pWaveform->getCompletion();
+        }
+    }
+    state.trackSamples = m_trackSamples;
+    state.playPos = m_playPos;
+    state.visualSamplePerPixel = m_visualSamplePerPixel;
+    state.gain = m_gain;
+    state.playMarkerPosition = m_playMarkerPosition;
+    state.width = m_width;
+    state.height = m_height;
+    m_frameState = state;
+}
+
 void WaveformWidgetRenderer::draw(QPainter* painter, QPaintEvent* event) {
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     m_lastSystemFrameTime = m_timer->restart().toIntegerNanos();
 #endif
+    m_drawnFrameState = m_frameState;
 
     //PerformanceTimer timer;
     //timer.start();
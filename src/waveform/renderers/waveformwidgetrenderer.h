@@ -36,6 +36,17 @@ class WaveformWidgetRenderer {
     void onPreRender(VSyncThread* vsyncThread);
     void draw(QPainter* painter, QPaintEvent* event);
 
+    // Returns true if the frame prepared by the last onPreRender() differs
+    // from the last drawn one. Only the state that changes the scrolling
+    // waveform is compared, not e.g. cues or beats.
+    bool isFrameChanged() const {
+        return !(m_frameState == m_drawnFrameState);
+    }
+    // Returns true if the waveform has scrolled since the last drawn frame
+    bool isScrolling() const {
+        return m_frameState.playPos != m_drawnFrameState.playPos;
+    }
+
     const QString& getGroup() const {
         return m_group;
     }
@@ -51,6 +62,10 @@ class WaveformWidgetRenderer {
     double getLastDisplayedPosition() const {
         return m_lastDisplayedPosition;
     }
+    // The length of the whole track in pixels
+    double getTrackPixelCount() const {
+        return m_trackPixelCount;
+    }
 
     void setZoom(double zoom);
 
@@ -202,6 +217,34 @@ class WaveformWidgetRenderer {
 private:
     DISALLOW_COPY_AND_ASSIGN(WaveformWidgetRenderer);
     friend class WaveformWidgetFactory;
+
+    struct FrameState {
+        const Track* pTrack = nullptr;
+        int trackSamples = 0;
+        int completion = 0;
+        double playPos = -1;
+        double visualSamplePerPixel = 0.0;
+        double gain = 0.0;
+        double playMarkerPosition = 0.0;
+        int width = 0;
+        int height = 0;
+
+        bool operator==(const FrameState& other) const {
+            return pTrack == other.pTrack &&
+                    trackSamples == other.trackSamples &&
+                    completion == other.completion &&
+                    playPos == other.playPos &&
+                    visualSamplePerPixel == other.visualSamplePerPixel &&
+                    gain == other.gain &&
+                    playMarkerPosition == other.playMarkerPosition &&
+                    width == other.width &&
+                    height == other.height;
+        }
+    };
+    void updateFrameState();
+    FrameState m_frameState;
+    FrameState m_drawnFrameState;
+
     QMap<WaveformMarkPointer, int> m_markPositions;
     // draw play position indicator triangles
     void drawPlayPosmarker(QPainter* painter);
@@ -6,6 +6,7 @@
 #include "control/controlproxy.h"
 #include "moc_visualplayposition.cpp"
 #include "util/math.h"
+#include "util/stat.h"
 #include "waveform/vsyncthread.h"
 
 namespace {
@@ -14,6 +15,15 @@ namespace {
 // but does not continue in case of underflows.
 constexpr int kMaxOffsetBufferCnt = 2;
 constexpr int kMicrosPerMillis = 1000; // 1 ms contains 1000 µs
+constexpr double kMicrosPerSecond = 1000000.0;
+constexpr double kNanosPerMicro = 1000.0;
+
+const QString kDacJitterStatTag = QStringLiteral("VisualPlayPosition DAC jitter");
+
+Stat::ComputeFlags statFlags() {
+    return Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+            Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX);
+}
 } // anonymous namespace
 
 
@@ -21,9 +31,14 @@ constexpr int kMicrosPerMillis = 1000; // 1 ms contains 1000 µs
 QMap<QString, QWeakPointer<VisualPlayPosition> > VisualPlayPosition::m_listVisualPlayPosition;
 PerformanceTimer VisualPlayPosition::m_timeInfoTime;
 double VisualPlayPosition::m_dCallbackEntryToDacSecs = 0;
+double VisualPlayPosition::m_dFilteredCallbackEntryToDacSecs = 0;
+DacClockFilter VisualPlayPosition::m_dacClockFilter;
+QAtomicInt VisualPlayPosition::m_resetDacClockFilter;
 
 VisualPlayPosition::VisualPlayPosition(const QString& key)
-        : m_valid(false),
+        : m_predictionErrorStatTag(
+                  QStringLiteral("VisualPlayPosition prediction error ") + key),
+          m_valid(false),
           m_key(key) {
     m_audioBufferSize = new ControlProxy(
             "[Master]", "audio_buffer_size", this);
@@ -39,18 +54,65 @@ void VisualPlayPosition::set(double playPos, double rate, double positionStep,
         double slipPosition, double tempoTrackSeconds) {
     VisualPlayPositionData data;
     data.m_referenceTime = m_timeInfoTime;
-    data.m_callbackEntrytoDac = static_cast<int>(m_dCallbackEntryToDacSecs * 1000000); // s to µs
+    data.m_callbackEntrytoDac = static_cast<int>(
+            m_dFilteredCallbackEntryToDacSecs * kMicrosPerSecond); // s to µs
+    data.m_bufferMicros = m_dacClockFilter.isValid()
+            ? m_dacClockFilter.periodMicros()
+            : m_audioBufferMicros;
     data.m_enginePlayPos = playPos;
     data.m_rate = rate;
     data.m_positionStep = positionStep;
     data.m_slipPosition = slipPosition;
     data.m_tempoTrackSeconds = tempoTrackSeconds;
 
+    if (m_valid) {
+        trackPredictionError(data);
+    }
+    m_lastData = data;
+
     // Atomic write
     m_data.setValue(data);
     m_valid = true;
 }
 
+void VisualPlayPosition::trackPredictionError(const VisualPlayPositionData& data) {
+    if (m_lastData.m_rate == 0.0 || m_lastData.m_positionStep <= 0.0 ||
+            m_lastData.m_bufferMicros <= 0.0) {
+        return;
+    }
+    const double dacMicros =
+            data.m_referenceTime.difference(m_lastData.m_referenceTime).toDoubleMicros() +
+            data.m_callbackEntrytoDac - m_lastData.m_callbackEntrytoDac;
+    const double predictedPlayPos = m_lastData.m_enginePlayPos +
+            m_lastData.m_positionStep * dacMicros * m_lastData.m_rate /
+                    m_lastData.m_bufferMicros;
+    // Convert the difference into the time it takes to play it
+    const double errorMicros = (data.m_enginePlayPos - predictedPlayPos) *
+            m_lastData.m_bufferMicros /
+            (m_lastData.m_positionStep * fabs(m_lastData.m_rate));
+    if (fabs(errorMicros) > m_lastData.m_bufferMicros * kMaxOffsetBufferCnt) {
+        // Seeks and loops are not predictable
+        return;
+    }
+    Stat::track(m_predictionErrorStatTag,
+            Stat::DURATION_NANOSEC,
+            statFlags(),
+            errorMicros * kNanosPerMicro);
+}
+
+double VisualPlayPosition::calcPosAtNextVSync(
+        VSyncThread* pVSyncThread, const VisualPlayPositionData& data) {
+    int refToVSync = pVSyncThread->fromTimerToNextSyncMicros(data.m_referenceTime);
+    int offset = refToVSync - data.m_callbackEntrytoDac;
+    offset = math_min(offset, m_audioBufferMicros * kMaxOffsetBufferCnt);
+    double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
+    // add the offset for the position of the sample that will be transferred to the DAC
+    // When the next display frame is displayed
+    playPos += data.m_positionStep * offset * data.m_rate / data.m_bufferMicros;
+    //qDebug() << "playPos" << playPos << offset;
+    return playPos;
+}
+
 double VisualPlayPosition::getAtNextVSync(VSyncThread* vSyncThread) {
     //static double testPos = 0;
     //testPos += 0.000017759; //0.000016608; //  1.46257e-05;
@@ -58,15 +120,7 @@ double VisualPlayPosition::getAtNextVSync(VSyncThread* vSyncThread) {
 
     if (m_valid) {
         VisualPlayPositionData data = m_data.getValue();
-        int refToVSync = vSyncThread->fromTimerToNextSyncMicros(data.m_referenceTime);
-        int offset = refToVSync - data.m_callbackEntrytoDac;
-        offset = math_min(offset, m_audioBufferMicros * kMaxOffsetBufferCnt);
-        double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
-        // add the offset for the position of the sample that will be transferred to the DAC
-        // When the next display frame is displayed
-        playPos += data.m_positionStep * offset * data.m_rate / m_audioBufferMicros;
-        //qDebug() << "playPos" << playPos << offset;
-        return playPos;
+        return calcPosAtNextVSync(vSyncThread, data);
     }
     return -1;
 }
@@ -78,12 +132,7 @@ void VisualPlayPosition::getPlaySlipAtNextVSync(VSyncThread* vSyncThread, double
 
     if (m_valid) {
         VisualPlayPositionData data = m_data.getValue();
-        int refToVSync = vSyncThread->fromTimerToNextSyncMicros(data.m_referenceTime);
-        int offset = refToVSync - data.m_callbackEntrytoDac;
-        offset = math_min(offset, m_audioBufferMicros * kMaxOffsetBufferCnt);
-        double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
-        playPos += data.m_positionStep * offset * data.m_rate / m_audioBufferMicros;
-        *pPlayPosition = playPos;
+        *pPlayPosition = calcPosAtNextVSync(vSyncThread, data);
         *pSlipPosition = data.m_slipPosition;
     }
 }
@@ -110,6 +159,7 @@ void VisualPlayPosition::getTrackTime(double* pPlayPosition, double* pTempoTrack
 
 void VisualPlayPosition::slotAudioBufferSizeChanged(double sizeMillis) {
     m_audioBufferMicros = static_cast<int>(sizeMillis * kMicrosPerMillis);
+    m_resetDacClockFilter.storeRelease(1);
 }
 
 //static
@@ -124,8 +174,24 @@ QSharedPointer<VisualPlayPosition> VisualPlayPosition::getVisualPlayPosition(con
 
 //static
 void VisualPlayPosition::setCallbackEntryToDacSecs(double secs, const PerformanceTimer& time) {
+    // The interval between the DAC times of the previous and this buffer
+    const double intervalMicros = time.difference(m_timeInfoTime).toDoubleMicros() +
+            (secs - m_dCallbackEntryToDacSecs) * kMicrosPerSecond;
+    if (m_resetDacClockFilter.fetchAndStoreAcquire(0)) {
+        m_dacClockFilter.reset();
+    }
+    const double correctionMicros = m_dacClockFilter.observe(intervalMicros);
+    if (m_dacClockFilter.isValid()) {
+        Stat::track(kDacJitterStatTag,
+                Stat::DURATION_NANOSEC,
+                statFlags(),
+                m_dacClockFilter.jitterMicros() * kNanosPerMicro);
+    }
+
     // the time is valid only just NOW, so measure the time from NOW for
     // later correction
     m_timeInfoTime = time;
     m_dCallbackEntryToDacSecs = secs;
+    m_dFilteredCallbackEntryToDacSecs = math_max(
+            0.0, secs + correctionMicros / kMicrosPerSecond);
 }
@@ -7,6 +7,7 @@
 
 #include "util/performancetimer.h"
 #include "control/controlvalue.h"
+#include "waveform/dacclockfilter.h"
 
 class ControlProxy;
 class VSyncThread;
@@ -24,11 +25,17 @@ class VSyncThread;
 // GPU: ---------|----------------------------------- |--|-------------------------------
 //               ^Render Waveform sample X            |  ^VSync (New waveform is displayed
 //                by use usFromTimerToNextSync        ^swap Buffer
+//
+// The time from the Audio Callback Entry to the DAC jitters from callback to
+// callback, which results in visible stepping with large audio buffers. It is
+// smoothed by a DacClockFilter, which also provides the actual interval of the
+// buffers for extrapolating the play position.
 
 class VisualPlayPositionData {
   public:
     PerformanceTimer m_referenceTime;
     int m_callbackEntrytoDac; // Time from Audio Callback Entry to first sample of Buffer is transferred to DAC
+    double m_bufferMicros; // Time in µs until the DAC has consumed the Buffer
     double m_enginePlayPos; // Play position of fist Sample in Buffer
     double m_rate;
     double m_positionStep;
@@ -68,7 +75,15 @@ class VisualPlayPosition : public QObject {
     void slotAudioBufferSizeChanged(double sizeMs);
 
   private:
+    double calcPosAtNextVSync(VSyncThread* pVSyncThread, const VisualPlayPositionData& data);
+    // Reports how far the previous buffer extrapolated to the DAC time of
+    // the new buffer is off. Must be called only from the engine thread.
+    void trackPredictionError(const VisualPlayPositionData& data);
+
     ControlValueAtomic<VisualPlayPositionData> m_data;
+    // The data of the previous buffer, only accessed by the engine thread
+    VisualPlayPositionData m_lastData;
+    QString m_predictionErrorStatTag;
     ControlProxy* m_audioBufferSize;
     int m_audioBufferMicros; // Audio buffer size in µs
     bool m_valid;
@@ -77,6 +92,12 @@ class VisualPlayPosition : public QObject {
     static QMap<QString, QWeakPointer<VisualPlayPosition> > m_listVisualPlayPosition;
     // Time info from the Sound device, updated just after audio callback is called
     static double m_dCallbackEntryToDacSecs;
+    // m_dCallbackEntryToDacSecs corrected by m_dacClockFilter
+    static double m_dFilteredCallbackEntryToDacSecs;
+    static DacClockFilter m_dacClockFilter;
+    // Set when the audio buffer size changes, the filter is reset in the
+    // audio thread that owns it
+    static QAtomicInt m_resetDacClockFilter;
     // Time stamp for m_timeInfo in main CPU time
     static PerformanceTimer m_timeInfoTime;
 };
@@ -1,12 +1,64 @@
+#include <QFile>
 #include <QtDebug>
 
 #include "waveform/waveform.h"
+
+#include <algorithm>
+
 #include "proto/waveform.pb.h"
+#include "util/math.h"
 
 using namespace mixxx::track;
 
 const int kNumChannels = 2;
 
+namespace {
+
+// Levels with fewer visual frames are not worth it
+constexpr int kPyramidMinFrames = 16;
+constexpr int kPyramidMaxLevels = 16;
+
+// Each visual sample of a pyramid level is serialized as 4 bytes
+constexpr int kPyramidBytesPerSample = 4;
+
+inline WaveformData maxOf(const WaveformData& a, const WaveformData& b) {
+    WaveformData result;
+    result.filtered.low = math_max(a.filtered.low, b.filtered.low);
+    result.filtered.mid = math_max(a.filtered.mid, b.filtered.mid);
+    result.filtered.high = math_max(a.filtered.high, b.filtered.high);
+    result.filtered.all = math_max(a.filtered.all, b.filtered.all);
+    return result;
+}
+
+void writePyramidData(std::string* pBytes, const WaveformData* pData, int size) {
+    pBytes->resize(size * kPyramidBytesPerSample);
+    char* pByte = &(*pBytes)[0];
+    for (int i = 0; i < size; ++i) {
+        const WaveformData& datum = pData[i];
+        *pByte++ = static_cast<char>(datum.filtered.low);
+        *pByte++ = static_cast<char>(datum.filtered.mid);
+        *pByte++ = static_cast<char>(datum.filtered.high);
+        *pByte++ = static_cast<char>(datum.filtered.all);
+    }
+}
+
+bool readPyramidData(WaveformData* pData, int size, const std::string& bytes) {
+    if (bytes.size() != static_cast<size_t>(size) * kPyramidBytesPerSample) {
+        return false;
+    }
+    const char* pByte = bytes.data();
+    for (int i = 0; i < size; ++i) {
+        WaveformData& datum = pData[i];
+        datum.filtered.low = static_cast<unsigned char>(*pByte++);
+        datum.filtered.mid = static_cast<unsigned char>(*pByte++);
+        datum.filtered.high = static_cast<unsigned char>(*pByte++);
+        datum.filtered.all = static_cast<unsigned char>(*pByte++);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -21,9 +73,12 @@ Waveform::Waveform(const QByteArray& data)
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
+          m_textureSize(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
+          m_pyramidCompletion(0),
           m_completion(-1) {
     readByteArray(data);
 }
@@ -33,9 +88,12 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
+          m_textureSize(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
+          m_pyramidCompletion(0),
           m_completion(-1) {
     int numberOfVisualSamples = 0;
     if (audioSampleRate > 0) {
@@ -108,18 +166,24 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
         high->add_value(datum.filtered.high);
     }
 
+    for (const auto& level : m_pyramid) {
+        io::Waveform::PyramidLevel* pLevel = waveform.add_pyramid_levels();
+        writePyramidData(pLevel->mutable_max(), level.max, level.size);
+    }
+
     qDebug() << "Writing waveform from byte array:"
              << "dataSize" << dataSize
              << "allSignalSize" << all->value_size()
              << "visualSampleRate" << waveform.visual_sample_rate()
-             << "audioVisualRatio" << waveform.audio_visual_ratio();
+             << "audioVisualRatio" << waveform.audio_visual_ratio()
+             << "pyramidLevels" << waveform.pyramid_levels_size();
 
     std::string output;
     waveform.SerializeToString(&output);
@@ -185,36 +249,121 @@ void Waveform::readByteArray(const QByteArray& data) {
     bool mid_valid = mid.units() == io::Waveform::RMS;
     bool high_valid = high.units() == io::Waveform::RMS;
     for (int i = 0; i < dataSize; ++i) {
-        m_data[i].filtered.all = static_cast<unsigned char>(all.value(i));
+        m_pData[i].filtered.all = static_cast<unsigned char>(all.value(i));
         bool use_low = low_valid && i < low.value_size();
         bool use_mid = mid_valid && i < mid.value_size();
         bool use_high = high_valid && i < high.value_size();
-        m_data[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
-        m_data[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
-        m_data[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
+        m_pData[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
+        m_pData[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
+        m_pData[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
+    }
+
+    // The pyramid is missing in waveforms that have been stored by older
+    // versions and is then recalculated from the data.
+    bool pyramidValid = waveform.pyramid_levels_size() == static_cast<int>(m_pyramid.size());
+    for (int i = 0; pyramidValid && i < waveform.pyramid_levels_size(); ++i) {
+        const io::Waveform::PyramidLevel& level = waveform.pyramid_levels(i);
+        const PyramidLevel& pyramidLevel = m_pyramid[i];
+        pyramidValid = readPyramidData(pyramidLevel.max, pyramidLevel.size, level.max());
+    }
+    if (pyramidValid) {
+        m_pyramidCompletion = dataSize;
+    } else {
+        updatePyramid(dataSize);
     }
     m_completion = dataSize;
     m_saveState = SaveState::Saved;
 }
 
 void Waveform::resize(int size) {
-    m_dataSize = size;
     m_textureStride = computeTextureStride(size);
-    m_data.resize(m_textureStride * m_textureStride);
+    allocateStorage(size, m_textureStride * m_textureStride);
 }
 
 void Waveform::assign(int size, int value) {
-    m_dataSize = size;
     m_textureStride = computeTextureStride(size);
-    m_data.assign(m_textureStride * m_textureStride, value);
+    allocateStorage(size, m_textureStride * m_textureStride);
+    if (value != 0) {
+        std::fill(m_storage.begin(), m_storage.end(), WaveformData(value));
+    }
     m_saveState = SaveState::SavePending;
 }
 
+int Waveform::layoutStorage(int size, int textureSize, WaveformData* pStorage) {
+    m_dataSize = size;
+    m_textureSize = textureSize;
+    m_pData = pStorage;
+    m_pyramid.clear();
+    m_pyramidCompletion = 0;
+    int storageSize = textureSize;
+    int frameCount = size / kNumChannels;
+    while (static_cast<int>(m_pyramid.size()) + 1 < kPyramidMaxLevels) {
+        // Round up to cover the trailing frame
+        frameCount = (frameCount + 1) / 2;
+        if (frameCount < kPyramidMinFrames) {
+            break;
+        }
+        PyramidLevel level;
+        level.size = frameCount * kNumChannels;
+        level.max = pStorage ? pStorage + storageSize : nullptr;
+        m_pyramid.push_back(level);
+        storageSize += level.size;
+    }
+    return storageSize;
+}
+
+void Waveform::allocateStorage(int size, int textureSize) {
+    m_pMappedFile.reset();
+    m_storage.assign(layoutStorage(size, textureSize, nullptr), WaveformData(0));
+    layoutStorage(size, textureSize, m_storage.data());
+}
+
+int Waveform::getPyramidLevel(double visualSamplesPerPixel) const {
+    int level = 0;
+    while (level + 1 < getPyramidLevelCount() && visualSamplesPerPixel >= 2.0) {
+        visualSamplesPerPixel /= 2;
+        ++level;
+    }
+    return level;
+}
+
+void Waveform::updatePyramid(int completion) {
+    completion = math_min(completion, m_dataSize);
+    if (completion <= m_pyramidCompletion) {
+        return;
+    }
+    // Frames of coarser levels that only cover partially completed data
+    // are recalculated on the next update.
+    int firstFrame = m_pyramidCompletion / kNumChannels;
+    int endFrame = (completion + kNumChannels - 1) / kNumChannels;
+    const WaveformData* pSourceMax = data();
+    int sourceFrameCount = m_dataSize / kNumChannels;
+    for (auto& level : m_pyramid) {
+        firstFrame /= 2;
+        endFrame = (endFrame + 1) / 2;
+        for (int frame = firstFrame; frame < endFrame; ++frame) {
+            const int sourceFrame = frame * 2;
+            const bool hasNextSourceFrame = sourceFrame + 1 < sourceFrameCount;
+            for (int channel = 0; channel < kNumChannels; ++channel) {
+                const int i = frame * kNumChannels + channel;
+                const int source = sourceFrame * kNumChannels + channel;
+                level.max[i] = hasNextSourceFrame
+                        ? maxOf(pSourceMax[source], pSourceMax[source + kNumChannels])
+                        : pSourceMax[source];
+            }
+        }
+        pSourceMax = level.max;
+        sourceFrameCount = level.size / kNumChannels;
+    }
+    m_pyramidCompletion = completion;
+}
+
 void Waveform::dump() const {
     qDebug() << "Waveform" << this
              << "size("+QString::number(getDataSize())+")"
              << "textureStride("+QString::number(m_textureStride)+")"
              << "completion("+QString::number(getCompletion())+")"
              << "visualSampleRate("+QString::number(m_visualSampleRate)+")"
-             << "audioVisualRatio("+QString::number(m_audioVisualRatio)+")";
+             << "audioVisualRatio("+QString::number(m_audioVisualRatio)+")"
+             << "pyramidLevels("+QString::number(getPyramidLevelCount())+")";
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <QMutex>
@@ -9,6 +10,9 @@
 #include <QSharedPointer>
 #include <QMutexLocker>
 
+QT_FORWARD_DECLARE_CLASS(QFile)
+
+#include "util/assert.h"
 #include "util/class.h"
 #include "util/compatibility.h"
 
@@ -109,41 +113,101 @@ class Waveform {
     // the constructor runs.
     inline int getTextureStride() const { return m_textureStride; }
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    inline int getTextureSize() const { return static_cast<int>(m_data.size()); }
+    // The number of visual samples in data() including the padding for
+    // uploading it as a texture. It is a multiple of the texture stride.
+    // We do not lock the mutex since it is not changed after the constructor
+    // runs.
+    inline int getTextureSize() const { return m_textureSize; }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since m_pData is not reallocated after the
     // constructor runs.
-    WaveformData* data() { return &m_data[0];}
+    WaveformData* data() { return m_pData;}
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since m_pData is not reallocated after the
     // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    const WaveformData* data() const { return m_pData;}
+
+    // Whether the data has been mapped from a WaveformFile instead of
+    // being loaded into memory.
+    bool isMapped() const {
+        return m_pMappedFile != nullptr;
+    }
+
+    // The waveform data is accompanied by a pyramid of successively
+    // downsampled copies. Each level halves the number of visual frames
+    // (pairs of left/right visual samples) of the previous level. Level 0
+    // is the full resolution data, i.e. data(). Renderers should pick the
+    // level that matches the current zoom to keep the number of visual
+    // samples per frame independent of the zoom factor.
+    //
+    // The levels are allocated by the constructor and their size is not
+    // allowed to change afterwards, just like the data.
+    int getPyramidLevelCount() const {
+        return static_cast<int>(m_pyramid.size()) + 1;
+    }
+
+    // The number of visual samples of the given level. The visual indices
+    // of a level are the full resolution indices divided by 2^level.
+    int getPyramidDataSize(int level) const {
+        DEBUG_ASSERT(level >= 0 && level < getPyramidLevelCount());
+        return level == 0 ? m_dataSize : m_pyramid[level - 1].size;
+    }
+
+    // The maximum of all full resolution visual samples that are covered
+    // by a visual sample of the given level. This is what the renderers
+    // need for drawing the peaks.
+    const WaveformData* getPyramidData(int level) const {
+        DEBUG_ASSERT(level >= 0 && level < getPyramidLevelCount());
+        return level == 0 ? data() : m_pyramid[level - 1].max;
+    }
+
+    // Returns the coarsest level that still provides at least one visual
+    // frame per pixel. The visual samples per pixel are measured in
+    // frames, see WaveformWidgetRenderer::getVisualSamplePerPixel().
+    int getPyramidLevel(double visualSamplesPerPixel) const;
+
+    // Updates the pyramid after the data has been completed up to the
+    // given visual index. Must be invoked from the thread that writes
+    // the data.
+    void updatePyramid(int completion);
 
     void dump() const;
 
   private:
+    // WaveformFile stores and maps the storage of the data and the pyramid
+    friend class WaveformFile;
+
+    struct PyramidLevel {
+        WaveformData* max;
+        int size;
+    };
+
     void readByteArray(const QByteArray& data);
     void resize(int size);
     void assign(int size, int value = 0);
-
-    inline WaveformData& at(int i) { return m_data[i];}
-    inline unsigned char& low(int i) { return m_data[i].filtered.low;}
-    inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
-    inline unsigned char& high(int i) { return m_data[i].filtered.high;}
-    inline unsigned char& all(int i) { return m_data[i].filtered.all;}
+    // Lays out the data and the pyramid for a waveform of the given size
+    // and returns the required number of visual samples. The data and
+    // pyramid pointers are set up if pStorage is given.
+    int layoutStorage(int size, int textureSize, WaveformData* pStorage);
+    // Allocates m_storage and lays out the data and the pyramid in it
+    void allocateStorage(int size, int textureSize);
+
+    inline WaveformData& at(int i) { return m_pData[i];}
+    inline unsigned char& low(int i) { return m_pData[i].filtered.low;}
+    inline unsigned char& mid(int i) { return m_pData[i].filtered.mid;}
+    inline unsigned char& high(int i) { return m_pData[i].filtered.high;}
+    inline unsigned char& all(int i) { return m_pData[i].filtered.all;}
     double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
@@ -153,26 +217,37 @@ class Waveform {
     QString m_version;
     QString m_description;
 
-    // The size of the waveform data stored in m_data. Not allowed to change
+    // The size of the waveform data stored in m_pData. Not allowed to change
     // after the constructor runs.
     int m_dataSize;
-    // The vector storing the waveform data. It is potentially larger than
-    // m_dataSize since it includes padding for uploading the entire waveform as
-    // a texture in the GLSL renderer. The size is not allowed to change after
-    // the constructor runs. We use a std::vector to avoid the cost of bounds
-    // checking when accessing the vector.
-    // TODO(XXX): In the future we should switch to QVector and use the raw data
-    // pointer when performance matters.
-    std::vector<WaveformData> m_data;
+    // The waveform data, either in m_storage or in the mapped file. It is
+    // potentially larger than m_dataSize since it includes padding up to
+    // m_textureSize for uploading the entire waveform as a texture in the
+    // GLSL renderer. Not allowed to change after the constructor runs.
+    WaveformData* m_pData;
+    int m_textureSize;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
     double m_audioVisualRatio;
 
-    // We create an NxN texture out of m_data's buffer in the GLSL renderer. The
+    // We create an NxN texture out of the data in the GLSL renderer. The
     // stride is N. Not allowed to change after the constructor runs.
     int m_textureStride;
 
+    // The downsampled levels 1..n of the pyramid, stored behind the data.
+    // Not allowed to change their size after the constructor runs.
+    std::vector<PyramidLevel> m_pyramid;
+    // The data followed by the pyramid, unless they are mapped from
+    // m_pMappedFile. Stored in one piece to match the layout of a
+    // WaveformFile.
+    std::vector<WaveformData> m_storage;
+    // Keeps the mapping alive
+    std::unique_ptr<QFile> m_pMappedFile;
+    // The visual index up to which the pyramid has been updated. Only
+    // accessed by the thread that writes the data.
+    int m_pyramidCompletion;
+
     // For performance, completion is shared as a QAtomicInt and does not lock
     // the mutex. The completion of the waveform calculation.
     QAtomicInt m_completion;
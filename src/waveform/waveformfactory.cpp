@@ -2,11 +2,19 @@
 
 #include "waveform/waveformfactory.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformfile.h"
 
 // static
 Waveform* WaveformFactory::loadWaveformFromAnalysis(
         const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+    Waveform* pWaveform = nullptr;
+    if (analysis.dataFormat == AnalysisDao::DataFormat::WaveformFile) {
+        pWaveform = WaveformFile::load(analysis.dataPath);
+    }
+    if (!pWaveform) {
+        // Also results in an invalid waveform if mapping failed
+        pWaveform = new Waveform(analysis.data);
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
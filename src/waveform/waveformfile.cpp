@@ -0,0 +1,363 @@
+#include "waveform/waveformfile.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "musicbrainz/crc.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "waveform/waveform.h"
+
+namespace {
+
+const mixxx::Logger kLogger("WaveformFile");
+
+constexpr char kMagic[4] = {'M', 'X', 'W', 'F'};
+constexpr char kEndMagic[4] = {'M', 'X', 'W', 'E'};
+
+// 256 KiB per block
+constexpr int kBlockSize = 64 * 1024;
+// The first block is aligned to a cache line
+constexpr int kBlockAlignment = 64;
+
+constexpr int kBytesPerSample = static_cast<int>(sizeof(WaveformData));
+
+constexpr qint64 kFixedHeaderBytes = 48;
+constexpr qint64 kBlockEntryBytes = 24;
+// The end magic followed by the CRC-32 of the header
+constexpr qint64 kEndMarkerBytes = 8;
+
+enum class Codec : quint32 {
+    Raw = 0,
+    Zlib = 1,
+};
+
+struct BlockEntry {
+    Codec codec;
+    quint32 storedBytes;
+    quint64 offset;
+    quint32 checksum;
+};
+
+struct Header {
+    qint32 dataSize;
+    qint32 textureStride;
+    qint32 textureSize;
+    qint32 storageSize;
+    double visualSampleRate;
+    double audioVisualRatio;
+    qint32 blockSize;
+    std::vector<BlockEntry> blocks;
+};
+
+void setupStream(QDataStream* pStream) {
+    pStream->setByteOrder(QDataStream::LittleEndian);
+    pStream->setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+QByteArray writeHeader(const Header& header) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    setupStream(&stream);
+    stream.writeRawData(kMagic, sizeof(kMagic));
+    stream << WaveformFile::kVersion
+           << header.dataSize
+           << header.textureStride
+           << header.textureSize
+           << header.storageSize
+           << header.visualSampleRate
+           << header.audioVisualRatio
+           << header.blockSize
+           << static_cast<qint32>(header.blocks.size());
+    for (const auto& block : header.blocks) {
+        stream << static_cast<quint32>(block.codec)
+               << block.storedBytes
+               << block.offset
+               << block.checksum
+               << quint32(0); // reserved
+    }
+    DEBUG_ASSERT(bytes.size() == kFixedHeaderBytes +
+                    static_cast<qint64>(header.blocks.size()) * kBlockEntryBytes);
+    return bytes;
+}
+
+bool readHeader(QIODevice* pDevice, Header* pHeader, QByteArray* pBytes) {
+    *pBytes = pDevice->read(kFixedHeaderBytes);
+    if (pBytes->size() != kFixedHeaderBytes ||
+            std::memcmp(pBytes->constData(), kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    QDataStream fixedStream(*pBytes);
+    setupStream(&fixedStream);
+    fixedStream.skipRawData(sizeof(kMagic));
+    quint32 version;
+    qint32 blockCount;
+    fixedStream >> version;
+    if (version != WaveformFile::kVersion) {
+        kLogger.warning() << "Unsupported version" << version;
+        return false;
+    }
+    fixedStream >> pHeader->dataSize >> pHeader->textureStride >>
+            pHeader->textureSize >> pHeader->storageSize >>
+            pHeader->visualSampleRate >> pHeader->audioVisualRatio >>
+            pHeader->blockSize >> blockCount;
+    if (fixedStream.status() != QDataStream::Ok ||
+            pHeader->dataSize < 0 ||
+            pHeader->textureStride <= 0 ||
+            pHeader->textureSize < pHeader->dataSize ||
+            pHeader->textureSize % pHeader->textureStride != 0 ||
+            pHeader->storageSize < pHeader->textureSize ||
+            pHeader->blockSize <= 0 ||
+            blockCount != (pHeader->storageSize + pHeader->blockSize - 1) /
+                            pHeader->blockSize) {
+        kLogger.warning() << "Invalid header";
+        return false;
+    }
+
+    const qint64 blockTableBytes = blockCount * kBlockEntryBytes;
+    if (pDevice->bytesAvailable() < blockTableBytes) {
+        return false;
+    }
+    const QByteArray blockTable = pDevice->read(blockTableBytes);
+    if (blockTable.size() != blockTableBytes) {
+        return false;
+    }
+    pBytes->append(blockTable);
+    QDataStream blockStream(blockTable);
+    setupStream(&blockStream);
+    pHeader->blocks.resize(blockCount);
+    for (auto& block : pHeader->blocks) {
+        quint32 codec;
+        quint32 reserved;
+        blockStream >> codec >> block.storedBytes >> block.offset >>
+                block.checksum >> reserved;
+        if (codec != static_cast<quint32>(Codec::Raw) &&
+                codec != static_cast<quint32>(Codec::Zlib)) {
+            kLogger.warning() << "Unsupported codec" << codec;
+            return false;
+        }
+        block.codec = static_cast<Codec>(codec);
+    }
+    return blockStream.status() == QDataStream::Ok;
+}
+
+quint32 crc32(const char* pData, qint64 size) {
+    crc_t crc = crc_init();
+    crc = crc_update(crc,
+            reinterpret_cast<const unsigned char*>(pData),
+            static_cast<size_t>(size));
+    return static_cast<quint32>(crc_finalize(crc));
+}
+
+QByteArray writeEndMarker(const QByteArray& headerBytes) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    setupStream(&stream);
+    stream.writeRawData(kEndMagic, sizeof(kEndMagic));
+    stream << crc32(headerBytes.constData(), headerBytes.size());
+    DEBUG_ASSERT(bytes.size() == kEndMarkerBytes);
+    return bytes;
+}
+
+/// Checks that the end marker follows the last block. It is written last,
+/// so a file that contains it has been written completely.
+bool hasEndMarker(QFile* pFile, const Header& header, const QByteArray& headerBytes) {
+    quint64 end = headerBytes.size();
+    for (const auto& block : header.blocks) {
+        end = math_max(end, block.offset + block.storedBytes);
+    }
+    if (!pFile->seek(static_cast<qint64>(end))) {
+        return false;
+    }
+    const QByteArray bytes = pFile->read(kEndMarkerBytes);
+    if (bytes.size() != kEndMarkerBytes) {
+        return false;
+    }
+    return bytes == writeEndMarker(headerBytes);
+}
+
+int blockBytes(const Header& header, int block) {
+    const int firstSample = block * header.blockSize;
+    return math_min(header.blockSize, header.storageSize - firstSample) *
+            kBytesPerSample;
+}
+
+} // anonymous namespace
+
+// static
+QByteArray WaveformFile::toByteArray(
+        const Waveform& waveform,
+        Compression compression) {
+    Header header;
+    header.dataSize = waveform.m_dataSize;
+    header.textureStride = waveform.m_textureStride;
+    // Only pad the data to full rows of the texture
+    header.textureSize = math_min(waveform.m_textureSize,
+            (waveform.m_dataSize + header.textureStride - 1) /
+                    header.textureStride * header.textureStride);
+    header.visualSampleRate = waveform.m_visualSampleRate;
+    header.audioVisualRatio = waveform.m_audioVisualRatio;
+    header.blockSize = kBlockSize;
+
+    QByteArray storage;
+    storage.reserve(static_cast<int>(waveform.m_storage.size()) * kBytesPerSample);
+    storage.append(reinterpret_cast<const char*>(waveform.m_pData),
+            header.textureSize * kBytesPerSample);
+    for (const auto& level : waveform.m_pyramid) {
+        storage.append(reinterpret_cast<const char*>(level.max),
+                level.size * kBytesPerSample);
+    }
+    header.storageSize = storage.size() / kBytesPerSample;
+
+    const int blockCount = (header.storageSize + kBlockSize - 1) / kBlockSize;
+    const qint64 headerBytes = kFixedHeaderBytes + blockCount * kBlockEntryBytes;
+    quint64 offset = (headerBytes + kBlockAlignment - 1) /
+            kBlockAlignment * kBlockAlignment;
+    QByteArray blocks;
+    for (int i = 0; i < blockCount; ++i) {
+        QByteArray block = storage.mid(i * kBlockSize * kBytesPerSample,
+                blockBytes(header, i));
+        BlockEntry entry;
+        entry.codec = Codec::Raw;
+        if (compression == Compression::Zlib) {
+            QByteArray compressed = qCompress(block);
+            if (compressed.size() < block.size()) {
+                entry.codec = Codec::Zlib;
+                block = compressed;
+            }
+        }
+        entry.storedBytes = block.size();
+        entry.offset = offset;
+        entry.checksum = crc32(block.constData(), block.size());
+        header.blocks.push_back(entry);
+        blocks.append(block);
+        offset += block.size();
+    }
+
+    const QByteArray headerBytes = writeHeader(header);
+    QByteArray bytes = headerBytes;
+    if (!header.blocks.empty()) {
+        // Padding up to the first block
+        bytes.append(QByteArray(
+                static_cast<int>(header.blocks.front().offset) - bytes.size(), '\0'));
+    }
+    bytes.append(blocks);
+    bytes.append(writeEndMarker(headerBytes));
+    return bytes;
+}
+
+// static
+int WaveformFile::headerChecksum(QIODevice* pDevice) {
+    Header header;
+    QByteArray bytes;
+    if (!readHeader(pDevice, &header, &bytes)) {
+        return -1;
+    }
+    return static_cast<int>(crc32(bytes.constData(), bytes.size()) & 0x7fffffff);
+}
+
+// static
+Waveform* WaveformFile::load(const QString& fileName) {
+    auto pFile = std::make_unique<QFile>(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        kLogger.warning() << "Failed to open" << fileName;
+        return nullptr;
+    }
+    Header header;
+    QByteArray headerBytes;
+    if (!readHeader(pFile.get(), &header, &headerBytes)) {
+        kLogger.warning() << "Failed to read header of" << fileName;
+        return nullptr;
+    }
+
+    auto pWaveform = std::make_unique<Waveform>();
+    if (pWaveform->layoutStorage(header.dataSize, header.textureSize, nullptr) !=
+            header.storageSize) {
+        kLogger.warning() << "Unexpected size of" << fileName;
+        return nullptr;
+    }
+
+    // Uncompressed blocks that follow each other can be mapped as a whole
+    const qint64 storageBytes = static_cast<qint64>(header.storageSize) * kBytesPerSample;
+    bool mappable = !header.blocks.empty() &&
+            header.blocks.front().offset + storageBytes <=
+                    static_cast<quint64>(pFile->size());
+    for (int i = 0; mappable && i < static_cast<int>(header.blocks.size()); ++i) {
+        const BlockEntry& block = header.blocks[i];
+        mappable = block.codec == Codec::Raw &&
+                block.offset == header.blocks.front().offset +
+                                static_cast<quint64>(i) * header.blockSize *
+                                        kBytesPerSample;
+    }
+    uchar* pMapped = nullptr;
+    if (mappable) {
+        // Private, so that writes to the waveform never reach the file
+        pMapped = pFile->map(header.blocks.front().offset,
+                storageBytes,
+                QFileDevice::MapPrivateOption);
+    }
+
+    if (pMapped) {
+        // The pages of a file that has been written completely are only
+        // read when the waveform is rendered. Verifying the blocks of
+        // other files pages in the whole file once.
+        const bool verifyBlocks = !hasEndMarker(pFile.get(), header, headerBytes);
+        if (verifyBlocks) {
+            kLogger.info() << "Verifying incompletely written" << fileName;
+        }
+        for (int i = 0; i < static_cast<int>(header.blocks.size()); ++i) {
+            const BlockEntry& block = header.blocks[i];
+            const auto pBlock = reinterpret_cast<const char*>(pMapped) +
+                    static_cast<qint64>(i) * header.blockSize * kBytesPerSample;
+            if (static_cast<int>(block.storedBytes) != blockBytes(header, i) ||
+                    (verifyBlocks &&
+                            crc32(pBlock, block.storedBytes) != block.checksum)) {
+                kLogger.warning() << "Corrupt block" << i << "in" << fileName;
+                return nullptr;
+            }
+        }
+        pWaveform->layoutStorage(header.dataSize,
+                header.textureSize,
+                reinterpret_cast<WaveformData*>(pMapped));
+        pWaveform->m_pMappedFile = std::move(pFile);
+    } else {
+        pWaveform->m_storage.resize(header.storageSize);
+        char* pStorage = reinterpret_cast<char*>(pWaveform->m_storage.data());
+        for (int i = 0; i < static_cast<int>(header.blocks.size()); ++i) {
+            const BlockEntry& block = header.blocks[i];
+            QByteArray bytes;
+            if (pFile->seek(block.offset)) {
+                bytes = pFile->read(block.storedBytes);
+            }
+            if (bytes.size() != static_cast<int>(block.storedBytes) ||
+                    crc32(bytes.constData(), bytes.size()) != block.checksum) {
+                kLogger.warning() << "Corrupt block" << i << "in" << fileName;
+                return nullptr;
+            }
+            if (block.codec == Codec::Zlib) {
+                bytes = qUncompress(bytes);
+            }
+            if (bytes.size() != blockBytes(header, i)) {
+                kLogger.warning() << "Unexpected size of block" << i << "in" << fileName;
+                return nullptr;
+            }
+            std::memcpy(pStorage + static_cast<qint64>(i) * header.blockSize * kBytesPerSample,
+                    bytes.constData(),
+                    bytes.size());
+        }
+        pWaveform->layoutStorage(header.dataSize,
+                header.textureSize,
+                pWaveform->m_storage.data());
+    }
+
+    pWaveform->m_textureStride = header.textureStride;
+    pWaveform->m_visualSampleRate = header.visualSampleRate;
+    pWaveform->m_audioVisualRatio = header.audioVisualRatio;
+    pWaveform->m_pyramidCompletion = header.dataSize;
+    pWaveform->m_completion = header.dataSize;
+    pWaveform->m_saveState = Waveform::SaveState::Saved;
+    return pWaveform.release();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+class Waveform;
+
+/// A versioned binary file format for waveforms with a fixed layout that
+/// can be mapped into memory instead of being parsed.
+///
+/// The file starts with a header that describes the waveform, followed by
+/// a table of blocks. The blocks store the data of the waveform followed by
+/// its pyramid in the same layout that Waveform uses in memory. An end
+/// marker with the CRC-32 of the header follows the last block. If all
+/// blocks are stored uncompressed they are mapped directly instead of being
+/// copied. Compressed blocks are decompressed when loading. The CRC-32 of
+/// each stored block is listed in the table. It is verified when loading
+/// compressed blocks, but for mapped blocks only if the end marker is
+/// missing, so that loading a completely written file doesn't page it in.
+///
+/// All numbers in the header are stored in little endian byte order.
+/// WaveformData is stored byte by byte and doesn't depend on the byte order.
+class WaveformFile {
+  public:
+    /// The version of the file format, incremented on incompatible changes.
+    static constexpr quint32 kVersion = 3;
+
+    enum class Compression {
+        None,
+        /// Each block is compressed with qCompress() if it gets smaller.
+        Zlib,
+    };
+
+    /// Serializes the waveform including its pyramid.
+    static QByteArray toByteArray(
+            const Waveform& waveform,
+            Compression compression = Compression::None);
+
+    /// Returns the CRC-32 of the header at the current position of the
+    /// device, truncated to a non-negative int, or -1 if it doesn't contain
+    /// a valid header, e.g. for waveforms that have been stored with
+    /// Waveform::toByteArray().
+    ///
+    /// The blocks are only covered indirectly by their checksums in the
+    /// header, so that checking the header doesn't require to read the
+    /// whole waveform. The blocks themselves are verified by load() unless
+    /// they are mapped from a completely written file.
+    static int headerChecksum(QIODevice* pDevice);
+
+    /// Maps or reads the waveform from the given file. Returns nullptr
+    /// if the file is not a valid waveform file or any verified block
+    /// doesn't match its checksum.
+    static Waveform* load(const QString& fileName);
+};
@@ -0,0 +1,88 @@
+#include "waveform/waveformrendergovernor.h"
+
+#include "util/math.h"
+
+namespace {
+
+// Unchanged widgets are still rendered at 4 fps
+constexpr int kMaxUnchangedIntervalMicros = 250000;
+
+// Rendering may take this share of the frame interval, the rest is left
+// for the other work of the GUI thread
+constexpr double kRenderBudget = 0.5;
+// Background widgets are rendered more often again when the render time
+// has dropped below this share of the frame interval
+constexpr double kRenderHeadroom = 0.25;
+
+constexpr int kMaxBackgroundDivider = 8;
+
+// The divider is adjusted at most once within this number of frames, to
+// give the smoothed render time a chance to follow
+constexpr int kAdjustmentFrames = 16;
+
+// The weight of the latest frame in the smoothed render time
+constexpr double kRenderTimeAlpha = 0.1;
+
+} // anonymous namespace
+
+WaveformRenderGovernor::WaveformRenderGovernor()
+        : m_enabled(false),
+          m_frameIntervalMicros(1000000 / 30),
+          m_frame(0),
+          m_framesSinceAdjustment(0),
+          m_backgroundDivider(1),
+          m_averageRenderTimeMicros(0.0) {
+}
+
+void WaveformRenderGovernor::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    m_backgroundDivider = 1;
+    m_framesSinceAdjustment = 0;
+    m_skippedFrames.clear();
+}
+
+void WaveformRenderGovernor::setFrameIntervalMicros(int frameIntervalMicros) {
+    m_frameIntervalMicros = math_max(1, frameIntervalMicros);
+}
+
+WaveformRenderGovernor::Decision WaveformRenderGovernor::decide(
+        int widget, bool changed, bool background) {
+    if (!m_enabled) {
+        return Decision::Render;
+    }
+    if (widget >= static_cast<int>(m_skippedFrames.size())) {
+        m_skippedFrames.resize(widget + 1, 0);
+    }
+    int& skippedFrames = m_skippedFrames[widget];
+    const bool refreshDue = skippedFrames + 1 >=
+            kMaxUnchangedIntervalMicros / m_frameIntervalMicros;
+    if (!changed && !refreshDue) {
+        ++skippedFrames;
+        return Decision::SkipUnchanged;
+    }
+    // Spread the throttled widgets across frames
+    if (background && m_backgroundDivider > 1 &&
+            (m_frame + widget) % m_backgroundDivider != 0) {
+        ++skippedFrames;
+        return Decision::SkipThrottled;
+    }
+    skippedFrames = 0;
+    return Decision::Render;
+}
+
+bool WaveformRenderGovernor::frameRendered(int renderTimeMicros) {
+    ++m_frame;
+    m_averageRenderTimeMicros += kRenderTimeAlpha *
+            (renderTimeMicros - m_averageRenderTimeMicros);
+    if (!m_enabled || ++m_framesSinceAdjustment < kAdjustmentFrames) {
+        return false;
+    }
+    const int oldBackgroundDivider = m_backgroundDivider;
+    if (m_averageRenderTimeMicros > m_frameIntervalMicros * kRenderBudget) {
+        m_backgroundDivider = math_min(m_backgroundDivider * 2, kMaxBackgroundDivider);
+    } else if (m_averageRenderTimeMicros < m_frameIntervalMicros * kRenderHeadroom) {
+        m_backgroundDivider = math_max(m_backgroundDivider / 2, 1);
+    }
+    m_framesSinceAdjustment = 0;
+    return m_backgroundDivider != oldBackgroundDivider;
+}
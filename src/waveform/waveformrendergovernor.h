@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+/// Decides which waveform widgets are rendered in a frame of the VSyncThread.
+///
+/// Widgets that show the same as in the previous frame, e.g. those of paused
+/// decks, are skipped and only refreshed now and then to pick up changes
+/// that are not tracked, like moved cues. If rendering takes more than its
+/// share of the frame interval, background widgets are only rendered every
+/// 2nd, 4th or 8th frame, until the render time has dropped again.
+class WaveformRenderGovernor {
+  public:
+    enum class Decision {
+        Render,
+        SkipUnchanged,
+        SkipThrottled,
+    };
+
+    WaveformRenderGovernor();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const {
+        return m_enabled;
+    }
+
+    /// The interval between two frames
+    void setFrameIntervalMicros(int frameIntervalMicros);
+
+    /// Decides whether the widget with the given index is rendered in the
+    /// current frame. Widgets that show a moving waveform of a deck are in
+    /// the foreground, all others in the background.
+    Decision decide(int widget, bool changed, bool background);
+
+    /// Completes the current frame with the time it took to render all
+    /// widgets that have been decided to be rendered. Returns true if the
+    /// background divider has changed.
+    bool frameRendered(int renderTimeMicros);
+
+    /// Background widgets are rendered every n-th frame
+    int backgroundDivider() const {
+        return m_backgroundDivider;
+    }
+
+    /// The smoothed render time of a frame
+    double averageRenderTimeMicros() const {
+        return m_averageRenderTimeMicros;
+    }
+
+  private:
+    bool m_enabled;
+    int m_frameIntervalMicros;
+    int m_frame;
+    int m_framesSinceAdjustment;
+    int m_backgroundDivider;
+    double m_averageRenderTimeMicros;
+    // The number of frames each widget has been skipped in a row
+    std::vector<int> m_skippedFrames;
+};
@@ -11,10 +11,13 @@
 #include <QtDebug>
 
 #include "control/controlpotmeter.h"
+#include "mixer/playermanager.h"
 #include "moc_waveformwidgetfactory.cpp"
 #include "util/cmdlineargs.h"
+#include "util/counter.h"
 #include "util/math.h"
 #include "util/performancetimer.h"
+#include "util/stat.h"
 #include "util/timer.h"
 #include "waveform/guitick.h"
 #include "waveform/sharedglcontext.h"
@@ -24,6 +27,7 @@
 #include "waveform/widgets/glrgbwaveformwidget.h"
 #include "waveform/widgets/glsimplewaveformwidget.h"
 #include "waveform/widgets/glslwaveformwidget.h"
+#include "waveform/widgets/glvbowaveformwidget.h"
 #include "waveform/widgets/glvsynctestwidget.h"
 #include "waveform/widgets/glwaveformwidget.h"
 #include "waveform/widgets/hsvwaveformwidget.h"
@@ -80,7 +84,8 @@ WaveformWidgetAbstractHandle::WaveformWidgetAbstractHandle()
 WaveformWidgetHolder::WaveformWidgetHolder()
         : m_waveformWidget(nullptr),
           m_waveformViewer(nullptr),
-          m_skinContextCache(UserSettingsPointer(), QString()) {
+          m_skinContextCache(UserSettingsPointer(), QString()),
+          m_rendered(false) {
 }
 
 WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidget,
@@ -90,7 +95,8 @@ WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidge
     : m_waveformWidget(waveformWidget),
       m_waveformViewer(waveformViewer),
       m_skinNodeCache(node.cloneNode()),
-      m_skinContextCache(&parentContext) {
+      m_skinContextCache(&parentContext),
+      m_rendered(false) {
 }
 
 ///////////////////////////////////////////
@@ -118,7 +124,8 @@ WaveformWidgetFactory::WaveformWidgetFactory()
           m_frameCnt(0),
           m_actualFrameRate(0),
           m_vSyncType(0),
-          m_playMarkerPosition(WaveformWidgetRenderer::s_defaultPlayMarkerPosition) {
+          m_playMarkerPosition(WaveformWidgetRenderer::s_defaultPlayMarkerPosition),
+          m_pGeometryCache(std::make_shared<WaveformGeometryCache>()) {
     m_visualGain[All] = 1.0;
     m_visualGain[Low] = 1.0;
     m_visualGain[Mid] = 1.0;
@@ -285,6 +292,7 @@ bool WaveformWidgetFactory::setConfig(UserSettingsPointer config) {
 
     int frameRate = m_config->getValue(ConfigKey("[Waveform]","FrameRate"), m_frameRate);
     m_frameRate = math_clamp(frameRate, 1, 120);
+    m_renderGovernor.setFrameIntervalMicros(static_cast<int>(1e6 / m_frameRate));
 
 
     int endTime = m_config->getValueString(ConfigKey("[Waveform]","EndOfTrackWarningTime")).toInt(&ok);
@@ -310,6 +318,10 @@ bool WaveformWidgetFactory::setConfig(UserSettingsPointer config) {
     int beatGridAlpha = m_config->getValue(ConfigKey("[Waveform]", "beatGridAlpha"), m_beatGridAlpha);
     setDisplayBeatGridAlpha(beatGridAlpha);
 
+    bool adaptiveFrameRate = m_config->getValue(
+            ConfigKey("[Waveform]", "AdaptiveFrameRate"), isAdaptiveFrameRate());
+    setAdaptiveFrameRate(adaptiveFrameRate);
+
     WaveformWidgetType::Type type = static_cast<WaveformWidgetType::Type>(
             m_config->getValueString(ConfigKey("[Waveform]","WaveformType")).toInt(&ok));
     // Store the widget type on m_configType for later initialization.
@@ -420,11 +432,19 @@ void WaveformWidgetFactory::setFrameRate(int frameRate) {
     if (m_config) {
         m_config->set(ConfigKey("[Waveform]","FrameRate"), ConfigValue(m_frameRate));
     }
+    m_renderGovernor.setFrameIntervalMicros(static_cast<int>(1e6 / m_frameRate));
     if (m_vsyncThread) {
         m_vsyncThread->setSyncIntervalTimeMicros(static_cast<int>(1e6 / m_frameRate));
     }
 }
 
+void WaveformWidgetFactory::setAdaptiveFrameRate(bool adaptive) {
+    m_renderGovernor.setEnabled(adaptive);
+    if (m_config) {
+        m_config->set(ConfigKey("[Waveform]", "AdaptiveFrameRate"), ConfigValue(adaptive));
+    }
+}
+
 void WaveformWidgetFactory::setEndOfTrackWarningTime(int endTime) {
     m_endOfTrackWarningTime = endTime;
     if (m_config) {
@@ -637,37 +657,60 @@ void WaveformWidgetFactory::render() {
     if (!m_skipRender) {
         if (m_type) {   // no regular updates for an empty waveform
             // next rendered frame is displayed after next buffer swap and than after VSync
-            QVarLengthArray<bool, 10> shouldRenderWaveforms(
-                    static_cast<int>(m_waveformWidgetHolders.size()));
             for (decltype(m_waveformWidgetHolders)::size_type i = 0;
                     i < m_waveformWidgetHolders.size();
                     i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
+                WaveformWidgetHolder& holder = m_waveformWidgetHolders[i];
+                WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
+                holder.m_rendered = false;
                 // Don't bother doing the pre-render work if we aren't going to
                 // render this widget.
-                bool shouldRender = shouldRenderWaveform(pWaveformWidget);
-                shouldRenderWaveforms[i] = shouldRender;
-                if (!shouldRender) {
+                if (!shouldRenderWaveform(pWaveformWidget)) {
                     continue;
                 }
                 // Calculate play position for the new Frame in following run
                 pWaveformWidget->preRender(m_vsyncThread);
+
+                // Waveforms that don't move, e.g. of paused decks, and those
+                // of the preview deck and samplers are in the background
+                const bool background = !pWaveformWidget->isScrolling() ||
+                        !PlayerManager::isDeckGroup(pWaveformWidget->getGroup());
+                switch (m_renderGovernor.decide(static_cast<int>(i),
+                        pWaveformWidget->isFrameChanged(),
+                        background)) {
+                case WaveformRenderGovernor::Decision::SkipUnchanged:
+                    Counter("WaveformWidgetFactory::render() skipped unchanged")++;
+                    break;
+                case WaveformRenderGovernor::Decision::SkipThrottled:
+                    Counter("WaveformWidgetFactory::render() skipped throttled")++;
+                    break;
+                case WaveformRenderGovernor::Decision::Render:
+                    holder.m_rendered = true;
+                    break;
+                }
             }
             //qDebug() << "prerender" << m_vsyncThread->elapsed();
 
             // It may happen that there is an artificially delayed due to
             // anti tearing driver settings
             // all render commands are delayed until the swap from the previous run is executed
-            for (decltype(m_waveformWidgetHolders)::size_type i = 0;
-                    i < m_waveformWidgetHolders.size();
-                    i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
-                if (!shouldRenderWaveforms[i]) {
+            PerformanceTimer renderTimer;
+            renderTimer.start();
+            for (const auto& holder : m_waveformWidgetHolders) {
+                if (!holder.m_rendered) {
                     continue;
                 }
-                pWaveformWidget->render();
+                holder.m_waveformWidget->render();
                 //qDebug() << "render" << i << m_vsyncThread->elapsed();
             }
+            if (m_renderGovernor.frameRendered(
+                        static_cast<int>(renderTimer.elapsed().toIntegerMicros()))) {
+                Stat::track("WaveformWidgetFactory::render() background divider",
+                        Stat::UNSPECIFIED,
+                        Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                                Stat::MIN | Stat::MAX),
+                        m_renderGovernor.backgroundDivider());
+            }
         }
 
         // WSpinnys are also double-buffered QGLWidgets, like all the waveform
@@ -713,7 +756,9 @@ void WaveformWidgetFactory::swap() {
                 // unexposed window. Prevents continuous log spew of
                 // "QOpenGLContext::swapBuffers() called with non-exposed
                 // window, behavior is undefined" on Qt5. See Bug #1779487.
-                if (!shouldRenderWaveform(pWaveformWidget)) {
+                // Widgets that have not been rendered still show their last
+                // frame, but their back buffer is stale.
+                if (!holder.m_rendered || !shouldRenderWaveform(pWaveformWidget)) {
                     continue;
                 }
                 QGLWidget* glw = qobject_cast<QGLWidget*>(pWaveformWidget->getWidget());
@@ -850,6 +895,27 @@ void WaveformWidgetFactory::evaluateWidgets() {
             useOpenGLShaders = GLSLRGBStackedWaveformWidget::useOpenGLShaders();
             developerOnly = GLSLRGBStackedWaveformWidget::developerOnly();
             break;
+        case WaveformWidgetType::GLVBOSimpleWaveform:
+            widgetName = GLVBOSimpleWaveformWidget::getWaveformWidgetName();
+            useOpenGl = GLVBOSimpleWaveformWidget::useOpenGl();
+            useOpenGles = GLVBOSimpleWaveformWidget::useOpenGles();
+            useOpenGLShaders = GLVBOSimpleWaveformWidget::useOpenGLShaders();
+            developerOnly = GLVBOSimpleWaveformWidget::developerOnly();
+            break;
+        case WaveformWidgetType::GLVBOFilteredWaveform:
+            widgetName = GLVBOFilteredWaveformWidget::getWaveformWidgetName();
+            useOpenGl = GLVBOFilteredWaveformWidget::useOpenGl();
+            useOpenGles = GLVBOFilteredWaveformWidget::useOpenGles();
+            useOpenGLShaders = GLVBOFilteredWaveformWidget::useOpenGLShaders();
+            developerOnly = GLVBOFilteredWaveformWidget::developerOnly();
+            break;
+        case WaveformWidgetType::GLVBORGBWaveform:
+            widgetName = GLVBORGBWaveformWidget::getWaveformWidgetName();
+            useOpenGl = GLVBORGBWaveformWidget::useOpenGl();
+            useOpenGles = GLVBORGBWaveformWidget::useOpenGles();
+            useOpenGLShaders = GLVBORGBWaveformWidget::useOpenGLShaders();
+            developerOnly = GLVBORGBWaveformWidget::developerOnly();
+            break;
         case WaveformWidgetType::GLVSyncTest:
             widgetName = GLVSyncTestWidget::getWaveformWidgetName();
             useOpenGl = GLVSyncTestWidget::useOpenGl();
@@ -979,6 +1045,15 @@ WaveformWidgetAbstract* WaveformWidgetFactory::createWaveformWidget(
         case WaveformWidgetType::GLSLRGBStackedWaveform:
             widget = new GLSLRGBStackedWaveformWidget(viewer->getGroup(), viewer);
             break;
+        case WaveformWidgetType::GLVBOSimpleWaveform:
+            widget = new GLVBOSimpleWaveformWidget(viewer->getGroup(), viewer);
+            break;
+        case WaveformWidgetType::GLVBOFilteredWaveform:
+            widget = new GLVBOFilteredWaveformWidget(viewer->getGroup(), viewer);
+            break;
+        case WaveformWidgetType::GLVBORGBWaveform:
+            widget = new GLVBORGBWaveformWidget(viewer->getGroup(), viewer);
+            break;
         case WaveformWidgetType::GLVSyncTest:
             widget = new GLVSyncTestWidget(viewer->getGroup(), viewer);
             break;
@@ -2,13 +2,16 @@
 
 #include <QObject>
 #include <QVector>
+#include <memory>
 #include <vector>
 
 #include "preferences/usersettings.h"
 #include "skin/legacy/skincontext.h"
 #include "util/performancetimer.h"
 #include "util/singleton.h"
+#include "waveform/renderers/waveformgeometrycache.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformrendergovernor.h"
 #include "waveform/widgets/waveformwidgettype.h"
 
 class WVuMeter;
@@ -48,6 +51,8 @@ class WaveformWidgetHolder {
     WWaveformViewer* m_waveformViewer;
     QDomNode m_skinNodeCache;
     SkinContext m_skinContextCache;
+    // Only rendered widgets need their buffers swapped
+    bool m_rendered;
 
     friend class WaveformWidgetFactory;
 };
@@ -72,6 +77,12 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
 
     void setFrameRate(int frameRate);
     int getFrameRate() const { return m_frameRate;}
+    // Skips unchanged waveforms and renders background waveforms at a lower
+    // frame rate while rendering takes too long
+    void setAdaptiveFrameRate(bool adaptive);
+    bool isAdaptiveFrameRate() const {
+        return m_renderGovernor.isEnabled();
+    }
 //    bool getVSync() const { return m_vSyncType;}
     void setEndOfTrackWarningTime(int endTime);
     int getEndOfTrackWarningTime() const { return m_endOfTrackWarningTime;}
@@ -118,6 +129,11 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     void setOverviewNormalized(bool normalize);
     int isOverviewNormalized() const { return m_overviewNormalized;}
 
+    // The geometry of the signal renderers of all waveform widgets
+    std::shared_ptr<WaveformGeometryCache> getGeometryCache() const {
+        return m_pGeometryCache;
+    }
+
     const QVector<WaveformWidgetAbstractHandle> getAvailableTypes() const { return m_waveformWidgetHandles;}
     void getAvailableVSyncTypes(QList<QPair<int, QString > >* list);
     void destroyWidgets();
@@ -197,4 +213,6 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     double m_actualFrameRate;
     int m_vSyncType;
     double m_playMarkerPosition;
+    WaveformRenderGovernor m_renderGovernor;
+    std::shared_ptr<WaveformGeometryCache> m_pGeometryCache;
 };
@@ -0,0 +1,96 @@
+#include "waveform/widgets/glvbowaveformwidget.h"
+
+#include <QPainter>
+#include <QtDebug>
+
+#include "moc_glvbowaveformwidget.cpp"
+#include "util/performancetimer.h"
+#include "waveform/renderers/glvbowaveformrenderersignal.h"
+#include "waveform/renderers/waveformrenderbackground.h"
+#include "waveform/renderers/waveformrenderbeat.h"
+#include "waveform/renderers/waveformrendererendoftrack.h"
+#include "waveform/renderers/waveformrendererpreroll.h"
+#include "waveform/renderers/waveformrendermark.h"
+#include "waveform/renderers/waveformrendermarkrange.h"
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/sharedglcontext.h"
+
+GLVBOSimpleWaveformWidget::GLVBOSimpleWaveformWidget(
+        const QString& group,
+        QWidget* parent)
+        : GLVBOWaveformWidget(group, parent, GLVBOWaveformWidget::VboType::Simple) {
+}
+
+GLVBOFilteredWaveformWidget::GLVBOFilteredWaveformWidget(
+        const QString& group,
+        QWidget* parent)
+        : GLVBOWaveformWidget(group, parent, GLVBOWaveformWidget::VboType::Filtered) {
+}
+
+GLVBORGBWaveformWidget::GLVBORGBWaveformWidget(
+        const QString& group,
+        QWidget* parent)
+        : GLVBOWaveformWidget(group, parent, GLVBOWaveformWidget::VboType::RGB) {
+}
+
+GLVBOWaveformWidget::GLVBOWaveformWidget(
+        const QString& group,
+        QWidget* parent,
+        VboType type)
+        : GLWaveformWidgetAbstract(group, parent) {
+    qDebug() << "Created QGLWidget. Context"
+             << "Valid:" << context()->isValid()
+             << "Sharing:" << context()->isSharing();
+    if (QGLContext::currentContext() != context()) {
+        makeCurrent();
+    }
+
+    addRenderer<WaveformRenderBackground>();
+    addRenderer<WaveformRendererEndOfTrack>();
+    addRenderer<WaveformRendererPreroll>();
+    addRenderer<WaveformRenderMarkRange>();
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+    switch (type) {
+    case VboType::Simple:
+        m_pGlRenderer = addRenderer<GLVBOWaveformRendererSimpleSignal>();
+        break;
+    case VboType::Filtered:
+        m_pGlRenderer = addRenderer<GLVBOWaveformRendererFilteredSignal>();
+        break;
+    case VboType::RGB:
+        m_pGlRenderer = addRenderer<GLVBOWaveformRendererRGBSignal>();
+        break;
+    }
+#else
+    Q_UNUSED(type);
+#endif // !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+    addRenderer<WaveformRenderBeat>();
+    addRenderer<WaveformRenderMark>();
+
+    setAttribute(Qt::WA_NoSystemBackground);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    setAutoBufferSwap(false);
+
+    m_initSuccess = init();
+}
+
+void GLVBOWaveformWidget::castToQWidget() {
+    m_widget = this;
+}
+
+void GLVBOWaveformWidget::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+}
+
+mixxx::Duration GLVBOWaveformWidget::render() {
+    PerformanceTimer timer;
+    mixxx::Duration t1;
+    timer.start();
+    // QPainter makes QGLContext::currentContext() == context()
+    // this may delayed until previous buffer swap finished
+    QPainter painter(this);
+    t1 = timer.restart();
+    draw(&painter, nullptr);
+    return t1; // return timer for painter setup
+}
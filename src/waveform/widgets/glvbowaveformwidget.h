@@ -0,0 +1,107 @@
+#pragma once
+
+#include "waveform/widgets/glwaveformwidgetabstract.h"
+
+class GLVBOWaveformWidget : public GLWaveformWidgetAbstract {
+    Q_OBJECT
+  public:
+    enum class VboType {
+        Simple,
+        Filtered,
+        RGB,
+    };
+    GLVBOWaveformWidget(
+            const QString& group,
+            QWidget* parent,
+            VboType type);
+    ~GLVBOWaveformWidget() override = default;
+
+  protected:
+    void castToQWidget() override;
+    void paintEvent(QPaintEvent* event) override;
+    mixxx::Duration render() override;
+
+  private:
+    friend class WaveformWidgetFactory;
+};
+
+class GLVBOSimpleWaveformWidget : public GLVBOWaveformWidget {
+    Q_OBJECT
+  public:
+    GLVBOSimpleWaveformWidget(const QString& group, QWidget* parent);
+    ~GLVBOSimpleWaveformWidget() override = default;
+
+    WaveformWidgetType::Type getType() const override {
+        return WaveformWidgetType::GLVBOSimpleWaveform;
+    }
+
+    static inline QString getWaveformWidgetName() {
+        return tr("Simple (VBO)");
+    }
+    static inline bool useOpenGl() {
+        return true;
+    }
+    static inline bool useOpenGles() {
+        return false;
+    }
+    static inline bool useOpenGLShaders() {
+        return true;
+    }
+    static inline bool developerOnly() {
+        return false;
+    }
+};
+
+class GLVBOFilteredWaveformWidget : public GLVBOWaveformWidget {
+    Q_OBJECT
+  public:
+    GLVBOFilteredWaveformWidget(const QString& group, QWidget* parent);
+    ~GLVBOFilteredWaveformWidget() override = default;
+
+    WaveformWidgetType::Type getType() const override {
+        return WaveformWidgetType::GLVBOFilteredWaveform;
+    }
+
+    static inline QString getWaveformWidgetName() {
+        return tr("Filtered (VBO)");
+    }
+    static inline bool useOpenGl() {
+        return true;
+    }
+    static inline bool useOpenGles() {
+        return false;
+    }
+    static inline bool useOpenGLShaders() {
+        return true;
+    }
+    static inline bool developerOnly() {
+        return false;
+    }
+};
+
+class GLVBORGBWaveformWidget : public GLVBOWaveformWidget {
+    Q_OBJECT
+  public:
+    GLVBORGBWaveformWidget(const QString& group, QWidget* parent);
+    ~GLVBORGBWaveformWidget() override = default;
+
+    WaveformWidgetType::Type getType() const override {
+        return WaveformWidgetType::GLVBORGBWaveform;
+    }
+
+    static inline QString getWaveformWidgetName() {
+        return tr("RGB (VBO)");
+    }
+    static inline bool useOpenGl() {
+        return true;
+    }
+    static inline bool useOpenGles() {
+        return false;
+    }
+    static inline bool useOpenGLShaders() {
+        return true;
+    }
+    static inline bool developerOnly() {
+        return false;
+    }
+};
@@ -22,6 +22,9 @@ class WaveformWidgetType {
         QtHSVWaveform,           // 14 HSV Qt
         QtRGBWaveform,           // 15 RGB Qt
         GLSLRGBStackedWaveform,  // 16 RGB Stacked
-        Count_WaveformwidgetType // 17 Also used as invalid value
+        GLVBOSimpleWaveform,     // 17 Simple VBO
+        GLVBOFilteredWaveform,   // 18 Filtered VBO
+        GLVBORGBWaveform,        // 19 RGB VBO
+        Count_WaveformwidgetType // 20 Also used as invalid value
     };
 };
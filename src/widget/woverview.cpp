@@ -18,7 +18,9 @@
 #include <QPaintEvent>
 #include <QPainter>
 #include <QUrl>
+#include <QtConcurrentRun>
 #include <QtDebug>
+#include <algorithm>
 
 #include "analyzer/analyzerprogress.h"
 #include "control/controlobject.h"
@@ -40,21 +42,39 @@
 #include "widget/controlwidgetconnection.h"
 #include "wskincolor.h"
 
+namespace {
+
+// The number of visual samples per channel of the waveform summary
+// per tile. The summary of a track has 1920 samples per channel.
+constexpr int kTileWidth = 128;
+
+// Scaled tiles are kept for this number of sizes, e.g. for switching
+// between the normal and the maximized library
+constexpr std::size_t kMaxScaledTileSets = 2;
+
+} // anonymous namespace
+
 WOverview::WOverview(
         const QString& group,
         PlayerManager* pPlayerManager,
         UserSettingsPointer pConfig,
+        DrawTileFunction drawTile,
+        bool scaleTilesWithDevicePixelRatio,
         QWidget* parent)
         : WWidget(parent),
-          m_actualCompletion(0),
-          m_pixmapDone(false),
-          m_waveformPeak(-1.0),
-          m_diffGain(0),
           m_devicePixelRatio(1.0),
           m_group(group),
           m_pConfig(pConfig),
           m_endOfTrack(false),
           m_bPassthroughEnabled(false),
+          m_drawTile(drawTile),
+          m_bScaleTilesWithDevicePixelRatio(scaleTilesWithDevicePixelRatio),
+          m_tileGeneration(0),
+          m_actualCompletion(0),
+          m_pixmapDone(false),
+          m_waveformPeak(-1.0),
+          m_pTileRenderWatcher(new QFutureWatcher<TileRenderResult>(this)),
+          m_tileRenderPending(false),
           m_pCueMenuPopup(make_parented<WCueMenuPopup>(pConfig, this)),
           m_bShowCueTimes(true),
           m_iPosSeconds(0),
@@ -97,6 +117,11 @@ WOverview::WOverview(
 
     connect(m_pCueMenuPopup.get(), &WCueMenuPopup::aboutToHide, this, &WOverview::slotCueMenuPopupAboutToHide);
 
+    connect(m_pTileRenderWatcher,
+            &QFutureWatcher<TileRenderResult>::finished,
+            this,
+            &WOverview::slotTilesRendered);
+
     m_pPassthroughLabel = new QLabel(this);
     m_pPassthroughLabel->setObjectName("PassthroughLabel");
     m_pPassthroughLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
@@ -269,22 +294,20 @@ void WOverview::slotWaveformSummaryUpdated() {
     if (!pTrack) {
         return;
     }
-    m_pWaveform = pTrack->getWaveformSummary();
-    if (m_pWaveform) {
+    ConstWaveformPointer pWaveform = pTrack->getWaveformSummary();
+    if (pWaveform) {
         // If the waveform is already complete, just draw it.
-        if (m_pWaveform->getCompletion() == m_pWaveform->getDataSize()) {
-            m_actualCompletion = 0;
-            if (drawNextPixmapPart()) {
-                update();
-            }
+        if (pWaveform != m_pWaveform ||
+                pWaveform->getCompletion() == pWaveform->getDataSize()) {
+            m_pWaveform = pWaveform;
+            resetTiles();
+            renderNextTiles();
         }
     } else {
         // Null waveform pointer means waveform was cleared.
-        m_waveformSourceImage = QImage();
+        m_pWaveform.clear();
+        resetTiles();
         m_analyzerProgress = kAnalyzerProgressUnknown;
-        m_actualCompletion = 0;
-        m_waveformPeak = -1.0;
-        m_pixmapDone = false;
 
         update();
     }
@@ -295,13 +318,167 @@ void WOverview::onTrackAnalyzerProgress(TrackId trackId, AnalyzerProgress analyz
         return;
     }
 
-    bool updateNeeded = drawNextPixmapPart();
-    if (updateNeeded || (m_analyzerProgress != analyzerProgress)) {
+    // The widget is updated when the tiles are done
+    renderNextTiles();
+    if (m_analyzerProgress != analyzerProgress) {
         m_analyzerProgress = analyzerProgress;
         update();
     }
 }
 
+void WOverview::renderNextTiles() {
+    ConstWaveformPointer pWaveform = getWaveform();
+    if (!pWaveform) {
+        return;
+    }
+
+    const int dataSize = pWaveform->getDataSize();
+    if (dataSize == 0) {
+        return;
+    }
+
+    if (m_pTileRenderWatcher->isRunning()) {
+        // The new data is drawn onto the tiles that are currently drawn
+        m_tileRenderPending = true;
+        return;
+    }
+
+    if (m_sourceTiles.empty()) {
+        m_tileStyle.signalColors = m_signalColors;
+        m_tileStyle.verticalScale =
+                m_bScaleTilesWithDevicePixelRatio ? m_devicePixelRatio : 1.0;
+        // Tiles twice the height of the viewport to be scalable
+        // by total_gain
+        // We keep full range waveform data to scale it on paint
+        const int tileHeight = static_cast<int>(2 * 255 * m_tileStyle.verticalScale);
+        const int sourceWidth = dataSize / 2;
+        for (int x = 0; x < sourceWidth; x += kTileWidth) {
+            QImage tile(math_min(kTileWidth, sourceWidth - x),
+                    tileHeight,
+                    QImage::Format_ARGB32_Premultiplied);
+            tile.fill(Qt::transparent);
+            m_sourceTiles.push_back(std::move(tile));
+        }
+        m_scaledTiles.clear();
+    }
+
+    // Always multiple of 2
+    const int waveformCompletion = math_min(pWaveform->getCompletion(), dataSize);
+    // Test if there is some new to draw (at least of pixel width)
+    const int completionIncrement = waveformCompletion - m_actualCompletion;
+    if (completionIncrement <= 0) {
+        return;
+    }
+
+    const int visiblePixelIncrement = completionIncrement * length() / dataSize;
+    if (waveformCompletion < (dataSize - 2) &&
+            (completionIncrement < 2 || visiblePixelIncrement == 0)) {
+        return;
+    }
+
+    TileRenderJob job;
+    job.drawTile = m_drawTile;
+    job.style = m_tileStyle;
+    job.pWaveform = pWaveform;
+    job.generation = m_tileGeneration;
+    job.firstCompletion = m_actualCompletion;
+    job.endCompletion = waveformCompletion;
+    const int firstTile = m_actualCompletion / 2 / kTileWidth;
+    const int lastTile = math_min((waveformCompletion - 1) / 2 / kTileWidth,
+            static_cast<int>(m_sourceTiles.size()) - 1);
+    for (int tile = firstTile; tile <= lastTile; ++tile) {
+        // Implicitly shared until the worker thread draws onto it
+        job.tiles.emplace_back(tile, m_sourceTiles[tile]);
+    }
+    m_actualCompletion = waveformCompletion;
+
+    m_pTileRenderWatcher->setFuture(QtConcurrent::run(&WOverview::renderTiles, job));
+}
+
+// static
+WOverview::TileRenderResult WOverview::renderTiles(const TileRenderJob& job) {
+    ScopedTimer t("WOverview::renderTiles");
+
+    const Waveform& waveform = *job.pWaveform;
+    TileRenderResult result;
+    result.generation = job.generation;
+    result.completion = job.endCompletion;
+    result.dataSize = waveform.getDataSize();
+    result.tiles = job.tiles;
+
+    for (auto& tile : result.tiles) {
+        const int tileFirstCompletion = tile.first * kTileWidth * 2;
+        const int firstCompletion = math_max(job.firstCompletion, tileFirstCompletion);
+        const int endCompletion = math_min(job.endCompletion,
+                tileFirstCompletion + tile.second.width() * 2);
+        QPainter painter(&tile.second);
+        painter.translate(-static_cast<double>(tile.first * kTileWidth),
+                static_cast<double>(tile.second.height()) / 2.0);
+        job.drawTile(&painter, waveform, firstCompletion, endCompletion, job.style);
+    }
+
+    // Evaluate waveform ratio peak
+    float peak = -1.0f;
+    for (int currentCompletion = job.firstCompletion;
+            currentCompletion < job.endCompletion;
+            currentCompletion += 2) {
+        peak = math_max3(peak,
+                static_cast<float>(waveform.getAll(currentCompletion)),
+                static_cast<float>(waveform.getAll(currentCompletion + 1)));
+    }
+    result.peak = peak;
+    return result;
+}
+
+void WOverview::slotTilesRendered() {
+    const TileRenderResult result = m_pTileRenderWatcher->result();
+    if (result.generation == m_tileGeneration) {
+        for (const auto& tile : result.tiles) {
+            m_sourceTiles[tile.first] = tile.second;
+            for (auto& scaledTiles : m_scaledTiles) {
+                scaledTiles.images[tile.first] = QImage();
+            }
+        }
+        m_waveformPeak = math_max(m_waveformPeak, result.peak);
+        // Test if the complete waveform is done
+        if (result.completion >= result.dataSize - 2) {
+            m_pixmapDone = true;
+        }
+        update();
+    }
+
+    if (m_tileRenderPending) {
+        m_tileRenderPending = false;
+        renderNextTiles();
+    }
+}
+
+void WOverview::resetTiles() {
+    m_sourceTiles.clear();
+    m_scaledTiles.clear();
+    ++m_tileGeneration;
+    m_actualCompletion = 0;
+    m_waveformPeak = -1.0;
+    m_pixmapDone = false;
+}
+
+std::vector<QImage>& WOverview::scaledTiles(QSize deviceSize, float diffGain) {
+    for (auto it = m_scaledTiles.begin(); it != m_scaledTiles.end(); ++it) {
+        if (it->deviceSize == deviceSize && it->diffGain == diffGain) {
+            std::rotate(m_scaledTiles.begin(), it, it + 1);
+            return m_scaledTiles.front().images;
+        }
+    }
+    if (m_scaledTiles.size() >= kMaxScaledTileSets) {
+        m_scaledTiles.pop_back();
+    }
+    m_scaledTiles.insert(m_scaledTiles.begin(),
+            ScaledTiles{deviceSize,
+                    diffGain,
+                    std::vector<QImage>(m_sourceTiles.size())});
+    return m_scaledTiles.front().images;
+}
+
 void WOverview::slotTrackLoaded(TrackPointer pTrack) {
     Q_UNUSED(pTrack); // only used in DEBUG_ASSERT
     DEBUG_ASSERT(m_pCurrentTrack == pTrack);
@@ -323,11 +500,8 @@ void WOverview::slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack)
                 &WOverview::slotWaveformSummaryUpdated);
     }
 
-    m_waveformSourceImage = QImage();
+    resetTiles();
     m_analyzerProgress = kAnalyzerProgressUnknown;
-    m_actualCompletion = 0;
-    m_waveformPeak = -1.0;
-    m_pixmapDone = false;
     m_trackLoaded = false;
     m_endOfTrack = false;
 
@@ -631,53 +805,84 @@ void WOverview::drawAxis(QPainter* pPainter) {
 
 void WOverview::drawWaveformPixmap(QPainter* pPainter) {
     WaveformWidgetFactory* widgetFactory = WaveformWidgetFactory::instance();
-    if (!m_waveformSourceImage.isNull()) {
-        PainterScope painterScope(pPainter);
-        float diffGain;
-        bool normalize = widgetFactory->isOverviewNormalized();
-        if (normalize && m_pixmapDone && m_waveformPeak > 1) {
-            diffGain = 255 - m_waveformPeak - 1;
-        } else {
-            const auto visualGain = static_cast<float>(
-                    widgetFactory->getVisualGain(WaveformWidgetFactory::All));
-            diffGain = 255.0f - (255.0f / visualGain);
-        }
+    if (m_sourceTiles.empty()) {
+        return;
+    }
+    PainterScope painterScope(pPainter);
+    float diffGain;
+    bool normalize = widgetFactory->isOverviewNormalized();
+    if (normalize && m_pixmapDone && m_waveformPeak > 1) {
+        diffGain = 255 - m_waveformPeak - 1;
+    } else {
+        const auto visualGain = static_cast<float>(
+                widgetFactory->getVisualGain(WaveformWidgetFactory::All));
+        diffGain = 255.0f - (255.0f / visualGain);
+    }
 
-        if (m_diffGain != diffGain || m_waveformImageScaled.isNull()) {
-            QRect sourceRect(0,
-                    static_cast<int>(diffGain),
-                    m_waveformSourceImage.width(),
-                    m_waveformSourceImage.height() -
-                            2 * static_cast<int>(diffGain));
-            QImage croppedImage = m_waveformSourceImage.copy(sourceRect);
+    const QSize deviceSize = size() * m_devicePixelRatio;
+    const int deviceLength = m_orientation == Qt::Horizontal
+            ? deviceSize.width()
+            : deviceSize.height();
+    const int deviceBreadth = m_orientation == Qt::Horizontal
+            ? deviceSize.height()
+            : deviceSize.width();
+    const int sourceWidth = static_cast<int>(m_sourceTiles.size() - 1) * kTileWidth +
+            m_sourceTiles.back().width();
+    const int crop = static_cast<int>(diffGain * m_tileStyle.verticalScale);
+
+    std::vector<QImage>& scaledImages = scaledTiles(deviceSize, diffGain);
+    for (int tile = 0; tile < static_cast<int>(m_sourceTiles.size()); ++tile) {
+        const QImage& sourceTile = m_sourceTiles[tile];
+        // The device pixels covered by this tile
+        const int begin = tile * kTileWidth * deviceLength / sourceWidth;
+        const int end = (tile * kTileWidth + sourceTile.width()) * deviceLength / sourceWidth;
+        if (end <= begin) {
+            continue;
+        }
+        QImage& scaledTile = scaledImages[tile];
+        if (scaledTile.isNull()) {
+            QImage croppedTile = sourceTile.copy(0,
+                    crop,
+                    sourceTile.width(),
+                    sourceTile.height() - 2 * crop);
             if (m_orientation == Qt::Vertical) {
-                // Rotate pixmap
-                croppedImage = croppedImage.transformed(QTransform(0, 1, 1, 0, 0, 0));
+                // Rotate tile
+                croppedTile = croppedTile.transformed(QTransform(0, 1, 1, 0, 0, 0));
+                scaledTile = croppedTile.scaled(deviceBreadth,
+                        end - begin,
+                        Qt::IgnoreAspectRatio,
+                        Qt::SmoothTransformation);
+            } else {
+                scaledTile = croppedTile.scaled(end - begin,
+                        deviceBreadth,
+                        Qt::IgnoreAspectRatio,
+                        Qt::SmoothTransformation);
             }
-            m_waveformImageScaled = croppedImage.scaled(size() * m_devicePixelRatio,
-                    Qt::IgnoreAspectRatio,
-                    Qt::SmoothTransformation);
-            m_diffGain = diffGain;
         }
-
-        pPainter->drawImage(rect(), m_waveformImageScaled);
+        const qreal position = begin / m_devicePixelRatio;
+        const qreal extent = (end - begin) / m_devicePixelRatio;
+        if (m_orientation == Qt::Vertical) {
+            pPainter->drawImage(QRectF(0, position, width(), extent), scaledTile);
+        } else {
+            pPainter->drawImage(QRectF(position, 0, extent, height()), scaledTile);
+        }
     }
 }
 
 void WOverview::drawPlayedOverlay(QPainter* pPainter) {
     // Overlay the played part of the overview-waveform with a skin defined color
-    if (!m_waveformSourceImage.isNull() && m_playedOverlayColor.alpha() > 0) {
+    if (!m_sourceTiles.empty() && m_playedOverlayColor.alpha() > 0) {
         if (m_orientation == Qt::Vertical) {
             pPainter->fillRect(0,
                     0,
-                    m_waveformImageScaled.width(),
+                    width(),
                     m_iPlayPos,
                     m_playedOverlayColor);
         } else {
             pPainter->fillRect(0,
                     0,
                     m_iPlayPos,
-                    m_waveformImageScaled.height(),
+                    height(),
                     m_playedOverlayColor);
         }
     }
@@ -1191,7 +1396,7 @@ void WOverview::drawMarkLabels(QPainter* pPainter, const float offset, const flo
 }
 
 void WOverview::drawPassthroughOverlay(QPainter* pPainter) {
-    if (!m_waveformSourceImage.isNull() && m_passthroughOverlayColor.alpha() > 0) {
+    if (!m_sourceTiles.empty() && m_passthroughOverlayColor.alpha() > 0) {
         // Overlay the entire overview-waveform with a skin defined color
         pPainter->fillRect(rect(), m_passthroughOverlayColor);
     }
@@ -1246,10 +1451,9 @@ void WOverview::resizeEvent(QResizeEvent* pEvent) {
     m_a = (length() - 1) / (one - zero);
     m_b = zero * m_a;
 
+    // The scaled tiles are cached per size, so they are kept
     m_devicePixelRatio = getDevicePixelRatioF(this);
 
-    m_waveformImageScaled = QImage();
-    m_diffGain = 0;
     Init();
 }
 
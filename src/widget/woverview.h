@@ -12,10 +12,13 @@
 #pragma once
 
 #include <QColor>
+#include <QFutureWatcher>
 #include <QList>
 #include <QMouseEvent>
 #include <QPaintEvent>
 #include <QPixmap>
+#include <utility>
+#include <vector>
 
 #include "analyzer/analyzerprogress.h"
 #include "skin/legacy/skincontext.h"
@@ -51,10 +54,29 @@ class WOverview : public WWidget, public TrackDropTarget {
     void cloneDeck(const QString& sourceGroup, const QString& targetGroup) override;
 
   protected:
+    /// Everything that is needed to draw a tile besides the waveform.
+    /// Tiles are drawn on a worker thread, so this is a copy.
+    struct TileStyle {
+        WaveformSignalColors signalColors;
+        // Source pixels per waveform value in vertical direction
+        qreal verticalScale = 1.0;
+    };
+
+    /// Draws the visual samples [firstCompletion, endCompletion) at
+    /// x = completion / 2 with the axis at y = 0. Invoked on a worker
+    /// thread and must not access the widget.
+    typedef void (*DrawTileFunction)(QPainter* pPainter,
+            const Waveform& waveform,
+            int firstCompletion,
+            int endCompletion,
+            const TileStyle& style);
+
     WOverview(
             const QString& group,
             PlayerManager* pPlayerManager,
             UserSettingsPointer pConfig,
+            DrawTileFunction drawTile,
+            bool scaleTilesWithDevicePixelRatio,
             QWidget* parent = nullptr);
 
     void mouseMoveEvent(QMouseEvent* e) override;
@@ -78,18 +100,8 @@ class WOverview : public WWidget, public TrackDropTarget {
         return m_pWaveform;
     }
 
-    QImage m_waveformSourceImage;
-    QImage m_waveformImageScaled;
-
     WaveformSignalColors m_signalColors;
 
-    // Hold the last visual sample processed to generate the pixmap
-    int m_actualCompletion;
-
-    bool m_pixmapDone;
-    float m_waveformPeak;
-
-    float m_diffGain;
     qreal m_devicePixelRatio;
 
   private slots:
@@ -103,11 +115,42 @@ class WOverview : public WWidget, public TrackDropTarget {
 
     void slotWaveformSummaryUpdated();
     void slotCueMenuPopupAboutToHide();
+    void slotTilesRendered();
 
   private:
-    // Append the waveform overview pixmap according to available data
-    // in waveform
-    virtual bool drawNextPixmapPart() = 0;
+    struct TileRenderJob {
+        DrawTileFunction drawTile;
+        TileStyle style;
+        ConstWaveformPointer pWaveform;
+        int generation;
+        int firstCompletion;
+        int endCompletion;
+        // The tile indexes with the current content of the tiles
+        std::vector<std::pair<int, QImage>> tiles;
+    };
+
+    struct TileRenderResult {
+        int generation;
+        int completion;
+        int dataSize;
+        float peak;
+        std::vector<std::pair<int, QImage>> tiles;
+    };
+
+    // The scaled tiles for one size of the widget and gain
+    struct ScaledTiles {
+        QSize deviceSize;
+        float diffGain;
+        std::vector<QImage> images;
+    };
+
+    // Starts drawing the tiles that have new data in the waveform on a
+    // worker thread, unless the previous tiles are still being drawn
+    void renderNextTiles();
+    static TileRenderResult renderTiles(const TileRenderJob& job);
+    void resetTiles();
+    std::vector<QImage>& scaledTiles(QSize deviceSize, float diffGain);
+
     void drawEndOfTrackBackground(QPainter* pPainter);
     void drawAxis(QPainter* pPainter);
     void drawWaveformPixmap(QPainter* pPainter);
@@ -147,6 +190,25 @@ class WOverview : public WWidget, public TrackDropTarget {
     TrackPointer m_pCurrentTrack;
     ConstWaveformPointer m_pWaveform;
 
+    const DrawTileFunction m_drawTile;
+    const bool m_bScaleTilesWithDevicePixelRatio;
+    // The waveform overview is drawn in tiles of fixed width with one
+    // column per visual sample. Only the tiles with new data are redrawn
+    // while the track is analyzed.
+    std::vector<QImage> m_sourceTiles;
+    TileStyle m_tileStyle;
+    // Most recently used first
+    std::vector<ScaledTiles> m_scaledTiles;
+    // Incremented whenever the tiles are discarded to ignore the tiles
+    // that are still being drawn
+    int m_tileGeneration;
+    // The last visual sample that has been passed to renderTiles()
+    int m_actualCompletion;
+    bool m_pixmapDone;
+    float m_waveformPeak;
+    QFutureWatcher<TileRenderResult>* m_pTileRenderWatcher;
+    bool m_tileRenderPending;
+
     parented_ptr<WCueMenuPopup> m_pCueMenuPopup;
     bool m_bShowCueTimes;
 
@@ -11,5 +11,9 @@ class WOverviewHSV : public WOverview {
             QWidget* parent = nullptr);
 
   private:
-    bool drawNextPixmapPart() override;
+    static void drawTile(QPainter* pPainter,
+            const Waveform& waveform,
+            int firstCompletion,
+            int endCompletion,
+            const TileStyle& style);
 };